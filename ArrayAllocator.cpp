@@ -0,0 +1,468 @@
+//
+//                           A r r a y  A l l o c a t o r . c p p
+//
+//  Function:
+//     Pluggable memory allocation backends for the ArrayManager class.
+//
+//  Description:
+//     See the .h file for a description of the allocators from a user's perspective. This
+//     file provides the implementation. The MallocAllocator is trivial. The interesting code
+//     is the ArenaAllocator, and in particular SizeClass(), which decides how requests are
+//     rounded up, and Carve(), which hands out the memory from the chunks.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added NumaAllocator.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//  NumaAllocator needs mmap(), madvise() and syscall(), which the -ansi option the ArrayManager
+//  self-test is built with hides unless they're asked for before any includes.
+
+#if defined(__linux__)
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#define AA_HAVE_NUMA
+#endif
+
+#include <stdio.h>
+
+#include "ArrayAllocator.h"
+
+#ifdef AA_HAVE_NUMA
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef unsigned char Byte;
+
+//  Everything the arena hands out is a multiple of 64 bytes long and starts on a 64 byte
+//  boundary from the start of its chunk. The chunk header is padded to 64 bytes, and malloc()
+//  gives at least 16 byte alignment, so every block is at least as well aligned as anything
+//  malloc() returns - which is all the ArrayAllocator interface promises.
+
+static const size_t Granule = 64;
+
+static const size_t ChunkHeaderBytes = ((sizeof(ArenaChunk) + Granule - 1) / Granule) * Granule;
+
+//  The default chunk size. Large enough that a typical set of work arrays for one frame fits
+//  in a handful of chunks, small enough not to matter for a program that only uses a little.
+
+static const size_t DefaultChunkBytes = 4 * 1024 * 1024;
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          D e f a u l t
+//
+//  Default() returns the shared MallocAllocator used by any ArrayManager that hasn't been told
+//  to use anything else. It has no state, so sharing it causes no problems.
+
+ArrayAllocator* ArrayAllocator::Default (void)
+{
+   static MallocAllocator TheDefault;
+   return &TheDefault;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                               M a l l o c  A l l o c a t o r
+
+void* MallocAllocator::Allocate (size_t Bytes)
+{
+   return malloc (Bytes);
+}
+
+void MallocAllocator::Release (void* Block, size_t /*Bytes*/)
+{
+   free (Block);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     C o n s t r u c t o r
+//
+//  The ArenaAllocator constructor doesn't obtain any memory - that waits until the first
+//  allocation. ChunkBytes is the size of the chunks it obtains from the system. Zero means
+//  use the default size. A request too big for a chunk of this size gets a chunk of its own.
+
+ArenaAllocator::ArenaAllocator (size_t ChunkBytes)
+{
+   I_ChunkBytes = ChunkBytes ? ChunkBytes : DefaultChunkBytes;
+   I_First = NULL;
+   I_Current = NULL;
+   for (int IClass = 0; IClass < NClasses; IClass++) I_FreeLists[IClass] = NULL;
+   I_BytesReserved = 0;
+   I_Recycled = 0;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      D e s t r u c t o r
+
+ArenaAllocator::~ArenaAllocator ()
+{
+   FreeChunks();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      S i z e  C l a s s
+//
+//  SizeClass() returns the size class for a request of a given number of bytes, and sets
+//  ClassBytes to the size of the blocks in that class. Requests of up to 256 bytes are rounded
+//  up to a multiple of 64 bytes. Above that, each power of two is split into four classes, so
+//  that a request is never rounded up by more than 25% - which matters when the blocks are the
+//  data for large arrays. With 192 classes this covers anything that will fit in memory. The
+//  point of the size classes is that a block released to a free list can be reused for any
+//  request in the same class, not just one of exactly the same size, but since ArrayManager
+//  requests for same-shaped arrays are always exactly the same size, what matters most is that
+//  they always map to the same class, which they obviously do.
+
+int ArenaAllocator::SizeClass (size_t Bytes, size_t* ClassBytes)
+{
+   int IClass = 0;
+   if (Bytes <= 4 * Granule) {
+      if (Bytes > 0) IClass = int((Bytes - 1) / Granule);
+      *ClassBytes = (IClass + 1) * Granule;
+   } else {
+
+      //  Find the power of two, Base, such that Base < Bytes <= 2 * Base, and then which
+      //  quarter of the range above Base the request falls into. The classes for the
+      //  range 256..512 start at 4.
+
+      size_t Base = 4 * Granule;
+      int Power = 0;
+      while (Bytes > 2 * Base) {
+         Base *= 2;
+         Power++;
+      }
+      size_t Step = Base / 4;
+      int Quarter = int((Bytes - Base - 1) / Step);
+      IClass = 4 + (Power * 4) + Quarter;
+      *ClassBytes = Base + (Quarter + 1) * Step;
+   }
+   return IClass;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         A l l o c a t e
+//
+//  Allocate() first looks at the free list for the request's size class, and returns the first
+//  block on it if there is one. Otherwise, it carves a new block of the class size out of the
+//  chunks. Size classes beyond the last free list can't actually happen with 192 of them, but
+//  are handled - they're simply never recycled - rather than assumed.
+
+void* ArenaAllocator::Allocate (size_t Bytes)
+{
+   size_t ClassBytes = 0;
+   int IClass = SizeClass (Bytes,&ClassBytes);
+   void* Block = NULL;
+   if (IClass < NClasses && I_FreeLists[IClass]) {
+      Block = I_FreeLists[IClass];
+      I_FreeLists[IClass] = *((void**) Block);
+      I_Recycled++;
+   } else {
+      Block = Carve (ClassBytes);
+   }
+   return Block;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         R e l e a s e
+//
+//  Release() puts a block onto the front of the free list for its size class. The link to the
+//  next block on the list is kept in the first bytes of the released block itself, which is
+//  why every block is at least one granule long.
+
+void ArenaAllocator::Release (void* Block, size_t Bytes)
+{
+   if (Block) {
+      size_t ClassBytes = 0;
+      int IClass = SizeClass (Bytes,&ClassBytes);
+      if (IClass < NClasses) {
+         *((void**) Block) = I_FreeLists[IClass];
+         I_FreeLists[IClass] = Block;
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           C a r v e
+//
+//  Carve() hands out a new block of the given size (always a multiple of Granule) from the
+//  chunks. If the current chunk doesn't have room, it moves on to the next one in the chain -
+//  after a Reset() those are empty and ready for reuse - and if none of them have room it
+//  gets a new chunk from the system and adds it to the end of the chain. Whatever was left in
+//  a chunk that is passed over is wasted until the next Reset(), but for the intended use,
+//  where the same pattern of allocations repeats, that is a small, bounded, amount.
+
+void* ArenaAllocator::Carve (size_t Bytes)
+{
+   void* Block = NULL;
+   ArenaChunk* Chunk = I_Current;
+   while (Chunk && Chunk->Capacity - Chunk->Used < Bytes) {
+      Chunk = Chunk->Next;
+   }
+   if (Chunk == NULL) {
+      size_t Capacity = (Bytes > I_ChunkBytes) ? Bytes : I_ChunkBytes;
+      Chunk = (ArenaChunk*) malloc (ChunkHeaderBytes + Capacity);
+      if (Chunk) {
+         Chunk->Next = NULL;
+         Chunk->Capacity = Capacity;
+         Chunk->Used = 0;
+         I_BytesReserved += Capacity;
+
+         //  Add the new chunk to the end of the chain. (It goes at the end, rather than
+         //  the front, so that after a Reset() the chunks get reused in the order in which
+         //  they were first obtained.)
+
+         if (I_First == NULL) {
+            I_First = Chunk;
+         } else {
+            ArenaChunk* Last = I_Current ? I_Current : I_First;
+            while (Last->Next) Last = Last->Next;
+            Last->Next = Chunk;
+         }
+      }
+   }
+   if (Chunk) {
+      Block = (Byte*) Chunk + ChunkHeaderBytes + Chunk->Used;
+      Chunk->Used += Bytes;
+      I_Current = Chunk;
+   }
+   return Block;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           R e s e t
+//
+//  Reset() releases, all at once, everything that has been allocated from the arena. It does
+//  this by emptying the free lists and rewinding every chunk, so none of it involves any calls
+//  to free(), no matter how many blocks had been handed out. The chunks are kept, and reused
+//  by later allocations, unless ReturnMemory is true, in which case they are returned to the
+//  system. Obviously, any block obtained from the arena before the Reset() must not be used
+//  afterwards.
+
+void ArenaAllocator::Reset (bool ReturnMemory)
+{
+   for (int IClass = 0; IClass < NClasses; IClass++) I_FreeLists[IClass] = NULL;
+   if (ReturnMemory) {
+      FreeChunks();
+   } else {
+      for (ArenaChunk* Chunk = I_First; Chunk; Chunk = Chunk->Next) Chunk->Used = 0;
+      I_Current = I_First;
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     F r e e  C h u n k s
+
+void ArenaAllocator::FreeChunks (void)
+{
+   ArenaChunk* Chunk = I_First;
+   while (Chunk) {
+      ArenaChunk* Next = Chunk->Next;
+      free (Chunk);
+      Chunk = Next;
+   }
+   I_First = NULL;
+   I_Current = NULL;
+   I_BytesReserved = 0;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                N U M A  A l l o c a t o r
+//
+//  The mbind() policy values, from the kernel's linux/mempolicy.h, which isn't always installed.
+//  The node masks used here have room for 1024 nodes.
+
+static const int PolicyBind = 2;
+static const int PolicyInterleave = 3;
+static const int MaskWords = 16;
+static const size_t MaskBits = MaskWords * 8 * sizeof(unsigned long);
+
+//  Blocks are aligned on this boundary when huge pages are wanted.
+
+static const size_t HugePageBytes = 2 * 1024 * 1024;
+
+//  The default smallest block to place.
+
+static const size_t DefaultMinBytes = 256 * 1024;
+
+//  OnlineNodes() sets the bits in Mask for each NUMA node that is online, using the list the
+//  kernel gives in /sys, which looks like "0-1" or "0,2-3", and returns the number of nodes.
+//  If the file can't be read, it assumes just node 0.
+
+static int OnlineNodes (unsigned long Mask[MaskWords])
+{
+   for (int Word = 0; Word < MaskWords; Word++) Mask[Word] = 0;
+   int Count = 0;
+   FILE* File = fopen ("/sys/devices/system/node/online","r");
+   if (File) {
+      int First, Last;
+      while (fscanf (File,"%d",&First) == 1) {
+         Last = First;
+         int Next = fgetc (File);
+         if (Next == '-') {
+            if (fscanf (File,"%d",&Last) != 1) break;
+            Next = fgetc (File);
+         }
+         for (int Node = First; Node <= Last && Node >= 0 && size_t(Node) < MaskBits; Node++) {
+            unsigned long Bit = 1UL << (Node % (8 * sizeof(unsigned long)));
+            Mask[Node / (8 * sizeof(unsigned long))] |= Bit;
+            Count++;
+         }
+         if (Next != ',') break;
+      }
+      fclose (File);
+   }
+   if (Count == 0) {
+      Mask[0] = 1;
+      Count = 1;
+   }
+   return Count;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     C o n s t r u c t o r
+
+NumaAllocator::NumaAllocator (Placement Policy, int Node, bool HugePages, size_t MinBytes)
+{
+   I_Policy = Policy;
+   I_Node = Node;
+   I_HugePages = HugePages;
+   I_MinBytes = MinBytes ? MinBytes : DefaultMinBytes;
+   I_Failures = 0;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           N o d e s
+
+int NumaAllocator::Nodes (void)
+{
+   unsigned long Mask[MaskWords];
+   return OnlineNodes(Mask);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    M a p p e d  B y t e s
+//
+//  A mapped block is a whole number of pages, or of huge pages if they are wanted. Release()
+//  is passed the same size as Allocate() was, so both work out the same length from it.
+
+size_t NumaAllocator::MappedBytes (size_t Bytes) const
+{
+   size_t Unit = 4096;
+#ifdef AA_HAVE_NUMA
+   long PageBytes = sysconf(_SC_PAGESIZE);
+   if (PageBytes > 0) Unit = size_t(PageBytes);
+#endif
+   if (I_HugePages) Unit = HugePageBytes;
+   return ((Bytes + Unit - 1) / Unit) * Unit;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         A l l o c a t e
+//
+//  A block that is to use huge pages has to start on a huge page boundary, which mmap() won't
+//  guarantee, so a block one huge page larger than needed is mapped, and the unaligned ends are
+//  unmapped again. None of the pages have been touched at this point, which is the whole idea.
+
+void* NumaAllocator::Allocate (size_t Bytes)
+{
+#ifdef AA_HAVE_NUMA
+   if (Bytes >= I_MinBytes) {
+      size_t Length = MappedBytes(Bytes);
+      size_t Extra = I_HugePages ? HugePageBytes : 0;
+      void* Mapping = mmap (NULL,Length + Extra,PROT_READ | PROT_WRITE,
+                                                        MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+      if (Mapping == MAP_FAILED) return NULL;
+      Byte* Block = (Byte*) Mapping;
+      if (Extra) {
+         size_t Misalign = size_t((unsigned long) Block % HugePageBytes);
+         size_t Lead = Misalign ? HugePageBytes - Misalign : 0;
+         if (Lead) munmap (Block,Lead);
+         if (Extra - Lead) munmap (Block + Lead + Length,Extra - Lead);
+         Block += Lead;
+      }
+      Place (Block,Length);
+      return Block;
+   }
+#endif
+   return malloc (Bytes);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          P l a c e
+
+void NumaAllocator::Place (void* Block, size_t Length)
+{
+#ifdef AA_HAVE_NUMA
+   if (I_Policy != FirstTouch) {
+      unsigned long Mask[MaskWords];
+      int Policy = PolicyInterleave;
+      if (I_Policy == Interleave) {
+         OnlineNodes(Mask);
+      } else {
+         Policy = PolicyBind;
+         for (int Word = 0; Word < MaskWords; Word++) Mask[Word] = 0;
+         if (I_Node >= 0 && size_t(I_Node) < MaskBits) {
+            Mask[I_Node / (8 * sizeof(unsigned long))] |=
+                                                1UL << (I_Node % (8 * sizeof(unsigned long)));
+         }
+      }
+      if (syscall(SYS_mbind,Block,Length,Policy,Mask,MaskBits + 1,0) != 0) I_Failures++;
+   }
+#ifdef MADV_HUGEPAGE
+   if (I_HugePages && madvise (Block,Length,MADV_HUGEPAGE) != 0) I_Failures++;
+#else
+   if (I_HugePages) I_Failures++;
+#endif
+#else
+   (void) Block;
+   (void) Length;
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         R e l e a s e
+
+void NumaAllocator::Release (void* Block, size_t Bytes)
+{
+#ifdef AA_HAVE_NUMA
+   if (Bytes >= I_MinBytes) {
+      if (Block) munmap (Block,MappedBytes(Bytes));
+      return;
+   }
+#endif
+   free (Block);
+}
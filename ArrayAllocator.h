@@ -0,0 +1,211 @@
+//
+//                             A r r a y  A l l o c a t o r . h
+//
+//  Function:
+//     Pluggable memory allocation backends for the ArrayManager class.
+//
+//  Description:
+//     ArrayManager originally got all its memory directly from malloc() and gave it back with
+//     free(). That is fine for a program that allocates a few large arrays and keeps them,
+//     but a data reduction program that creates and drops a number of same-sized work arrays
+//     for every frame it processes ends up making a great many malloc() and free() calls, and
+//     in a long-running process that can fragment the heap. This file defines a small abstract
+//     ArrayAllocator class through which ArrayManager now gets its memory, and two
+//     implementations of it:
+//
+//     MallocAllocator simply uses malloc() and free(), and is what ArrayManager uses unless
+//     told otherwise. ArrayAllocator::Default() returns a shared instance of it.
+//
+//     ArenaAllocator takes memory from the system in large chunks and hands it out in pieces.
+//     Each request is rounded up to one of a set of size classes, and a released piece goes
+//     onto a free list for its class, from which it is handed out again the next time a
+//     piece of that class is wanted. So an array that is freed and then allocated again with
+//     the same shape - which is what happens frame after frame in a reduction loop - simply
+//     gets the same memory back, with no call to malloc() at all. Reset() releases everything
+//     the arena has handed out in one go, by rewinding the chunks rather than freeing each
+//     piece, and the chunks are then reused by subsequent allocations. The chunks themselves
+//     are only returned to the system when the arena is destroyed, or if Reset() is told to.
+//
+//     An ArenaAllocator does no locking. It is intended to be used by one ArrayManager (see
+//     ArrayManager::UseArena()), and ArrayManagers are not thread-safe anyway. Giving each
+//     thread its own manager, each with its own arena, means threads don't contend for a
+//     single heap lock when they allocate.
+//
+//     NumaAllocator is for large arrays on machines with more than one NUMA node - typically
+//     a machine with two or more sockets, each with its own memory. Where the pages of an
+//     array end up depends on the kernel's placement policy, which by default puts each page
+//     on the node of the thread that first writes to it. So if one thread initialises an
+//     array that many threads then work on, all of it is on one node, and the threads on the
+//     other nodes have to reach across to it. A NumaAllocator gets each block big enough to
+//     matter directly from mmap(), rather than from malloc(), so the allocator knows its pages
+//     haven't been touched, and then applies one of three policies to them:
+//
+//     FirstTouch leaves the pages alone, so they go wherever they are first written. This is
+//     the right policy when the array is initialised by the same threads, in the same pieces,
+//     as will later work on it - see SubrFirstTouch() in cpsub.cpp.
+//
+//     Interleave spreads the pages round-robin over all the nodes, which gives every thread
+//     the same average access time, whichever rows it works on.
+//
+//     Bind puts all the pages on one given node.
+//
+//     It can also ask for transparent huge pages (madvise(MADV_HUGEPAGE)), in which case the
+//     blocks are aligned on 2 MByte boundaries so they can use them. A multi-GByte data cube
+//     in 4 KByte pages needs hundreds of thousands of TLB entries, and with 2 MByte pages
+//     only a few thousand. Blocks smaller than a threshold - which include all the array
+//     headers - simply come from malloc(). All of this is only available on Linux; anywhere
+//     else a NumaAllocator behaves like a MallocAllocator. The placement calls are made
+//     directly through syscall(), as the perf_event_open() call is in PerfCounters.h, so
+//     libnuma isn't needed. The policies are hints: if the kernel rejects one - because the
+//     kernel has no NUMA support, or a container doesn't allow it - the block is still
+//     allocated, and Failures() counts the number of times this has happened.
+//
+//     Every allocator has to be told the size of a block when it is released, which saves it
+//     having to record the size itself. ArrayManager always knows the size of every block it
+//     allocated, so this costs it nothing.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added NumaAllocator.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __ArrayAllocator__
+#define __ArrayAllocator__
+
+#include <stdlib.h>
+
+//  ArrayAllocator is the abstract interface. Allocate() returns a block of at least the
+//  requested size, aligned at least as well as malloc() would align it, or NULL if the memory
+//  isn't available. Release() returns a block, and must be passed the same size as was passed
+//  to Allocate().
+
+class ArrayAllocator {
+public:
+   //!  Destructor
+   virtual ~ArrayAllocator () {}
+   //!  Allocate a block of memory.
+   virtual void* Allocate (size_t Bytes) = 0;
+   //!  Release a block of memory obtained from Allocate().
+   virtual void Release (void* Block, size_t Bytes) = 0;
+   //!  Return a shared instance of the default, malloc() based, allocator.
+   static ArrayAllocator* Default (void);
+};
+
+//  MallocAllocator is the default, and just uses malloc() and free().
+
+class MallocAllocator : public ArrayAllocator {
+public:
+   //!  Allocate a block of memory using malloc().
+   void* Allocate (size_t Bytes);
+   //!  Release a block of memory using free().
+   void Release (void* Block, size_t Bytes);
+};
+
+//  One ArenaChunk header is at the start of each chunk of memory obtained by an ArenaAllocator.
+
+typedef struct ArenaChunk {
+   //! The next chunk obtained by the same allocator, or NULL.
+   struct ArenaChunk* Next;
+   //! The number of bytes available for allocation in the chunk.
+   size_t Capacity;
+   //! The number of those bytes that have been handed out since the last Reset().
+   size_t Used;
+} ArenaChunk;
+
+//  ArenaAllocator is the arena with size-class free lists described above.
+
+class ArenaAllocator : public ArrayAllocator {
+public:
+   //!  Constructor, specifying the size of the chunks obtained from the system.
+   ArenaAllocator (size_t ChunkBytes = 0);
+   //!  Destructor. Returns all the chunks to the system.
+   ~ArenaAllocator ();
+   //!  Allocate a block of memory from the arena.
+   void* Allocate (size_t Bytes);
+   //!  Put a block back on the free list for its size class.
+   void Release (void* Block, size_t Bytes);
+   //!  Release everything allocated from the arena at once.
+   void Reset (bool ReturnMemory = false);
+   //!  The number of bytes currently obtained from the system.
+   size_t BytesReserved (void) const { return I_BytesReserved; }
+   //!  The number of Allocate() calls satisfied from the free lists.
+   long Recycled (void) const { return I_Recycled; }
+private:
+   //!  The number of size classes.
+   enum { NClasses = 192 };
+   //!  Return the size class for a request, and the size of blocks in that class.
+   static int SizeClass (size_t Bytes, size_t* ClassBytes);
+   //!  Carve a block of the given size out of the chunks, getting a new one if needed.
+   void* Carve (size_t Bytes);
+   //!  Return all the chunks to the system.
+   void FreeChunks (void);
+   //!  The size of the chunks normally obtained from the system.
+   size_t I_ChunkBytes;
+   //!  The first chunk obtained from the system, or NULL.
+   ArenaChunk* I_First;
+   //!  The chunk currently being carved up, or NULL.
+   ArenaChunk* I_Current;
+   //!  The heads of the free lists, one for each size class.
+   void* I_FreeLists[NClasses];
+   //!  The total size of all the chunks.
+   size_t I_BytesReserved;
+   //!  The number of allocations satisfied from the free lists.
+   long I_Recycled;
+   //!  Copying an arena makes no sense, so the copy constructor is private and not defined.
+   ArenaAllocator (const ArenaAllocator&);
+   //!  Nor is the assignment operator.
+   ArenaAllocator& operator= (const ArenaAllocator&);
+};
+
+//  NumaAllocator is the allocator with NUMA placement policies and huge pages described above.
+
+class NumaAllocator : public ArrayAllocator {
+public:
+   //!  The placement policies.
+   enum Placement { FirstTouch, Interleave, Bind };
+   //!  Constructor, specifying the policy, the node for Bind, whether to use huge pages, and
+   //!  the smallest block to place (zero means 256 KBytes).
+   NumaAllocator (Placement Policy = FirstTouch, int Node = 0, bool HugePages = false,
+                                                                         size_t MinBytes = 0);
+   //!  Allocate a block of memory, placed according to the policy if it is large enough.
+   void* Allocate (size_t Bytes);
+   //!  Release a block of memory obtained from Allocate().
+   void Release (void* Block, size_t Bytes);
+   //!  The number of times the kernel rejected a placement policy or huge page request.
+   long Failures (void) const { return I_Failures; }
+   //!  The number of NUMA nodes the system has online (1 if this can't be determined).
+   static int Nodes (void);
+private:
+   //!  The number of bytes actually mapped for a block of a given size.
+   size_t MappedBytes (size_t Bytes) const;
+   //!  Apply the placement policy and huge page hint to a newly mapped block.
+   void Place (void* Block, size_t Length);
+   //!  The placement policy.
+   Placement I_Policy;
+   //!  The node used by the Bind policy.
+   int I_Node;
+   //!  True if huge pages are to be requested.
+   bool I_HugePages;
+   //!  Blocks smaller than this come from malloc().
+   size_t I_MinBytes;
+   //!  The number of rejected placement requests.
+   long I_Failures;
+};
+
+#endif
@@ -0,0 +1,310 @@
+//
+//                              A r r a y  E x p r . h
+//
+//  Function:
+//     Expression templates that fuse chains of operations on typed 2D arrays into one loop.
+//
+//  Description:
+//     Real processing seldom stops at one operation. Something like
+//
+//     Out = (In + Ix + Iy) * Flat - Bias
+//
+//     coded as a series of subr()-style passes over Array2D<T> arrays (see ArrayTemplates.h)
+//     reads and writes the whole of a frame once for each step, and once the frames are
+//     bigger than the cache, that memory traffic is what sets the speed. This file lets such
+//     a chain be written as a single expression, which is then evaluated in one pass over
+//     the arrays, element by element, so each input is read once and the output is written
+//     once, with no temporary arrays at all. For example:
+//
+//     ArrayManager Manager;
+//     Array2D<float> In(Manager,Ny,Nx), Flat(Manager,Ny,Nx), Out(Manager,Ny,Nx);
+//     ...
+//     Evaluate (Out,(In + XIndex() + YIndex()) * Flat - 10.0f);
+//
+//     The expression itself does no arithmetic. The +, -, * and / operators applied to
+//     Array2D<T> arrays, to the index terms XIndex() and YIndex(), to scalars and to other
+//     expressions, simply build up a small object - its type is the tree of operations - and
+//     Evaluate() then loops over the rows and columns of Out, computing the whole expression
+//     for each element. Since the type of the expression tells the compiler exactly what has
+//     to be done, all the little functions involved are inlined, and the loop that results
+//     is the same one that would have been written out by hand, which the compiler can then
+//     vectorise in the usual way. (The technique is the one used by Blitz++, Eigen and the
+//     like, reduced to what the arrays here need.)
+//
+//     XIndex() and YIndex() stand for the column and row number of the element being
+//     evaluated, so the operation used by the tests in this study, In[Iy][Ix] + Ix + Iy, is
+//     simply In + XIndex() + YIndex(), and gives exactly the same result, with the column
+//     index added before the row index. The index terms are ints, and, as in ordinary C++,
+//     an int combined with a float gives a float, and a float combined with a double gives a
+//     double. Scalars can be ints, floats or doubles. The result of each element is converted
+//     to the element type of Out as it is stored.
+//
+//     All the arrays in an expression must have the same dimensions as Out, and Evaluate()
+//     returns false, without changing Out, if they don't, or if any of them isn't valid - as
+//     an Array2D<T> wrapping an indexed array, which has no row pointers, isn't. Out can also
+//     appear in the expression - Evaluate (Out,Out * Flat) is fine - since each element of Out
+//     only depends on the same element of the inputs. Expressions hold copies of the
+//     Array2D<T> objects, which are just their addresses and dimensions, so they are cheap to
+//     build, but they are meant to be passed straight to Evaluate(), not kept.
+//
+//     This sticks to C++98, like the rest of the ArrayManager code.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Noted that indexed arrays are refused.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __ArrayExpr__
+#define __ArrayExpr__
+
+#include "ArrayTemplates.h"
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    P r o m o t i o n
+//
+//  ExprPromote<A,B>::Type is the type of the result of combining values of types A and B -
+//  int with anything gives the other type, float with double gives double.
+
+template <typename A, typename B> struct ExprPromote { typedef A Type; };
+template <typename A> struct ExprPromote<A,int> { typedef A Type; };
+template <typename B> struct ExprPromote<int,B> { typedef B Type; };
+template <> struct ExprPromote<int,int> { typedef int Type; };
+template <> struct ExprPromote<float,double> { typedef double Type; };
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       T e r m s
+//
+//  Each node of an expression tree provides the same three things: Matches() checks that it
+//  can be used for an array of the given dimensions, StartRow() is called at the start of
+//  each row, and At() returns its value for a given column of that row.
+
+//  An array. StartRow() picks up the address of the row, so At() is a simple load.
+
+template <typename T>
+class ExprArrayTerm {
+public:
+   typedef T ValueType;
+   explicit ExprArrayTerm (const Array2D<T>& Array) : I_Array(Array), I_Row(NULL) {}
+   bool Matches (long Nx, long Ny) const {
+      return I_Array.IsValid() && I_Array.Nx() == Nx && I_Array.Ny() == Ny;
+   }
+   void StartRow (long Iy) { I_Row = I_Array[Iy]; }
+   T At (long Ix) const { return I_Row[Ix]; }
+private:
+   Array2D<T> I_Array;
+   const T* I_Row;
+};
+
+//  A constant.
+
+template <typename T>
+class ExprScalarTerm {
+public:
+   typedef T ValueType;
+   explicit ExprScalarTerm (T Value) : I_Value(Value) {}
+   bool Matches (long, long) const { return true; }
+   void StartRow (long) {}
+   T At (long) const { return I_Value; }
+private:
+   T I_Value;
+};
+
+//  The column number.
+
+class ExprXIndexTerm {
+public:
+   typedef int ValueType;
+   bool Matches (long, long) const { return true; }
+   void StartRow (long) {}
+   int At (long Ix) const { return int(Ix); }
+};
+
+//  The row number.
+
+class ExprYIndexTerm {
+public:
+   typedef int ValueType;
+   ExprYIndexTerm (void) : I_Iy(0) {}
+   bool Matches (long, long) const { return true; }
+   void StartRow (long Iy) { I_Iy = int(Iy); }
+   int At (long) const { return I_Iy; }
+private:
+   int I_Iy;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     O p e r a t i o n s
+
+struct ExprAdd { template <typename T> static T Apply (T Left, T Right) { return Left + Right; } };
+struct ExprSub { template <typename T> static T Apply (T Left, T Right) { return Left - Right; } };
+struct ExprMul { template <typename T> static T Apply (T Left, T Right) { return Left * Right; } };
+struct ExprDiv { template <typename T> static T Apply (T Left, T Right) { return Left / Right; } };
+
+//  A binary operation on two nodes, converting both to the promoted type first.
+
+template <class Op, class Left, class Right>
+class ExprBinary {
+public:
+   typedef typename ExprPromote<typename Left::ValueType,
+                                typename Right::ValueType>::Type ValueType;
+   ExprBinary (const Left& L, const Right& R) : I_Left(L), I_Right(R) {}
+   bool Matches (long Nx, long Ny) const {
+      return I_Left.Matches(Nx,Ny) && I_Right.Matches(Nx,Ny);
+   }
+   void StartRow (long Iy) {
+      I_Left.StartRow(Iy);
+      I_Right.StartRow(Iy);
+   }
+   ValueType At (long Ix) const {
+      return Op::Apply(ValueType(I_Left.At(Ix)),ValueType(I_Right.At(Ix)));
+   }
+private:
+   Left I_Left;
+   Right I_Right;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    E x p r e s s i o n s
+//
+//  ArrayExpr<Node> is what the operators return. It just wraps the root node of the tree,
+//  and exists so the operators can tell an expression from any other type.
+
+template <class Node>
+class ArrayExpr {
+public:
+   explicit ArrayExpr (const Node& Root) : I_Root(Root) {}
+   const Node& Root (void) const { return I_Root; }
+private:
+   Node I_Root;
+};
+
+//  ExprTraits<X> says how something of type X becomes a node: IsExpr is true for the types
+//  that make an expression out of an operator (arrays and expressions), and Node and Make()
+//  give the node for all the types that can appear in one.
+
+template <class X> struct ExprTraits { enum { IsExpr = 0 }; };
+
+template <class N> struct ExprTraits< ArrayExpr<N> > {
+   enum { IsExpr = 1 };
+   typedef N Node;
+   static Node Make (const ArrayExpr<N>& X) { return X.Root(); }
+};
+
+template <typename T> struct ExprTraits< Array2D<T> > {
+   enum { IsExpr = 1 };
+   typedef ExprArrayTerm<T> Node;
+   static Node Make (const Array2D<T>& X) { return Node(X); }
+};
+
+template <typename T> struct ExprScalarTraits {
+   enum { IsExpr = 0 };
+   typedef ExprScalarTerm<T> Node;
+   static Node Make (T X) { return Node(X); }
+};
+
+template <> struct ExprTraits<int> : public ExprScalarTraits<int> {};
+template <> struct ExprTraits<float> : public ExprScalarTraits<float> {};
+template <> struct ExprTraits<double> : public ExprScalarTraits<double> {};
+
+//  ExprResult<Op,A,B>::Type is the type of the expression A Op B, but only if at least one of
+//  A and B is an array or expression. Otherwise there is no Type, so the operators below
+//  quietly drop out of consideration for any other types.
+
+template <class Op, class A, class B,
+                 bool Enable = (ExprTraits<A>::IsExpr || ExprTraits<B>::IsExpr)>
+struct ExprResult {};
+
+template <class Op, class A, class B>
+struct ExprResult<Op,A,B,true> {
+   typedef ExprBinary<Op,typename ExprTraits<A>::Node,typename ExprTraits<B>::Node> Node;
+   typedef ArrayExpr<Node> Type;
+   static Type Make (const A& Left, const B& Right) {
+      return Type(Node(ExprTraits<A>::Make(Left),ExprTraits<B>::Make(Right)));
+   }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     O p e r a t o r s
+
+template <class A, class B>
+inline typename ExprResult<ExprAdd,A,B>::Type operator+ (const A& Left, const B& Right) {
+   return ExprResult<ExprAdd,A,B>::Make(Left,Right);
+}
+
+template <class A, class B>
+inline typename ExprResult<ExprSub,A,B>::Type operator- (const A& Left, const B& Right) {
+   return ExprResult<ExprSub,A,B>::Make(Left,Right);
+}
+
+template <class A, class B>
+inline typename ExprResult<ExprMul,A,B>::Type operator* (const A& Left, const B& Right) {
+   return ExprResult<ExprMul,A,B>::Make(Left,Right);
+}
+
+template <class A, class B>
+inline typename ExprResult<ExprDiv,A,B>::Type operator/ (const A& Left, const B& Right) {
+   return ExprResult<ExprDiv,A,B>::Make(Left,Right);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    I n d e x  T e r m s
+
+//!  The column number of the element being evaluated.
+inline ArrayExpr<ExprXIndexTerm> XIndex (void) {
+   return ArrayExpr<ExprXIndexTerm>(ExprXIndexTerm());
+}
+
+//!  The row number of the element being evaluated.
+inline ArrayExpr<ExprYIndexTerm> YIndex (void) {
+   return ArrayExpr<ExprYIndexTerm>(ExprYIndexTerm());
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       E v a l u a t e
+//
+//  Evaluate() sets each element of Out to the value of an expression, in a single pass. It
+//  works on a copy of the expression tree, which StartRow() updates as it goes. The inner
+//  loop is kept as simple as possible - one call to At() for each element - so that once
+//  everything is inlined the compiler sees an ordinary loop it can vectorise.
+
+template <typename T, class X>
+inline bool Evaluate (const Array2D<T>& Out, const X& Expression)
+{
+   typename ExprTraits<X>::Node Root = ExprTraits<X>::Make(Expression);
+   const long Nx = Out.Nx();
+   const long Ny = Out.Ny();
+   if (!Out.IsValid() || !Root.Matches(Nx,Ny)) return false;
+   for (long Iy = 0; Iy < Ny; Iy++) {
+      Root.StartRow(Iy);
+      T* OutRow = Out[Iy];
+      for (long Ix = 0; Ix < Nx; Ix++) {
+         OutRow[Ix] = T(Root.At(Ix));
+      }
+   }
+   return true;
+}
+
+#endif
@@ -22,6 +22,28 @@
 //                    DEBUGLog(). However, calls to List() may have to be revised, as this
 //                    change is not backwards-compatible(). Licence text is now the more
 //                    permissive version currently used by AAO. KS.
+//     14th Oct 2026. Array details now live in a header in front of the address returned
+//                    to the caller, and are chained through that header, rather than
+//                    being held in a std::list that had to be searched. Free(),
+//                    BaseArray() and GetDimensions() now take constant time.
+//     14th Oct 2026. Added the single block allocation mode set by SetSingleBlock(). The
+//                    Malloc<n>D routines now handle both modes.
+//     14th Oct 2026. Added SetAlignment() and GetPitch(), for aligned data and padded rows.
+//     14th Oct 2026. All memory now comes from a pluggable ArrayAllocator. Added
+//                    SetAllocator(), UseArena() and Reset().
+//     14th Oct 2026. Added MapFile2D() and MapFile3D(), for arrays mapped from files.
+//     14th Oct 2026. Added Release(), Adopt(), Transfer(), FreeReleased(), Swap() and the
+//                    move operations, so arrays can change hands without being copied.
+//     14th Oct 2026. Added Owner(), used by ConcurrentArrayManager.
+//     14th Oct 2026. Added View2D() and View3D(), for views of part of an array.
+//     14th Oct 2026. Added SetIndexed(), IsIndexed() and MallocIndexed(), for arrays that
+//                    have no pointer arrays.
+//     14th Oct 2026. Added the memory usage counters, kept up to date by AddDetails() and
+//                    Unlink(), and SetTag(), GetUsage(), ResetUsage() and ReportUsage().
+//     14th Oct 2026. Comments now say plainly that FindDetails() and Owner() read the header
+//                    in front of any address they are given.
+//     14th Oct 2026. Added IsView() and GetStride(), since a view's planes don't follow the
+//                    pitch the way other arrays' do.
 //
 //  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
 //
@@ -40,15 +62,58 @@
 //  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+//  The file mapping routines need the POSIX mmap() interface. The self-test is built with
+//  -ansi, which hides the POSIX declarations in the system headers unless they're asked for
+//  explicitly, so this has to come before any includes. Systems without mmap() still get the
+//  rest of ArrayManager, but the MapFile routines always fail.
+
+#if defined(__unix__) || defined(__APPLE__)
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#define AM_HAVE_MMAP
+#endif
+
 #include "ArrayManager.h"
 
-using std::list;
+#include <string.h>
+#include <time.h>
+
+#ifdef AM_HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 //  You can't do pointer arithmetic on void pointers, so the code has to use a byte type. I only
 //  define Byte here because 'unsigned char' is too long to have all over the code.
 
 typedef unsigned char Byte;
 
+//  The header holding the ArrayDetails for an array is allocated immediately in front of the
+//  address returned by the Malloc() routines. Its size is rounded up to a multiple of 16 bytes
+//  so that whatever follows it is as well aligned as anything malloc() itself returns. The
+//  magic number lets FindDetails() make a reasonable check that what it finds in front of an
+//  address really is one of these headers - but it has to read the memory to do so, so the
+//  address has to be one that has such a header (see ArrayManager.h).
+
+static const size_t HeaderBytes = ((sizeof(ArrayDetails) + 15) / 16) * 16;
+
+static const unsigned long ArrayMagic = 0x41724d67UL;
+
+//  AlignUp() rounds an address up to the next multiple of Align, which must be a power of 2.
+//  It is used to position the data for an array on whatever boundary has been requested by
+//  SetAlignment().
+
+static Byte* AlignUp (Byte* Address, size_t Align)
+{
+   size_t Offset = (size_t) Address % Align;
+   if (Offset) Address += Align - Offset;
+   return Address;
+}
+
 //  ------------------------------------------------------------------------------------------------
 
 //                                      C o n s t r u c t o r
@@ -57,7 +122,16 @@ typedef unsigned char Byte;
 
 ArrayManager::ArrayManager (void)
 {
-   I_Details.clear();
+   I_First = NULL;
+   I_Last = NULL;
+   I_SingleBlock = false;
+   I_Indexed = false;
+   I_Alignment = 16;
+   I_PadRows = false;
+   I_AvoidAliasing = false;
+   I_Allocator = ArrayAllocator::Default();
+   I_Arena = NULL;
+   InitUsage();
 }
 
 //  ------------------------------------------------------------------------------------------------
@@ -69,17 +143,247 @@ ArrayManager::ArrayManager (void)
 
 ArrayManager::~ArrayManager()
 {
-   //  Iterate through all the arrays for which we have detais and clear them out.
+   //  Reset() releases all the arrays, and then all that's left is any arena we created.
    
-   for (list<ArrayDetails>::iterator Iter = I_Details.begin(); Iter != I_Details.end(); Iter++) {
-      for (int IDim = 0; IDim < Iter->NDims; IDim++) {
-         if (Iter->Addresses[IDim]) {
-            free(Iter->Addresses[IDim]);
-            Iter->Addresses[IDim] = NULL;
+   Reset();
+   if (I_Arena) delete I_Arena;
+   I_Arena = NULL;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 A l l o c a t e  H e a d e r
+//
+//  AllocateHeader() is used internally by all the Malloc<n>D routines. It allocates a single
+//  block big enough for an array header followed by Bytes bytes for whatever array is to follow
+//  the header (the data itself for a 1D array, the highest dimensioned pointer array for the
+//  others), and initialises the details held in the header. The address of the array that
+//  follows the header is always HeaderBytes on from the start of the header, and if Align is
+//  more than 16 the header is positioned within the block so that this address is a multiple
+//  of Align. (Anything an allocator returns is already aligned well enough for a pointer
+//  array.) It returns NULL if the allocation fails.
+
+ArrayDetails* ArrayManager::AllocateHeader (size_t Bytes, size_t Align)
+{
+   ArrayDetails* Details = NULL;
+   size_t Slack = (Align > 16) ? Align : 0;
+   size_t BlockBytes = HeaderBytes + Slack + Bytes;
+   Byte* Block = (Byte*) I_Allocator->Allocate (BlockBytes);
+   if (Block) {
+      Byte* Array = Block + HeaderBytes;
+      if (Slack) Array = AlignUp (Array,Align);
+      Details = (ArrayDetails*) (Array - HeaderBytes);
+      for (int IDim = 0; IDim < 4; IDim++) {
+         Details->Dims[IDim] = 0;
+         Details->Addresses[IDim] = NULL;
+      }
+      Details->NDims = 0;
+      Details->BytesPerElement = 0;
+      Details->Magic = ArrayMagic;
+      Details->Manager = this;
+      Details->Prev = NULL;
+      Details->Next = NULL;
+      Details->SingleBlock = false;
+      Details->Pitch = 0;
+      Details->HeaderBlock = Block;
+      Details->HeaderBlockBytes = BlockBytes;
+      Details->DataBlock = NULL;
+      Details->DataBlockBytes = 0;
+      Details->Allocator = I_Allocator;
+      Details->MappedBlock = NULL;
+      Details->MappedBytes = 0;
+      Details->View = false;
+      Details->Indexed = false;
+      Details->Tag = I_Tag;
+      Details->UsageBytes = 0;
+      Details->UsageDataBytes = 0;
+   }
+   return Details;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   A l l o c a t e  D a t a
+//
+//  AllocateData() is used by the Malloc<n>D routines for 2 or more dimensions to allocate the
+//  memory for the array data when this is not part of the same block as the header. It returns
+//  the address for the data, aligned as specified by SetAlignment(), and sets Block to the
+//  address actually returned by the allocator, and BlockBytes to the size of that block, which
+//  are what have to be passed back to the allocator eventually. Block and the returned address
+//  are the same unless an alignment of more than 16 bytes was requested.
+
+Byte* ArrayManager::AllocateData (size_t Bytes, void** Block, size_t* BlockBytes)
+{
+   Byte* Address = NULL;
+   *BlockBytes = (I_Alignment > 16) ? Bytes + I_Alignment : Bytes;
+   *Block = I_Allocator->Allocate (*BlockBytes);
+   if (*Block) Address = AlignUp ((Byte*) *Block,I_Alignment);
+   return Address;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       T a b l e  B y t e s
+//
+//  TableBytes() returns the size of the pointer array at a given level (1 for the row pointers,
+//  2 for the plane pointers) for an array with the specified details. There is one pointer for
+//  each combination of the indices above that level - so for a 4D array there are Ny * Nz * Nt
+//  row pointers, for example. ReleaseArray() uses this to tell the allocator how big each of
+//  the separately allocated pointer arrays was.
+
+static size_t TableBytes (const ArrayDetails* Details, int Level)
+{
+   size_t Count = 1;
+   for (int IDim = Level; IDim < Details->NDims; IDim++) Count *= Details->Dims[IDim];
+   return Count * sizeof(void*);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       R o w  B y t e s
+//
+//  RowBytes() returns the number of bytes from the start of one row of an array to the start of
+//  the next, given the size of each element and the number of elements in a row. Normally, that
+//  is simply the size of the data in the row, but if padding has been requested by SetAlignment()
+//  it is rounded up to a multiple of the alignment size - and then, if necessary, further to a
+//  multiple of the element size, so the pitch is always a whole number of elements. If the option
+//  to avoid aliasing has been set, a row size that is a multiple of 4096 bytes has another
+//  alignment unit added. Rows that are exact multiples of 4096 bytes apart map onto the same
+//  cache sets, so walking down a column - or running over several rows at once - can thrash the
+//  cache, and a little extra padding avoids that.
+
+size_t ArrayManager::RowBytes (unsigned int BytesPerElement, long Nx)
+{
+   size_t Bytes = BytesPerElement * Nx;
+   if (I_PadRows && BytesPerElement > 0) {
+      size_t Align = I_Alignment;
+      Bytes = ((Bytes + Align - 1) / Align) * Align;
+      while (Bytes % BytesPerElement) Bytes += Align;
+      if (I_AvoidAliasing && Align < 4096 && Bytes > 0 && (Bytes % 4096) == 0) {
+         Bytes += Align;
+         while (Bytes % BytesPerElement) Bytes += Align;
+      }
+   }
+   return Bytes;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   F i n d  D e t a i l s
+//
+//  FindDetails() returns the address of the details held for an array, given the address that
+//  was returned by one of the Malloc<n>D routines for that array. The details are in the header
+//  just in front of that address, so finding them is simple. It checks that the header really
+//  does appear to be a header for an array allocated by this ArrayManager, and returns NULL if
+//  it isn't - or if the address is NULL. It reads the header without any other check, so an
+//  address that isn't NULL has to be that of an array from some ArrayManager, still allocated.
+
+ArrayDetails* ArrayManager::FindDetails (void* Address)
+{
+   return FindOwned (Address,this);
+}
+
+//  FindOwned() does the work for FindDetails(), for any manager - or, if Manager is NULL, for
+//  an array that has been released and belongs to no manager at all.
+
+ArrayDetails* ArrayManager::FindOwned (void* Address, ArrayManager* Manager)
+{
+   ArrayDetails* Details = NULL;
+   if (Address) {
+      ArrayDetails* Header = (ArrayDetails*) ((Byte*) Address - HeaderBytes);
+      if (Header->Magic == ArrayMagic && Header->Manager == Manager && Header->NDims > 0 &&
+                       Header->NDims <= 4 && Header->Addresses[Header->NDims - 1] == Address) {
+         Details = Header;
+      }
+   }
+   return Details;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    A d d  D e t a i l s
+//
+//  AddDetails() adds the details for a newly allocated array to the end of the chain of arrays
+//  allocated by this ArrayManager. Adding to the end keeps the arrays in the order in which
+//  they were allocated, which is the order List() has always used. Every array a manager
+//  takes on comes through here, so this is where it is added to the usage counts.
+
+void ArrayManager::AddDetails (ArrayDetails* Details)
+{
+   Details->Prev = I_Last;
+   Details->Next = NULL;
+   if (I_Last) {
+      I_Last->Next = Details;
+   } else {
+      I_First = Details;
+   }
+   I_Last = Details;
+   CountAdded(Details);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         U n l i n k
+//
+//  Unlink() removes the details for an array from the chain of arrays allocated by this
+//  ArrayManager, without releasing anything, and removes it from the usage counts.
+
+void ArrayManager::Unlink (ArrayDetails* Details)
+{
+   CountRemoved(Details);
+   if (Details->Prev) {
+      Details->Prev->Next = Details->Next;
+   } else {
+      I_First = Details->Next;
+   }
+   if (Details->Next) {
+      Details->Next->Prev = Details->Prev;
+   } else {
+      I_Last = Details->Prev;
+   }
+   Details->Prev = NULL;
+   Details->Next = NULL;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  R e l e a s e  A r r a y
+//
+//  ReleaseArray() releases all the memory associated with an array, given its details, and
+//  removes it from the chain of arrays allocated by this ArrayManager. ReleaseMemory() does the
+//  actual releasing, and is also used for arrays that belong to no manager. The highest
+//  dimensioned array (Addresses[NDims - 1]) follows the header in the same block, so it is
+//  released when the header is released. The data and the other pointer arrays were allocated
+//  separately, unless the array was allocated as a single block, in which case they are all
+//  released along with the header.
+
+void ArrayManager::ReleaseArray (ArrayDetails* Details)
+{
+   Unlink(Details);
+   ReleaseMemory(Details);
+}
+
+void ArrayManager::ReleaseMemory (ArrayDetails* Details)
+{
+   ArrayAllocator* Allocator = Details->Allocator;
+   if (!Details->SingleBlock) {
+      for (int IDim = 1; IDim < Details->NDims - 1; IDim++) {
+         if (Details->Addresses[IDim]) {
+            Allocator->Release(Details->Addresses[IDim],TableBytes(Details,IDim));
          }
       }
+      if (Details->DataBlock) Allocator->Release(Details->DataBlock,Details->DataBlockBytes);
    }
-   I_Details.clear();
+   if (Details->MappedBlock) Unmap(Details->MappedBlock,Details->MappedBytes);
+   for (int IDim = 0; IDim < 4; IDim++) {
+      Details->Addresses[IDim] = NULL;
+   }
+   
+   //  Clear the magic number, so a second attempt to free the same array has a better
+   //  chance of being spotted as a mistake.
+   
+   Details->Magic = 0;
+   Allocator->Release(Details->HeaderBlock,Details->HeaderBlockBytes);
 }
 
 //  ------------------------------------------------------------------------------------------------
@@ -93,21 +397,11 @@ void ArrayManager::Free (
    void* Address)
 {
    //  The address will be the address not of the main array, but of the highest dimensioned
-   //  pointer array allocated for it. Look through the details list to find such an address,
-   //  and if we find it release all the arrays used and erase the details.
+   //  pointer array allocated for it. The details for the array are in the header in front
+   //  of that address, and if we find them we release all the arrays used.
    
-   for (list<ArrayDetails>::iterator Iter = I_Details.begin(); Iter != I_Details.end(); Iter++) {
-      if (Iter->Addresses[Iter->NDims - 1] == Address) {
-         for (int IDim = 0; IDim < Iter->NDims; IDim++) {
-            if (Iter->Addresses[IDim]) {
-               free(Iter->Addresses[IDim]);
-               Iter->Addresses[IDim] = NULL;
-            }
-         }
-         I_Details.erase(Iter);
-         break;
-      }
-   }
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details) ReleaseArray(Details);
 }
 
 //  ------------------------------------------------------------------------------------------------
@@ -119,22 +413,19 @@ void ArrayManager::Free (
 //   such a routine. The base address may be needed to load up the array by reading from a file,
 //   or to write the data out, or some other purpose. There is no problem with going behind the
 //   back of the ArrayManager code to do such things. (Although, obviously, attempting to access
-//   memory outside that allocated for the array is almost certain to cause problems.)
+//   memory outside that allocated for the array is almost certain to cause problems.) Note
+//   that if the array was allocated with padded rows - see SetAlignment() - the rows are not
+//   packed one after the other, and GetPitch() gives the number of elements from one to the next.
 
 void* ArrayManager::BaseArray (void* Address)
 {
    //  The address will be the address not of the main array, but of the highest dimensioned
-   //  pointer array allocated for it. Look through the details list to find such an address,
-   //  and if we find it the address of the base array will be held in Addresses[0] for that
-   //  array.
+   //  pointer array allocated for it. If we find the details for it, the address of the base
+   //  array will be held in Addresses[0] for that array.
    
    void* BaseAddress = NULL;
-   for (list<ArrayDetails>::iterator Iter = I_Details.begin(); Iter != I_Details.end(); Iter++) {
-      if (Iter->Addresses[Iter->NDims - 1] == Address) {
-         BaseAddress = Iter->Addresses[0];
-         break;
-      }
-   }
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details) BaseAddress = Details->Addresses[0];
    return BaseAddress;
 }
 
@@ -158,31 +449,25 @@ void ArrayManager::GetDimensions (
    int* NDims,
    long Dims[])
 {   
-   bool Found = false;
-   
    //  The address will be the address not of the main array, but of the highest dimensioned
-   //  pointer array allocated for it. Look through the details list to find such an address,
-   //  and if we find it copy the dimension details back to the caller.
+   //  pointer array allocated for it. If we find the details for it, copy the dimension
+   //  details back to the caller.
    
-   for (list<ArrayDetails>::iterator Iter = I_Details.begin(); Iter != I_Details.end(); Iter++) {
-      if (Iter->Addresses[Iter->NDims - 1] == Address) {
-         *NDims = Iter->NDims;
-         int ReportDims = Iter->NDims;
-         if (ReportDims > MaxDims) ReportDims = MaxDims;
-         for (int IDim = 0; IDim < ReportDims; IDim++) {
-            Dims[IDim] = Iter->Dims[IDim];
-         }
-         for (int IDim = ReportDims; IDim < MaxDims; IDim++) {
-            Dims[IDim] = 1;
-         }
-         Found = true;
-         break;
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details) {
+      *NDims = Details->NDims;
+      int ReportDims = Details->NDims;
+      if (ReportDims > MaxDims) ReportDims = MaxDims;
+      for (int IDim = 0; IDim < ReportDims; IDim++) {
+         Dims[IDim] = Details->Dims[IDim];
       }
-   }
+      for (int IDim = ReportDims; IDim < MaxDims; IDim++) {
+         Dims[IDim] = 1;
+      }
+   } else {
    
-   //  If we didn't find it, return a set of zeros.
+      //  If we didn't find it, return a set of zeros.
    
-   if (!Found) {
       for (int IDim = 0; IDim < MaxDims; IDim++) {
          Dims[IDim] = 0;
       }
@@ -203,14 +488,22 @@ void ArrayManager::GetDimensions (
 void ArrayManager::List (void (*ListRoutine)(const char* String))
 {
    char DebugString[256];
-   for (list<ArrayDetails>::iterator Iter = I_Details.begin(); Iter != I_Details.end(); Iter++) {
-      long Elements = Iter->Dims[0];
-      for (int Index = 1; Index < Iter->NDims; Index++) {
-         Elements *= Iter->Dims[Index];
-      }
-      long Bytes = Elements * Iter->BytesPerElement;
-      snprintf (DebugString,sizeof(DebugString),"%d-D array of %ld bytes at %p",
-                                                Iter->NDims,Bytes,Iter->Addresses[0]);
+   for (ArrayDetails* Details = I_First; Details; Details = Details->Next) {
+      long Elements = Details->Dims[0];
+      for (int Index = 1; Index < Details->NDims; Index++) {
+         Elements *= Details->Dims[Index];
+      }
+      long Bytes = Elements * Details->BytesPerElement;
+      const char* Kind = "";
+      if (Details->MappedBlock) {
+         Kind = " (mapped)";
+      } else if (Details->View) {
+         Kind = " (view)";
+      } else if (Details->Indexed) {
+         Kind = " (indexed)";
+      }
+      snprintf (DebugString,sizeof(DebugString),"%d-D array of %ld bytes at %p%s",
+                           Details->NDims,Bytes,Details->Addresses[0],Kind);
       if (ListRoutine) {
          (*ListRoutine)(DebugString);
       } else {
@@ -221,35 +514,291 @@ void ArrayManager::List (void (*ListRoutine)(const char* String))
 
 //  ------------------------------------------------------------------------------------------------
 
+//                                 S e t  S i n g l e  B l o c k
+//
+//  SetSingleBlock() controls how arrays allocated after it has been called are laid out in
+//  memory. If it is passed true, each array is allocated as a single block that holds the
+//  array header, then the pointer arrays (the highest dimensioned first), and then the data,
+//  which starts on a 16 byte boundary (or on whatever boundary SetAlignment() has specified).
+//  If it is passed false (the default), the data and all but the highest dimensioned pointer
+//  array are allocated separately. It makes no difference to 1D arrays, which have no pointer
+//  arrays and are always allocated as one block anyway. Arrays that have already been
+//  allocated are not affected.
+
+void ArrayManager::SetSingleBlock (bool SingleBlock)
+{
+   I_SingleBlock = SingleBlock;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     S e t  I n d e x e d
+//
+//  SetIndexed() controls whether arrays allocated after it has been called have pointer arrays.
+//  If it is passed true, 2D, 3D and 4D arrays are allocated by MallocIndexed(), with no pointer
+//  arrays, and the Malloc<n>D routines return the address of the data. If it is passed false
+//  (the default), they have pointer arrays as usual. 1D arrays are the same either way, and
+//  arrays that have already been allocated are not affected.
+
+void ArrayManager::SetIndexed (bool Indexed)
+{
+   I_Indexed = Indexed;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     I s  I n d e x e d
+//
+//  IsIndexed() returns true if the array allocated at the given address has no pointer arrays,
+//  having been allocated after SetIndexed(true), and false if it has them, or if it isn't an
+//  array belonging to this manager. A 1D array has no pointer arrays either, and its address
+//  is that of its data, so it counts as indexed.
+
+bool ArrayManager::IsIndexed (void* Address)
+{
+   ArrayDetails* Details = FindDetails(Address);
+   return Details && (Details->Indexed || Details->NDims == 1);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        I s  V i e w
+//
+//  IsView() returns true if the array at the given address is a view of part of another array,
+//  created by View2D() or View3D(), and false if it isn't, or isn't one of this manager's.
+
+bool ArrayManager::IsView (void* Address)
+{
+   ArrayDetails* Details = FindDetails(Address);
+   return Details && Details->View;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   S e t  A l i g n m e n t
+//
+//  SetAlignment() controls the alignment of the data for arrays allocated after it has been
+//  called. AlignBytes is the boundary on which the data for each array is to start. It should
+//  be a power of 2 - anything else is rounded up to the next power of 2 - and values below 16
+//  are treated as 16, which is what malloc() normally provides anyway and is the default. For
+//  vector code, 32 (AVX) or 64 (AVX-512, and the usual cache line size) are the useful values.
+//  If PadRows is true, each row of an array of two or more dimensions is padded so that the
+//  start of every row, not just the first, is on such a boundary. The number of elements from
+//  the start of one row to the next can then be more than the number of elements in a row, and
+//  can be found using GetPitch(). If AvoidAliasing is also true, rows whose padded length would
+//  be an exact multiple of 4096 bytes are given an extra alignment unit of padding. (This has
+//  no effect if AlignBytes is 4096 or more.) Arrays that have already been allocated are not
+//  affected.
+
+void ArrayManager::SetAlignment (unsigned int AlignBytes, bool PadRows, bool AvoidAliasing)
+{
+   size_t Align = 16;
+   while (Align < AlignBytes) Align *= 2;
+   I_Alignment = Align;
+   I_PadRows = PadRows;
+   I_AvoidAliasing = AvoidAliasing;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        G e t  P i t c h
+//
+//   GetPitch() returns the number of elements from the start of one row of an array to the start
+//   of the next, given the address returned by one of the Malloc<n>D routines. This is the same
+//   as the number of elements in a row (Dims[0] as returned by GetDimensions()) unless the array
+//   was allocated with padded rows - see SetAlignment(). Successive planes, and cubes, of an
+//   array allocated or mapped by the manager are always contiguous in terms of rows, so element
+//   [Iz][Iy][Ix] of a 3D array is (((Iz * Ny) + Iy) * Pitch) + Ix elements on from the start
+//   of the data. That isn't true of a view: its pitch is the distance from one of its rows to
+//   the next - which, for a view taking every n'th row, is n times the pitch of the original -
+//   but its planes are wherever in the original they happen to be. GetStride() gives the
+//   distance between planes where there is one. It returns zero if the array cannot be found.
+
+long ArrayManager::GetPitch (void* Address)
+{
+   long Pitch = 0;
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details) Pitch = Details->Pitch;
+   return Pitch;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       G e t  S t r i d e
+//
+//  GetStride() returns the number of elements from one index to the next along dimension IDim
+//  of an array (0 is X), that is, from element [Iz][Iy][Ix] to element [Iz][Iy][Ix + 1] for
+//  IDim 0, to [Iz][Iy + 1][Ix] for IDim 1, and to [Iz + 1][Iy][Ix] for IDim 2. So it is 1 for
+//  IDim 0, the pitch for IDim 1, and for an array allocated or mapped by the manager - indexed
+//  or not - the pitch times the number of rows for IDim 2, and that times the number of planes
+//  for IDim 3. The planes of a 3D view needn't be evenly spaced, so for a view the stride is
+//  found from the plane pointers, and is zero if they aren't. It also returns zero if the
+//  array cannot be found or doesn't have dimension IDim.
+
+long ArrayManager::GetStride (void* Address, int IDim)
+{
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details == NULL || IDim < 0 || IDim >= Details->NDims) return 0;
+   if (IDim == 0) return 1;
+   long Stride = Details->Pitch;
+   if (!Details->View) {
+      for (int Dim = 1; Dim < IDim; Dim++) Stride *= Details->Dims[Dim];
+   } else if (IDim == 2) {
+   
+      //  Only a 3D view has a plane stride to find. Each of its planes starts where the
+      //  plane pointer's first row pointer says, and they have to be evenly spaced.
+      
+      Byte*** Planes = (Byte***) Address;
+      long Nz = Details->Dims[2];
+      long Bytes = Details->BytesPerElement;
+      Stride = Details->Pitch * Details->Dims[1];
+      if (Nz > 1) {
+         long Gap = long(Planes[1][0] - Planes[0][0]);
+         Stride = (Gap > 0 && Gap % Bytes == 0) ? Gap / Bytes : 0;
+         for (long Plane = 2; Stride && Plane < Nz; Plane++) {
+            if (Planes[Plane][0] - Planes[0][0] != Plane * Gap) Stride = 0;
+         }
+      }
+   }
+   return Stride;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   S e t  A l l o c a t o r
+//
+//  SetAllocator() specifies the allocator (see ArrayAllocator.h) from which the memory for
+//  arrays allocated after it has been called is to be obtained. Passing NULL reverts to the
+//  default, which uses malloc(). Each array remembers the allocator it came from, and goes back
+//  to it when it is released, so arrays already allocated are not affected. The allocator is
+//  not owned by the ArrayManager, and must outlast every array allocated from it.
+
+void ArrayManager::SetAllocator (ArrayAllocator* Allocator)
+{
+   I_Allocator = Allocator ? Allocator : ArrayAllocator::Default();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       U s e  A r e n a
+//
+//  UseArena() has arrays allocated after it has been called come from an ArenaAllocator
+//  belonging to this ArrayManager, creating it if necessary. ChunkBytes is the size of the
+//  chunks the arena gets from the system - zero means use the arena's default - and only has
+//  any effect when the arena is first created. Once arrays come from the manager's own arena,
+//  an array that is freed and then allocated again with the same shape reuses the same memory,
+//  and Reset() can release them all without freeing each one. The arena is deleted along with
+//  the ArrayManager.
+
+void ArrayManager::UseArena (size_t ChunkBytes)
+{
+   if (I_Arena == NULL) I_Arena = new ArenaAllocator(ChunkBytes);
+   I_Allocator = I_Arena;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          R e s e t
+//
+//  Reset() releases all the arrays allocated by the ArrayManager, just as the destructor does,
+//  but leaves the manager usable, so a program can allocate a frame's worth of work arrays,
+//  process the frame, Reset(), and go on to the next frame. Arrays that came from the manager's
+//  own arena (see UseArena()) are not released individually - they are simply dropped from the
+//  chain, and then the arena is reset, which releases everything in it at once and keeps its
+//  memory ready for the next frame. Any other arrays, including any mapped files, are released
+//  in the usual way.
+
+void ArrayManager::Reset (void)
+{
+   //  Work through the chain of arrays for which we have details and clear them out. Note
+   //  that ReleaseArray() releases the header holding the details as well, so we need to
+   //  pick up the next one in the chain before releasing each array.
+   
+   ArrayDetails* Details = I_First;
+   while (Details) {
+      ArrayDetails* Next = Details->Next;
+      if (I_Arena && Details->Allocator == I_Arena && Details->MappedBlock == NULL) {
+         CountRemoved(Details);
+         Details->Magic = 0;
+      } else {
+         ReleaseArray(Details);
+      }
+      Details = Next;
+   }
+   I_First = NULL;
+   I_Last = NULL;
+   if (I_Arena) I_Arena->Reset();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
 //                                      M a l l o c  1 D
 //
 //  Malloc1D() allocates a 1-dimensional array of elements of the specified size. It is passed
 //  the size of each element (usually a sizeof() call) and the number of elements. This is a 
-//  simple operation and hardly taxes the code - all we do is return the address we get from 
-//  malloc() - but it serves as a template for the higher-dimensional array allocation routines.
+//  simple operation and hardly taxes the code - all we do is allocate the data in the same
+//  block as the array header and return its address - but it serves as a template for the
+//  higher-dimensional array allocation routines.
 
 void* ArrayManager::Malloc1D (
    unsigned int BytesPerElement,
    long Nx)
 {
-   //  Allocate the array and get its address.
+   //  Allocate the header and the array following it, and get the array address.
    
-   Byte* Address = (Byte*) malloc (BytesPerElement * Nx);
-   if (Address) {
+   Byte* Address = NULL;
+   ArrayDetails* Details = AllocateHeader (BytesPerElement * Nx,I_Alignment);
+   if (Details) {
      
-      //  If it allocated OK, record the details in a structure and push a copy onto the
-      //  I_Details list.
+      //  If it allocated OK, record the details in the header and add it to the chain
+      //  of allocated arrays.
       
-      ArrayDetails Details;
-      for (int IDim = 0; IDim < 4; IDim++) {
-         Details.Dims[IDim] = 0;
-         Details.Addresses[IDim] = NULL;
+      Address = (Byte*) Details + HeaderBytes;
+      Details->NDims = 1;
+      Details->Dims[0] = Nx;
+      Details->Pitch = Nx;
+      Details->BytesPerElement = BytesPerElement;
+      Details->Addresses[0] = Address;
+      AddDetails(Details);
+   }
+   return (void*) Address;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  M a l l o c  I n d e x e d
+//
+//  MallocIndexed() allocates an array of 2, 3 or 4 dimensions with no pointer arrays, for the
+//  Malloc<n>D routines when SetIndexed(true) is in effect. Dims[] are the dimensions, Nx first.
+//  It is just Malloc1D() with more dimensions: the data follows the header, in the same block,
+//  on whatever boundary SetAlignment() has specified, and its address is what is returned. The
+//  rows are padded as usual if that has been asked for. Each of the Addresses[] in the details
+//  is the data address, since that is what FindDetails() expects to find for the highest of
+//  them, and the array counts as a single block, so the header block is all there is to
+//  release.
+
+void* ArrayManager::MallocIndexed (
+   unsigned int BytesPerElement,
+   int NDims,
+   const long Dims[])
+{
+   size_t Pitch = RowBytes (BytesPerElement,Dims[0]);
+   size_t DataBytes = Pitch;
+   for (int IDim = 1; IDim < NDims; IDim++) DataBytes *= Dims[IDim];
+   Byte* Address = NULL;
+   ArrayDetails* Details = AllocateHeader (DataBytes,I_Alignment);
+   if (Details) {
+      Address = (Byte*) Details + HeaderBytes;
+      Details->SingleBlock = true;
+      Details->Indexed = true;
+      Details->NDims = NDims;
+      for (int IDim = 0; IDim < NDims; IDim++) {
+         Details->Dims[IDim] = Dims[IDim];
+         Details->Addresses[IDim] = (void*) Address;
       }
-      Details.NDims = 1;
-      Details.Dims[0] = Nx;
-      Details.BytesPerElement = BytesPerElement;
-      Details.Addresses[0] = Address;
-      I_Details.push_back(Details);
+      Details->Pitch = Pitch / BytesPerElement;
+      Details->BytesPerElement = BytesPerElement;
+      AddDetails(Details);
    }
    return (void*) Address;
 }
@@ -271,46 +820,68 @@ void* ArrayManager::Malloc2D (
    long Ny,
    long Nx)
 {
-   //  Allocate the data for the array (Nx by Ny bytes) and also allocate an array of Ny
-   //  pointers to the start of each row.
+   //  Allocate the data for the array (Ny rows, each of Pitch bytes - which is normally just
+   //  Nx elements) and also allocate an array of Ny pointers to the start of each row. The
+   //  row pointers follow the array header. If the array is to be allocated as a single
+   //  block, then the data follows the row pointers in the same block. If it isn't to have
+   //  row pointers at all, MallocIndexed() does the work.
    
-   Byte* Address = (Byte*) malloc (BytesPerElement * Nx * Ny);
-   Byte** RowAddresses = (Byte**) malloc (sizeof(Byte*) * Ny);
-   if (Address && RowAddresses) {
+   if (I_Indexed) {
+      long Dims[2] = { Nx, Ny };
+      return MallocIndexed (BytesPerElement,2,Dims);
+   }
+   size_t Pitch = RowBytes (BytesPerElement,Nx);
+   size_t DataBytes = Pitch * Ny;
+   Byte* Address = NULL;
+   void* DataBlock = NULL;
+   size_t DataBlockBytes = 0;
+   ArrayDetails* Details = NULL;
+   if (I_SingleBlock) {
+      size_t RowTableBytes = sizeof(Byte*) * Ny;
+      Details = AllocateHeader (RowTableBytes + I_Alignment + DataBytes,0);
+      if (Details) {
+         Address = AlignUp ((Byte*) Details + HeaderBytes + RowTableBytes,I_Alignment);
+      }
+   } else {
+      Address = AllocateData (DataBytes,&DataBlock,&DataBlockBytes);
+      Details = AllocateHeader (sizeof(Byte*) * Ny,0);
+   }
+   Byte** RowAddresses = NULL;
+   if (Address && Details) {
    
-      //  If we were able to allocate those OK, set the details into an array details structure
-      //  and add a copy to the I_Details list of allocated arrays. This is like Malloc1D(),
-      //  except that we need to set Dims[1] as well as Dims[0], but we also need to initialise
-      //  the pointers in the RowAddresses array. And we save both addresses in the details
-      //  structure.
+      //  If we were able to allocate those OK, set the details into the array header and
+      //  add it to the chain of allocated arrays. This is like Malloc1D(), except that we
+      //  need to set Dims[1] as well as Dims[0], but we also need to initialise the pointers
+      //  in the RowAddresses array. And we save both addresses in the details structure.
       
-      ArrayDetails Details;
-      for (int IDim = 0; IDim < 4; IDim++) {
-         Details.Dims[IDim] = 0;
-         Details.Addresses[IDim] = NULL;
-      }
-      Details.NDims = 2;
-      Details.Dims[0] = Nx;
-      Details.Dims[1] = Ny;
-      Details.BytesPerElement = BytesPerElement;
-      Details.Addresses[0] = (void*) Address;
-      Details.Addresses[1] = (void*) RowAddresses;
-      I_Details.push_back(Details);
+      RowAddresses = (Byte**) ((Byte*) Details + HeaderBytes);
+      Details->SingleBlock = I_SingleBlock;
+      Details->DataBlock = DataBlock;
+      Details->DataBlockBytes = DataBlockBytes;
+      Details->NDims = 2;
+      Details->Dims[0] = Nx;
+      Details->Dims[1] = Ny;
+      Details->Pitch = Pitch / BytesPerElement;
+      Details->BytesPerElement = BytesPerElement;
+      Details->Addresses[0] = (void*) Address;
+      Details->Addresses[1] = (void*) RowAddresses;
+      AddDetails(Details);
       
       //  The values for the RowAddresses are the addresses at which we find the start of
       //  the data for each row in the array starting at Address. Each row will be
-      //  Nx * BytesPerElement bytes long.
+      //  Pitch bytes on from the previous one.
       
       for (int Row = 0; Row < Ny; Row++) {
-         RowAddresses[Row] = Address + (Row * Nx * BytesPerElement);
+         RowAddresses[Row] = Address + (Row * Pitch);
       }
    } else {
    
-      //  If either malloc call failed, make sure we release the other. Releasing both
-      //  like this works.
+      //  If either allocation failed, make sure we release the other. Releasing both
+      //  like this works. (If this was a single block, we only get here if the one
+      //  allocation failed.)
       
-      if (Address) free(Address);
-      if (RowAddresses) free(RowAddresses);
+      if (DataBlock) I_Allocator->Release(DataBlock,DataBlockBytes);
+      if (Details) I_Allocator->Release(Details->HeaderBlock,Details->HeaderBlockBytes);
       Address = NULL;
       RowAddresses = NULL;
    }
@@ -338,35 +909,62 @@ void* ArrayManager::Malloc3D (
    long Nx)
 {
    //  If you've looked at the code for Malloc2D(), all this does is add one more dimension.
+   //  It's the plane pointers that follow the array header, and for a single block they
+   //  are followed by the row pointers and then the data.
    
-   Byte* Address = (Byte*) malloc (BytesPerElement * Nx * Ny * Nz);
-   Byte** RowAddresses = (Byte**) malloc (sizeof(Byte*) * Ny * Nz);
-   Byte*** PlaneAddresses = (Byte***) malloc (sizeof(Byte**) * Nz);
-   if (Address && RowAddresses && PlaneAddresses) {
-      ArrayDetails Details;
-      for (int IDim = 0; IDim < 4; IDim++) {
-         Details.Dims[IDim] = 0;
-         Details.Addresses[IDim] = NULL;
+   if (I_Indexed) {
+      long Dims[3] = { Nx, Ny, Nz };
+      return MallocIndexed (BytesPerElement,3,Dims);
+   }
+   size_t Pitch = RowBytes (BytesPerElement,Nx);
+   size_t DataBytes = Pitch * Ny * Nz;
+   Byte* Address = NULL;
+   void* DataBlock = NULL;
+   size_t DataBlockBytes = 0;
+   Byte** RowAddresses = NULL;
+   ArrayDetails* Details = NULL;
+   if (I_SingleBlock) {
+      size_t PlaneTableBytes = sizeof(Byte**) * Nz;
+      size_t RowTableBytes = sizeof(Byte*) * Ny * Nz;
+      Details = AllocateHeader (PlaneTableBytes + RowTableBytes + I_Alignment + DataBytes,0);
+      if (Details) {
+         Byte* Tables = (Byte*) Details + HeaderBytes;
+         RowAddresses = (Byte**) (Tables + PlaneTableBytes);
+         Address = AlignUp (Tables + PlaneTableBytes + RowTableBytes,I_Alignment);
       }
-      Details.NDims = 3;
-      Details.Dims[0] = Nx;
-      Details.Dims[1] = Ny;
-      Details.Dims[2] = Nz;
+   } else {
+      Address = AllocateData (DataBytes,&DataBlock,&DataBlockBytes);
+      RowAddresses = (Byte**) I_Allocator->Allocate (sizeof(Byte*) * Ny * Nz);
+      Details = AllocateHeader (sizeof(Byte**) * Nz,0);
+   }
+   Byte*** PlaneAddresses = NULL;
+   if (Address && RowAddresses && Details) {
+      PlaneAddresses = (Byte***) ((Byte*) Details + HeaderBytes);
+      Details->SingleBlock = I_SingleBlock;
+      Details->DataBlock = DataBlock;
+      Details->DataBlockBytes = DataBlockBytes;
+      Details->NDims = 3;
+      Details->Dims[0] = Nx;
+      Details->Dims[1] = Ny;
+      Details->Dims[2] = Nz;
+      Details->Pitch = Pitch / BytesPerElement;
       for (int Row = 0; Row < (Ny * Nz); Row++) {
-         RowAddresses[Row] = Address + (Row * Nx * BytesPerElement);
+         RowAddresses[Row] = Address + (Row * Pitch);
       }
       for (int Plane = 0; Plane < Nz; Plane++) {
          PlaneAddresses[Plane] = RowAddresses + (Plane * Ny);
       }
-      Details.BytesPerElement = BytesPerElement;
-      Details.Addresses[0] = (void*) Address;
-      Details.Addresses[1] = (void*) RowAddresses;
-      Details.Addresses[2] = (void*) PlaneAddresses;
-      I_Details.push_back(Details);
+      Details->BytesPerElement = BytesPerElement;
+      Details->Addresses[0] = (void*) Address;
+      Details->Addresses[1] = (void*) RowAddresses;
+      Details->Addresses[2] = (void*) PlaneAddresses;
+      AddDetails(Details);
    } else {
-      if (Address) free(Address);
-      if (RowAddresses) free(RowAddresses);
-      if (PlaneAddresses) free(PlaneAddresses);
+      if (!I_SingleBlock) {
+         if (DataBlock) I_Allocator->Release(DataBlock,DataBlockBytes);
+         if (RowAddresses) I_Allocator->Release(RowAddresses,sizeof(Byte*) * Ny * Nz);
+      }
+      if (Details) I_Allocator->Release(Details->HeaderBlock,Details->HeaderBlockBytes);
       Address = NULL;
       RowAddresses = NULL;
       PlaneAddresses = NULL;
@@ -401,23 +999,51 @@ void* ArrayManager::Malloc4D (
    //  although I admit that by the time you have four asterisks in a row it starts to get
    //  scary.
    
-   Byte* Address = (Byte*) malloc (BytesPerElement * Nx * Ny * Nz * Nt);
-   Byte** RowAddresses = (Byte**) malloc (sizeof(Byte*) * Ny * Nz * Nt);
-   Byte*** PlaneAddresses = (Byte***) malloc (sizeof(Byte**) * Nz * Nt);
-   Byte**** CubeAddresses = (Byte****) malloc (sizeof(Byte***) * Nt);
-   if (Address && RowAddresses && PlaneAddresses && CubeAddresses) {
-      ArrayDetails Details;
-      for (int IDim = 0; IDim < 4; IDim++) {
-         Details.Dims[IDim] = 0;
-         Details.Addresses[IDim] = NULL;
-      }
-      Details.NDims = 4;
-      Details.Dims[0] = Nx;
-      Details.Dims[1] = Ny;
-      Details.Dims[2] = Nz;
-      Details.Dims[3] = Nt;
+   if (I_Indexed) {
+      long Dims[4] = { Nx, Ny, Nz, Nt };
+      return MallocIndexed (BytesPerElement,4,Dims);
+   }
+   size_t Pitch = RowBytes (BytesPerElement,Nx);
+   size_t DataBytes = Pitch * Ny * Nz * Nt;
+   Byte* Address = NULL;
+   void* DataBlock = NULL;
+   size_t DataBlockBytes = 0;
+   Byte** RowAddresses = NULL;
+   Byte*** PlaneAddresses = NULL;
+   ArrayDetails* Details = NULL;
+   if (I_SingleBlock) {
+      size_t CubeTableBytes = sizeof(Byte***) * Nt;
+      size_t PlaneTableBytes = sizeof(Byte**) * Nz * Nt;
+      size_t RowTableBytes = sizeof(Byte*) * Ny * Nz * Nt;
+      Details = AllocateHeader (CubeTableBytes + PlaneTableBytes + RowTableBytes +
+                                                               I_Alignment + DataBytes,0);
+      if (Details) {
+         Byte* Tables = (Byte*) Details + HeaderBytes;
+         PlaneAddresses = (Byte***) (Tables + CubeTableBytes);
+         RowAddresses = (Byte**) (Tables + CubeTableBytes + PlaneTableBytes);
+         Address = AlignUp (Tables + CubeTableBytes + PlaneTableBytes + RowTableBytes,
+                                                                              I_Alignment);
+      }
+   } else {
+      Address = AllocateData (DataBytes,&DataBlock,&DataBlockBytes);
+      RowAddresses = (Byte**) I_Allocator->Allocate (sizeof(Byte*) * Ny * Nz * Nt);
+      PlaneAddresses = (Byte***) I_Allocator->Allocate (sizeof(Byte**) * Nz * Nt);
+      Details = AllocateHeader (sizeof(Byte***) * Nt,0);
+   }
+   Byte**** CubeAddresses = NULL;
+   if (Address && RowAddresses && PlaneAddresses && Details) {
+      CubeAddresses = (Byte****) ((Byte*) Details + HeaderBytes);
+      Details->SingleBlock = I_SingleBlock;
+      Details->DataBlock = DataBlock;
+      Details->DataBlockBytes = DataBlockBytes;
+      Details->NDims = 4;
+      Details->Dims[0] = Nx;
+      Details->Dims[1] = Ny;
+      Details->Dims[2] = Nz;
+      Details->Dims[3] = Nt;
+      Details->Pitch = Pitch / BytesPerElement;
       for (int Row = 0; Row < (Ny * Nz * Nt); Row++) {
-         RowAddresses[Row] = Address + (Row * Nx * BytesPerElement);
+         RowAddresses[Row] = Address + (Row * Pitch);
       }
       for (int Plane = 0; Plane < Nz * Nt; Plane++) {
          PlaneAddresses[Plane] = RowAddresses + (Plane * Ny);
@@ -425,17 +1051,19 @@ void* ArrayManager::Malloc4D (
       for (int Cube = 0; Cube < Nt; Cube++) {
          CubeAddresses[Cube] = PlaneAddresses + (Cube * Nz);
       }
-      Details.BytesPerElement = BytesPerElement;
-      Details.Addresses[0] = (void*) Address;
-      Details.Addresses[1] = (void*) RowAddresses;
-      Details.Addresses[2] = (void*) PlaneAddresses;
-      Details.Addresses[3] = (void*) CubeAddresses;
-      I_Details.push_back(Details);
+      Details->BytesPerElement = BytesPerElement;
+      Details->Addresses[0] = (void*) Address;
+      Details->Addresses[1] = (void*) RowAddresses;
+      Details->Addresses[2] = (void*) PlaneAddresses;
+      Details->Addresses[3] = (void*) CubeAddresses;
+      AddDetails(Details);
    } else {
-      if (Address) free(Address);
-      if (RowAddresses) free(RowAddresses);
-      if (PlaneAddresses) free(PlaneAddresses);
-      if (CubeAddresses) free(CubeAddresses);
+      if (!I_SingleBlock) {
+         if (DataBlock) I_Allocator->Release(DataBlock,DataBlockBytes);
+         if (RowAddresses) I_Allocator->Release(RowAddresses,sizeof(Byte*) * Ny * Nz * Nt);
+         if (PlaneAddresses) I_Allocator->Release(PlaneAddresses,sizeof(Byte**) * Nz * Nt);
+      }
+      if (Details) I_Allocator->Release(Details->HeaderBlock,Details->HeaderBlockBytes);
       Address = NULL;
       RowAddresses = NULL;
       PlaneAddresses = NULL;
@@ -446,55 +1074,791 @@ void* ArrayManager::Malloc4D (
 
 //  ------------------------------------------------------------------------------------------------
 
-//                                     T e s t  C o d e
-//
-//  This is a pretty basic test routine that at least exercises most of the facilities
-//  of the ArrayManager code. It creates arrays of all the supported dimensionalities and
-//  collapses the large down into the smaller, successively, until all the data in the
-//  largest array has been collapsed down into just one number. This is compared to the
-//  value obtained by summing the elements of the original raw data in the largest
-//  array and seeing if they match.
+//                                        M a p  F i l e
 //
-//  Building:
-//     g++ -Wall -ansi -pedantic -o Test -DTEST_ACCESS ArrayManager.cpp
-//     ./Test
+//  MapFile() is used internally by MapFile2D() and MapFile3D(). It maps Bytes bytes of the named
+//  file, starting Offset bytes into the file, into memory, and returns the address at which the
+//  first of those bytes appears, or NULL if the file can't be opened or mapped, or is too short.
+//  mmap() can only map from a page boundary, so the mapping actually starts at the page
+//  boundary at or below Offset, and Block and BlockBytes are set to the address and size of the
+//  whole mapping, which are what munmap() needs to be passed eventually. The file is mapped
+//  shared, so the pages are shared with any other process mapping the same file, and if
+//  Writable is true then changes made through the mapping are written back to the file. If
+//  Writable is false, the mapping is read-only and any attempt to write to it will crash the
+//  program. The file descriptor is closed once the mapping is set up - the mapping doesn't
+//  need it.
 
-#ifdef TEST_ACCESS
-
-int main ()
+Byte* ArrayManager::MapFile (
+   const char* FileName,
+   size_t Bytes,
+   long Offset,
+   bool Writable,
+   void** Block,
+   size_t* BlockBytes)
 {
-   int Nt = 2;
-   int Nz = 3;
-   int Ny = 4;
-   int Nx = 5;
-   ArrayManager Manager;
-   
-   //  Allocate a 4D array and fill it up with test values.
-   
-   int**** Int4dArray = (int****) Manager.Malloc4D (sizeof(int),Nt,Nz,Ny,Nx);
-   if (!Int4dArray) {
-      printf ("***Failed to allocate 4D array***\n");
-   } else {
-      for (int It = 0; It < Nt; It++) {
-         for (int Iz = 0; Iz < Nz; Iz++) {
-            for (int Iy = 0; Iy < Ny; Iy++) {
-               for (int Ix = 0; Ix < Nx; Ix++) {
-                  Int4dArray[It][Iz][Iy][Ix] = It + Iz + Iy + Ix;
-               }
+   Byte* Address = NULL;
+   *Block = NULL;
+   *BlockBytes = 0;
+#ifdef AM_HAVE_MMAP
+   if (FileName && Offset >= 0 && Bytes > 0) {
+      int File = open (FileName,Writable ? O_RDWR : O_RDONLY);
+      if (File >= 0) {
+         struct stat Status;
+         if (fstat (File,&Status) == 0 && (size_t) Status.st_size >= (size_t) Offset + Bytes) {
+            long PageBytes = sysconf (_SC_PAGESIZE);
+            if (PageBytes <= 0) PageBytes = 4096;
+            long PageOffset = Offset % PageBytes;
+            int Protection = Writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+            void* Mapping = mmap (NULL,Bytes + PageOffset,Protection,MAP_SHARED,File,
+                                                                       Offset - PageOffset);
+            if (Mapping != MAP_FAILED) {
+               *Block = Mapping;
+               *BlockBytes = Bytes + PageOffset;
+               Address = (Byte*) Mapping + PageOffset;
             }
          }
+         close (File);
       }
-      
-      //  Allocate a 3D array and collapse the 4D array down into it.
-      
-      float*** Float3dArray = (float***) Manager.Malloc3D (sizeof(float),Nz,Ny,Nx);
-      if (!Float3dArray) {
-         printf ("***Failed to allocate 3D array***\n");
-      } else {
-         for (int Iz = 0; Iz < Nz; Iz++) {
-            for (int Iy = 0; Iy < Ny; Iy++) {
-               for (int Ix = 0; Ix < Nx; Ix++) {
-                  float Total = 0.0;
+   }
+#else
+   (void) FileName;
+   (void) Bytes;
+   (void) Offset;
+   (void) Writable;
+#endif
+   return Address;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     M a p  F i l e  2 D
+//
+//  MapFile2D() sets up a 2-dimensional array whose data is the contents of a file, mapped
+//  into memory rather than read. It is passed the name of the file, the size of each element,
+//  the number of rows (Ny) and columns (Nx), the offset in bytes of the first element from the
+//  start of the file, and a flag that is true if the array is to be written to as well as read.
+//  The data has to be stored in the file row by row, exactly as it would be in memory - which
+//  includes being in the native byte order of the machine. (So the data part of a FITS file,
+//  for example, which is always big-endian, can be mapped this way on a little-endian machine,
+//  but the values will need byte-swapping before they make sense. In that case the offset is
+//  the length of the FITS header, which is always a multiple of 2880 bytes.) It returns the
+//  same sort of address Malloc2D() does, so the data can be accessed as Data[Iy][Ix], and
+//  the result can be passed to Free(), BaseArray(), GetDimensions() and so on. Free() unmaps
+//  the file. It returns NULL if the file can't be mapped. Only the row pointers are allocated
+//  through the ArrayManager's allocator - they follow the array header in one block, just as
+//  for a single block allocation - so the array is available immediately without any reading
+//  of the file at all; pages are only read in as they are accessed.
+
+void* ArrayManager::MapFile2D (
+   const char* FileName,
+   unsigned int BytesPerElement,
+   long Ny,
+   long Nx,
+   long Offset,
+   bool Writable)
+{
+   size_t Pitch = BytesPerElement * Nx;
+   void* MappedBlock = NULL;
+   size_t MappedBytes = 0;
+   Byte* Address = MapFile (FileName,Pitch * Ny,Offset,Writable,&MappedBlock,&MappedBytes);
+   Byte** RowAddresses = NULL;
+   if (Address) {
+      ArrayDetails* Details = AllocateHeader (sizeof(Byte*) * Ny,0);
+      if (Details) {
+         RowAddresses = (Byte**) ((Byte*) Details + HeaderBytes);
+         Details->SingleBlock = true;
+         Details->MappedBlock = MappedBlock;
+         Details->MappedBytes = MappedBytes;
+         Details->NDims = 2;
+         Details->Dims[0] = Nx;
+         Details->Dims[1] = Ny;
+         Details->Pitch = Nx;
+         Details->BytesPerElement = BytesPerElement;
+         Details->Addresses[0] = (void*) Address;
+         Details->Addresses[1] = (void*) RowAddresses;
+         AddDetails(Details);
+         for (int Row = 0; Row < Ny; Row++) {
+            RowAddresses[Row] = Address + (Row * Pitch);
+         }
+      } else {
+         Unmap (MappedBlock,MappedBytes);
+      }
+   }
+   return (void*) RowAddresses;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     M a p  F i l e  3 D
+//
+//  MapFile3D() is to MapFile2D() what Malloc3D() is to Malloc2D(). The data in the file has to
+//  be stored plane by plane, and row by row within each plane. The plane pointers follow the
+//  header, and the row pointers follow them, in the one block.
+
+void* ArrayManager::MapFile3D (
+   const char* FileName,
+   unsigned int BytesPerElement,
+   long Nz,
+   long Ny,
+   long Nx,
+   long Offset,
+   bool Writable)
+{
+   size_t Pitch = BytesPerElement * Nx;
+   void* MappedBlock = NULL;
+   size_t MappedBytes = 0;
+   Byte* Address = MapFile (FileName,Pitch * Ny * Nz,Offset,Writable,&MappedBlock,&MappedBytes);
+   Byte*** PlaneAddresses = NULL;
+   if (Address) {
+      size_t PlaneTableBytes = sizeof(Byte**) * Nz;
+      ArrayDetails* Details = AllocateHeader (PlaneTableBytes + sizeof(Byte*) * Ny * Nz,0);
+      if (Details) {
+         PlaneAddresses = (Byte***) ((Byte*) Details + HeaderBytes);
+         Byte** RowAddresses = (Byte**) ((Byte*) PlaneAddresses + PlaneTableBytes);
+         Details->SingleBlock = true;
+         Details->MappedBlock = MappedBlock;
+         Details->MappedBytes = MappedBytes;
+         Details->NDims = 3;
+         Details->Dims[0] = Nx;
+         Details->Dims[1] = Ny;
+         Details->Dims[2] = Nz;
+         Details->Pitch = Nx;
+         Details->BytesPerElement = BytesPerElement;
+         Details->Addresses[0] = (void*) Address;
+         Details->Addresses[1] = (void*) RowAddresses;
+         Details->Addresses[2] = (void*) PlaneAddresses;
+         AddDetails(Details);
+         for (int Row = 0; Row < (Ny * Nz); Row++) {
+            RowAddresses[Row] = Address + (Row * Pitch);
+         }
+         for (int Plane = 0; Plane < Nz; Plane++) {
+            PlaneAddresses[Plane] = RowAddresses + (Plane * Ny);
+         }
+      } else {
+         Unmap (MappedBlock,MappedBytes);
+      }
+   }
+   return (void*) PlaneAddresses;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           U n m a p
+//
+//  Unmap() releases a mapping set up by MapFile(). For a writable mapping, this is what
+//  eventually gets any changes written back to the file (although the system is free to
+//  write them back at any time before that).
+
+void ArrayManager::Unmap (void* Block, size_t BlockBytes)
+{
+#ifdef AM_HAVE_MMAP
+   if (Block) munmap (Block,BlockBytes);
+#else
+   (void) Block;
+   (void) BlockBytes;
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        R e l e a s e
+//
+//  Release() gives up this manager's ownership of an array, without freeing it. The array is
+//  removed from the chain of arrays, so Free(), Reset() and the destructor no longer touch it,
+//  and is marked as belonging to no manager, so that another manager can Adopt() it. Until
+//  then, the only thing that can be done with it, apart from using the data, is to free it
+//  with FreeReleased(). An array that came from this manager's own arena can't be released,
+//  since its memory goes when the arena is reset or deleted. Release() returns true if the
+//  array was released, false if it wasn't one of this manager's arrays or came from its arena.
+
+bool ArrayManager::Release (void* Address)
+{
+   ArrayDetails* Details = FindDetails(Address);
+   if (Details == NULL) return false;
+   if (I_Arena && Details->Allocator == I_Arena) return false;
+   Unlink(Details);
+   Details->Manager = NULL;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          A d o p t
+//
+//  Adopt() takes on an array that another manager has released, adding it to the end of this
+//  manager's chain of arrays, so that from then on it is treated exactly as if this manager
+//  had allocated it. The memory still goes back to the allocator it came from when the array
+//  is freed. It returns false if the address isn't that of a released array.
+
+bool ArrayManager::Adopt (void* Address)
+{
+   ArrayDetails* Details = FindOwned(Address,NULL);
+   if (Details == NULL) return false;
+   Details->Manager = this;
+   AddDetails(Details);
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        T r a n s f e r
+//
+//  Transfer() passes an array from this manager to another, returning false - and leaving the
+//  array where it was - if it can't be released from this one.
+
+bool ArrayManager::Transfer (void* Address, ArrayManager& Recipient)
+{
+   if (!Release(Address)) return false;
+   return Recipient.Adopt(Address);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   F r e e  R e l e a s e d
+//
+//  FreeReleased() frees an array that has been released and not adopted, and so belongs to no
+//  manager. It does nothing if passed NULL, or anything else that isn't such an array.
+
+void ArrayManager::FreeReleased (void* Address)
+{
+   ArrayDetails* Details = FindOwned(Address,NULL);
+   if (Details) ReleaseMemory(Details);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          O w n e r
+//
+//  Owner() returns the manager an array belongs to, given the address returned by one of the
+//  Malloc() routines, or NULL if the array has been released, or the address is NULL. As with
+//  Free(), the address must be one returned by a Malloc() routine, as its header is read
+//  before anything else is checked. This is what lets ConcurrentArrayManager find which of
+//  its managers an array came from.
+
+ArrayManager* ArrayManager::Owner (void* Address)
+{
+   ArrayManager* Manager = NULL;
+   if (Address) {
+      ArrayDetails* Header = (ArrayDetails*) ((Byte*) Address - HeaderBytes);
+      if (Header->Magic == ArrayMagic && Header->NDims > 0 && Header->NDims <= 4 &&
+                                            Header->Addresses[Header->NDims - 1] == Address) {
+         Manager = Header->Manager;
+      }
+   }
+   return Manager;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        V i e w  2 D
+//
+//  View2D() returns the address of a set of row pointers for a region of an existing 2D array,
+//  which should be one allocated (or mapped, or viewed) by this manager. The region starts at
+//  row Y0 and element X0, and has Ny rows of Nx elements, taking every YStep'th row of the
+//  original. The row pointers are worked out from those of the original array, rather than
+//  from its base address and pitch, so views of views and of padded arrays come out right.
+//  It returns NULL if the address isn't that of a 2D array belonging to this manager, if the
+//  region isn't entirely within the array, if the array is indexed (and so has no row pointers
+//  to work from), or if the header can't be allocated.
+
+void* ArrayManager::View2D (
+   void* Address,
+   long Y0,
+   long X0,
+   long Ny,
+   long Nx,
+   long YStep)
+{
+   Byte** RowAddresses = NULL;
+   ArrayDetails* Parent = FindDetails(Address);
+   if (Parent && !Parent->Indexed && Parent->NDims == 2 && Nx > 0 && Ny > 0 && YStep > 0 &&
+            X0 >= 0 && Y0 >= 0 && X0 + Nx <= Parent->Dims[0] &&
+                                                       Y0 + (Ny - 1) * YStep < Parent->Dims[1]) {
+      ArrayDetails* Details = AllocateHeader (sizeof(Byte*) * Ny,0);
+      if (Details) {
+         Byte** ParentRows = (Byte**) Address;
+         size_t Offset = size_t(X0) * Parent->BytesPerElement;
+         RowAddresses = (Byte**) ((Byte*) Details + HeaderBytes);
+         for (long Row = 0; Row < Ny; Row++) {
+            RowAddresses[Row] = ParentRows[Y0 + Row * YStep] + Offset;
+         }
+         Details->SingleBlock = true;
+         Details->View = true;
+         Details->NDims = 2;
+         Details->Dims[0] = Nx;
+         Details->Dims[1] = Ny;
+         Details->Pitch = Parent->Pitch * YStep;
+         Details->BytesPerElement = Parent->BytesPerElement;
+         Details->Addresses[0] = (void*) RowAddresses[0];
+         Details->Addresses[1] = (void*) RowAddresses;
+         AddDetails(Details);
+      }
+   }
+   return (void*) RowAddresses;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        V i e w  3 D
+//
+//  View3D() is the 3D equivalent of View2D(). The view has Nz planes, taking every ZStep'th
+//  plane of the original from plane Z0, and each has Ny rows of Nx elements, taking every
+//  YStep'th row from row Y0 and starting at element X0. The plane pointers and the row
+//  pointers are allocated together, after the header, as they are for a mapped file.
+
+void* ArrayManager::View3D (
+   void* Address,
+   long Z0,
+   long Y0,
+   long X0,
+   long Nz,
+   long Ny,
+   long Nx,
+   long ZStep,
+   long YStep)
+{
+   Byte*** PlaneAddresses = NULL;
+   ArrayDetails* Parent = FindDetails(Address);
+   if (Parent && !Parent->Indexed && Parent->NDims == 3 && Nx > 0 && Ny > 0 && Nz > 0 &&
+         YStep > 0 && ZStep > 0 && X0 >= 0 && Y0 >= 0 && Z0 >= 0 && X0 + Nx <= Parent->Dims[0] &&
+         Y0 + (Ny - 1) * YStep < Parent->Dims[1] && Z0 + (Nz - 1) * ZStep < Parent->Dims[2]) {
+      size_t PlaneTableBytes = sizeof(Byte**) * Nz;
+      ArrayDetails* Details = AllocateHeader (PlaneTableBytes + sizeof(Byte*) * Ny * Nz,0);
+      if (Details) {
+         Byte*** ParentPlanes = (Byte***) Address;
+         size_t Offset = size_t(X0) * Parent->BytesPerElement;
+         PlaneAddresses = (Byte***) ((Byte*) Details + HeaderBytes);
+         Byte** RowAddresses = (Byte**) ((Byte*) PlaneAddresses + PlaneTableBytes);
+         for (long Plane = 0; Plane < Nz; Plane++) {
+            Byte** ParentRows = ParentPlanes[Z0 + Plane * ZStep];
+            PlaneAddresses[Plane] = RowAddresses + Plane * Ny;
+            for (long Row = 0; Row < Ny; Row++) {
+               PlaneAddresses[Plane][Row] = ParentRows[Y0 + Row * YStep] + Offset;
+            }
+         }
+         Details->SingleBlock = true;
+         Details->View = true;
+         Details->NDims = 3;
+         Details->Dims[0] = Nx;
+         Details->Dims[1] = Ny;
+         Details->Dims[2] = Nz;
+         Details->Pitch = Parent->Pitch * YStep;
+         Details->BytesPerElement = Parent->BytesPerElement;
+         Details->Addresses[0] = (void*) RowAddresses[0];
+         Details->Addresses[1] = (void*) RowAddresses;
+         Details->Addresses[2] = (void*) PlaneAddresses;
+         AddDetails(Details);
+      }
+   }
+   return (void*) PlaneAddresses;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          S w a p
+//
+//  Swap() exchanges the contents of two managers - their arrays, their settings, their usage
+//  counts and their arenas, if any - so each ends up exactly as the other was. Each array
+//  records the manager it belongs to, so the two chains have to be gone through to change that
+//  over, but nothing else is touched, and in particular no data is copied.
+
+void ArrayManager::Swap (ArrayManager& Other)
+{
+   ArrayDetails* First = I_First;
+   ArrayDetails* Last = I_Last;
+   bool SingleBlock = I_SingleBlock;
+   bool Indexed = I_Indexed;
+   size_t Alignment = I_Alignment;
+   bool PadRows = I_PadRows;
+   bool AvoidAliasing = I_AvoidAliasing;
+   ArrayAllocator* Allocator = I_Allocator;
+   ArenaAllocator* Arena = I_Arena;
+   int Tag = I_Tag;
+   ArrayUsage Usage = I_Usage;
+   double UsageStart = I_UsageStart;
+   
+   I_First = Other.I_First;
+   I_Last = Other.I_Last;
+   I_SingleBlock = Other.I_SingleBlock;
+   I_Indexed = Other.I_Indexed;
+   I_Alignment = Other.I_Alignment;
+   I_PadRows = Other.I_PadRows;
+   I_AvoidAliasing = Other.I_AvoidAliasing;
+   I_Allocator = Other.I_Allocator;
+   I_Arena = Other.I_Arena;
+   I_Tag = Other.I_Tag;
+   I_Usage = Other.I_Usage;
+   I_UsageStart = Other.I_UsageStart;
+   
+   Other.I_First = First;
+   Other.I_Last = Last;
+   Other.I_SingleBlock = SingleBlock;
+   Other.I_Indexed = Indexed;
+   Other.I_Alignment = Alignment;
+   Other.I_PadRows = PadRows;
+   Other.I_AvoidAliasing = AvoidAliasing;
+   Other.I_Allocator = Allocator;
+   Other.I_Arena = Arena;
+   Other.I_Tag = Tag;
+   Other.I_Usage = Usage;
+   Other.I_UsageStart = UsageStart;
+   
+   for (int ITag = 0; ITag < MaxTags; ITag++) {
+      ArrayUsage TagUsage = I_TagUsage[ITag];
+      I_TagUsage[ITag] = Other.I_TagUsage[ITag];
+      Other.I_TagUsage[ITag] = TagUsage;
+      char Name[sizeof(I_TagNames[0])];
+      memcpy (Name,I_TagNames[ITag],sizeof(Name));
+      memcpy (I_TagNames[ITag],Other.I_TagNames[ITag],sizeof(Name));
+      memcpy (Other.I_TagNames[ITag],Name,sizeof(Name));
+   }
+   
+   for (ArrayDetails* Details = I_First; Details; Details = Details->Next) {
+      Details->Manager = this;
+   }
+   for (ArrayDetails* Details = Other.I_First; Details; Details = Details->Next) {
+      Details->Manager = &Other;
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o u n t  A d d e d
+//
+//  CountAdded() adds an array to the usage counts for the manager and for its tag. The memory
+//  counted is everything the array's allocator was asked for - the block holding the header,
+//  and so the highest pointer array and, for a single block array, everything else - plus the
+//  separate data block and pointer arrays, if any - just what ReleaseMemory() gives back. Of
+//  that, the data is the rows of elements, with any padding; a view or a mapped array has
+//  none of its own. The amounts are recorded in the header, so that what is taken off again,
+//  by this manager or by one that adopts the array, is exactly what was added. This is called
+//  by every Malloc() routine, so must stay cheap - no searching, and no locking.
+
+void ArrayManager::CountAdded (ArrayDetails* Details)
+{
+   size_t Bytes = Details->HeaderBlockBytes + Details->DataBlockBytes;
+   if (!Details->SingleBlock) {
+      for (int IDim = 1; IDim < Details->NDims - 1; IDim++) {
+         if (Details->Addresses[IDim]) Bytes += TableBytes(Details,IDim);
+      }
+   }
+   size_t DataBytes = 0;
+   if (!Details->View && Details->MappedBlock == NULL) {
+      DataBytes = size_t(Details->Pitch) * size_t(Details->BytesPerElement);
+      for (int IDim = 1; IDim < Details->NDims; IDim++) DataBytes *= Details->Dims[IDim];
+   }
+   Details->UsageBytes = Bytes;
+   Details->UsageDataBytes = DataBytes;
+   if (Details->Tag < 0 || Details->Tag >= MaxTags) Details->Tag = 0;
+   ArrayUsage* Counts[2] = { &I_Usage, &I_TagUsage[Details->Tag] };
+   for (int Index = 0; Index < 2; Index++) {
+      ArrayUsage* Usage = Counts[Index];
+      Usage->LiveBytes += Bytes;
+      Usage->LiveDataBytes += DataBytes;
+      Usage->MappedBytes += Details->MappedBytes;
+      Usage->LiveArrays++;
+      Usage->Allocations++;
+      Usage->AllocatedBytes += double(Bytes);
+      if (Usage->LiveBytes > Usage->PeakBytes) Usage->PeakBytes = Usage->LiveBytes;
+      if (Usage->LiveArrays > Usage->PeakArrays) Usage->PeakArrays = Usage->LiveArrays;
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    C o u n t  R e m o v e d
+
+void ArrayManager::CountRemoved (ArrayDetails* Details)
+{
+   ArrayUsage* Counts[2] = { &I_Usage, &I_TagUsage[Details->Tag] };
+   for (int Index = 0; Index < 2; Index++) {
+      ArrayUsage* Usage = Counts[Index];
+      Usage->LiveBytes -= Details->UsageBytes;
+      Usage->LiveDataBytes -= Details->UsageDataBytes;
+      Usage->MappedBytes -= Details->MappedBytes;
+      Usage->LiveArrays--;
+      Usage->Frees++;
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       I n i t  U s a g e
+
+void ArrayManager::InitUsage (void)
+{
+   ArrayUsage Zero;
+   memset (&Zero,0,sizeof(Zero));
+   I_Usage = Zero;
+   for (int ITag = 0; ITag < MaxTags; ITag++) {
+      I_TagUsage[ITag] = Zero;
+      I_TagNames[ITag][0] = '\0';
+   }
+   I_Tag = 0;
+   I_UsageStart = Now();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                             N o w
+//
+//  Now() is only used when the counters are started and when they are read, never when an
+//  array is allocated, so it doesn't matter that it means a system call.
+
+double ArrayManager::Now (void)
+{
+#if defined(CLOCK_MONOTONIC)
+   struct timespec Time;
+   if (clock_gettime(CLOCK_MONOTONIC,&Time) == 0) {
+      return double(Time.tv_sec) + double(Time.tv_nsec) * 1.0e-9;
+   }
+#endif
+   return double(time(NULL));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          S e t  T a g
+//
+//  SetTag() sets the tag that arrays allocated after it has been called are counted against,
+//  as well as being counted in the totals for the manager. Tags are numbered from 0, the
+//  default, to MaxTags - 1; anything else is treated as 0. A tag is just a number, and what
+//  it means is up to the program - each stage of a pipeline might use its own, for example.
+//  An array keeps its tag if it passes to another manager.
+
+void ArrayManager::SetTag (int Tag)
+{
+   I_Tag = (Tag >= 0 && Tag < MaxTags) ? Tag : 0;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         N a m e  T a g
+//
+//  NameTag() gives a tag a name, used by ReportUsage() in place of its number. Names longer
+//  than 31 characters are truncated, and they shouldn't contain spaces, since ReportUsage()
+//  separates its fields with spaces.
+
+void ArrayManager::NameTag (int Tag, const char* Name)
+{
+   if (Tag >= 0 && Tag < MaxTags) {
+      size_t Length = Name ? strlen(Name) : 0;
+      if (Length >= sizeof(I_TagNames[Tag])) Length = sizeof(I_TagNames[Tag]) - 1;
+      if (Length) memcpy (I_TagNames[Tag],Name,Length);
+      I_TagNames[Tag][Length] = '\0';
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         T a g  N a m e
+
+const char* ArrayManager::TagName (int Tag) const
+{
+   if (Tag < 0 || Tag >= MaxTags || I_TagNames[Tag][0] == '\0') return NULL;
+   return I_TagNames[Tag];
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        G e t  U s a g e
+//
+//  GetUsage() returns the usage counts for all the arrays belonging to the manager, if Tag is
+//  -1 (the default), or for those counted against the given tag. It just copies them, so it
+//  can be called as often as is needed. Note that the peak for a tag is the highest that tag
+//  alone has reached, so the peaks for the different tags may add up to more than the peak
+//  for the manager as a whole, if they weren't all at their highest at the same time.
+
+void ArrayManager::GetUsage (ArrayUsage* Usage, int Tag) const
+{
+   if (Tag >= 0 && Tag < MaxTags) {
+      *Usage = I_TagUsage[Tag];
+   } else {
+      *Usage = I_Usage;
+   }
+   Usage->Seconds = Now() - I_UsageStart;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R e s e t  U s a g e
+//
+//  ResetUsage() starts the counters again, so the next GetUsage() covers just what has
+//  happened since - a program might call it at the start of each stage of its processing. The
+//  live counts can't change, as they describe the arrays the manager holds, but the peaks go
+//  back to the current values and the counts of allocations and frees go back to zero.
+
+void ArrayManager::ResetUsage (void)
+{
+   for (int Index = -1; Index < MaxTags; Index++) {
+      ArrayUsage* Usage = (Index < 0) ? &I_Usage : &I_TagUsage[Index];
+      Usage->PeakBytes = Usage->LiveBytes;
+      Usage->PeakArrays = Usage->LiveArrays;
+      Usage->Allocations = 0;
+      Usage->Frees = 0;
+      Usage->AllocatedBytes = 0.0;
+   }
+   I_UsageStart = Now();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      F o r m a t  U s a g e
+//
+//  FormatUsage() formats a set of usage counts as a single line, starting 'ARRAYS', followed
+//  by key=value pairs separated by spaces, in the same form as the BENCH lines written by
+//  BenchHarness.h. TagName is the value for the 'tag' key. The rates are per second since
+//  the counters were started, and overhead_bytes is everything that isn't data - headers,
+//  pointer arrays and alignment.
+
+void ArrayManager::FormatUsage (const ArrayUsage& Usage, const char* TagName, char* Line,
+                                                                            size_t LineBytes)
+{
+   double Seconds = Usage.Seconds > 0.0 ? Usage.Seconds : 0.0;
+   double AllocsPerSec = Seconds > 0.0 ? double(Usage.Allocations) / Seconds : 0.0;
+   double BytesPerSec = Seconds > 0.0 ? Usage.AllocatedBytes / Seconds : 0.0;
+   snprintf (Line,LineBytes,"ARRAYS tag=%s live_bytes=%lu data_bytes=%lu overhead_bytes=%lu "
+      "peak_bytes=%lu mapped_bytes=%lu live_arrays=%ld peak_arrays=%ld allocs=%lu frees=%lu "
+      "alloc_bytes=%.0f seconds=%.6g allocs_per_s=%.6g alloc_bytes_per_s=%.6g",TagName,
+      (unsigned long) Usage.LiveBytes,(unsigned long) Usage.LiveDataBytes,
+      (unsigned long) (Usage.LiveBytes - Usage.LiveDataBytes),(unsigned long) Usage.PeakBytes,
+      (unsigned long) Usage.MappedBytes,Usage.LiveArrays,Usage.PeakArrays,Usage.Allocations,
+      Usage.Frees,Usage.AllocatedBytes,Seconds,AllocsPerSec,BytesPerSec);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R e p o r t  U s a g e
+//
+//  ReportUsage() outputs the usage counts, one line for the manager as a whole (tag=all) and
+//  one for each tag that has had any arrays counted against it, in the form FormatUsage()
+//  gives. As with List(), the lines go to standard output if ReportRoutine is NULL, and
+//  otherwise ReportRoutine is called with each of them.
+
+void ArrayManager::ReportUsage (void (*ReportRoutine)(const char* String)) const
+{
+   char Line[512];
+   for (int Index = -1; Index < MaxTags; Index++) {
+      ArrayUsage Usage;
+      GetUsage (&Usage,Index);
+      if (Index >= 0 && Usage.Allocations == 0 && Usage.PeakArrays == 0) continue;
+      char Number[16];
+      const char* Name = "all";
+      if (Index >= 0) {
+         Name = TagName(Index);
+         if (Name == NULL) {
+            snprintf (Number,sizeof(Number),"%d",Index);
+            Name = Number;
+         }
+      }
+      FormatUsage (Usage,Name,Line,sizeof(Line));
+      if (ReportRoutine) {
+         (*ReportRoutine)(Line);
+      } else {
+         printf ("%s\n",Line);
+      }
+   }
+}
+
+#if __cplusplus >= 201103L
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     M o v e  O p e r a t i o n s
+//
+//  Moving a manager is just a Swap() with one that has nothing. The move constructor starts
+//  this manager off empty, as the normal constructor does, and swaps. Move assignment releases
+//  everything this manager holds, including its arena, before swapping, so what is left
+//  behind in Other is an empty manager with the default settings.
+
+ArrayManager::ArrayManager (ArrayManager&& Other)
+{
+   I_First = NULL;
+   I_Last = NULL;
+   I_SingleBlock = false;
+   I_Indexed = false;
+   I_Alignment = 16;
+   I_PadRows = false;
+   I_AvoidAliasing = false;
+   I_Allocator = ArrayAllocator::Default();
+   I_Arena = NULL;
+   InitUsage();
+   Swap(Other);
+}
+
+ArrayManager& ArrayManager::operator= (ArrayManager&& Other)
+{
+   if (this != &Other) {
+      Reset();
+      if (I_Arena) delete I_Arena;
+      I_Arena = NULL;
+      I_SingleBlock = false;
+      I_Indexed = false;
+      I_Alignment = 16;
+      I_PadRows = false;
+      I_AvoidAliasing = false;
+      I_Allocator = ArrayAllocator::Default();
+      InitUsage();
+      Swap(Other);
+   }
+   return *this;
+}
+
+#endif
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     T e s t  C o d e
+//
+//  This is a pretty basic test routine that at least exercises most of the facilities
+//  of the ArrayManager code. It creates arrays of all the supported dimensionalities and
+//  collapses the large down into the smaller, successively, until all the data in the
+//  largest array has been collapsed down into just one number. This is compared to the
+//  value obtained by summing the elements of the original raw data in the largest
+//  array and seeing if they match.
+//
+//  Building:
+//     g++ -Wall -ansi -pedantic -o Test -DTEST_ACCESS ArrayManager.cpp ArrayAllocator.cpp
+//     ./Test
+
+#ifdef TEST_ACCESS
+
+#include "ArrayTemplates.h"
+
+int main ()
+{
+   int Nt = 2;
+   int Nz = 3;
+   int Ny = 4;
+   int Nx = 5;
+   ArrayManager Manager;
+   
+   //  Allocate a 4D array and fill it up with test values.
+   
+   int**** Int4dArray = (int****) Manager.Malloc4D (sizeof(int),Nt,Nz,Ny,Nx);
+   if (!Int4dArray) {
+      printf ("***Failed to allocate 4D array***\n");
+   } else {
+      for (int It = 0; It < Nt; It++) {
+         for (int Iz = 0; Iz < Nz; Iz++) {
+            for (int Iy = 0; Iy < Ny; Iy++) {
+               for (int Ix = 0; Ix < Nx; Ix++) {
+                  Int4dArray[It][Iz][Iy][Ix] = It + Iz + Iy + Ix;
+               }
+            }
+         }
+      }
+      
+      //  Allocate a 3D array and collapse the 4D array down into it.
+      
+      float*** Float3dArray = (float***) Manager.Malloc3D (sizeof(float),Nz,Ny,Nx);
+      if (!Float3dArray) {
+         printf ("***Failed to allocate 3D array***\n");
+      } else {
+         for (int Iz = 0; Iz < Nz; Iz++) {
+            for (int Iy = 0; Iy < Ny; Iy++) {
+               for (int Ix = 0; Ix < Nx; Ix++) {
+                  float Total = 0.0;
                   for (int It = 0; It < Nt; It++) {
                      Total += Int4dArray[It][Iz][Iy][Ix];
                   }
@@ -576,6 +1940,405 @@ int main ()
             }
          }
       }
+
+      //  Arrays are only recognised by the manager that allocated them, and once freed
+      //  they aren't recognised at all.
+
+      ArrayManager OtherManager;
+      long Dims[4];
+      int NDims;
+      OtherManager.GetDimensions (Int4dArray,4,&NDims,Dims);
+      if (NDims != 0) {
+         printf ("***Array recognised by the wrong ArrayManager***\n");
+      }
+      int** Scratch = (int**) Manager.Malloc2D (sizeof(int),Ny,Nx);
+      Manager.Free (Scratch);
+      Manager.GetDimensions (Int4dArray,4,&NDims,Dims);
+      if (NDims != 4 || Manager.BaseArray (Int4dArray) == NULL) {
+         printf ("***Lost track of 4D array after freeing another***\n");
+      }
+
+      //  An array allocated as a single block should be accessed in exactly the same way,
+      //  with its data still contiguous and still found by BaseArray().
+
+      Manager.SetSingleBlock(true);
+      int**** Block4dArray = (int****) Manager.Malloc4D (sizeof(int),Nt,Nz,Ny,Nx);
+      Manager.SetSingleBlock(false);
+      if (!Block4dArray) {
+         printf ("***Failed to allocate single block 4D array***\n");
+      } else {
+         int* RawBlock = (int*) Manager.BaseArray (Block4dArray);
+         int Index = 0;
+         bool Matched = (RawBlock != NULL);
+         for (int It = 0; It < Nt; It++) {
+            for (int Iz = 0; Iz < Nz; Iz++) {
+               for (int Iy = 0; Iy < Ny; Iy++) {
+                  for (int Ix = 0; Ix < Nx; Ix++) {
+                     Block4dArray[It][Iz][Iy][Ix] = Int4dArray[It][Iz][Iy][Ix];
+                     if (Matched && &(Block4dArray[It][Iz][Iy][Ix]) != RawBlock + Index) {
+                        Matched = false;
+                     }
+                     Index++;
+                  }
+               }
+            }
+         }
+         if (!Matched) printf ("***Single block 4D array data isn't contiguous***\n");
+         Manager.Free (Block4dArray);
+      }
+
+      //  Aligned arrays with padded rows should have every row on the requested boundary,
+      //  with the pitch rounded up accordingly, and should be found by GetPitch().
+
+      for (int Single = 0; Single < 2; Single++) {
+         Manager.SetSingleBlock(Single != 0);
+         Manager.SetAlignment(64,true,true);
+         float*** Padded = (float***) Manager.Malloc3D (sizeof(float),3,4,5);
+         float** Aliased = (float**) Manager.Malloc2D (sizeof(float),4,1024);
+         Manager.SetAlignment(16);
+         Manager.SetSingleBlock(false);
+         if (!Padded || !Aliased) {
+            printf ("***Failed to allocate aligned arrays***\n");
+         } else {
+            if (Manager.GetPitch (Padded) != 16) {
+               printf ("***Pitch of padded array is %ld, not 16***\n",Manager.GetPitch (Padded));
+            }
+            if (Manager.GetPitch (Aliased) == 1024) {
+               printf ("***Pitch of 4096 byte rows was not adjusted***\n");
+            }
+            for (int Iz = 0; Iz < 3; Iz++) {
+               for (int Iy = 0; Iy < 4; Iy++) {
+                  if ((size_t) Padded[Iz][Iy] % 64) {
+                     printf ("***Row %d of plane %d is not 64 byte aligned***\n",Iy,Iz);
+                  }
+                  for (int Ix = 0; Ix < 5; Ix++) Padded[Iz][Iy][Ix] = float(Ix + Iy + Iz);
+               }
+            }
+            float* Base = (float*) Manager.BaseArray (Padded);
+            if (Base + ((2 * 4) + 3) * 16 + 4 != &(Padded[2][3][4])) {
+               printf ("***Padded array element not where the pitch says it is***\n");
+            }
+         }
+         Manager.Free (Padded);
+         Manager.Free (Aliased);
+      }
+
+      //  Arrays allocated from an arena should reuse the memory of a freed array of the same
+      //  shape, and should all go when the manager is reset, leaving it usable.
+
+      ArrayManager FrameManager;
+      FrameManager.UseArena(64 * 1024);
+      for (int Frame = 0; Frame < 3; Frame++) {
+         float*** Work = (float***) FrameManager.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         float** Scratch = (float**) FrameManager.Malloc2D (sizeof(float),Ny,Nx);
+         if (!Work || !Scratch) {
+            printf ("***Failed to allocate arena arrays for frame %d***\n",Frame);
+            break;
+         }
+         void* ScratchData = FrameManager.BaseArray (Scratch);
+         FrameManager.Free (Scratch);
+         Scratch = (float**) FrameManager.Malloc2D (sizeof(float),Ny,Nx);
+         if (Scratch != (void*) 0 && FrameManager.BaseArray (Scratch) != ScratchData) {
+            printf ("***Arena did not reuse memory for a same-shaped array***\n");
+         }
+         for (int Iz = 0; Iz < Nz; Iz++) {
+            for (int Iy = 0; Iy < Ny; Iy++) {
+               for (int Ix = 0; Ix < Nx; Ix++) Work[Iz][Iy][Ix] = Scratch[Iy][Ix] = 1.0;
+            }
+         }
+         FrameManager.Reset();
+         FrameManager.GetDimensions (Work,4,&NDims,Dims);
+         if (NDims != 0) printf ("***Array still recognised after Reset()***\n");
+      }
+
+      //  An array released by one manager and adopted by another should belong to the second
+      //  and not the first, keep its data, and be freed by the second. One passed through an
+      //  ArrayHandle and never adopted should be freed by the handle. Swapping two managers
+      //  should swap their arrays. Arena arrays can't be released.
+
+      {
+         ArrayManager Producer;
+         ArrayManager Consumer;
+         float** Frame = (float**) Producer.Malloc2D (sizeof(float),Ny,Nx);
+         if (!Frame) {
+            printf ("***Failed to allocate array to transfer***\n");
+         } else {
+            Frame[2][3] = 42.0;
+            if (!Producer.Transfer (Frame,Consumer)) printf ("***Transfer failed***\n");
+            Producer.GetDimensions (Frame,4,&NDims,Dims);
+            if (NDims != 0) printf ("***Transferred array still belongs to producer***\n");
+            Consumer.GetDimensions (Frame,4,&NDims,Dims);
+            if (NDims != 2 || Dims[0] != Nx || Frame[2][3] != 42.0) {
+               printf ("***Transferred array not found intact in consumer***\n");
+            }
+            if (Consumer.Adopt (Frame)) printf ("***Array adopted twice***\n");
+            ArrayManager Other;
+            Other.Swap (Consumer);
+            if (Other.BaseArray (Frame) == NULL || Consumer.BaseArray (Frame) != NULL) {
+               printf ("***Swap did not move the array between managers***\n");
+            }
+            Other.Free (Frame);
+         }
+         float*** Cube = (float***) Producer.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         {
+            ArrayHandle Handle (Producer,Cube);
+            if (Handle.Address() != Cube) printf ("***Handle did not take the array***\n");
+            Producer.GetDimensions (Cube,4,&NDims,Dims);
+            if (NDims != 0) printf ("***Array held by a handle still belongs to manager***\n");
+         }
+         ArrayManager ArenaManager;
+         ArenaManager.UseArena();
+         float** ArenaArray = (float**) ArenaManager.Malloc2D (sizeof(float),Ny,Nx);
+         if (ArenaManager.Release (ArenaArray)) printf ("***Arena array was released***\n");
+      }
+
+      //  A view of part of an array should see the same elements as the original, a change
+      //  made through it should show in the original, and freeing it should leave the
+      //  original alone. A 3D view that takes every other plane and row, and a view of that
+      //  view, should find the right elements too, and report where its planes really are.
+      //  A region that doesn't fit gets no view.
+
+      {
+         float*** Cube = (float***) Manager.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         float** Plane = (float**) Manager.Malloc2D (sizeof(float),Ny,Nx);
+         if (!Cube || !Plane) {
+            printf ("***Failed to allocate arrays for views***\n");
+         } else {
+            for (int Iz = 0; Iz < Nz; Iz++) {
+               for (int Iy = 0; Iy < Ny; Iy++) {
+                  for (int Ix = 0; Ix < Nx; Ix++) {
+                     Cube[Iz][Iy][Ix] = float(Iz * 100 + Iy * 10 + Ix);
+                     if (Iz == 0) Plane[Iy][Ix] = float(Iy * 10 + Ix);
+                  }
+               }
+            }
+            float** Roi = (float**) Manager.View2D (Plane,1,2,2,3);
+            int NDims = 0;
+            long Dims[3];
+            Manager.GetDimensions (Roi,3,&NDims,Dims);
+            if (!Roi || NDims != 2 || Dims[0] != 3 || Dims[1] != 2) {
+               printf ("***2D view has the wrong dimensions***\n");
+            } else {
+               if (Roi[1][2] != Plane[2][4]) printf ("***2D view element is %f***\n",Roi[1][2]);
+               Roi[0][0] = -1.0;
+               if (Plane[1][2] != -1.0) printf ("***Change through view not in original***\n");
+               if (Manager.BaseArray (Roi) != &Plane[1][2]) printf ("***View base is wrong***\n");
+               Manager.Free (Roi);
+               if (Plane[1][2] != -1.0) printf ("***Freeing a view changed the original***\n");
+            }
+            float*** Binned = (float***) Manager.View3D (Cube,0,0,1,2,2,3,2,2);
+            if (!Binned || Binned[1][1][0] != 200.0 + 20.0 + 1.0) {
+               printf ("***3D view with steps finds the wrong elements***\n");
+            } else {
+               float*** Inner = (float***) Manager.View3D (Binned,1,0,1,1,2,2);
+               if (!Inner || Inner[0][1][1] != 200.0 + 20.0 + 3.0) {
+                  printf ("***View of a view finds the wrong elements***\n");
+               }
+               if (Manager.GetPitch (Binned) != 2 * Manager.GetPitch (Cube)) {
+                  printf ("***Pitch of view with a row step is wrong***\n");
+               }
+               long CubePlane = Manager.GetStride (Cube,2);
+               if (CubePlane != Ny * Manager.GetPitch (Cube) || Manager.IsView (Cube) ||
+                     !Manager.IsView (Binned) || Manager.GetStride (Binned,2) != 2 * CubePlane) {
+                  printf ("***Plane stride of view with a plane step is wrong***\n");
+               }
+               Manager.Free (Inner);
+            }
+            Manager.Free (Binned);
+            if (Manager.View2D (Plane,0,Nx - 2,1,3) || Manager.View2D (Plane,0,0,3,1,2) ||
+                                                         Manager.View2D (Cube,0,0,1,1)) {
+               printf ("***View of a region outside the array was created***\n");
+            }
+            Manager.Free (Plane);
+            Manager.Free (Cube);
+         }
+      }
+
+      //  An indexed array has no pointer arrays, so the address returned is that of the
+      //  first element, and element [Iz][Iy][Ix] is ((Iz * Ny) + Iy) * Pitch + Ix elements
+      //  beyond it, with the pitch allowing for any padding. A view can't be made of one.
+
+      {
+         Manager.SetAlignment (32,true);
+         Manager.SetIndexed (true);
+         float* Stack = (float*) Manager.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         float* Hyper = (float*) Manager.Malloc4D (sizeof(float),2,Nz,Ny,Nx);
+         Manager.SetIndexed (false);
+         Manager.SetAlignment (0);
+         if (!Stack || !Hyper) {
+            printf ("***Failed to allocate indexed arrays***\n");
+         } else {
+            long Pitch = Manager.GetPitch (Stack);
+            if (Pitch != 8) printf ("***Pitch of padded indexed array is %ld***\n",Pitch);
+            if (!Manager.IsIndexed (Stack) || !Manager.IsIndexed (Hyper)) {
+               printf ("***Indexed arrays not reported as indexed***\n");
+            }
+            if (Manager.BaseArray (Stack) != Stack) {
+               printf ("***Base of indexed array is not its address***\n");
+            }
+            for (int Iz = 0; Iz < Nz; Iz++) {
+               for (int Iy = 0; Iy < Ny; Iy++) {
+                  for (int Ix = 0; Ix < Nx; Ix++) {
+                     Stack[((Iz * Ny) + Iy) * Pitch + Ix] = float(Iz * 100 + Iy * 10 + Ix);
+                  }
+               }
+            }
+            if (Stack[((2 * Ny) + 3) * Pitch + 4] != 234.0) {
+               printf ("***Indexed array element is wrong***\n");
+            }
+            long HyperPitch = Manager.GetPitch (Hyper);
+            Hyper[(((1 * Nz + Nz - 1) * Ny) + Ny - 1) * HyperPitch + Nx - 1] = 1.0;
+            int NDims = 0;
+            long Dims[4];
+            Manager.GetDimensions (Hyper,4,&NDims,Dims);
+            if (NDims != 4 || Dims[0] != Nx || Dims[3] != 2) {
+               printf ("***Indexed 4D array has the wrong dimensions***\n");
+            }
+            if (Manager.View2D (Stack,0,0,1,1) || Manager.View3D (Stack,0,0,0,1,1,1)) {
+               printf ("***View of an indexed array was created***\n");
+            }
+            Manager.Free (Hyper);
+            Manager.Free (Stack);
+         }
+         ArrayManager Other;
+         Other.SetIndexed (true);
+         void* Foreign = Other.Malloc2D (sizeof(float),Ny,Nx);
+         if (!Other.IsIndexed (Foreign) || Manager.IsIndexed (Foreign)) {
+            printf ("***Another manager's array reported as indexed***\n");
+         }
+         Other.Free (Foreign);
+         float** Table = (float**) Manager.Malloc2D (sizeof(float),Ny,Nx);
+         if (!Table || Manager.IsIndexed (Table)) {
+            printf ("***Array allocated after SetIndexed(false) has no pointers***\n");
+         }
+         Manager.Free (Table);
+
+         //  The typed classes that go through the pointer arrays have to refuse an indexed
+         //  array - freeing it again if they allocated it - while the indexed classes take
+         //  either kind. Once everything is freed, no arrays should be left over.
+
+         ArrayUsage Before;
+         Manager.GetUsage (&Before);
+         Manager.SetIndexed (true);
+         void* Plane = Manager.Malloc2D (sizeof(float),Ny,Nx);
+         void* Cube = Manager.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         void* Hyper4 = Manager.Malloc4D (sizeof(float),2,Nz,Ny,Nx);
+         Array2D<float> Plane2D (Manager,6,7);
+         Manager.SetIndexed (false);
+         if (Array2D<float> (Manager,(float**) Plane).IsValid() ||
+                Array3D<float> (Manager,(float***) Cube).IsValid() ||
+                   Array4D<float> (Manager,(float****) Hyper4).IsValid() || Plane2D.IsValid()) {
+            printf ("***Pointer array class accepted an indexed array***\n");
+         }
+         if (!IndexedArray2D<float> (Manager,Plane).IsValid() ||
+                                         !IndexedArray3D<float> (Manager,Cube).IsValid()) {
+            printf ("***Indexed array class refused an indexed array***\n");
+         }
+         Array2D<float> Ordinary (Manager,Ny,Nx);
+         if (!Ordinary.IsValid() || !IndexedArray2D<float> (Manager,Ordinary.Handle()).IsValid()) {
+            printf ("***Array with pointer arrays refused by a typed class***\n");
+         }
+         Manager.Free (Ordinary.Handle());
+         Manager.Free (Hyper4);
+         Manager.Free (Cube);
+         Manager.Free (Plane);
+         ArrayUsage After;
+         Manager.GetUsage (&After);
+         if (After.LiveArrays != Before.LiveArrays) {
+            printf ("***Refused typed array left %ld arrays allocated***\n",
+                                                     After.LiveArrays - Before.LiveArrays);
+         }
+      }
+
+      //  The usage counts should include an array's pointers and header as well as its data,
+      //  go back down when it is freed while keeping the peak, follow an array that moves to
+      //  another manager, and count a view as overhead only.
+
+      {
+         ArrayManager Counted;
+         Counted.NameTag (1,"frames");
+         Counted.SetTag (1);
+         float*** Cube = (float***) Counted.Malloc3D (sizeof(float),Nz,Ny,Nx);
+         Counted.SetTag (0);
+         ArrayUsage Usage;
+         Counted.GetUsage (&Usage,1);
+         size_t DataBytes = size_t(Nx) * Ny * Nz * sizeof(float);
+         if (!Cube || Usage.LiveArrays != 1 || Usage.LiveDataBytes != DataBytes ||
+                                                      Usage.LiveBytes <= Usage.LiveDataBytes) {
+            printf ("***Usage of tagged array counted wrongly***\n");
+         }
+         size_t CubeBytes = Usage.LiveBytes;
+         float*** Roi = (float***) Counted.View3D (Cube,0,0,0,2,2,2);
+         Counted.GetUsage (&Usage);
+         if (Usage.LiveArrays != 2 || Usage.LiveDataBytes != DataBytes) {
+            printf ("***Usage of view counted wrongly***\n");
+         }
+         Counted.Free (Roi);
+         ArrayManager Receiver;
+         Counted.Transfer (Cube,Receiver);
+         Receiver.GetUsage (&Usage,1);
+         if (Usage.LiveBytes != CubeBytes) printf ("***Usage did not follow transfer***\n");
+         Receiver.Free (Cube);
+         Counted.GetUsage (&Usage);
+         if (Usage.LiveBytes != 0 || Usage.LiveArrays != 0 || Usage.PeakBytes < CubeBytes ||
+                                               Usage.Allocations != 2 || Usage.Frees != 2) {
+            printf ("***Usage not back to zero after freeing***\n");
+         }
+         Counted.ResetUsage();
+         Counted.GetUsage (&Usage);
+         if (Usage.PeakBytes != 0 || Usage.Allocations != 0) {
+            printf ("***Usage not reset***\n");
+         }
+         char Line[512];
+         ArrayManager::FormatUsage (Usage,Counted.TagName(1),Line,sizeof(Line));
+         if (strncmp (Line,"ARRAYS tag=frames ",18)) printf ("***Usage line is '%s'***\n",Line);
+      }
+
+      //  A file mapped as a 3D array, starting part way into a page, should show its values
+      //  as elements of the array, and changes made through a writable 2D mapping of the
+      //  same file should end up in the file.
+
+      const char* MapFileName = "ArrayManagerTest.dat";
+      FILE* MapTest = fopen (MapFileName,"wb");
+      if (MapTest) {
+         const long HeaderLength = 100;
+         for (long IByte = 0; IByte < HeaderLength; IByte++) fputc (' ',MapTest);
+         for (int Index = 0; Index < Nx * Ny * Nz; Index++) {
+            float Value = float(Index);
+            fwrite (&Value,sizeof(float),1,MapTest);
+         }
+         fclose (MapTest);
+         float*** Mapped = (float***) Manager.MapFile3D (MapFileName,sizeof(float),Nz,Ny,Nx,
+                                                                           HeaderLength);
+         if (!Mapped) {
+            printf ("***Failed to map file as 3D array***\n");
+         } else {
+            if (Mapped[2][3][4] != float(((2 * Ny) + 3) * Nx + 4)) {
+               printf ("***Mapped 3D array element is %f***\n",Mapped[2][3][4]);
+            }
+            Manager.Free (Mapped);
+         }
+         float** Writable = (float**) Manager.MapFile2D (MapFileName,sizeof(float),Ny,Nx,
+                                                                     HeaderLength,true);
+         if (!Writable) {
+            printf ("***Failed to map file as writable 2D array***\n");
+         } else {
+            Writable[1][2] = -1.0;
+            Manager.Free (Writable);
+            float Value = 0.0;
+            MapTest = fopen (MapFileName,"rb");
+            if (MapTest) {
+               fseek (MapTest,HeaderLength + (Nx + 2) * sizeof(float),SEEK_SET);
+               if (fread (&Value,sizeof(float),1,MapTest) != 1) Value = 0.0;
+               fclose (MapTest);
+            }
+            if (Value != -1.0) printf ("***Write to mapped array not in file***\n");
+         }
+         if (Manager.MapFile2D (MapFileName,sizeof(float),Ny * 100,Nx)) {
+            printf ("***Mapped more data than the file holds***\n");
+         }
+         remove (MapFileName);
+      }
    }
    Manager.List();
    return 0;
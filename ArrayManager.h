@@ -18,7 +18,9 @@
 //
 //     There are routines to allocate 1D,2D,3D and 4D arrays of any type. It might be nice
 //     to have this implemented using templates so the casts in the Malloc calls can be
-//     avoided, but this is effective and simplifies things considerably.
+//     avoided, but this is effective and simplifies things considerably. (ArrayTemplates.h
+//     now provides a thin typed layer over these routines - Array2D<float> and so on - for
+//     code that would rather not have the casts.)
 //
 //     This sort of functionality is also provided, perhaps more elegantly, by the Boost
 //     multi-dimensional array library, or by Blitz++, but these are implemented using 
@@ -48,6 +50,132 @@
 //     GetDimensions() to find out the dimensions of the array. This means you can pass the
 //     address to a subroutine without needing to also pass the array dimensions, for example.
 //
+//     The details of each array are held in a small header allocated immediately in front of
+//     the address returned to the caller, so finding them from that address doesn't involve
+//     any searching, no matter how many arrays a manager is looking after. What this does
+//     mean is that every routine that takes the address of an array - Free(), BaseArray(),
+//     GetDimensions(), GetPitch(), IsIndexed(), View2D(), Release(), Owner() and the rest -
+//     must be passed NULL or an address that really was returned by one of the Malloc(),
+//     MapFile() or View() routines of an ArrayManager, and not yet freed. The header in
+//     front of the address is read before anything else is done, so an array that belongs
+//     to a different ArrayManager is recognised as such and ignored, but anything else - an
+//     address on the stack, one from malloc(), one part way into an array, or the address
+//     of an array that has been freed - leads to a read of memory that may not be there at
+//     all. (Older versions of this code searched a list of arrays, and so quietly ignored
+//     such addresses. This version doesn't, and the magic number in the header can't make
+//     up for that: it catches a header that isn't one, but only once it has been read.)
+//
+//     Normally, the data for an array and each of its levels of pointer arrays are allocated
+//     separately. If you call SetSingleBlock(true), any arrays allocated after that have the
+//     header, the pointer arrays and the data all allocated as a single block, with the
+//     pointer arrays first and the data starting on a 16 byte boundary after them (or a
+//     larger one, if SetAlignment() has been used). Access to
+//     the array is exactly the same either way, but a 4D array then only needs one call to
+//     malloc() and one to free(), rather than four of each, and the pointer arrays are kept
+//     close to the data they point to. This can help if you allocate and release a lot of
+//     arrays. The data for an array allocated in this way is still contiguous, and is still
+//     what BaseArray() returns.
+//
+//     By default, the data for each array starts on a 16 byte boundary, and rows follow one
+//     another with no gaps. SetAlignment() can be used to have the data for subsequent arrays
+//     start on a larger boundary - 32 or 64 bytes is useful for vector instructions and to
+//     match the cache line size - and optionally to have every row padded so that each row
+//     starts on such a boundary. In that case, the distance from one row to the next, the
+//     'pitch', can be more than the row length, and GetPitch() returns it (in elements).
+//     Code that accesses the data through the pointer arrays doesn't need to care about
+//     this, but code that treats BaseArray() as one long contiguous vector does. Padding can
+//     also be extended to avoid rows being an exact multiple of 4096 bytes apart, which can
+//     cause cache conflicts when code works on a number of rows at once.
+//
+//     All the memory an ArrayManager uses comes from an ArrayAllocator (see ArrayAllocator.h).
+//     The default simply uses malloc() and free(), and SetAllocator() can be used to supply
+//     another. A program that allocates and frees many same-sized work arrays - once per
+//     frame of data, say - can call UseArena() to have them come from an arena belonging to
+//     the manager. Freed arrays then go onto free lists and are reused by the next array
+//     of the same size, and Reset() releases every array the manager has allocated in one
+//     go, leaving the manager ready for the next frame. Since the manager now needs
+//     ArrayAllocator.cpp, that has to be compiled and linked along with ArrayManager.cpp.
+//
+//     BaseArray() is often used just to read data into an array from a file, or to write it
+//     out again, which means copying all the data. MapFile2D() and MapFile3D() avoid that by
+//     mapping the file into memory (using mmap()) and setting up the usual pointer arrays so
+//     that they point into the mapping. They return the same sort of address as Malloc2D()
+//     and Malloc3D(), and Free() unmaps the file. The data has to be stored in the file just
+//     as it would be in memory, in the machine's native byte order, starting at a given
+//     offset into the file (which need not be a multiple of the page size, so a fixed-length
+//     header such as that of a FITS file can be skipped over). Nothing is read until it is
+//     accessed, so even very large files are available at once, and the pages are shared
+//     with any other process that maps the same file. The mapping can be read-only or
+//     writable; changes to a writable mapping end up in the file.
+//
+//     Normally an array belongs to the manager that allocated it until it is freed or the
+//     manager is destroyed. Release() lets a manager give up an array without freeing it,
+//     and Adopt() lets another manager take it on, after which it is exactly as if that
+//     manager had allocated it - Transfer() does both at once. This means a frame produced
+//     by one stage of a pipeline can be passed on to the next stage, which has its own
+//     manager, without being copied. While an array belongs to no manager, FreeReleased()
+//     can be used to free it, and an ArrayHandle can be used to hold it, freeing it when the
+//     handle is destroyed unless it has been handed to a manager in the meantime. (Arrays
+//     that came from a manager's own arena belong to the arena, and can't be released.)
+//     Managers themselves can't be copied, but Swap() exchanges everything two managers
+//     hold, and when compiled as C++11 or later a manager can be moved, taking all its
+//     arrays with it - which is useful for returning a manager full of results from a
+//     routine, or keeping managers in a container.
+//
+//     View2D() and View3D() give access to a rectangular part of an existing array - a
+//     region of interest, or the part of a frame read out through one amplifier - without
+//     copying it. A view has its own pointer arrays, which point into the data of the array
+//     it is a view of, so it returns the same sort of address as Malloc2D() or Malloc3D(),
+//     and anything that takes one of those - such as the subr() routine in cnrsub.cpp - can
+//     be passed a view and works on just that region. A view can also take every n'th row
+//     (or plane), which is what binning needs. Since the pointer arrays are all a view has of
+//     its own, it costs one small allocation (two for 3D), and that is all Free() releases.
+//     Changes made through a view change the original array, which has to outlive the view.
+//     A view of a view works too. Pointer arrays can't skip along a row, so a view always
+//     takes consecutive elements of each row; StridedView2D in ArrayTemplates.h handles
+//     steps along the rows as well, at the cost of no longer looking like a Malloc2D() array.
+//     For a view, BaseArray() is the address of its first element and GetPitch() is the
+//     distance from one of its rows to the next, but a 3D view's planes are wherever they are
+//     in the original, so element [Iz][Iy][Ix] is not (((Iz * Ny) + Iy) * Pitch) + Ix on
+//     from the base as it is for other arrays. Code that works from the base address rather
+//     than the pointer arrays can use IsView() to spot a view, and GetStride() to find the
+//     distance between its planes - which is zero if they aren't evenly spaced.
+//
+//     The pointer arrays are what let Data[Iz][Iy][Ix] work on a plain pointer, but every
+//     access through them has to load a row address - and for a 3D or 4D array a plane or
+//     cube address before that - and the loads depend on one another, and the tables take
+//     up room in the cache that the data could use. If SetIndexed(true) is called, any
+//     2D, 3D or 4D arrays allocated after that have no pointer arrays at all. The Malloc()
+//     routines then return the address of the data itself, which is also what BaseArray()
+//     returns, and the usual header in front of it means GetDimensions(), GetPitch() and
+//     Free() work as usual. (SetSingleBlock() makes no difference to these, as the header
+//     and the data are always one block.) What the caller can't do is use the address as a
+//     float*** - element [Iz][Iy][Ix] is (((Iz * Ny) + Iy) * Pitch) + Ix elements on from
+//     it. IndexedArray2D, IndexedArray3D and IndexedArray4D in ArrayTemplates.h do that
+//     arithmetic behind the same Data[Iz][Iy][Ix] syntax, so code using them looks just
+//     like code using the pointer arrays. IsIndexed() says which kind an array is. Since
+//     the setting applies to each array as it is allocated, one program can have arrays of
+//     both kinds, and compare them. Views need the pointer arrays of the original array, so
+//     View2D() and View3D() can't be used on an indexed array.
+//
+//     Each manager keeps count of the memory its arrays are using - the data, the pointer
+//     arrays, the headers and any alignment padding - and of the highest that has reached,
+//     and GetUsage() returns these counts, along with the number of arrays allocated and
+//     freed, and how long it is since the counters were started. The counts are kept up
+//     to date as each array is added or removed, so GetUsage() is cheap enough to call at
+//     any time, and adding to them costs Malloc() and Free() a few additions, with no
+//     searching and no locking (an ArrayManager isn't thread-safe anyway - for a
+//     ConcurrentArrayManager, each shard keeps its own counts). An array that passes to
+//     another manager takes its share of the counts with it. Files mapped using MapFile2D()
+//     or MapFile3D() are counted separately, since the system can drop their pages at will.
+//     SetTag() attributes arrays allocated after it has been called to one of MaxTags
+//     tags - one for each stage of a pipeline, say - and each tag has counts of its own,
+//     so the peak memory for each stage can be found. ResetUsage() starts the peaks again
+//     from the current usage, and zeros the counts of allocations and frees. ReportUsage()
+//     outputs the counts as lines of key=value pairs - one for the manager as a whole, one
+//     for each tag that has been used - in the same form as the BENCH lines of the test
+//     programs, which is easy to pass on to a metrics system.
+//
 //     The idea of this code is to allow you to get elements of an N-dimensional array
 //     directly without having to do the usual C thing of manipulating pointers yourself
 //     in what I always find is a very error-prone process. It should be efficient. For
@@ -76,6 +204,29 @@
 //                    DEBUGLog(). However, calls to List() may have to be revised, as this
 //                    change is not backwards-compatible(). Licence text is now the more
 //                    permissive version currently used by AAO. KS.
+//     14th Oct 2026. The details for each array are now held in a small header
+//                    just in front of the address returned by the Malloc() routines,
+//                    and are chained together rather than held in a std::list. This
+//                    makes Free(), BaseArray() and GetDimensions() constant-time
+//                    operations, and means no separate list node is allocated for
+//                    each array.
+//     14th Oct 2026. Added SetSingleBlock(), which has the pointer arrays and the data
+//                    for an array allocated as one block.
+//     14th Oct 2026. Added SetAlignment() and GetPitch(), to support aligned data and
+//                    padded rows.
+//     14th Oct 2026. Memory now comes from an ArrayAllocator. Added SetAllocator(),
+//                    UseArena() and Reset().
+//     14th Oct 2026. Added MapFile2D() and MapFile3D().
+//     14th Oct 2026. Added Release(), Adopt(), Transfer(), FreeReleased(), Swap(), the
+//                    C++11 move operations, and the ArrayHandle class.
+//     14th Oct 2026. Added Owner(), for ConcurrentArrayManager.
+//     14th Oct 2026. Added View2D() and View3D().
+//     14th Oct 2026. Added SetIndexed() and IsIndexed(), for arrays without pointer arrays.
+//     14th Oct 2026. Added the memory usage counters, SetTag(), NameTag(), GetUsage(),
+//                    ResetUsage(), ReportUsage() and FormatUsage().
+//     14th Oct 2026. Added an include guard, so ArrayTemplates.h can be included as well.
+//     14th Oct 2026. Spelled out that only addresses returned by the manager may be passed.
+//     14th Oct 2026. Added IsView() and GetStride().
 //
 //  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
 //
@@ -94,13 +245,20 @@
 //  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
-#include <list>
+#ifndef __ArrayManager__
+#define __ArrayManager__
+
 #include <stdlib.h>
 #include <stdio.h>
 
-//  One struct of type ArrayDetails is used for each allocated array.
+#include "ArrayAllocator.h"
+
+class ArrayManager;
 
-typedef struct {
+//  One struct of type ArrayDetails is used for each allocated array. It is held in the
+//  header allocated in front of the address returned by the Malloc() routines.
+
+typedef struct ArrayDetails {
    //! Array dimensions
    long Dims[4];
    //! Number of dimensions
@@ -113,8 +271,69 @@ typedef struct {
    //! new plane of the data, [3] is the address of an array of pointers each pointing
    //! to the plane pointer that starts a new cube of the data. And so it could go on.. 
    void* Addresses[4];
+   //! A known value, used to check that this really is an array descriptor.
+   unsigned long Magic;
+   //! The ArrayManager that allocated the array.
+   ArrayManager* Manager;
+   //! The previous array allocated by the same manager, or NULL.
+   struct ArrayDetails* Prev;
+   //! The next array allocated by the same manager, or NULL.
+   struct ArrayDetails* Next;
+   //! True if the pointer arrays and the data follow the header in the one block.
+   bool SingleBlock;
+   //! Number of elements from the start of one row to the start of the next.
+   long Pitch;
+   //! The address the allocator returned for the block holding the header.
+   void* HeaderBlock;
+   //! The size of the block holding the header.
+   size_t HeaderBlockBytes;
+   //! The address the allocator returned for the data, or NULL if it is in the header block.
+   void* DataBlock;
+   //! The size of the block holding the data.
+   size_t DataBlockBytes;
+   //! The allocator from which all the memory for the array was obtained.
+   ArrayAllocator* Allocator;
+   //! The start of the file mapping holding the data, or NULL if it isn't mapped.
+   void* MappedBlock;
+   //! The size of the file mapping.
+   size_t MappedBytes;
+   //! True if this is a view of the data of another array, and has no data of its own.
+   bool View;
+   //! True if the array has no pointer arrays, and its address is that of the data.
+   bool Indexed;
+   //! The tag the array is counted against (see SetTag()).
+   int Tag;
+   //! The bytes of memory the array is counted as using, including its pointer arrays.
+   size_t UsageBytes;
+   //! How many of those bytes are the data itself.
+   size_t UsageDataBytes;
 } ArrayDetails;
 
+//  An ArrayUsage holds the memory usage counts for a manager, or for one tag - see GetUsage().
+
+typedef struct ArrayUsage {
+   //! Bytes used by the current arrays - data, pointer arrays, headers and alignment.
+   size_t LiveBytes;
+   //! How many of LiveBytes are the data of the arrays, including any padding of the rows.
+   size_t LiveDataBytes;
+   //! The highest LiveBytes has been since the counters were started.
+   size_t PeakBytes;
+   //! Bytes of files currently mapped by MapFile2D() or MapFile3D(). Not in LiveBytes.
+   size_t MappedBytes;
+   //! The number of current arrays.
+   long LiveArrays;
+   //! The highest LiveArrays has been since the counters were started.
+   long PeakArrays;
+   //! Arrays added since the counters were started - allocated, mapped, views, or adopted.
+   unsigned long Allocations;
+   //! Arrays removed since the counters were started - freed, or released.
+   unsigned long Frees;
+   //! The total LiveBytes of all the arrays added since the counters were started.
+   double AllocatedBytes;
+   //! The number of seconds since the counters were started.
+   double Seconds;
+} ArrayUsage;
+
 
 class ArrayManager {
 public:
@@ -138,9 +357,196 @@ public:
    void GetDimensions (void* Address, int MaxDims, int* NDims, long Dims[]);
    //!  List the allocated arrays for diagnostic purposes.
    void List (void (*ListRoutine)(const char* String) = NULL);
+   //!  Specify whether subsequent arrays are allocated as a single block.
+   void SetSingleBlock (bool SingleBlock);
+   //!  Specify whether subsequent arrays are allocated without pointer arrays.
+   void SetIndexed (bool Indexed);
+   //!  True if an array has no pointer arrays, so its address is that of its data.
+   bool IsIndexed (void* Address);
+   //!  Specify the alignment, and optional row padding, for subsequent arrays.
+   void SetAlignment (unsigned int AlignBytes, bool PadRows = false, bool AvoidAliasing = false);
+   //!  Return the number of elements from the start of one row to the start of the next.
+   long GetPitch (void* Address);
+   //!  Return the number of elements from one index to the next along a dimension, or 0.
+   long GetStride (void* Address, int IDim);
+   //!  True if an array is a view of part of another array (see View2D() and View3D()).
+   bool IsView (void* Address);
+   //!  Specify the allocator to be used for subsequent arrays (NULL for the default).
+   void SetAllocator (ArrayAllocator* Allocator);
+   //!  Have subsequent arrays allocated from an arena belonging to this manager.
+   void UseArena (size_t ChunkBytes = 0);
+   //!  Release all the arrays allocated by this manager, leaving it usable.
+   void Reset (void);
+   //!  Set up a 2-dimensional array whose data is mapped from a file.
+   void* MapFile2D (const char* FileName, unsigned int BytesPerElement, long Ny, long Nx,
+                                                  long Offset = 0, bool Writable = false);
+   //!  Set up a 3-dimensional array whose data is mapped from a file.
+   void* MapFile3D (const char* FileName, unsigned int BytesPerElement, long Nz, long Ny,
+                                         long Nx, long Offset = 0, bool Writable = false);
+   //!  Give up ownership of an array, which this manager will then no longer free.
+   bool Release (void* Address);
+   //!  Take ownership of an array that another manager has given up using Release().
+   bool Adopt (void* Address);
+   //!  Pass ownership of an array to another manager.
+   bool Transfer (void* Address, ArrayManager& Recipient);
+   //!  Free an array that has been released and not yet adopted by any manager.
+   static void FreeReleased (void* Address);
+   //!  Exchange all the arrays, settings and any arena held by two managers.
+   void Swap (ArrayManager& Other);
+   //!  The manager an array belongs to, or NULL if it has been released.
+   static ArrayManager* Owner (void* Address);
+   //!  Create a view of a rectangular region of a 2D array, taking every YStep'th row.
+   void* View2D (void* Address, long Y0, long X0, long Ny, long Nx, long YStep = 1);
+   //!  Create a view of a region of a 3D array, taking every ZStep'th plane, YStep'th row.
+   void* View3D (void* Address, long Z0, long Y0, long X0, long Nz, long Ny, long Nx,
+                                                            long ZStep = 1, long YStep = 1);
+   //!  The number of tags arrays can be counted against.
+   enum { MaxTags = 16 };
+   //!  Count arrays allocated from now on against a tag, from 0 (the default) to MaxTags - 1.
+   void SetTag (int Tag);
+   //!  Give a tag a name, for ReportUsage().
+   void NameTag (int Tag, const char* Name);
+   //!  The name of a tag, or NULL if it hasn't been given one.
+   const char* TagName (int Tag) const;
+   //!  Get the memory usage counts for all the arrays, or, if Tag isn't -1, for one tag.
+   void GetUsage (ArrayUsage* Usage, int Tag = -1) const;
+   //!  Start the peaks again from the current usage, and zero the allocation counts.
+   void ResetUsage (void);
+   //!  Output the usage counts for the manager, and for each tag used, as key=value lines.
+   void ReportUsage (void (*ReportRoutine)(const char* String) = NULL) const;
+   //!  Format a set of usage counts as one line of key=value pairs.
+   static void FormatUsage (const ArrayUsage& Usage, const char* TagName, char* Line,
+                                                                         size_t LineBytes);
+#if __cplusplus >= 201103L
+   //!  Move constructor. Other is left with no arrays, as if newly constructed.
+   ArrayManager (ArrayManager&& Other);
+   //!  Move assignment. Any arrays this manager had are released first.
+   ArrayManager& operator= (ArrayManager&& Other);
+#endif
 private:
-   //!  The set of descriptor structures for each array currently allocated.
-   std::list<ArrayDetails> I_Details;
+   //!  Allocate the block holding an array header and the array that follows it.
+   ArrayDetails* AllocateHeader (size_t Bytes, size_t Align);
+   //!  Allocate the data for an array, aligned as specified by SetAlignment().
+   unsigned char* AllocateData (size_t Bytes, void** Block, size_t* BlockBytes);
+   //!  Return the number of bytes from the start of one row to the next.
+   size_t RowBytes (unsigned int BytesPerElement, long Nx);
+   //!  Allocate an array with no pointer arrays, for SetIndexed(). Dims[0] is Nx.
+   void* MallocIndexed (unsigned int BytesPerElement, int NDims, const long Dims[]);
+   //!  Map part of a file into memory.
+   unsigned char* MapFile (const char* FileName, size_t Bytes, long Offset, bool Writable,
+                                                         void** Block, size_t* BlockBytes);
+   //!  Release a mapping set up by MapFile().
+   static void Unmap (void* Block, size_t BlockBytes);
+   //!  Find the details for an array belonging to a manager - NULL means no manager.
+   static ArrayDetails* FindOwned (void* Address, ArrayManager* Manager);
+   //!  Find the details for an array, given the address returned by Malloc().
+   ArrayDetails* FindDetails (void* Address);
+   //!  Add the details for a newly allocated array to the chain of arrays.
+   void AddDetails (ArrayDetails* Details);
+   //!  Remove the details for an array from the chain of arrays.
+   void Unlink (ArrayDetails* Details);
+   //!  Release all the memory used by an array and remove it from the chain.
+   void ReleaseArray (ArrayDetails* Details);
+   //!  Release all the memory used by an array that is not in any chain.
+   static void ReleaseMemory (ArrayDetails* Details);
+   //!  Add an array to the usage counts.
+   void CountAdded (ArrayDetails* Details);
+   //!  Remove an array from the usage counts.
+   void CountRemoved (ArrayDetails* Details);
+   //!  Zero all the usage counts and tag names, and start the clock.
+   void InitUsage (void);
+   //!  The time in seconds, from an arbitrary starting point.
+   static double Now (void);
+   //!  The descriptor for the first array currently allocated, or NULL.
+   ArrayDetails* I_First;
+   //!  The descriptor for the most recently allocated array, or NULL.
+   ArrayDetails* I_Last;
+   //!  True if new arrays are to be allocated as a single block.
+   bool I_SingleBlock;
+   //!  True if new arrays are to be allocated without pointer arrays.
+   bool I_Indexed;
+   //!  The alignment in bytes for the data of new arrays.
+   size_t I_Alignment;
+   //!  True if each row of new arrays is to start on an alignment boundary.
+   bool I_PadRows;
+   //!  True if padded rows that are a multiple of 4096 bytes are to be padded further.
+   bool I_AvoidAliasing;
+   //!  The allocator used for new arrays.
+   ArrayAllocator* I_Allocator;
+   //!  The arena belonging to this manager, if UseArena() has been called, or NULL.
+   ArenaAllocator* I_Arena;
+   //!  The tag new arrays are counted against.
+   int I_Tag;
+   //!  The usage counts for all the arrays.
+   ArrayUsage I_Usage;
+   //!  The usage counts for each tag.
+   ArrayUsage I_TagUsage[MaxTags];
+   //!  The names given to the tags - an empty string if not named.
+   char I_TagNames[MaxTags][32];
+   //!  The time the counters were started.
+   double I_UsageStart;
+   //!  Copying a manager would mean two managers owning the same arrays, so the copy
+   //!  constructor is private and not defined.
+   ArrayManager (const ArrayManager&);
+   //!  Nor is the assignment operator.
+   ArrayManager& operator= (const ArrayManager&);
 };
-   
-   
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     A r r a y  H a n d l e
+//
+//  An ArrayHandle holds a single array that has been released from its manager, and frees it
+//  when the handle is destroyed, unless it has been passed on to a manager by AdoptInto(). It
+//  can't be copied, since only one handle can own the array, but Swap() exchanges the arrays
+//  held by two handles and, for C++11 and later, a handle can be moved.
+
+class ArrayHandle {
+public:
+   //!  Constructor for a handle that holds nothing.
+   ArrayHandle (void) : I_Address(NULL) {}
+   //!  Constructor that takes an array from a manager. If it can't be released, the handle
+   //!  holds nothing and the array stays with the manager.
+   ArrayHandle (ArrayManager& Manager, void* Address) :
+      I_Address(Manager.Release(Address) ? Address : NULL) {}
+   //!  Destructor, which frees the array if the handle still holds it.
+   ~ArrayHandle () { ArrayManager::FreeReleased(I_Address); }
+   //!  The address of the array, as returned by the Malloc() routine, or NULL.
+   void* Address (void) const { return I_Address; }
+   //!  Hand the array to a manager, returning its address, or NULL if the handle was empty.
+   void* AdoptInto (ArrayManager& Manager) {
+      void* Address = I_Address;
+      if (Address && Manager.Adopt(Address)) {
+         I_Address = NULL;
+         return Address;
+      }
+      return NULL;
+   }
+   //!  Exchange the arrays held by two handles.
+   void Swap (ArrayHandle& Other) {
+      void* Address = I_Address;
+      I_Address = Other.I_Address;
+      Other.I_Address = Address;
+   }
+#if __cplusplus >= 201103L
+   //!  Move constructor.
+   ArrayHandle (ArrayHandle&& Other) : I_Address(Other.I_Address) { Other.I_Address = NULL; }
+   //!  Move assignment, which frees any array this handle held.
+   ArrayHandle& operator= (ArrayHandle&& Other) {
+      if (this != &Other) {
+         ArrayManager::FreeReleased(I_Address);
+         I_Address = Other.I_Address;
+         Other.I_Address = NULL;
+      }
+      return *this;
+   }
+#endif
+private:
+   //!  The address of the array held, or NULL.
+   void* I_Address;
+   //!  Copying isn't allowed.
+   ArrayHandle (const ArrayHandle&);
+   ArrayHandle& operator= (const ArrayHandle&);
+};
+
+#endif
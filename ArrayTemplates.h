@@ -0,0 +1,543 @@
+//
+//                           A r r a y  T e m p l a t e s . h
+//
+//  Function:
+//     Typed template front-end to the ArrayManager class.
+//
+//  Description:
+//     ArrayManager allocates arrays of any type, but because it does so through calls that
+//     return a void pointer, the caller has to cast the result to the right type, for example
+//     (float***) for a 3D array of floats, and has to remember the dimensions separately or
+//     ask for them using GetDimensions(). This file provides a set of small templated classes,
+//     Array1D<T>, Array2D<T>, Array3D<T> and Array4D<T>, that package up the address returned
+//     by ArrayManager together with the array dimensions. The element type and the number of
+//     dimensions are then known at compile time, so there are no casts, and a mistake such as
+//     passing a 3D array to a routine expecting a 2D array is caught by the compiler. For
+//     example:
+//
+//     ArrayManager Manager;
+//     Array3D<float> Data(Manager,Nz,Ny,Nx);
+//     float Element = Data[Iz][Iy][Ix];
+//
+//     These classes don't own the memory for the arrays - that still belongs to the
+//     ArrayManager used to allocate them, and is released as usual when that is destroyed,
+//     or explicitly by passing Handle() to ArrayManager::Free(). They are just a pointer and
+//     a few dimensions, so they are cheap to copy and can be passed by value or by reference.
+//     Handle() returns the same address the Malloc() routine returned, so existing code that
+//     uses the ArrayManager addresses directly - such as the subr() routine in cnrsub.cpp,
+//     which expects a float** - works unchanged.
+//
+//     Having the dimensions held alongside the address also helps the compiler. A subroutine
+//     passed an Array2D<float> can pick up Nx() and Ny() into local variables, and knows the
+//     element size exactly, which gives it the same information it would have had with
+//     separately passed dimensions but without the risk of the two getting out of step.
+//
+//     Dimension indices follow the ArrayManager convention: Dim(0) is the number of elements
+//     along X (the fastest varying index), Dim(1) the number along Y, and so on. If the
+//     ArrayManager was set to pad rows (see ArrayManager::SetAlignment()), Pitch() gives the
+//     number of elements from the start of one row to the start of the next, which is what
+//     code stepping through Data() directly needs to use rather than Nx().
+//
+//     Array2D and Array3D can also be constructed as views of part of an existing array of the
+//     same type, using ArrayManager::View2D() or View3D(), so a region of interest can be
+//     handled just like a whole array, and shares its data with the original. (The Pitch() of
+//     a view that takes every n'th row is n times that of the original. All the rows of a 3D
+//     view are spaced by Pitch(), but its planes need not be any particular distance apart.)
+//
+//     StridedView2D is for the case a view can't handle - taking every n'th element along
+//     each row, as when binning in X. It holds the address of the first element of the region
+//     and the distance in elements from one element to the next along a row and down a
+//     column, and element (Iy,Ix) is found as View(Iy,Ix). It isn't an ArrayManager array and
+//     has no pointer arrays, so it can't be passed to code that expects a T**, and it needs
+//     no allocation at all - it can be created for nothing, on the stack, as often as needed.
+//
+//     IndexedArray2D, IndexedArray3D and IndexedArray4D are for arrays with no pointer arrays
+//     at all, as allocated by an ArrayManager after SetIndexed(true). They keep the usual
+//     syntax - Data[Iz][Iy][Ix] - but the first subscripts return small proxy objects
+//     (IndexedCube and IndexedPlane) that just hold an address and a stride or two, and the
+//     last but one returns a row address worked out as Base + ((Iz * Ny) + Iy) * Pitch. So
+//     there is arithmetic where the Array3D<T> classes have a chain of dependent loads, and
+//     the compiler can see the whole calculation, and move the invariant parts out of the
+//     loops, just as it would for a static array. The proxies are never stored anywhere, so
+//     an optimising compiler leaves nothing of them but the arithmetic.
+//
+//     They can wrap any array from the manager whose rows are spaced by its pitch and whose
+//     planes follow each other - an indexed array, an ordinary one whose pointer arrays then
+//     go unused, or a 2D view - so the same code can be timed with both kinds. A 3D view
+//     whose planes aren't evenly spaced, which the arithmetic can't describe, gives an
+//     invalid indexed array. Handle() is the address the Malloc() routine returned, for use
+//     with the manager; for an indexed array it is the same as Data(). The allocating
+//     constructors allocate the array according to the manager's current SetIndexed()
+//     setting, so it is up to the caller to have set that. The other way round doesn't work:
+//     Array2D, Array3D and Array4D need the pointer arrays, so given an indexed array they
+//     are left invalid - and if they allocated it themselves, because SetIndexed(true) was in
+//     force, they free it again.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added Pitch().
+//     14th Oct 2026. Added the view constructors and StridedView2D.
+//     14th Oct 2026. Added IndexedArray2D, IndexedArray3D and IndexedArray4D.
+//     14th Oct 2026. Array2D, Array3D and Array4D now refuse indexed arrays, which have none
+//                    of the pointer arrays they use.
+//     14th Oct 2026. An array allocated by one of these and then refused is freed again.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __ArrayTemplates__
+#define __ArrayTemplates__
+
+#include "ArrayManager.h"
+
+//  ------------------------------------------------------------------------------------------------
+
+//                              U s e s  P o i n t e r  A r r a y s
+//
+//  UsesPointerArrays<AddressType>::Value is true if a class holding an address of that type
+//  reaches its elements through the array's pointer arrays - a T**, say - and false if the
+//  address is just a void* handle, as for the indexed array classes.
+
+template <typename AddressType>
+struct UsesPointerArrays { enum { Value = true }; };
+
+template <>
+struct UsesPointerArrays<void*> { enum { Value = false }; };
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                T y p e d  A r r a y  B a s e
+//
+//  TypedArrayBase is the common part of all the typed array classes. It holds the address
+//  returned by the ArrayManager (of type AddressType, eg T** for a 2D array) and the dimensions
+//  of the array. Rank is the number of dimensions.
+
+template <typename T, int Rank, typename AddressType>
+class TypedArrayBase {
+public:
+   //!  The type of each element of the array.
+   typedef T ElementType;
+   //!  The type of the address returned by the ArrayManager for this type of array.
+   typedef AddressType HandleType;
+   //!  The number of dimensions of the array.
+   enum { NDims = Rank };
+   //!  The address originally returned by the ArrayManager, or NULL.
+   HandleType Handle (void) const { return I_Handle; }
+   //!  The number of elements along one of the dimensions (0 is X).
+   long Dim (int IDim) const { return I_Dims[IDim]; }
+   //!  The total number of elements in the array.
+   long Elements (void) const {
+      long Count = 1;
+      for (int IDim = 0; IDim < Rank; IDim++) Count *= I_Dims[IDim];
+      return Count;
+   }
+   //!  True if the array was allocated (or wrapped) successfully.
+   bool IsValid (void) const { return I_Handle != NULL; }
+   //!  The number of elements from the start of one row to the next (see SetAlignment()).
+   long Pitch (void) const { return I_Pitch; }
+protected:
+   //!  Constructor, for use by the derived classes.
+   TypedArrayBase (void) : I_Handle(NULL), I_Pitch(0) {
+      for (int IDim = 0; IDim < Rank; IDim++) I_Dims[IDim] = 0;
+   }
+   //!  Record the handle, and get the dimensions from the manager. An indexed array has no
+   //!  pointer arrays, so is refused by the classes that need them.
+   void SetHandle (ArrayManager& Manager, HandleType Address) {
+      long Dims[Rank];
+      int NDimsFound = 0;
+      Manager.GetDimensions ((void*) Address,Rank,&NDimsFound,Dims);
+      I_Handle = NULL;
+      bool NeedsPointers = Rank > 1 && UsesPointerArrays<AddressType>::Value;
+      if (NDimsFound == Rank && !(NeedsPointers && Manager.IsIndexed ((void*) Address))) {
+         I_Handle = Address;
+      }
+      for (int IDim = 0; IDim < Rank; IDim++) I_Dims[IDim] = I_Handle ? Dims[IDim] : 0;
+      I_Pitch = I_Handle ? Manager.GetPitch ((void*) Address) : 0;
+   }
+   //!  Record the handle of an array just allocated, freeing it again if it is refused.
+   void SetAllocated (ArrayManager& Manager, HandleType Address) {
+      SetHandle(Manager,Address);
+      if (I_Handle == NULL && Address) Manager.Free ((void*) Address);
+   }
+   //!  The address returned by the ArrayManager.
+   HandleType I_Handle;
+   //!  The array dimensions, X first.
+   long I_Dims[Rank];
+   //!  The row pitch, in elements.
+   long I_Pitch;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       A r r a y  1 D
+
+template <typename T>
+class Array1D : public TypedArrayBase<T,1,T*> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   Array1D (void) {}
+   //!  Constructor that allocates a new array using an ArrayManager.
+   Array1D (ArrayManager& Manager, long Nx) {
+      this->SetAllocated(Manager,(T*) Manager.Malloc1D(sizeof(T),Nx));
+   }
+   //!  Constructor that wraps an array already allocated by an ArrayManager.
+   Array1D (ArrayManager& Manager, T* Address) { this->SetHandle(Manager,Address); }
+   //!  Element access.
+   T& operator[] (long Ix) const { return this->I_Handle[Ix]; }
+   //!  The number of elements.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return this->I_Handle; }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       A r r a y  2 D
+
+template <typename T>
+class Array2D : public TypedArrayBase<T,2,T**> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   Array2D (void) {}
+   //!  Constructor that allocates a new array using an ArrayManager.
+   Array2D (ArrayManager& Manager, long Ny, long Nx) {
+      this->SetAllocated(Manager,(T**) Manager.Malloc2D(sizeof(T),Ny,Nx));
+   }
+   //!  Constructor that wraps an array already allocated by an ArrayManager.
+   Array2D (ArrayManager& Manager, T** Address) { this->SetHandle(Manager,Address); }
+   //!  Constructor that creates a view of part of another array (see ArrayManager::View2D()).
+   Array2D (ArrayManager& Manager, const Array2D<T>& Parent, long Y0, long X0, long Ny, long Nx,
+                                                                             long YStep = 1) {
+      this->SetHandle(Manager,(T**) Manager.View2D(Parent.Handle(),Y0,X0,Ny,Nx,YStep));
+   }
+   //!  Row access, so elements can be accessed as Array[Iy][Ix].
+   T* operator[] (long Iy) const { return this->I_Handle[Iy]; }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return this->I_Handle ? this->I_Handle[0] : NULL; }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       A r r a y  3 D
+
+template <typename T>
+class Array3D : public TypedArrayBase<T,3,T***> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   Array3D (void) {}
+   //!  Constructor that allocates a new array using an ArrayManager.
+   Array3D (ArrayManager& Manager, long Nz, long Ny, long Nx) {
+      this->SetAllocated(Manager,(T***) Manager.Malloc3D(sizeof(T),Nz,Ny,Nx));
+   }
+   //!  Constructor that wraps an array already allocated by an ArrayManager.
+   Array3D (ArrayManager& Manager, T*** Address) { this->SetHandle(Manager,Address); }
+   //!  Constructor that creates a view of part of another array (see ArrayManager::View3D()).
+   Array3D (ArrayManager& Manager, const Array3D<T>& Parent, long Z0, long Y0, long X0,
+                          long Nz, long Ny, long Nx, long ZStep = 1, long YStep = 1) {
+      this->SetHandle(Manager,(T***) Manager.View3D(Parent.Handle(),Z0,Y0,X0,Nz,Ny,Nx,
+                                                                              ZStep,YStep));
+   }
+   //!  Plane access, so elements can be accessed as Array[Iz][Iy][Ix].
+   T** operator[] (long Iz) const { return this->I_Handle[Iz]; }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The number of planes.
+   long Nz (void) const { return this->I_Dims[2]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return this->I_Handle ? this->I_Handle[0][0] : NULL; }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       A r r a y  4 D
+
+template <typename T>
+class Array4D : public TypedArrayBase<T,4,T****> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   Array4D (void) {}
+   //!  Constructor that allocates a new array using an ArrayManager.
+   Array4D (ArrayManager& Manager, long Nt, long Nz, long Ny, long Nx) {
+      this->SetAllocated(Manager,(T****) Manager.Malloc4D(sizeof(T),Nt,Nz,Ny,Nx));
+   }
+   //!  Constructor that wraps an array already allocated by an ArrayManager.
+   Array4D (ArrayManager& Manager, T**** Address) { this->SetHandle(Manager,Address); }
+   //!  Cube access, so elements can be accessed as Array[It][Iz][Iy][Ix].
+   T*** operator[] (long It) const { return this->I_Handle[It]; }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The number of planes.
+   long Nz (void) const { return this->I_Dims[2]; }
+   //!  The number of cubes.
+   long Nt (void) const { return this->I_Dims[3]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return this->I_Handle ? this->I_Handle[0][0][0] : NULL; }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 S t r i d e d  V i e w  2 D
+//
+//  A StridedView2D of a 2D array takes Ny rows of Nx elements, starting at row Y0 and element
+//  X0, taking every YStep'th row and every XStep'th element along each row. If the region isn't
+//  entirely within the array, the view is invalid. It relies on the rows of the array being
+//  Pitch() elements apart, which they are for anything an ArrayManager creates.
+
+template <typename T>
+class StridedView2D {
+public:
+   //!  Constructor for an empty (invalid) view.
+   StridedView2D (void) : I_Base(NULL), I_Nx(0), I_Ny(0), I_XStride(0), I_YStride(0) {}
+   //!  Constructor for a view of part of an array.
+   StridedView2D (const Array2D<T>& Parent, long Y0, long X0, long Ny, long Nx,
+                                                       long YStep = 1, long XStep = 1) :
+                    I_Base(NULL), I_Nx(0), I_Ny(0), I_XStride(0), I_YStride(0) {
+      if (Parent.IsValid() && Nx > 0 && Ny > 0 && XStep > 0 && YStep > 0 && X0 >= 0 &&
+               Y0 >= 0 && X0 + (Nx - 1) * XStep < Parent.Nx() &&
+                                                   Y0 + (Ny - 1) * YStep < Parent.Ny()) {
+         I_Base = Parent[Y0] + X0;
+         I_Nx = Nx;
+         I_Ny = Ny;
+         I_XStride = XStep;
+         I_YStride = Parent.Pitch() * YStep;
+      }
+   }
+   //!  Element access, as View(Iy,Ix).
+   T& operator() (long Iy, long Ix) const { return I_Base[Iy * I_YStride + Ix * I_XStride]; }
+   //!  The address of the first element of a row. Its elements are XStride() apart.
+   T* Row (long Iy) const { return I_Base + Iy * I_YStride; }
+   //!  The number of columns.
+   long Nx (void) const { return I_Nx; }
+   //!  The number of rows.
+   long Ny (void) const { return I_Ny; }
+   //!  The number of elements from one element of a row to the next.
+   long XStride (void) const { return I_XStride; }
+   //!  The number of elements from one row to the next.
+   long YStride (void) const { return I_YStride; }
+   //!  True if this is a usable view.
+   bool IsValid (void) const { return I_Base != NULL; }
+private:
+   //!  The first element of the view.
+   T* I_Base;
+   //!  The dimensions of the view.
+   long I_Nx;
+   long I_Ny;
+   //!  The strides, in elements.
+   long I_XStride;
+   long I_YStride;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                I n d e x e d  P l a n e
+//
+//  An IndexedPlane is what the first subscript of an IndexedArray3D gives - the start of one
+//  plane, and the row pitch - so that the next subscript can work out the address of a row.
+
+template <typename T>
+class IndexedPlane {
+public:
+   //!  Constructor, given the address of the first element of the plane and the row pitch.
+   IndexedPlane (T* Base, long Pitch) : I_Base(Base), I_Pitch(Pitch) {}
+   //!  Row access, so elements can be accessed as Plane[Iy][Ix].
+   T* operator[] (long Iy) const { return I_Base + Iy * I_Pitch; }
+private:
+   //!  The first element of the plane.
+   T* I_Base;
+   //!  The number of elements from one row to the next.
+   long I_Pitch;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 I n d e x e d  C u b e
+//
+//  An IndexedCube is what the first subscript of an IndexedArray4D gives.
+
+template <typename T>
+class IndexedCube {
+public:
+   //!  Constructor, given the first element of the cube, the plane stride and the row pitch.
+   IndexedCube (T* Base, long PlaneStride, long Pitch) :
+                                  I_Base(Base), I_PlaneStride(PlaneStride), I_Pitch(Pitch) {}
+   //!  Plane access, so elements can be accessed as Cube[Iz][Iy][Ix].
+   IndexedPlane<T> operator[] (long Iz) const {
+      return IndexedPlane<T> (I_Base + Iz * I_PlaneStride,I_Pitch);
+   }
+private:
+   //!  The first element of the cube.
+   T* I_Base;
+   //!  The number of elements from one plane to the next.
+   long I_PlaneStride;
+   //!  The number of elements from one row to the next.
+   long I_Pitch;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                               I n d e x e d  A r r a y  2 D
+
+template <typename T>
+class IndexedArray2D : public TypedArrayBase<T,2,void*> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   IndexedArray2D (void) : I_Base(NULL) {}
+   //!  Constructor that allocates a new array using an ArrayManager (see SetIndexed()).
+   IndexedArray2D (ArrayManager& Manager, long Ny, long Nx) : I_Base(NULL) {
+      Wrap(Manager,Manager.Malloc2D(sizeof(T),Ny,Nx));
+   }
+   //!  Constructor that wraps a 2D array already allocated by an ArrayManager.
+   IndexedArray2D (ArrayManager& Manager, void* Address) : I_Base(NULL) {
+      Wrap(Manager,Address);
+   }
+   //!  Row access, so elements can be accessed as Array[Iy][Ix].
+   T* operator[] (long Iy) const { return I_Base + Iy * this->I_Pitch; }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return I_Base; }
+private:
+   //!  Record the handle and dimensions, and find the data.
+   void Wrap (ArrayManager& Manager, void* Address) {
+      this->SetHandle(Manager,Address);
+      if (this->I_Handle) I_Base = (T*) Manager.BaseArray(Address);
+   }
+   //!  The first element of the array.
+   T* I_Base;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                               I n d e x e d  A r r a y  3 D
+
+template <typename T>
+class IndexedArray3D : public TypedArrayBase<T,3,void*> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   IndexedArray3D (void) : I_Base(NULL), I_PlaneStride(0) {}
+   //!  Constructor that allocates a new array using an ArrayManager (see SetIndexed()).
+   IndexedArray3D (ArrayManager& Manager, long Nz, long Ny, long Nx) :
+                                                          I_Base(NULL), I_PlaneStride(0) {
+      Wrap(Manager,Manager.Malloc3D(sizeof(T),Nz,Ny,Nx));
+   }
+   //!  Constructor that wraps a 3D array already allocated by an ArrayManager.
+   IndexedArray3D (ArrayManager& Manager, void* Address) : I_Base(NULL), I_PlaneStride(0) {
+      Wrap(Manager,Address);
+   }
+   //!  Plane access, so elements can be accessed as Array[Iz][Iy][Ix].
+   IndexedPlane<T> operator[] (long Iz) const {
+      return IndexedPlane<T> (I_Base + Iz * I_PlaneStride,this->I_Pitch);
+   }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The number of planes.
+   long Nz (void) const { return this->I_Dims[2]; }
+   //!  The number of elements from the start of one plane to the next.
+   long PlaneStride (void) const { return I_PlaneStride; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return I_Base; }
+private:
+   //!  Record the handle and dimensions, find the data, and check the planes are where the
+   //!  arithmetic expects them, which they are unless this is a view.
+   void Wrap (ArrayManager& Manager, void* Address) {
+      this->SetHandle(Manager,Address);
+      if (this->I_Handle) {
+         I_Base = (T*) Manager.BaseArray(Address);
+         I_PlaneStride = this->I_Dims[1] * this->I_Pitch;
+         if (!Manager.IsIndexed(Address)) {
+            T*** Planes = (T***) Address;
+            for (long Iz = 0; Iz < this->I_Dims[2]; Iz++) {
+               if (Planes[Iz][0] != I_Base + Iz * I_PlaneStride) {
+                  this->I_Handle = NULL;
+                  I_Base = NULL;
+                  break;
+               }
+            }
+         }
+      }
+   }
+   //!  The first element of the array.
+   T* I_Base;
+   //!  The number of elements from one plane to the next.
+   long I_PlaneStride;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                               I n d e x e d  A r r a y  4 D
+
+template <typename T>
+class IndexedArray4D : public TypedArrayBase<T,4,void*> {
+public:
+   //!  Constructor for an empty (invalid) array.
+   IndexedArray4D (void) : I_Base(NULL), I_PlaneStride(0), I_CubeStride(0) {}
+   //!  Constructor that allocates a new array using an ArrayManager (see SetIndexed()).
+   IndexedArray4D (ArrayManager& Manager, long Nt, long Nz, long Ny, long Nx) :
+                                        I_Base(NULL), I_PlaneStride(0), I_CubeStride(0) {
+      Wrap(Manager,Manager.Malloc4D(sizeof(T),Nt,Nz,Ny,Nx));
+   }
+   //!  Constructor that wraps a 4D array already allocated by an ArrayManager.
+   IndexedArray4D (ArrayManager& Manager, void* Address) :
+                                        I_Base(NULL), I_PlaneStride(0), I_CubeStride(0) {
+      Wrap(Manager,Address);
+   }
+   //!  Cube access, so elements can be accessed as Array[It][Iz][Iy][Ix].
+   IndexedCube<T> operator[] (long It) const {
+      return IndexedCube<T> (I_Base + It * I_CubeStride,I_PlaneStride,this->I_Pitch);
+   }
+   //!  The number of columns.
+   long Nx (void) const { return this->I_Dims[0]; }
+   //!  The number of rows.
+   long Ny (void) const { return this->I_Dims[1]; }
+   //!  The number of planes.
+   long Nz (void) const { return this->I_Dims[2]; }
+   //!  The number of cubes.
+   long Nt (void) const { return this->I_Dims[3]; }
+   //!  The address of the actual array elements.
+   T* Data (void) const { return I_Base; }
+private:
+   //!  Record the handle and dimensions, and find the data. (There are no 4D views, so the
+   //!  planes and cubes of any 4D array are always evenly spaced.)
+   void Wrap (ArrayManager& Manager, void* Address) {
+      this->SetHandle(Manager,Address);
+      if (this->I_Handle) {
+         I_Base = (T*) Manager.BaseArray(Address);
+         I_PlaneStride = this->I_Dims[1] * this->I_Pitch;
+         I_CubeStride = this->I_Dims[2] * I_PlaneStride;
+      }
+   }
+   //!  The first element of the array.
+   T* I_Base;
+   //!  The number of elements from one plane to the next.
+   long I_PlaneStride;
+   //!  The number of elements from one cube to the next.
+   long I_CubeStride;
+};
+
+#endif
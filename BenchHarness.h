@@ -0,0 +1,510 @@
+//
+//                              B e n c h  H a r n e s s . h
+//
+//  Function:
+//     In-process timing of the repeated subr() calls made by the C++ test programs.
+//
+//  Description:
+//     Run.py originally timed each test program as a whole, using the wall clock time for
+//     the process, and subtracted the time taken by a second run with a repeat count of one
+//     to allow for the time spent starting the program, setting up the arrays and checking
+//     the results. That works well enough when the repeated calls take most of the time,
+//     but it mixes in the process start-up, the page faults that come with touching newly
+//     allocated memory, and the checking code, and for small arrays the variation in those
+//     can be larger than the time being measured. A BenchHarness sits inside the test
+//     program and times just the loop that calls subr(), and it times it in pieces, so that
+//     the spread of the times can be seen as well as the typical value.
+//
+//     A test program uses it like this:
+//
+//     BenchHarness Bench ("cmain",Nx,Ny,Nrpt);
+//     ... allocate and initialise the arrays ...
+//     Bench.StartLoop();
+//     while (Bench.Next()) subr (In,Nx,Ny,Out);
+//     ... check the results, setting Error if they're wrong ...
+//     Bench.Report(Error);
+//
+//     The time from the construction of the harness to StartLoop() is reported as the setup
+//     time, and the time from the end of the loop to Report() as the check time. Next()
+//     first allows a number of warm-up calls, which are not timed, so the caches, the branch
+//     predictors and the CPU clock speed have settled by the time timing starts. It then
+//     allows exactly Nrpt timed calls, reading the clock (std::chrono::steady_clock) once for
+//     each batch of calls. The batch size is chosen so there are at most 1000 batches, which
+//     keeps the cost of reading the clock negligible even for very fast calls, and the time
+//     per call for each batch is one sample. Report() sorts the samples and prints the
+//     median, minimum, mean and the 10th, 90th and 99th percentiles, together with the
+//     setup, loop and check times.
+//
+//     Where it can, the harness also records the number of page faults in each phase (using
+//     getrusage()), the number of time stamp counter ticks per call on x86 (which runs at a
+//     fixed rate, so is another clock, not a cycle count), and whether the CPU's turbo boost
+//     is enabled and its clock frequency before and after the loop, as reported by Linux. A
+//     loop that shows page faults, or a frequency that changed, is worth a second look.
+//     It also counts hardware events over the timed calls - cycles, instructions, cache and
+//     branch misses and floating point instructions - using the PerfCounters class in
+//     PerfCounters.h, and reports them per array element. Those that aren't available are
+//     reported as -1.
+//
+//     Report() finishes with a single line starting with 'BENCH' and made up of key=value
+//     items, so that it can be picked up by Run.py, or any other script, without having to
+//     parse the rest of the output. Times in it are in nanoseconds per call, or seconds for
+//     the three phases. A value that couldn't be obtained is given as -1.
+//
+//     The harness can also be told the size of each array element, which defaults to the
+//     size of a float. It then reports the throughput for the median call in GBytes per
+//     second, counting each element as read once from one array and written once to
+//     another, as it is by subr(), and in elements processed per nanosecond. For tests with
+//     different element types, the first shows how close each gets to the memory bandwidth,
+//     and the second how much the narrower types gain by moving fewer bytes.
+//
+//     A test program can add results of its own to the BENCH line using Extra(), which
+//     takes a key and a numeric value - for example, cgpumain.cpp uses it to report the
+//     time taken by the GPU kernels alone, which it measures itself. The key is not copied,
+//     so should be a string constant, and must not include spaces or an '='.
+//
+//     The test programs keep subr() in a separate file so the compiler can't see that the
+//     repeated calls all do the same thing, and do it only once - or not at all, since
+//     only the last result is ever checked. Link time optimisation undoes that separation,
+//     so a program that may be built that way should pass the output array to Sink() after
+//     each call. Sink() generates no code, but the compiler has to assume it reads all
+//     of memory, so every call has to have written its results by then. (With compilers
+//     other than gcc and clang, it only stores the address in a volatile variable, which
+//     is weaker, but still keeps the calls.)
+//
+//     The number of warm-up calls defaults to a tenth of Nrpt, up to at most 1000, and can
+//     be set using the environment variable BENCH_WARMUP. The maximum number of samples can
+//     be set using BENCH_SAMPLES.
+//
+//     Everything is defined in this header, so a test program only needs to include it -
+//     there is nothing extra to compile or link. It needs C++11.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added the hardware performance counters.
+//     14th Oct 2026. Added the element size, and the throughput it gives.
+//     14th Oct 2026. Added Extra().
+//     14th Oct 2026. Added Sink().
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __BenchHarness__
+#define __BenchHarness__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "PerfCounters.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BENCH_HAVE_RUSAGE
+#include <sys/resource.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_HAVE_TSC
+#include <x86intrin.h>
+#endif
+
+class BenchHarness {
+public:
+   //!  Constructor. Setup timing starts here.
+   BenchHarness (const char* Name, long Nx, long Ny, long Nrpt,
+                                                   size_t ElementBytes = sizeof(float));
+   //!  Marks the end of the setup, and the start of the loop.
+   void StartLoop (void);
+   //!  Returns true if the loop should make another call.
+   bool Next (void) {
+      if (I_Left > 0) {
+         I_Left--;
+         return true;
+      }
+      return Advance();
+   }
+   //!  Stops the compiler optimising away the call that produced the data addressed.
+   static void Sink (const void* Data) {
+#if defined(__GNUC__) || defined(__clang__)
+      __asm__ __volatile__ ("" : : "r" (Data) : "memory");
+#else
+      static const void* volatile Kept;
+      Kept = Data;
+#endif
+   }
+   //!  Adds an item of the program's own to the BENCH line written by Report().
+   void Extra (const char* Key, double Value) {
+      I_Extras.push_back(std::make_pair(Key,Value));
+   }
+   //!  Marks the end of the checking, and reports the results.
+   void Report (bool Error);
+private:
+   typedef std::chrono::steady_clock Clock;
+   //!  The phases of the test.
+   enum Phase { Setup, Warmup, Timing, Check };
+   //!  Handles the end of a batch of calls. Returns true if there are more calls to make.
+   bool Advance (void);
+   //!  The number of page faults (minor, major) so far, or -1 if unknown.
+   static void PageFaults (long* Minor, long* Major);
+   //!  The current time stamp counter value, or 0 if there isn't one.
+   static unsigned long long Ticks (void);
+   //!  1 if turbo boost is enabled, 0 if not, -1 if unknown.
+   static int TurboState (void);
+   //!  The current clock frequency of CPU 0 in kHz, or -1 if unknown.
+   static long CurrentKHz (void);
+   //!  Read a single integer from a file, returning -1 if that's not possible.
+   static long ReadNumber (const char* FileName);
+   //!  Seconds between two clock readings.
+   static double Seconds (Clock::time_point Start, Clock::time_point End) {
+      return std::chrono::duration<double>(End - Start).count();
+   }
+   //!  The value at a given fraction of the way through the sorted samples.
+   double Percentile (double Fraction) const;
+   //!  The name of the test program, and the test parameters.
+   const char* I_Name;
+   long I_Nx;
+   long I_Ny;
+   long I_Nrpt;
+   //!  The size of each array element, in bytes.
+   size_t I_ElementBytes;
+   //!  The number of warm-up calls, and the number of calls in a full batch.
+   long I_Warmup;
+   long I_Batch;
+   //!  The current phase, the calls left in the current batch and the timed calls done.
+   Phase I_Phase;
+   long I_Left;
+   long I_Done;
+   long I_BatchCalls;
+   //!  The times at which each phase started, and the current batch started.
+   Clock::time_point I_SetupStart;
+   Clock::time_point I_LoopStart;
+   Clock::time_point I_TimingStart;
+   Clock::time_point I_CheckStart;
+   Clock::time_point I_BatchStart;
+   //!  The time stamp counter at the start and end of the timed calls.
+   unsigned long long I_TicksStart;
+   unsigned long long I_TicksEnd;
+   //!  Page faults at the start of each phase, and at the end.
+   long I_Minor[5];
+   long I_Major[5];
+   //!  Clock frequency at the start and end of the timed calls.
+   long I_KHzStart;
+   long I_KHzEnd;
+   //!  The time per call, in nanoseconds, for each batch.
+   std::vector<double> I_Samples;
+   //!  The hardware performance counters, counting over the timed calls.
+   PerfCounters I_Perf;
+   //!  Items added to the BENCH line by Extra().
+   std::vector<std::pair<const char*,double> > I_Extras;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+
+inline BenchHarness::BenchHarness (const char* Name, long Nx, long Ny, long Nrpt,
+                                                                     size_t ElementBytes) :
+   I_Name(Name), I_Nx(Nx), I_Ny(Ny), I_Nrpt(Nrpt), I_ElementBytes(ElementBytes),
+   I_Warmup(0), I_Batch(1), I_Phase(Setup),
+   I_Left(0), I_Done(0), I_BatchCalls(0), I_TicksStart(0), I_TicksEnd(0),
+   I_KHzStart(-1), I_KHzEnd(-1)
+{
+   if (I_Nrpt < 0) I_Nrpt = 0;
+   I_Warmup = I_Nrpt / 10;
+   if (I_Warmup > 1000) I_Warmup = 1000;
+   const char* Env = getenv("BENCH_WARMUP");
+   if (Env && atol(Env) >= 0) I_Warmup = atol(Env);
+   long MaxSamples = 1000;
+   Env = getenv("BENCH_SAMPLES");
+   if (Env && atol(Env) > 0) MaxSamples = atol(Env);
+   I_Batch = (I_Nrpt + MaxSamples - 1) / MaxSamples;
+   if (I_Batch < 1) I_Batch = 1;
+   I_Samples.reserve(size_t(MaxSamples));
+   for (int Index = 0; Index < 5; Index++) I_Minor[Index] = I_Major[Index] = -1;
+   PageFaults(&I_Minor[Setup],&I_Major[Setup]);
+   I_SetupStart = Clock::now();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      S t a r t  L o o p
+
+inline void BenchHarness::StartLoop (void)
+{
+   I_LoopStart = Clock::now();
+   PageFaults(&I_Minor[Warmup],&I_Major[Warmup]);
+   I_Phase = Warmup;
+   I_Left = I_Warmup;
+   I_Done = 0;
+   I_Samples.clear();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         A d v a n c e
+//
+//  Advance() is called by Next() when the current batch of calls has been made - or when
+//  the warm-up calls have been made, which is treated as a batch that isn't timed. It
+//  records the time for the batch and sets up the next one. The end of one batch is the
+//  start of the next, so there are no gaps in the timing.
+
+inline bool BenchHarness::Advance (void)
+{
+   unsigned long long TicksNow = Ticks();
+   Clock::time_point Now = Clock::now();
+   if (I_Phase == Timing && I_Done + I_BatchCalls >= I_Nrpt) I_Perf.Stop();
+   if (I_Phase == Warmup) {
+
+      //  The warm-up calls are done. Gather the things that are recorded at the start of
+      //  the timed calls, and then read the clocks again so that doing so isn't timed.
+
+      I_KHzStart = CurrentKHz();
+      PageFaults(&I_Minor[Timing],&I_Major[Timing]);
+      I_Phase = Timing;
+      I_Done = 0;
+      I_TicksStart = Ticks();
+      I_Perf.Start();
+      Now = Clock::now();
+      I_TimingStart = Now;
+   } else if (I_Phase == Timing) {
+      double Nanosecs = std::chrono::duration<double,std::nano>(Now - I_BatchStart).count();
+      I_Samples.push_back(Nanosecs / double(I_BatchCalls));
+      I_Done += I_BatchCalls;
+   } else {
+      return false;
+   }
+   if (I_Done >= I_Nrpt) {
+      if (I_Nrpt == 0) I_Perf.Stop();
+      I_TicksEnd = TicksNow;
+      I_Phase = Check;
+      I_CheckStart = Now;
+      I_KHzEnd = CurrentKHz();
+      PageFaults(&I_Minor[Check],&I_Major[Check]);
+      return false;
+   }
+   I_BatchCalls = std::min(I_Batch,I_Nrpt - I_Done);
+   I_Left = I_BatchCalls - 1;
+   I_BatchStart = Now;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       P e r c e n t i l e
+//
+//  Percentile() returns the sample a given fraction of the way through the sorted samples,
+//  using the nearest-rank method. The samples must already have been sorted.
+
+inline double BenchHarness::Percentile (double Fraction) const
+{
+   if (I_Samples.empty()) return -1.0;
+   long Count = long(I_Samples.size());
+   long Rank = long(Fraction * double(Count) + 0.5);
+   if (Rank < 1) Rank = 1;
+   if (Rank > Count) Rank = Count;
+   return I_Samples[size_t(Rank - 1)];
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          R e p o r t
+
+inline void BenchHarness::Report (bool Error)
+{
+   Clock::time_point End = Clock::now();
+   if (I_Phase != Check) {
+
+      //  The loop never finished, or never started. Treat whatever has happened since the
+      //  last phase began as the check, so at least the setup time is sensible.
+
+      if (I_Phase == Setup) I_LoopStart = End;
+      if (I_Phase != Timing) I_TimingStart = I_LoopStart;
+      I_CheckStart = End;
+      PageFaults(&I_Minor[Check],&I_Major[Check]);
+      if (I_Minor[Timing] < 0) {
+         I_Minor[Timing] = I_Minor[Check];
+         I_Major[Timing] = I_Major[Check];
+      }
+   }
+   PageFaults(&I_Minor[4],&I_Major[4]);
+
+   std::sort(I_Samples.begin(),I_Samples.end());
+   double Mean = -1.0;
+   if (!I_Samples.empty()) {
+      double Total = 0.0;
+      for (size_t Index = 0; Index < I_Samples.size(); Index++) Total += I_Samples[Index];
+      Mean = Total / double(I_Samples.size());
+   }
+   double Min = I_Samples.empty() ? -1.0 : I_Samples[0];
+   double Median = Percentile(0.5);
+   double SetupSecs = Seconds(I_SetupStart,I_LoopStart);
+   double LoopSecs = Seconds(I_TimingStart,I_CheckStart);
+   double CheckSecs = Seconds(I_CheckStart,End);
+   double ElementsPerNs = -1.0;
+   double GBytesPerSec = -1.0;
+   if (Median > 0.0) {
+      ElementsPerNs = double(I_Nx) * double(I_Ny) / Median;
+      GBytesPerSec = ElementsPerNs * 2.0 * double(I_ElementBytes);
+   }
+   double TicksPerCall = -1.0;
+   if (I_TicksEnd > I_TicksStart && I_Done > 0) {
+      TicksPerCall = double(I_TicksEnd - I_TicksStart) / double(I_Done);
+   }
+
+   //  The page fault counts for each phase are the differences between the counts at the
+   //  start of successive phases. (The warm-up calls are counted with the setup.)
+
+   long SetupMinor = -1, LoopMinor = -1, CheckMinor = -1, LoopMajor = -1;
+   if (I_Minor[Setup] >= 0) {
+      SetupMinor = I_Minor[Timing] - I_Minor[Setup];
+      LoopMinor = I_Minor[Check] - I_Minor[Timing];
+      LoopMajor = I_Major[Check] - I_Major[Timing];
+      CheckMinor = I_Minor[4] - I_Minor[Check];
+   }
+   int Turbo = TurboState();
+
+   //  The performance counter values are given per array element processed, which makes
+   //  them comparable between tests with different array sizes and repeat counts.
+
+   double PerElement[PerfCounters::NCounters];
+   double Elements = double(I_Done) * double(I_Nx) * double(I_Ny);
+   for (int Index = 0; Index < PerfCounters::NCounters; Index++) {
+      double Value = I_Perf.Value(PerfCounters::Counter(Index));
+      PerElement[Index] = (Value >= 0.0 && Elements > 0.0) ? Value / Elements : -1.0;
+   }
+
+   if (I_Samples.empty()) {
+      printf ("No timed calls were made\n");
+   } else {
+      printf ("Median %.4g us, min %.4g us, 10%% %.4g us, 90%% %.4g us, 99%% %.4g us per call\n",
+         Median * 0.001,Min * 0.001,Percentile(0.1) * 0.001,Percentile(0.9) * 0.001,
+         Percentile(0.99) * 0.001);
+   }
+   printf ("(%ld samples of %ld calls, after %ld warm-up calls)\n",
+      long(I_Samples.size()),I_Batch,I_Warmup);
+   if (GBytesPerSec > 0.0) {
+      printf ("Throughput %.4g GBytes/sec, %.4g elements/nsec, with %ld byte elements\n",
+                                       GBytesPerSec,ElementsPerNs,long(I_ElementBytes));
+   }
+   printf ("Setup %.3f sec, loop %.3f sec, check %.3f sec, page faults %ld/%ld/%ld\n",
+      SetupSecs,LoopSecs,CheckSecs,SetupMinor,LoopMinor,CheckMinor);
+   if (I_Perf.Available()) {
+      printf ("Per element:");
+      for (int Index = 0; Index < PerfCounters::NCounters; Index++) {
+         if (PerElement[Index] >= 0.0) {
+            printf (" %s %.4g",PerfCounters::Name(PerfCounters::Counter(Index)),
+                                                                  PerElement[Index]);
+         }
+      }
+      printf ("\n");
+   }
+   printf ("BENCH name=%s nx=%ld ny=%ld nrpt=%ld warmup=%ld samples=%ld batch=%ld "
+      "median_ns=%.6g min_ns=%.6g mean_ns=%.6g p10_ns=%.6g p90_ns=%.6g p99_ns=%.6g "
+      "setup_s=%.6g loop_s=%.6g check_s=%.6g minflt_setup=%ld minflt_loop=%ld "
+      "majflt_loop=%ld minflt_check=%ld tsc_per_call=%.6g turbo=%d khz_start=%ld "
+      "khz_end=%ld elem_bytes=%ld gbps=%.6g elem_per_ns=%.6g",
+      I_Name,I_Nx,I_Ny,I_Nrpt,I_Warmup,long(I_Samples.size()),I_Batch,
+      Median,Min,Mean,Percentile(0.1),Percentile(0.9),Percentile(0.99),
+      SetupSecs,LoopSecs,CheckSecs,SetupMinor,LoopMinor,LoopMajor,CheckMinor,
+      TicksPerCall,Turbo,I_KHzStart,I_KHzEnd,long(I_ElementBytes),GBytesPerSec,ElementsPerNs);
+   for (int Index = 0; Index < PerfCounters::NCounters; Index++) {
+      printf (" %s_per_elem=%.6g",PerfCounters::Name(PerfCounters::Counter(Index)),
+                                                                     PerElement[Index]);
+   }
+   for (size_t Index = 0; Index < I_Extras.size(); Index++) {
+      printf (" %s=%.6g",I_Extras[Index].first,I_Extras[Index].second);
+   }
+   printf (" status=%s\n",Error ? "error" : "ok");
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      P a g e  F a u l t s
+
+inline void BenchHarness::PageFaults (long* Minor, long* Major)
+{
+   *Minor = *Major = -1;
+#ifdef BENCH_HAVE_RUSAGE
+   struct rusage Usage;
+   if (getrusage(RUSAGE_SELF,&Usage) == 0) {
+      *Minor = long(Usage.ru_minflt);
+      *Major = long(Usage.ru_majflt);
+   }
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           T i c k s
+
+inline unsigned long long BenchHarness::Ticks (void)
+{
+#ifdef BENCH_HAVE_TSC
+   return (unsigned long long) __rdtsc();
+#else
+   return 0;
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     T u r b o  S t a t e
+//
+//  TurboState() looks at the two places Linux reports whether turbo boost is enabled: the
+//  intel_pstate driver's no_turbo flag, and the generic cpufreq boost flag. On other
+//  systems, or if neither is available (in a virtual machine, say), it returns -1.
+
+inline int BenchHarness::TurboState (void)
+{
+   long NoTurbo = ReadNumber("/sys/devices/system/cpu/intel_pstate/no_turbo");
+   if (NoTurbo >= 0) return NoTurbo ? 0 : 1;
+   long Boost = ReadNumber("/sys/devices/system/cpu/cpufreq/boost");
+   if (Boost >= 0) return Boost ? 1 : 0;
+   return -1;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     C u r r e n t  K H z
+
+inline long BenchHarness::CurrentKHz (void)
+{
+   return ReadNumber("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R e a d  N u m b e r
+
+inline long BenchHarness::ReadNumber (const char* FileName)
+{
+   long Value = -1;
+   FILE* File = fopen(FileName,"r");
+   if (File) {
+      if (fscanf(File,"%ld",&Value) != 1) Value = -1;
+      fclose(File);
+   }
+   return Value;
+}
+
+#endif
@@ -0,0 +1,355 @@
+//
+//                   C o n c u r r e n t  A r r a y  M a n a g e r . c p p
+//
+//  Function:
+//     A version of ArrayManager that can safely be used by many threads at once.
+//
+//  Description:
+//     See the .h file for a description of ConcurrentArrayManager from a user's perspective.
+//     This file provides the implementation, most of which simply finds the right shard,
+//     locks it, and passes the call on to that shard's ArrayManager.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added the usage counts.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+
+#include "ConcurrentArrayManager.h"
+
+//  Each thread is given a slot number the first time it uses any ConcurrentArrayManager, and
+//  uses the shard with that number (modulo the number of shards) in every manager. Handing out
+//  the numbers in turn spreads the threads evenly over the shards.
+
+static std::atomic<int> NextThreadSlot(0);
+static thread_local int ThreadSlot = -1;
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+//
+//  The constructor creates the shards - one for each CPU if NShards is zero - and, unless
+//  told otherwise, gives each its own arena. ChunkBytes is passed on to UseArena(), where zero
+//  means the arena's default chunk size.
+
+ConcurrentArrayManager::ConcurrentArrayManager (int NShards, bool UseArenas, size_t ChunkBytes)
+{
+   if (NShards <= 0) NShards = int(std::thread::hardware_concurrency());
+   if (NShards <= 0) NShards = 1;
+   I_NShards = NShards;
+   I_Shards.reset(new Shard[NShards]);
+   if (UseArenas) {
+      for (int Index = 0; Index < NShards; Index++) {
+         I_Shards[Index].Manager.UseArena(ChunkBytes);
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+//
+//  Each shard's ArrayManager releases its own arrays, and its arena, as it is deleted.
+
+ConcurrentArrayManager::~ConcurrentArrayManager ()
+{
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     L o c a l  S h a r d
+
+ConcurrentArrayManager::Shard& ConcurrentArrayManager::LocalShard (void)
+{
+   if (ThreadSlot < 0) ThreadSlot = NextThreadSlot++ & 0x7fffffff;
+   return I_Shards[ThreadSlot % I_NShards];
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    O w n i n g  S h a r d
+//
+//  OwningShard() gets the manager that allocated an array from the array's header, and works
+//  out which of the shards - which are all in the one block - that manager belongs to. If it
+//  doesn't belong to any of them, the array wasn't allocated here. Reading the header without
+//  holding a lock is safe, since the only fields of a live array's header that ever change are
+//  the links in its manager's chain, and Owner() doesn't look at those.
+
+ConcurrentArrayManager::Shard* ConcurrentArrayManager::OwningShard (void* Address)
+{
+   Shard* Owning = NULL;
+   ArrayManager* Manager = ArrayManager::Owner(Address);
+   if (Manager) {
+      uintptr_t First = uintptr_t(&I_Shards[0].Manager);
+      uintptr_t Offset = uintptr_t(Manager) - First;
+      if (uintptr_t(Manager) >= First && Offset / sizeof(Shard) < size_t(I_NShards)) {
+         Shard* Candidate = &I_Shards[Offset / sizeof(Shard)];
+         if (&Candidate->Manager == Manager) Owning = Candidate;
+      }
+   }
+   return Owning;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        M a l l o c  n D
+//
+//  All the allocation routines use the calling thread's own shard.
+
+void* ConcurrentArrayManager::Malloc4D (
+   unsigned int BytesPerElement,long Nt,long Nz,long Ny,long Nx)
+{
+   Shard& Local = LocalShard();
+   std::lock_guard<std::mutex> Lock(Local.Mutex);
+   return Local.Manager.Malloc4D(BytesPerElement,Nt,Nz,Ny,Nx);
+}
+
+void* ConcurrentArrayManager::Malloc3D (unsigned int BytesPerElement,long Nz,long Ny,long Nx)
+{
+   Shard& Local = LocalShard();
+   std::lock_guard<std::mutex> Lock(Local.Mutex);
+   return Local.Manager.Malloc3D(BytesPerElement,Nz,Ny,Nx);
+}
+
+void* ConcurrentArrayManager::Malloc2D (unsigned int BytesPerElement,long Ny,long Nx)
+{
+   Shard& Local = LocalShard();
+   std::lock_guard<std::mutex> Lock(Local.Mutex);
+   return Local.Manager.Malloc2D(BytesPerElement,Ny,Nx);
+}
+
+void* ConcurrentArrayManager::Malloc1D (unsigned int BytesPerElement,long Nx)
+{
+   Shard& Local = LocalShard();
+   std::lock_guard<std::mutex> Lock(Local.Mutex);
+   return Local.Manager.Malloc1D(BytesPerElement,Nx);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            F r e e
+//
+//  Free() goes to the shard that allocated the array, which need not be the calling thread's.
+//  As with ArrayManager::Free(), an address that isn't one of ours is quietly ignored.
+
+void ConcurrentArrayManager::Free (void* Address)
+{
+   Shard* Owning = OwningShard(Address);
+   if (Owning) {
+      std::lock_guard<std::mutex> Lock(Owning->Mutex);
+      Owning->Manager.Free(Address);
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        E n q u i r i e s
+//
+//  BaseArray(), GetDimensions() and GetPitch() only read the array's header, but take the
+//  shard's lock anyway, so they see a consistent header even if the array is being freed by
+//  another thread - although a program that does that has a bug of its own. Each returns
+//  what the ArrayManager routine does for an address it doesn't know.
+
+void* ConcurrentArrayManager::BaseArray (void* Address)
+{
+   void* Base = NULL;
+   Shard* Owning = OwningShard(Address);
+   if (Owning) {
+      std::lock_guard<std::mutex> Lock(Owning->Mutex);
+      Base = Owning->Manager.BaseArray(Address);
+   }
+   return Base;
+}
+
+void ConcurrentArrayManager::GetDimensions (
+   void* Address, int MaxDims, int* NDims, long Dims[])
+{
+   Shard* Owning = OwningShard(Address);
+   if (Owning) {
+      std::lock_guard<std::mutex> Lock(Owning->Mutex);
+      Owning->Manager.GetDimensions(Address,MaxDims,NDims,Dims);
+   } else {
+      for (int IDim = 0; IDim < MaxDims; IDim++) {
+         Dims[IDim] = 0;
+      }
+      *NDims = 0;
+   }
+}
+
+long ConcurrentArrayManager::GetPitch (void* Address)
+{
+   long Pitch = 0;
+   Shard* Owning = OwningShard(Address);
+   if (Owning) {
+      std::lock_guard<std::mutex> Lock(Owning->Mutex);
+      Pitch = Owning->Manager.GetPitch(Address);
+   }
+   return Pitch;
+}
+
+bool ConcurrentArrayManager::Owns (void* Address)
+{
+   return OwningShard(Address) != NULL;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 A l l  t h e  S h a r d s
+//
+//  These apply to every shard. Each shard is locked in turn, never more than one at a time.
+
+void ConcurrentArrayManager::SetAlignment (
+   unsigned int AlignBytes, bool PadRows, bool AvoidAliasing)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.SetAlignment(AlignBytes,PadRows,AvoidAliasing);
+   }
+}
+
+void ConcurrentArrayManager::SetSingleBlock (bool SingleBlock)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.SetSingleBlock(SingleBlock);
+   }
+}
+
+void ConcurrentArrayManager::Reset (void)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.Reset();
+   }
+}
+
+void ConcurrentArrayManager::List (void (*ListRoutine)(const char* String))
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.List(ListRoutine);
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     U s a g e  T a g s
+
+void ConcurrentArrayManager::SetTag (int Tag)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.SetTag(Tag);
+   }
+}
+
+void ConcurrentArrayManager::SetThreadTag (int Tag)
+{
+   Shard& Local = LocalShard();
+   std::lock_guard<std::mutex> Lock(Local.Mutex);
+   Local.Manager.SetTag(Tag);
+}
+
+void ConcurrentArrayManager::NameTag (int Tag, const char* Name)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.NameTag(Tag,Name);
+   }
+}
+
+void ConcurrentArrayManager::ResetUsage (void)
+{
+   for (int Index = 0; Index < I_NShards; Index++) {
+      std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+      I_Shards[Index].Manager.ResetUsage();
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        G e t  U s a g e
+//
+//  GetUsage() adds up the counts from each shard, locking each in turn, so the total is not
+//  a snapshot of a single instant if other threads are allocating at the time. The peaks are
+//  added up too (see the .h file), and the time is the longest any shard has been counting.
+
+void ConcurrentArrayManager::GetUsage (ArrayUsage* Usage, int Tag)
+{
+   ArrayUsage Total = ArrayUsage();
+   for (int Index = 0; Index < I_NShards; Index++) {
+      ArrayUsage Counts;
+      {
+         std::lock_guard<std::mutex> Lock(I_Shards[Index].Mutex);
+         I_Shards[Index].Manager.GetUsage(&Counts,Tag);
+      }
+      Total.LiveBytes += Counts.LiveBytes;
+      Total.LiveDataBytes += Counts.LiveDataBytes;
+      Total.PeakBytes += Counts.PeakBytes;
+      Total.MappedBytes += Counts.MappedBytes;
+      Total.LiveArrays += Counts.LiveArrays;
+      Total.PeakArrays += Counts.PeakArrays;
+      Total.Allocations += Counts.Allocations;
+      Total.Frees += Counts.Frees;
+      Total.AllocatedBytes += Counts.AllocatedBytes;
+      if (Counts.Seconds > Total.Seconds) Total.Seconds = Counts.Seconds;
+   }
+   *Usage = Total;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R e p o r t  U s a g e
+//
+//  ReportUsage() outputs the same lines as ArrayManager::ReportUsage(), but with the counts
+//  added up over all the shards. The tag names are taken from the first shard, since
+//  NameTag() names the tags in all of them.
+
+void ConcurrentArrayManager::ReportUsage (void (*ReportRoutine)(const char* String))
+{
+   char Line[512];
+   for (int Tag = -1; Tag < ArrayManager::MaxTags; Tag++) {
+      ArrayUsage Usage;
+      GetUsage(&Usage,Tag);
+      if (Tag >= 0 && Usage.Allocations == 0 && Usage.PeakArrays == 0) continue;
+      char Number[16];
+      const char* Name = "all";
+      if (Tag >= 0) {
+         {
+            std::lock_guard<std::mutex> Lock(I_Shards[0].Mutex);
+            Name = I_Shards[0].Manager.TagName(Tag);
+         }
+         if (Name == NULL) {
+            snprintf(Number,sizeof(Number),"%d",Tag);
+            Name = Number;
+         }
+      }
+      ArrayManager::FormatUsage(Usage,Name,Line,sizeof(Line));
+      if (ReportRoutine) {
+         (*ReportRoutine)(Line);
+      } else {
+         printf("%s\n",Line);
+      }
+   }
+}
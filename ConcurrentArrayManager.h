@@ -0,0 +1,160 @@
+//
+//                     C o n c u r r e n t  A r r a y  M a n a g e r . h
+//
+//  Function:
+//     A version of ArrayManager that can safely be used by many threads at once.
+//
+//  Description:
+//     An ArrayManager is not thread-safe. Its Malloc() routines and Free() add arrays to and
+//     remove them from a chain that has no locking of any kind, so a program in which several
+//     threads allocate work arrays has had to protect one shared manager with a mutex of its
+//     own - and once a few tens of threads are each allocating a scratch tile or two for every
+//     piece of work they do, that one lock is where they spend their time waiting.
+//
+//     A ConcurrentArrayManager provides the same Malloc<n>D(), Free(), BaseArray(),
+//     GetDimensions() and GetPitch() calls as an ArrayManager, and these can be called from any
+//     number of threads at once. Internally it holds a number of ordinary ArrayManagers, called
+//     shards, each with its own mutex, and each thread is (permanently) assigned one of the
+//     shards the first time it uses any ConcurrentArrayManager. All the allocations a thread
+//     makes come from its own shard, so provided there are at least as many shards as threads
+//     - by default there is one for each CPU - a thread taking its shard's lock almost never
+//     finds it held, and an uncontended lock costs little more than one atomic operation.
+//
+//     By default each shard also has its own arena (see ArrayManager::UseArena()), which acts
+//     as a per-thread cache of memory. An array that is freed goes back onto the free list of
+//     the arena it came from, and the next array of the same size allocated by that thread
+//     gets the same memory back, without any call to malloc() and so without touching the
+//     heap's own locks. The arenas only return their memory to the system when the
+//     ConcurrentArrayManager is deleted, which is the usual trade-off for an arena, and the
+//     constructor can be told not to use them, in which case every shard uses malloc().
+//
+//     An array may be freed by a thread other than the one that allocated it - a tile handed
+//     from one stage of a pipeline to the next, for example. The header every array has in
+//     front of it (see ArrayManager.h) records which manager allocated it, so Free() goes
+//     straight to the right shard, and takes that shard's lock. This does contend with the
+//     thread that owns the shard, but only for the length of time it takes to unlink one
+//     array. None of the calls ever needs to search for an array, or to lock more than one
+//     shard.
+//
+//     Anything that affects all the arrays - SetAlignment(), SetSingleBlock(), Reset() and
+//     List() - works through all the shards in turn. The first two should be called before
+//     the threads start allocating arrays, and Reset() only when no thread is using any of the
+//     arrays, since it releases them all. A ConcurrentArrayManager must not be deleted while
+//     any other thread might still be calling it.
+//
+//     The memory usage counts (see ArrayManager::GetUsage()) are kept by each shard, and
+//     GetUsage() adds them up. The live counts and the totals are exact, but each shard
+//     reaches its own peak at its own time, so the peak it reports is the sum of the shards'
+//     peaks, which is an upper limit on the real peak rather than the peak itself. SetTag()
+//     sets the tag for all the shards; SetThreadTag() just for the calling thread's shard, so
+//     that each stage of a pipeline, running in its own thread, can count its own arrays -
+//     provided there are enough shards for the stages not to share one.
+//
+//     Like ThreadPool, this uses the C++11 thread library, so needs to be compiled with C++11
+//     or later (and, with gcc, linked with -pthread). ArrayManager itself is unchanged, and
+//     still compiles as C++98.
+//
+//     cconcmain.cpp is a stress test that has a number of threads allocate, pass between
+//     them, and free arrays as fast as they can, using a ConcurrentArrayManager and, for
+//     comparison, a single ArrayManager protected by one mutex.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Added SetTag(), SetThreadTag(), NameTag(), GetUsage(), ResetUsage() and
+//                    ReportUsage().
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __ConcurrentArrayManager__
+#define __ConcurrentArrayManager__
+
+#include <stddef.h>
+
+#include <memory>
+#include <mutex>
+
+#include "ArrayManager.h"
+
+class ConcurrentArrayManager {
+public:
+   //!  Constructor. NShards of zero means one shard for each CPU.
+   ConcurrentArrayManager (int NShards = 0, bool UseArenas = true, size_t ChunkBytes = 0);
+   //!  Destructor. Releases all the arrays still allocated.
+   ~ConcurrentArrayManager ();
+   //!  Allocate a 4D array - as for ArrayManager, but callable from any thread.
+   void* Malloc4D (unsigned int BytesPerElement,long Nt,long Nz,long Ny,long Nx);
+   //!  Allocate a 3D array.
+   void* Malloc3D (unsigned int BytesPerElement,long Nz,long Ny,long Nx);
+   //!  Allocate a 2D array.
+   void* Malloc2D (unsigned int BytesPerElement,long Ny,long Nx);
+   //!  Allocate a 1D array.
+   void* Malloc1D (unsigned int BytesPerElement,long Nx);
+   //!  Release an allocated array, from whichever thread allocated it.
+   void Free (void* Address);
+   //!  Get the base address of the data in an array.
+   void* BaseArray (void* Address);
+   //!  Get the dimensions of an array.
+   void GetDimensions (void* Address, int MaxDims, int* NDims, long Dims[]);
+   //!  Get the number of elements from the start of one row of an array to the next.
+   long GetPitch (void* Address);
+   //!  Set the alignment for subsequently allocated arrays, in all the shards.
+   void SetAlignment (unsigned int AlignBytes, bool PadRows = false, bool AvoidAliasing = false);
+   //!  Control single block allocation of subsequent arrays, in all the shards.
+   void SetSingleBlock (bool SingleBlock);
+   //!  Release every array, in all the shards.
+   void Reset (void);
+   //!  List the allocated arrays, shard by shard.
+   void List (void (*ListRoutine)(const char* String) = NULL);
+   //!  Set the usage tag for subsequently allocated arrays, in all the shards.
+   void SetTag (int Tag);
+   //!  Set the usage tag for arrays subsequently allocated by the calling thread's shard.
+   void SetThreadTag (int Tag);
+   //!  Give a usage tag a name, in all the shards.
+   void NameTag (int Tag, const char* Name);
+   //!  Get the usage counts, summed over the shards, for all arrays or for one tag.
+   void GetUsage (ArrayUsage* Usage, int Tag = -1);
+   //!  Restart the usage counts, in all the shards.
+   void ResetUsage (void);
+   //!  Report the usage counts, summed over the shards, one line per tag used.
+   void ReportUsage (void (*ReportRoutine)(const char* String) = NULL);
+   //!  True if the array was allocated by this manager.
+   bool Owns (void* Address);
+   //!  The number of shards.
+   int Shards (void) const { return I_NShards; }
+private:
+   //!  One shard - an ArrayManager and the mutex that protects it, padded to keep the
+   //!  mutexes for different shards in different cache lines.
+   struct Shard {
+      std::mutex Mutex;
+      ArrayManager Manager;
+      char Pad[64];
+   };
+   //!  The shard used by the calling thread.
+   Shard& LocalShard (void);
+   //!  The shard that allocated an array, or NULL if it wasn't allocated by this manager.
+   Shard* OwningShard (void* Address);
+   //!  The number of shards.
+   int I_NShards;
+   //!  The shards themselves.
+   std::unique_ptr<Shard[]> I_Shards;
+   //!  A manager can't be copied.
+   ConcurrentArrayManager (const ConcurrentArrayManager&) = delete;
+   ConcurrentArrayManager& operator= (const ConcurrentArrayManager&) = delete;
+};
+
+#endif
@@ -0,0 +1,248 @@
+//
+//                             E l e m e n t  T y p e s . h
+//
+//  Function:
+//     Half-precision floating point types, and traits for the element types of the tests.
+//
+//  Description:
+//     All the C++ test programs in this study use arrays of float, although ArrayManager
+//     itself doesn't care what the elements are - it only needs to know how many bytes each
+//     takes. Raw detector data is usually 16-bit integers, and intermediate results can often
+//     be held to enough precision in a 16-bit floating point format. With elements half the
+//     size, the arrays take half the memory bandwidth, and for a simple operation like the
+//     one being tested - which on large arrays is limited by memory bandwidth, not by
+//     arithmetic - that can nearly double the speed, even though each element has to be
+//     converted to a wider type to work on it and back again to store it.
+//
+//     C++ has no standard 16-bit floating point types (before C++23), so this file provides
+//     two small ones:
+//
+//     Half      IEEE 754 binary16 - 1 sign bit, 5 exponent bits and 10 fraction bits. It
+//               holds integers exactly up to 2048, and values up to 65504.
+//     BFloat16  The 'brain float' format - the top 16 bits of a float, so 1 sign bit, 8
+//               exponent bits and 7 fraction bits. It has the same range as a float, but
+//               only holds integers exactly up to 256.
+//
+//     Each just holds its 16 bits, and converts to and from float. The conversions round to
+//     the nearest value (ties to even), handle infinities, NaNs and subnormal values, and are
+//     coded as simple integer operations with no table lookups, so a compiler can vectorise
+//     a loop that uses them. (Many CPUs have instructions that do these conversions - F16C on
+//     x86, for example - but using them means compiling for a particular CPU. The results are
+//     exactly the same either way.) No arithmetic is defined on the types themselves: the
+//     idea is always to convert to float, work in float, and convert back.
+//
+//     ElementTraits<T> describes each of the element types the tests use - int16_t, uint16_t,
+//     int32_t, Half, BFloat16, float and double. Wide is the type an element is converted to
+//     for arithmetic (int32_t for the integer types, float for the 16-bit floating point
+//     types), ToWide() and FromWide() do the conversions, Name() is a short name for the
+//     type, MaxValue is the largest value the type can hold (near enough, for the larger
+//     floating point types), and Tolerance is the largest relative error that rounding a
+//     result to the type can introduce - zero for the integer types. The test programs use
+//     these to set up the arrays and check the results, whatever the type.
+//
+//     This needs C++11, for the fixed-size integer types.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __ElementTypes__
+#define __ElementTypes__
+
+#include <stdint.h>
+#include <string.h>
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    B i t  C o p i e s
+//
+//  Moving bits between a float and an integer has to be done with memcpy() to be legal C++.
+//  Compilers turn this into a simple register move.
+
+inline uint32_t FloatBits (float Value)
+{
+   uint32_t Bits;
+   memcpy (&Bits,&Value,sizeof(Bits));
+   return Bits;
+}
+
+inline float BitsFloat (uint32_t Bits)
+{
+   float Value;
+   memcpy (&Value,&Bits,sizeof(Value));
+   return Value;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            H a l f
+//
+//  The conversion from float rounds the fraction to 10 bits by adding just under half of the
+//  unit being dropped, plus the lowest bit being kept (which makes ties go to even). Values
+//  too small to be normal half values are rounded by adding a float with an exponent chosen
+//  so the addition itself lines the bits up and rounds them. The conversion to float moves
+//  the exponent and fraction into place, adjusting the exponent bias, and makes subnormal
+//  half values normal by subtracting the same sort of magic number. Both work out the result
+//  for every case and then select the right one, rather than branching, since a loop with
+//  branches in it is much harder for a compiler to vectorise.
+
+class Half {
+public:
+   //!  Constructor for a zero value.
+   Half (void) : I_Bits(0) {}
+   //!  Constructor from a float, rounding to the nearest half value.
+   Half (float Value) : I_Bits(FromFloat(Value)) {}
+   //!  Conversion to float, which is always exact.
+   operator float (void) const { return ToFloat(I_Bits); }
+   //!  The 16 bits of the value.
+   uint16_t Bits (void) const { return I_Bits; }
+   //!  Convert a float to the bits of the nearest half value.
+   static uint16_t FromFloat (float Value) {
+      const uint32_t Magic = ((127 - 15) + (23 - 10) + 1) << 23;
+      uint32_t Bits = FloatBits(Value);
+      uint32_t Sign = Bits & 0x80000000u;
+      Bits ^= Sign;
+      uint32_t Special = (Bits > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+      uint32_t Small = FloatBits(BitsFloat(Bits) + BitsFloat(Magic)) - Magic;
+      uint32_t Normal = (Bits + ((15u - 127u) << 23) + 0xfffu + ((Bits >> 13) & 1u)) >> 13;
+      uint32_t Result = (Bits >= 0x47800000u) ? Special : ((Bits < 0x38800000u) ? Small : Normal);
+      return uint16_t(Result | (Sign >> 16));
+   }
+   //!  Convert the bits of a half value to a float.
+   static float ToFloat (uint16_t HalfBits) {
+      const uint32_t ShiftedExp = 0x7c00u << 13;
+      uint32_t Bits = (uint32_t(HalfBits) & 0x7fffu) << 13;
+      uint32_t Exp = Bits & ShiftedExp;
+      Bits += (127u - 15u) << 23;
+      uint32_t Special = Bits + ((128u - 16u) << 23);
+      uint32_t Small = FloatBits(BitsFloat(Bits + (1u << 23)) - BitsFloat(113u << 23));
+      Bits = (Exp == ShiftedExp) ? Special : ((Exp == 0) ? Small : Bits);
+      return BitsFloat(Bits | ((uint32_t(HalfBits) & 0x8000u) << 16));
+   }
+private:
+   //!  The IEEE binary16 bits.
+   uint16_t I_Bits;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       B F l o a t  1 6
+//
+//  A bfloat16 is the top half of a float, so the conversion to float is just a shift, and the
+//  conversion from float rounds away the bottom 16 bits (ties to even), taking care that a NaN
+//  stays a NaN rather than rounding to an infinity.
+
+class BFloat16 {
+public:
+   //!  Constructor for a zero value.
+   BFloat16 (void) : I_Bits(0) {}
+   //!  Constructor from a float, rounding to the nearest bfloat16 value.
+   BFloat16 (float Value) : I_Bits(FromFloat(Value)) {}
+   //!  Conversion to float, which is always exact.
+   operator float (void) const { return ToFloat(I_Bits); }
+   //!  The 16 bits of the value.
+   uint16_t Bits (void) const { return I_Bits; }
+   //!  Convert a float to the bits of the nearest bfloat16 value.
+   static uint16_t FromFloat (float Value) {
+      uint32_t Bits = FloatBits(Value);
+      uint32_t Rounded = (Bits + 0x7fffu + ((Bits >> 16) & 1u)) >> 16;
+      uint32_t Quiet = (Bits >> 16) | 0x0040u;
+      return uint16_t(((Bits & 0x7fffffffu) > 0x7f800000u) ? Quiet : Rounded);
+   }
+   //!  Convert the bits of a bfloat16 value to a float.
+   static float ToFloat (uint16_t Bits16) { return BitsFloat(uint32_t(Bits16) << 16); }
+private:
+   //!  The top 16 bits of the float.
+   uint16_t I_Bits;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  E l e m e n t  T r a i t s
+
+template <typename T> struct ElementTraits;
+
+template <> struct ElementTraits<int16_t> {
+   typedef int32_t Wide;
+   static Wide ToWide (int16_t Value) { return Wide(Value); }
+   static int16_t FromWide (Wide Value) { return int16_t(Value); }
+   static const char* Name (void) { return "int16"; }
+   static double MaxValue (void) { return 32767.0; }
+   static double Tolerance (void) { return 0.0; }
+};
+
+template <> struct ElementTraits<uint16_t> {
+   typedef int32_t Wide;
+   static Wide ToWide (uint16_t Value) { return Wide(Value); }
+   static uint16_t FromWide (Wide Value) { return uint16_t(Value); }
+   static const char* Name (void) { return "uint16"; }
+   static double MaxValue (void) { return 65535.0; }
+   static double Tolerance (void) { return 0.0; }
+};
+
+template <> struct ElementTraits<int32_t> {
+   typedef int32_t Wide;
+   static Wide ToWide (int32_t Value) { return Value; }
+   static int32_t FromWide (Wide Value) { return Value; }
+   static const char* Name (void) { return "int32"; }
+   static double MaxValue (void) { return 2147483647.0; }
+   static double Tolerance (void) { return 0.0; }
+};
+
+template <> struct ElementTraits<Half> {
+   typedef float Wide;
+   static Wide ToWide (Half Value) { return float(Value); }
+   static Half FromWide (Wide Value) { return Half(Value); }
+   static const char* Name (void) { return "fp16"; }
+   static double MaxValue (void) { return 65504.0; }
+   static double Tolerance (void) { return 1.0 / 2048.0; }
+};
+
+template <> struct ElementTraits<BFloat16> {
+   typedef float Wide;
+   static Wide ToWide (BFloat16 Value) { return float(Value); }
+   static BFloat16 FromWide (Wide Value) { return BFloat16(Value); }
+   static const char* Name (void) { return "bf16"; }
+   static double MaxValue (void) { return 3.0e38; }
+   static double Tolerance (void) { return 1.0 / 256.0; }
+};
+
+template <> struct ElementTraits<float> {
+   typedef float Wide;
+   static Wide ToWide (float Value) { return Value; }
+   static float FromWide (Wide Value) { return Value; }
+   static const char* Name (void) { return "float"; }
+   static double MaxValue (void) { return 3.0e38; }
+   static double Tolerance (void) { return 1.0 / 16777216.0; }
+};
+
+template <> struct ElementTraits<double> {
+   typedef double Wide;
+   static Wide ToWide (double Value) { return Value; }
+   static double FromWide (Wide Value) { return Value; }
+   static const char* Name (void) { return "double"; }
+   static double MaxValue (void) { return 1.0e308; }
+   static double Tolerance (void) { return 1.0 / 9007199254740992.0; }
+};
+
+#endif
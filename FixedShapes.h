@@ -0,0 +1,84 @@
+//
+//                              F i x e d  S h a p e s . h
+//
+//  Function:
+//     The registry of frame shapes for which compile-time specialised kernels are built.
+//
+//  Description:
+//     cmain.cpp points out that the ideal case for C++ is a static array, float In[NY][NX],
+//     where NX and NY are constants - the compiler then knows the exact trip counts of both
+//     loops, and can vectorise a row with no remainder loop, unroll as much as it likes, and
+//     compute every address from constants - and that the study gives that up so that the
+//     sizes can come from the command line. But a real instrument only has a few detector
+//     geometries, and they are known when the program is built. This file lists them, so
+//     that a subroutine can be compiled once for each, as a template instantiated with the
+//     dimensions as constants, and pick the right one when it is called, falling back to
+//     ordinary code for any shape not in the list. cfixedsub.cpp does this for the operation
+//     used by this study.
+//
+//     The list uses the 'X macro' technique, so that the one list can produce both the code
+//     that calls each specialisation and anything else that needs to know the shapes.
+//     FIXED_SHAPES(SHAPE) expands to SHAPE(Nx,Ny) for each shape in turn, so the code using
+//     it defines SHAPE to do whatever is wanted with each shape, for example:
+//
+//     #define DISPATCH(NX,NY) if (Nx == NX && Ny == NY) return Fixed<NX,NY>(In,Out);
+//     FIXED_SHAPES(DISPATCH)
+//     #undef DISPATCH
+//
+//     A program can use its own list by defining FIXED_SHAPES before this file is included
+//     (or in a file named by FIXED_SHAPES_FILE, which this includes if it is defined). Each
+//     shape adds a specialised copy of the code, so the list should be kept to the shapes
+//     actually used. The default list includes the default size used by Run.py, and the
+//     sizes used by its bigger tests. IsFixedShape() says if a shape is in the list.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __FixedShapes__
+#define __FixedShapes__
+
+#ifdef FIXED_SHAPES_FILE
+#include FIXED_SHAPES_FILE
+#endif
+
+#ifndef FIXED_SHAPES
+#define FIXED_SHAPES(SHAPE) \
+   SHAPE(2000,10)           \
+   SHAPE(1000,1000)         \
+   SHAPE(2000,2000)         \
+   SHAPE(2048,2048)         \
+   SHAPE(4096,4096)
+#endif
+
+//  IsFixedShape() returns true if there is a specialisation for a frame shape.
+
+inline bool IsFixedShape (long Nx, long Ny)
+{
+#define FIXED_SHAPE_MATCH(NX,NY) if (Nx == NX && Ny == NY) return true;
+   FIXED_SHAPES(FIXED_SHAPE_MATCH)
+#undef FIXED_SHAPE_MATCH
+   return false;
+}
+
+#endif
@@ -0,0 +1,400 @@
+//
+//                           F r a m e  P i p e l i n e . c p p
+//
+//  Function:
+//     Double-buffered asynchronous reading and writing of frames for the test subroutines.
+//
+//  Description:
+//     See the .h file for a description of the FramePipeline from a user's perspective. This
+//     file provides the implementation. Everything the three threads share is a set of four
+//     counters - frames handed to the caller, released by the caller, read and written - all
+//     counted from the start of the run, together with a failure flag, protected by one mutex
+//     and with one condition variable signalled whenever any of them changes. Frame N always
+//     uses buffer N % NBuffers. The reader may read frame N once frame N - NBuffers has been
+//     released, the writer may write frame N once it has been released, and the caller may
+//     have frame N once it has been read and frame N - NBuffers has been written (since that
+//     was the last frame to use the same output buffer). The I/O itself is done without the
+//     lock held.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#include "FramePipeline.h"
+
+//  Frames in the files, and the buffers, are aligned to this boundary, which satisfies the
+//  O_DIRECT requirements of any file system in common use.
+
+static const long IoAlignment = 4096;
+
+//  The time in seconds since an arbitrary start.
+
+static double Now (void)
+{
+   return std::chrono::duration<double>(
+                               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+//
+//  The buffers are allocated as single-block arrays aligned to IoAlignment, with enough
+//  extra rows for a whole number of IoAlignment blocks to fit, since an O_DIRECT transfer has
+//  to be a multiple of the block size as well as aligned. The rows aren't padded, so the
+//  frame is contiguous and the extra rows simply follow it. In Overlapped mode the reader
+//  starts filling the input buffers straight away.
+
+FramePipeline::FramePipeline (const char* InFile, const char* OutFile, long Nx, long Ny,
+                                                     Mode How, int NBuffers, bool Direct) :
+   I_Nx(Nx), I_Ny(Ny), I_FrameBytes(Nx * Ny * long(sizeof(float))),
+   I_Stride(FrameStride(Nx,Ny)), I_InFd(-1), I_OutFd(-1), I_FileFrames(0),
+   I_Mode(How), I_Direct(Direct), I_NBuffers(NBuffers < 1 ? 1 : NBuffers),
+   I_Current(0), I_Released(0), I_Read(0), I_Written(0), I_Failed(false), I_Stop(false),
+   I_IoSecs(0.0), I_WaitSecs(0.0)
+{
+   if (Nx <= 0 || Ny <= 0) {
+      Fail("Invalid frame dimensions");
+      return;
+   }
+#ifndef O_DIRECT
+   I_Direct = false;
+#endif
+   I_InFd = OpenFile(InFile,O_RDONLY);
+   if (I_InFd < 0) return;
+   I_OutFd = OpenFile(OutFile,O_WRONLY | O_CREAT | O_TRUNC);
+   if (I_OutFd < 0) return;
+   struct stat Status;
+   if (fstat(I_InFd,&Status) == 0) I_FileFrames = long(Status.st_size) / I_Stride;
+   if (I_FileFrames <= 0) {
+      Fail("Input file doesn't contain a whole frame");
+      return;
+   }
+   
+   long RowBytes = Nx * long(sizeof(float));
+   long Rows = Ny + (I_Stride - I_FrameBytes + RowBytes - 1) / RowBytes;
+   I_Manager.SetAlignment(IoAlignment);
+   I_Manager.SetSingleBlock(true);
+   for (int Index = 0; Index < I_NBuffers; Index++) {
+      float** In = (float**) I_Manager.Malloc2D(sizeof(float),Rows,Nx);
+      float** Out = (float**) I_Manager.Malloc2D(sizeof(float),Rows,Nx);
+      if (In == NULL || Out == NULL) {
+         Fail("Unable to allocate frame buffers");
+         return;
+      }
+      memset(I_Manager.BaseArray(Out),0,size_t(Rows * RowBytes));
+      I_InBuffers.push_back(In);
+      I_OutBuffers.push_back(Out);
+   }
+   
+   if (I_Mode == Overlapped) {
+      I_Reader = std::thread([this] { ReaderLoop(); });
+      I_Writer = std::thread([this] { WriterLoop(); });
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+//
+//  The writer finishes any frames already released before it stops. The reader may be part
+//  way through reading a frame ahead, which is simply never used.
+
+FramePipeline::~FramePipeline ()
+{
+   {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_Stop = true;
+   }
+   I_Changed.notify_all();
+   if (I_Reader.joinable()) I_Reader.join();
+   if (I_Writer.joinable()) I_Writer.join();
+   if (I_InFd >= 0) close(I_InFd);
+   if (I_OutFd >= 0) close(I_OutFd);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       F r a m e  S t r i d e
+
+long FramePipeline::FrameStride (long Nx, long Ny)
+{
+   long Bytes = Nx * Ny * long(sizeof(float));
+   return ((Bytes + IoAlignment - 1) / IoAlignment) * IoAlignment;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         O p e n  F i l e
+//
+//  If O_DIRECT is wanted but the file system won't have it - open() fails with EINVAL - the
+//  file is opened without it, and the pipeline carries on that way for both files.
+
+int FramePipeline::OpenFile (const char* FileName, int Flags)
+{
+   int Fd = -1;
+#ifdef O_DIRECT
+   if (I_Direct) {
+      Fd = open(FileName,Flags | O_DIRECT,0644);
+      if (Fd < 0 && errno == EINVAL) I_Direct = false;
+   }
+#endif
+   if (Fd < 0 && !I_Direct) Fd = open(FileName,Flags,0644);
+   if (Fd < 0) {
+      std::string Message = std::string("Unable to open ") + FileName + ": " + strerror(errno);
+      Fail(Message.c_str());
+   }
+   return Fd;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         R e a d  F r a m e
+//
+//  Reads and writes go through the whole stride, not just the frame data, so the transfers
+//  are whole blocks, as O_DIRECT requires. pread() and pwrite() can transfer less than was
+//  asked for, so both loop until they're done.
+
+bool FramePipeline::ReadFrame (long Index)
+{
+   char* Buffer = (char*) I_Manager.BaseArray(I_InBuffers[Index % I_NBuffers]);
+   off_t Offset = off_t(Index % I_FileFrames) * off_t(I_Stride);
+   long Done = 0;
+   while (Done < I_FrameBytes) {
+      ssize_t Bytes = pread(I_InFd,Buffer + Done,size_t(I_Stride - Done),Offset + Done);
+      if (Bytes < 0 && errno == EINTR) continue;
+      if (Bytes <= 0) {
+         Fail(Bytes < 0 ? strerror(errno) : "Unexpected end of input file");
+         return false;
+      }
+      Done += long(Bytes);
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        W r i t e  F r a m e
+
+bool FramePipeline::WriteFrame (long Index)
+{
+   const char* Buffer = (const char*) I_Manager.BaseArray(I_OutBuffers[Index % I_NBuffers]);
+   off_t Offset = off_t(Index % I_FileFrames) * off_t(I_Stride);
+   long Done = 0;
+   while (Done < I_Stride) {
+      ssize_t Bytes = pwrite(I_OutFd,Buffer + Done,size_t(I_Stride - Done),Offset + Done);
+      if (Bytes < 0 && errno == EINTR) continue;
+      if (Bytes <= 0) {
+         Fail(Bytes < 0 ? strerror(errno) : "Unable to write output file");
+         return false;
+      }
+      Done += long(Bytes);
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           F a i l
+
+void FramePipeline::Fail (const char* What)
+{
+   {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      if (!I_Failed) I_Error = What;
+      I_Failed = true;
+   }
+   I_Changed.notify_all();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R e a d e r  L o o p
+
+void FramePipeline::ReaderLoop (void)
+{
+   for (long Index = 0; ; Index++) {
+      {
+         std::unique_lock<std::mutex> Lock(I_Mutex);
+         I_Changed.wait(Lock,[this,Index] {
+            return I_Stop || I_Failed || Index < I_Released + I_NBuffers; });
+         if (I_Stop || I_Failed) return;
+      }
+      double Start = Now();
+      if (!ReadFrame(Index)) return;
+      {
+         std::lock_guard<std::mutex> Lock(I_Mutex);
+         I_IoSecs += Now() - Start;
+         I_Read = Index + 1;
+      }
+      I_Changed.notify_all();
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      W r i t e r  L o o p
+
+void FramePipeline::WriterLoop (void)
+{
+   for (long Index = 0; ; Index++) {
+      {
+         std::unique_lock<std::mutex> Lock(I_Mutex);
+         I_Changed.wait(Lock,[this,Index] {
+            return I_Stop || I_Failed || Index < I_Released; });
+         if (I_Failed || Index >= I_Released) return;
+      }
+      double Start = Now();
+      if (!WriteFrame(Index)) return;
+      {
+         std::lock_guard<std::mutex> Lock(I_Mutex);
+         I_IoSecs += Now() - Start;
+         I_Written = Index + 1;
+      }
+      I_Changed.notify_all();
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            N e x t
+//
+//  In Serial mode, Next() does the read itself, and the time it takes counts both as I/O
+//  time and as time spent waiting.
+
+float** FramePipeline::Next (float*** Out)
+{
+   *Out = NULL;
+   long Index = I_Current;
+   double Start = Now();
+   if (I_Mode == Serial) {
+      if (!Ok() || !ReadFrame(Index)) return NULL;
+      double Secs = Now() - Start;
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_IoSecs += Secs;
+      I_WaitSecs += Secs;
+      I_Read = Index + 1;
+   } else {
+      std::unique_lock<std::mutex> Lock(I_Mutex);
+      I_Changed.wait(Lock,[this,Index] {
+         return I_Failed || (I_Read > Index && I_Written > Index - I_NBuffers); });
+      I_WaitSecs += Now() - Start;
+      if (I_Failed) return NULL;
+   }
+   *Out = I_OutBuffers[Index % I_NBuffers];
+   return I_InBuffers[Index % I_NBuffers];
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            D o n e
+
+void FramePipeline::Done (void)
+{
+   long Index = I_Current;
+   if (I_Mode == Serial) {
+      double Start = Now();
+      if (!Ok() || !WriteFrame(Index)) return;
+      double Secs = Now() - Start;
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_IoSecs += Secs;
+      I_WaitSecs += Secs;
+      I_Written = Index + 1;
+      I_Released = Index + 1;
+      I_Current = Index + 1;
+   } else {
+      {
+         std::lock_guard<std::mutex> Lock(I_Mutex);
+         I_Released = Index + 1;
+         I_Current = Index + 1;
+      }
+      I_Changed.notify_all();
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           F l u s h
+
+bool FramePipeline::Flush (void)
+{
+   double Start = Now();
+   std::unique_lock<std::mutex> Lock(I_Mutex);
+   I_Changed.wait(Lock,[this] { return I_Failed || I_Written >= I_Released; });
+   I_WaitSecs += Now() - Start;
+   return !I_Failed;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        O k  a n d  E r r o r
+
+bool FramePipeline::Ok (void)
+{
+   std::lock_guard<std::mutex> Lock(I_Mutex);
+   return !I_Failed;
+}
+
+std::string FramePipeline::Error (void)
+{
+   std::lock_guard<std::mutex> Lock(I_Mutex);
+   return I_Error;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          T i m i n g s
+
+double FramePipeline::IoSeconds (void)
+{
+   std::lock_guard<std::mutex> Lock(I_Mutex);
+   return I_IoSecs;
+}
+
+double FramePipeline::WaitSeconds (void)
+{
+   std::lock_guard<std::mutex> Lock(I_Mutex);
+   return I_WaitSecs;
+}
+
+double FramePipeline::HiddenFraction (void)
+{
+   std::lock_guard<std::mutex> Lock(I_Mutex);
+   if (I_IoSecs <= 0.0) return 0.0;
+   double Hidden = (I_IoSecs - I_WaitSecs) / I_IoSecs;
+   return (Hidden < 0.0) ? 0.0 : Hidden;
+}
@@ -0,0 +1,189 @@
+//
+//                             F r a m e  P i p e l i n e . h
+//
+//  Function:
+//     Double-buffered asynchronous reading and writing of frames for the test subroutines.
+//
+//  Description:
+//     The test programs fill their input array in memory and then call subr() over and over,
+//     which measures the subroutine and nothing else. In a real reduction pipeline, the frames
+//     come from a disk or over a network, and the results go back the same way, and if the
+//     program simply reads a frame, processes it, writes the result and then reads the next,
+//     the CPU sits idle during the I/O and the I/O system sits idle during the processing. A
+//     FramePipeline overlaps them: while the caller processes one frame, a reader thread is
+//     already reading the next one into a second buffer, and a writer thread is writing out
+//     the results of the previous one from a second output buffer. The caller just does:
+//
+//     FramePipeline Pipe ("in.dat","out.dat",Nx,Ny);
+//     float** Out;
+//     while (... more frames wanted ...) {
+//        float** In = Pipe.Next(&Out);
+//        if (In == NULL) break;
+//        subr (In,Nx,Ny,Out);
+//        Pipe.Done();
+//     }
+//     Pipe.Flush();
+//
+//     Next() waits until the next frame has been read (and until the output buffer it hands
+//     back has been written out, if it was in use for an earlier frame), and returns it as an
+//     ordinary row table of the sort the 'Numerical Recipes' subr() in cnrsub.cpp expects.
+//     Done() says the caller has finished with that frame; the writer thread then writes the
+//     output buffer out, and the reader thread can reuse the input buffer for a frame further
+//     ahead. By default there are two of each buffer - double buffering - but more can be
+//     used, letting the reader get further ahead, which helps when the time taken by the I/O
+//     varies from frame to frame. The buffers are allocated by an ArrayManager, so In and Out
+//     can be passed to anything that takes an ArrayManager array.
+//
+//     The files are raw frames of Ny rows of Nx floats, each frame starting on a 4096 byte
+//     boundary - FrameStride() gives the spacing - so that they can be read and written with
+//     O_DIRECT. The frames are read in order, starting again at the first when the end of
+//     the input file is reached, so any number of frames can be processed from a short file,
+//     and frame N of the output is written to the same place in the output file as frame N
+//     came from in the input. Frame() gives the number, in the files, of the current frame.
+//
+//     If Direct is true, the files are opened with O_DIRECT, so the data moves straight
+//     between the device and the buffers, bypassing the kernel's page cache. Without it,
+//     a file that has been read recently will come from the page cache, at memory speed,
+//     which rather defeats the purpose of the exercise. Not every file system supports
+//     O_DIRECT, and if the file can't be opened that way it is opened normally, and Direct()
+//     returns false. Serial mode does the reads and writes in the caller's thread, in Next()
+//     and Done(), one after the other, which is what the pipeline is there to improve on and
+//     makes a fair comparison, since everything else is the same.
+//
+//     The pipeline keeps track of the time the reader and writer spend in I/O, and the time
+//     the caller spends waiting in Next() and Flush(). In serial mode those are the same. In
+//     an overlapped pipeline, the difference between them is I/O time that was hidden behind
+//     the processing, and HiddenFraction() returns it as a fraction of the total I/O time.
+//
+//     The pipeline uses threads rather than Linux's io_uring or POSIX AIO, which would need
+//     either an extra library or, in aio's case, an implementation that is often just a
+//     thread pool anyway. With one request in flight in each direction, plain pread() and
+//     pwrite() calls in two threads keep a disk just as busy. Errors are reported by Next()
+//     returning NULL, or Flush() returning false, with a description from Error(). This uses
+//     the C++11 thread library, and O_DIRECT is Linux-specific (elsewhere Direct is ignored).
+//
+//     cpipemain.cpp is a test program that uses a FramePipeline to feed subr() with frames.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __FramePipeline__
+#define __FramePipeline__
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ArrayManager.h"
+
+class FramePipeline {
+public:
+   //!  The ways the I/O can be done.
+   enum Mode { Serial, Overlapped };
+   //!  Constructor. Opens the files, allocates the buffers and starts reading.
+   FramePipeline (const char* InFile, const char* OutFile, long Nx, long Ny,
+                          Mode How = Overlapped, int NBuffers = 2, bool Direct = false);
+   //!  Destructor. Writes out any frames still outstanding, and closes the files.
+   ~FramePipeline ();
+   //!  True if everything is working.
+   bool Ok (void);
+   //!  A description of the first error, or an empty string.
+   std::string Error (void);
+   //!  True if the files are being accessed using O_DIRECT.
+   bool Direct (void) const { return I_Direct; }
+   //!  The number of frames in the input file.
+   long FileFrames (void) const { return I_FileFrames; }
+   //!  Wait for the next frame, returning it and (in Out) the buffer for its results.
+   float** Next (float*** Out);
+   //!  The number, in the files, of the frame returned by the last call to Next().
+   long Frame (void) const { return I_FileFrames ? (I_Current % I_FileFrames) : 0; }
+   //!  Finish with the current frame, queuing its results to be written out.
+   void Done (void);
+   //!  Wait until all the results have been written, returning true if all went well.
+   bool Flush (void);
+   //!  The number of frames passed to Done() so far.
+   long Frames (void) const { return I_Released; }
+   //!  The time spent reading and writing, in seconds.
+   double IoSeconds (void);
+   //!  The time the caller spent waiting for I/O to finish, in seconds.
+   double WaitSeconds (void);
+   //!  The part of the I/O time that was overlapped with the caller's processing.
+   double HiddenFraction (void);
+   //!  The number of bytes from the start of one frame in a file to the start of the next.
+   static long FrameStride (long Nx, long Ny);
+private:
+   //!  Open a file, with O_DIRECT if that's wanted and possible.
+   int OpenFile (const char* FileName, int Flags);
+   //!  Read frame Index (counting from the start of the run) into its input buffer.
+   bool ReadFrame (long Index);
+   //!  Write the output buffer for frame Index (counting from the start of the run).
+   bool WriteFrame (long Index);
+   //!  Record an error, making any waiting threads give up.
+   void Fail (const char* What);
+   //!  The loops run by the reader and writer threads.
+   void ReaderLoop (void);
+   void WriterLoop (void);
+   //!  The frame dimensions, the bytes of data in a frame, and the stride in the files.
+   long I_Nx;
+   long I_Ny;
+   long I_FrameBytes;
+   long I_Stride;
+   //!  The file descriptors, and the number of frames in the input file.
+   int I_InFd;
+   int I_OutFd;
+   long I_FileFrames;
+   //!  The mode, and whether O_DIRECT is in use.
+   Mode I_Mode;
+   bool I_Direct;
+   //!  The buffers, and the manager they come from.
+   int I_NBuffers;
+   ArrayManager I_Manager;
+   std::vector<float**> I_InBuffers;
+   std::vector<float**> I_OutBuffers;
+   //!  Frames handed to the caller, finished with, read and written, counted from zero.
+   long I_Current;
+   long I_Released;
+   long I_Read;
+   long I_Written;
+   //!  True once an error has happened, or the threads are to stop, and the first error.
+   bool I_Failed;
+   bool I_Stop;
+   std::string I_Error;
+   //!  Time spent reading and writing, and waiting for either, in seconds.
+   double I_IoSecs;
+   double I_WaitSecs;
+   //!  The lock for all the above, and the condition signalled when any of it changes.
+   std::mutex I_Mutex;
+   std::condition_variable I_Changed;
+   //!  The reader and writer threads.
+   std::thread I_Reader;
+   std::thread I_Writer;
+   //!  Copying would make no sense.
+   FramePipeline (const FramePipeline&) = delete;
+   FramePipeline& operator= (const FramePipeline&) = delete;
+};
+
+#endif
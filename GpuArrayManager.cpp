@@ -0,0 +1,309 @@
+//
+//                        G p u  A r r a y  M a n a g e r . c p p
+//
+//  Function:
+//     Arrays held in the memory of a CUDA GPU, and pinned host memory to stage them through.
+//
+//  Description:
+//     See the .h file for a description of GpuArrayManager and PinnedAllocator from a user's
+//     perspective. This file provides the implementation, which is mostly a thin layer over
+//     the CUDA runtime calls, keeping track of the dimensions and pitch of each array so the
+//     callers don't have to.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <stdio.h>
+
+#include <cuda_runtime_api.h>
+
+#include "GpuArrayManager.h"
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+
+GpuArrayManager::GpuArrayManager (int Device) :
+   I_Ready(false), I_Device(Device), I_LastError(cudaSuccess)
+{
+   I_Ready = Check(cudaSetDevice(Device));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+//
+//  The destructor frees any arrays that haven't been freed explicitly. It doesn't reset the
+//  device, since other code in the program may still be using it.
+
+GpuArrayManager::~GpuArrayManager ()
+{
+   for (std::list<DeviceArray>::iterator Iter = I_Arrays.begin();
+                                                         Iter != I_Arrays.end(); Iter++) {
+      cudaFree(Iter->Address);
+   }
+   I_Arrays.clear();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        M a l l o c  3 D
+//
+//  A 3D array is allocated as Nz * Ny rows, each padded to the pitch cudaMallocPitch() chooses,
+//  so every row of every plane starts on a boundary the GPU can read efficiently. The pitch
+//  is always a multiple of the size of the power-of-two sized types; for anything else it may
+//  not be, and then the rows are simply packed one after another.
+
+void* GpuArrayManager::Malloc3D (unsigned int BytesPerElement,long Nz,long Ny,long Nx)
+{
+   if (!I_Ready || BytesPerElement == 0 || Nz <= 0 || Ny <= 0 || Nx <= 0) return NULL;
+   void* Address = NULL;
+   size_t PitchBytes = 0;
+   size_t RowBytes = size_t(Nx) * BytesPerElement;
+   if (!Check(cudaMallocPitch(&Address,&PitchBytes,RowBytes,size_t(Nz) * size_t(Ny)))) {
+      return NULL;
+   }
+   if (PitchBytes % BytesPerElement) {
+      cudaFree(Address);
+      Address = NULL;
+      PitchBytes = RowBytes;
+      if (!Check(cudaMalloc(&Address,RowBytes * size_t(Ny) * size_t(Nz)))) return NULL;
+   }
+   DeviceArray Array;
+   Array.Address = Address;
+   Array.BytesPerElement = BytesPerElement;
+   Array.NDims = 3;
+   Array.Nz = Nz;
+   Array.Ny = Ny;
+   Array.Nx = Nx;
+   Array.PitchBytes = PitchBytes;
+   I_Arrays.push_back(Array);
+   return Address;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        M a l l o c  2 D
+//
+//  A 2D array is simply a 3D array with one plane.
+
+void* GpuArrayManager::Malloc2D (unsigned int BytesPerElement,long Ny,long Nx)
+{
+   void* Address = Malloc3D(BytesPerElement,1,Ny,Nx);
+   if (Address) Find(Address)->NDims = 2;
+   return Address;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            F r e e
+
+void GpuArrayManager::Free (void* Address)
+{
+   for (std::list<DeviceArray>::iterator Iter = I_Arrays.begin();
+                                                         Iter != I_Arrays.end(); Iter++) {
+      if (Iter->Address == Address) {
+         Check(cudaFree(Address));
+         I_Arrays.erase(Iter);
+         break;
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            F i n d
+
+GpuArrayManager::DeviceArray* GpuArrayManager::Find (void* Address)
+{
+   for (std::list<DeviceArray>::iterator Iter = I_Arrays.begin();
+                                                         Iter != I_Arrays.end(); Iter++) {
+      if (Iter->Address == Address) return &(*Iter);
+   }
+   return NULL;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   G e t  D i m e n s i o n s
+//
+//  As for ArrayManager, Dims[0] is the number of columns, Dims[1] the number of rows and so
+//  on, and an array that isn't known returns zeros.
+
+void GpuArrayManager::GetDimensions (void* Address, int MaxDims, int* NDims, long Dims[])
+{
+   DeviceArray* Array = Find(Address);
+   long AllDims[3] = { 0, 0, 0 };
+   *NDims = 0;
+   if (Array) {
+      *NDims = Array->NDims;
+      AllDims[0] = Array->Nx;
+      AllDims[1] = Array->Ny;
+      AllDims[2] = Array->Nz;
+   }
+   for (int IDim = 0; IDim < MaxDims; IDim++) {
+      if (IDim < *NDims) Dims[IDim] = AllDims[IDim];
+      else Dims[IDim] = Array ? 1 : 0;
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        G e t  P i t c h
+
+long GpuArrayManager::GetPitch (void* Address)
+{
+   DeviceArray* Array = Find(Address);
+   return Array ? long(Array->PitchBytes / Array->BytesPerElement) : 0;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           P l a n e
+
+void* GpuArrayManager::Plane (void* Address, long Iz)
+{
+   DeviceArray* Array = Find(Address);
+   if (Array == NULL || Iz < 0 || Iz >= Array->Nz) return NULL;
+   return (char*) Address + size_t(Iz) * size_t(Array->Ny) * Array->PitchBytes;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     C o p y  R e g i o n
+//
+//  CopyRegion() checks the range of planes for a copy - an NPlanes of -1 meaning all the
+//  planes from FirstPlane on - and returns the device address of the first row to copy.
+
+bool GpuArrayManager::CopyRegion (
+   DeviceArray* Array, long FirstPlane, long* NPlanes, char** Device)
+{
+   if (Array == NULL || FirstPlane < 0 || FirstPlane >= Array->Nz) return false;
+   if (*NPlanes < 0) *NPlanes = Array->Nz - FirstPlane;
+   if (*NPlanes == 0 || FirstPlane + *NPlanes > Array->Nz) return false;
+   *Device = (char*) Array->Address + size_t(FirstPlane) * size_t(Array->Ny) * Array->PitchBytes;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       T o  D e v i c e
+//
+//  Host is the address of the first element of the host array (what ArrayManager::BaseArray()
+//  returns, for an ArrayManager array) - not of the first element to be copied - and
+//  HostPitch is its pitch in elements.
+
+bool GpuArrayManager::ToDevice (
+   void* Address, const void* Host, long HostPitch, cudaStream_t Stream,
+                                                         long FirstPlane, long NPlanes)
+{
+   DeviceArray* Array = Find(Address);
+   char* Device = NULL;
+   if (Host == NULL || !CopyRegion(Array,FirstPlane,&NPlanes,&Device)) return false;
+   size_t HostPitchBytes = size_t(HostPitch) * Array->BytesPerElement;
+   const char* From = (const char*) Host + size_t(FirstPlane) * size_t(Array->Ny) * HostPitchBytes;
+   return Check(cudaMemcpy2DAsync(Device,Array->PitchBytes,From,HostPitchBytes,
+                 size_t(Array->Nx) * Array->BytesPerElement,size_t(NPlanes) * size_t(Array->Ny),
+                                                          cudaMemcpyHostToDevice,Stream));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         T o  H o s t
+
+bool GpuArrayManager::ToHost (
+   void* Host, long HostPitch, void* Address, cudaStream_t Stream,
+                                                         long FirstPlane, long NPlanes)
+{
+   DeviceArray* Array = Find(Address);
+   char* Device = NULL;
+   if (Host == NULL || !CopyRegion(Array,FirstPlane,&NPlanes,&Device)) return false;
+   size_t HostPitchBytes = size_t(HostPitch) * Array->BytesPerElement;
+   char* To = (char*) Host + size_t(FirstPlane) * size_t(Array->Ny) * HostPitchBytes;
+   return Check(cudaMemcpy2DAsync(To,HostPitchBytes,Device,Array->PitchBytes,
+                 size_t(Array->Nx) * Array->BytesPerElement,size_t(NPlanes) * size_t(Array->Ny),
+                                                          cudaMemcpyDeviceToHost,Stream));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            L i s t
+
+void GpuArrayManager::List (void (*ListRoutine)(const char* String))
+{
+   char DebugString[256];
+   for (std::list<DeviceArray>::iterator Iter = I_Arrays.begin();
+                                                         Iter != I_Arrays.end(); Iter++) {
+      long Bytes = Iter->Nz * Iter->Ny * long(Iter->PitchBytes);
+      snprintf (DebugString,sizeof(DebugString),"%d-D device array of %ld bytes at %p, pitch %ld",
+                 Iter->NDims,Bytes,Iter->Address,long(Iter->PitchBytes / Iter->BytesPerElement));
+      if (ListRoutine) {
+         (*ListRoutine)(DebugString);
+      } else {
+         printf ("%s\n",DebugString);
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      L a s t  E r r o r
+
+const char* GpuArrayManager::LastError (void) const
+{
+   return (I_LastError == cudaSuccess) ? "" : cudaGetErrorString(I_LastError);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           C h e c k
+
+bool GpuArrayManager::Check (cudaError_t Status)
+{
+   if (Status == cudaSuccess) return true;
+   I_LastError = Status;
+   return false;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                              P i n n e d  A l l o c a t o r
+
+PinnedAllocator::PinnedAllocator (bool WriteCombined) :
+   I_Flags(cudaHostAllocPortable), I_Failures(0)
+{
+   if (WriteCombined) I_Flags |= cudaHostAllocWriteCombined;
+}
+
+void* PinnedAllocator::Allocate (size_t Bytes)
+{
+   void* Block = NULL;
+   if (cudaHostAlloc(&Block,Bytes,I_Flags) != cudaSuccess) {
+      I_Failures++;
+      Block = NULL;
+   }
+   return Block;
+}
+
+void PinnedAllocator::Release (void* Block, size_t Bytes)
+{
+   (void) Bytes;
+   if (Block) cudaFreeHost(Block);
+}
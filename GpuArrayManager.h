@@ -0,0 +1,164 @@
+//
+//                         G p u  A r r a y  M a n a g e r . h
+//
+//  Function:
+//     Arrays held in the memory of a CUDA GPU, and pinned host memory to stage them through.
+//
+//  Description:
+//     For large frames, even a perfectly vectorised subr() running on the CPU is limited by
+//     the CPU's memory bandwidth, and a GPU has several times as much. But the data has to
+//     get to the GPU and back, over a bus that is a lot slower than either memory, so whether
+//     moving the work there pays off depends on how much work is done on the data once it is
+//     there, and on how well the copies can be overlapped with that work. This file declares
+//     two classes that the test programs use to find out.
+//
+//     A GpuArrayManager allocates 2D and 3D arrays in the memory of the GPU, using the CUDA
+//     runtime, and keeps track of them in much the way an ArrayManager does: it knows the
+//     dimensions of each array, GetDimensions() and GetPitch() report them, Free() releases
+//     an array, and any arrays still allocated are released when the manager is deleted. The
+//     big difference is that the addresses it returns are device addresses, of the elements
+//     themselves, and the host can't use them in any way except to pass them to a kernel or
+//     to one of the copy routines. So there are no row pointer tables - a kernel indexes the
+//     array using its pitch - and no header in front of the data, which is why the manager
+//     keeps its own list of the arrays, as ArrayManager originally did. The rows of an array
+//     are padded, using cudaMallocPitch(), so that each row starts at an address the GPU can
+//     read efficiently; GetPitch() returns the padded row length in elements. Plane() returns
+//     the device address of one plane of a 3D array.
+//
+//     ToDevice() and ToHost() copy a whole array, or a range of its planes, between the GPU
+//     and a host array with the same dimensions, taking the host array's own pitch into
+//     account, so a host array allocated by an ArrayManager with padded rows can be used. The
+//     copies are asynchronous, in the CUDA stream given, which is what lets the copy of one
+//     frame overlap the processing of another - but only if the host memory is 'pinned', ie
+//     locked into physical memory, so the GPU can read and write it directly. A copy to or
+//     from ordinary pageable memory is first staged through a pinned buffer by the CUDA
+//     driver, and doesn't overlap anything.
+//
+//     PinnedAllocator is an ArrayAllocator (see ArrayAllocator.h) that gets its memory from
+//     cudaHostAlloc(), so an ArrayManager can be told to use it with SetAllocator(), and the
+//     host arrays it allocates - row tables and all - are then pinned, and can be used from
+//     the host with the usual In[Iz][Iy][Ix] form. Pinned memory is a limited resource, and
+//     expensive to allocate, so it is best used for staging buffers that are allocated once
+//     and used many times.
+//
+//     Errors from the CUDA runtime are not reported as exceptions. The allocation routines
+//     return NULL and the copy routines false, and LastError() returns the CUDA description
+//     of the most recent error. Ready() shows whether the GPU could be selected at all.
+//
+//     These use the CUDA runtime API, but contain no device code, so they can be compiled by
+//     the host compiler - nvcc passes .cpp files straight to it - and linked with the CUDA
+//     runtime library. cgpusub.cu has the device code for the test, and cgpumain.cpp is the
+//     main program that uses all of this.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __GpuArrayManager__
+#define __GpuArrayManager__
+
+#include <stddef.h>
+
+#include <list>
+
+#include <cuda_runtime_api.h>
+
+#include "ArrayAllocator.h"
+
+class GpuArrayManager {
+public:
+   //!  Constructor, selecting the GPU to use.
+   GpuArrayManager (int Device = 0);
+   //!  Destructor. Releases all the arrays still allocated.
+   ~GpuArrayManager ();
+   //!  True if the GPU could be selected.
+   bool Ready (void) const { return I_Ready; }
+   //!  Allocate a 3-dimensional array in GPU memory, returning its device address.
+   void* Malloc3D (unsigned int BytesPerElement,long Nz,long Ny,long Nx);
+   //!  Allocate a 2-dimensional array in GPU memory, returning its device address.
+   void* Malloc2D (unsigned int BytesPerElement,long Ny,long Nx);
+   //!  Release an array allocated by one of the Malloc() routines.
+   void Free (void* Address);
+   //!  Return the dimensions of the array.
+   void GetDimensions (void* Address, int MaxDims, int* NDims, long Dims[]);
+   //!  Return the number of elements from the start of one row to the start of the next.
+   long GetPitch (void* Address);
+   //!  Return the device address of plane Iz of a 3D array (or of a 2D array, for Iz = 0).
+   void* Plane (void* Address, long Iz);
+   //!  Copy a host array, or NPlanes planes of it starting at FirstPlane, to the GPU.
+   bool ToDevice (void* Address, const void* Host, long HostPitch, cudaStream_t Stream = 0,
+                                                      long FirstPlane = 0, long NPlanes = -1);
+   //!  Copy an array, or NPlanes planes of it starting at FirstPlane, from the GPU.
+   bool ToHost (void* Host, long HostPitch, void* Address, cudaStream_t Stream = 0,
+                                                      long FirstPlane = 0, long NPlanes = -1);
+   //!  List the allocated arrays for diagnostic purposes.
+   void List (void (*ListRoutine)(const char* String) = NULL);
+   //!  The description of the most recent CUDA error, or an empty string.
+   const char* LastError (void) const;
+private:
+   //!  What is known about each array.
+   struct DeviceArray {
+      void* Address;
+      unsigned int BytesPerElement;
+      int NDims;
+      long Nz;
+      long Ny;
+      long Nx;
+      size_t PitchBytes;
+   };
+   //!  Find the details of an array, returning NULL if it isn't one of ours.
+   DeviceArray* Find (void* Address);
+   //!  Work out the rows and the address of the first of them for a copy of some planes.
+   bool CopyRegion (DeviceArray* Array, long FirstPlane, long* NPlanes, char** Device);
+   //!  Record the result of a CUDA call, returning true if it succeeded.
+   bool Check (cudaError_t Status);
+   //!  The arrays allocated and not yet freed.
+   std::list<DeviceArray> I_Arrays;
+   //!  True if the device was selected.
+   bool I_Ready;
+   //!  The device that was selected.
+   int I_Device;
+   //!  The result of the most recent CUDA call that failed.
+   cudaError_t I_LastError;
+   //!  Copying would free the arrays twice.
+   GpuArrayManager (const GpuArrayManager&);
+   GpuArrayManager& operator= (const GpuArrayManager&);
+};
+
+//  PinnedAllocator provides page-locked host memory for an ArrayManager.
+
+class PinnedAllocator : public ArrayAllocator {
+public:
+   //!  Constructor. Write-combined memory is faster to copy to the GPU, but very slow for
+   //!  the host to read, so is only suitable for arrays the host only writes.
+   PinnedAllocator (bool WriteCombined = false);
+   //!  Allocate a block of pinned memory.
+   void* Allocate (size_t Bytes);
+   //!  Release a block of memory obtained from Allocate().
+   void Release (void* Block, size_t Bytes);
+   //!  The number of allocations that failed.
+   long Failures (void) const { return I_Failures; }
+private:
+   //!  The flags passed to cudaHostAlloc().
+   unsigned int I_Flags;
+   //!  The number of failed allocations.
+   long I_Failures;
+};
+
+#endif
@@ -0,0 +1,213 @@
+//
+//                                  M a t r i x . h
+//
+//  Function:
+//     A 2D array container, like a vector of vectors but with all its elements contiguous.
+//
+//  Description:
+//     The STL version of the test, in cvmain.cpp and cvsub.cpp, uses a vector<vector<float> >
+//     as its 2D array. That's convenient - the elements can be accessed as In[Iy][Ix], the
+//     memory is released automatically, and it needs nothing beyond the standard library -
+//     but each row is a separate vector, allocated separately, so the rows are scattered
+//     about the heap, there are Ny + 1 allocations for each array, and there is no way to
+//     treat the array as a whole: copying it can't be one memcpy(), and a loop through all
+//     its elements has to be a loop through its rows.
+//
+//     Matrix<T> keeps the convenience and loses the scattering. It holds all the elements of
+//     an Ny by Nx array in one block, row after row, and operator[] returns a pointer to row
+//     Iy, so Matrix[Iy][Ix] works just as it does for a vector of vectors. The block is
+//     obtained from an allocator, std::allocator<T> by default, that can be specified as the
+//     second template argument in the usual STL way. begin(), end(), data() and size() give
+//     access to all the elements as one sequence, so whole-array operations can be done in a
+//     single loop, or with a single std::copy() or std::fill(). For example:
+//
+//     Matrix<float> Image (Ny,Nx);
+//     Image[Iy][Ix] = 1.0f;
+//     std::fill (Image.begin(),Image.end(),0.0f);
+//
+//     A Matrix can be moved - which just passes its block to the new Matrix, leaving the old
+//     one empty - but not copied. Copying a large image by accident, for example by passing
+//     it to a routine by value, is an easy mistake to make and an expensive one; if a copy
+//     really is needed, Clone() makes one explicitly.
+//
+//     The dimensions follow the same order as the vector of vectors it replaces, and as the
+//     ArrayManager Malloc2D() routine: rows first, so Matrix<float> M(Ny,Nx) has Ny rows of
+//     Nx columns. This needs C++11 or later.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. An empty matrix now keeps its number of rows and columns.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __Matrix__
+#define __Matrix__
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+template <typename T, typename Alloc = std::allocator<T> >
+class Matrix {
+public:
+   typedef T value_type;
+   typedef Alloc allocator_type;
+   typedef std::size_t size_type;
+   typedef T* pointer;
+   typedef const T* const_pointer;
+   typedef T* iterator;
+   typedef const T* const_iterator;
+   //!  Constructor for an empty matrix.
+   explicit Matrix (const Alloc& Allocator = Alloc()) :
+      I_Alloc(Allocator), I_Data(nullptr), I_Ny(0), I_Nx(0) {}
+   //!  Constructor for Ny rows of Nx columns, value-initialised (zero, for numbers).
+   Matrix (size_type Ny, size_type Nx, const Alloc& Allocator = Alloc()) :
+      I_Alloc(Allocator), I_Data(nullptr), I_Ny(0), I_Nx(0) { Create(Ny,Nx,T()); }
+   //!  Constructor for Ny rows of Nx columns, each element set to Value.
+   Matrix (size_type Ny, size_type Nx, const T& Value, const Alloc& Allocator = Alloc()) :
+      I_Alloc(Allocator), I_Data(nullptr), I_Ny(0), I_Nx(0) { Create(Ny,Nx,Value); }
+   //!  Move constructor. Other is left empty.
+   Matrix (Matrix&& Other) noexcept : I_Alloc(std::move(Other.I_Alloc)),
+      I_Data(Other.I_Data), I_Ny(Other.I_Ny), I_Nx(Other.I_Nx) { Other.Forget(); }
+   //!  Move assignment. Other is left empty.
+   Matrix& operator= (Matrix&& Other) noexcept {
+      if (this != &Other) {
+         Destroy();
+         I_Alloc = std::move(Other.I_Alloc);
+         I_Data = Other.I_Data;
+         I_Ny = Other.I_Ny;
+         I_Nx = Other.I_Nx;
+         Other.Forget();
+      }
+      return *this;
+   }
+   //!  Destructor.
+   ~Matrix () { Destroy(); }
+   //!  A copy, made explicitly, since copying isn't allowed otherwise.
+   Matrix Clone (void) const {
+      Matrix Copy (I_Alloc);
+      Copy.Create(I_Ny,I_Nx,I_Data);
+      return Copy;
+   }
+   //!  Row access, so elements can be accessed as Matrix[Iy][Ix].
+   T* operator[] (size_type Iy) { return I_Data + Iy * I_Nx; }
+   const T* operator[] (size_type Iy) const { return I_Data + Iy * I_Nx; }
+   //!  The number of rows.
+   size_type rows (void) const { return I_Ny; }
+   //!  The number of columns.
+   size_type cols (void) const { return I_Nx; }
+   //!  The total number of elements.
+   size_type size (void) const { return I_Ny * I_Nx; }
+   //!  True if there are no elements.
+   bool empty (void) const { return size() == 0; }
+   //!  The address of the first element - all the rest follow it, row by row.
+   T* data (void) { return I_Data; }
+   const T* data (void) const { return I_Data; }
+   //!  Iterators over all the elements, row by row.
+   iterator begin (void) { return I_Data; }
+   iterator end (void) { return I_Data + size(); }
+   const_iterator begin (void) const { return I_Data; }
+   const_iterator end (void) const { return I_Data + size(); }
+   //!  The allocator used for the elements.
+   allocator_type get_allocator (void) const { return I_Alloc; }
+   //!  Exchange the contents of two matrices.
+   void swap (Matrix& Other) noexcept {
+      std::swap(I_Alloc,Other.I_Alloc);
+      std::swap(I_Data,Other.I_Data);
+      std::swap(I_Ny,Other.I_Ny);
+      std::swap(I_Nx,Other.I_Nx);
+   }
+   //!  Copying is only possible using Clone().
+   Matrix (const Matrix&) = delete;
+   Matrix& operator= (const Matrix&) = delete;
+private:
+   typedef std::allocator_traits<Alloc> Traits;
+   //!  Allocate and construct the elements, from a single value or from another array.
+   void Create (size_type Ny, size_type Nx, const T& Value) { Create(Ny,Nx,&Value,0); }
+   void Create (size_type Ny, size_type Nx, const T* Source) { Create(Ny,Nx,Source,1); }
+   void Create (size_type Ny, size_type Nx, const T* Source, size_type Step);
+   //!  Destroy the elements and release the memory.
+   void Destroy (void);
+   //!  Forget the elements, which now belong to another matrix.
+   void Forget (void) { I_Data = nullptr; I_Ny = I_Nx = 0; }
+   //!  The allocator.
+   Alloc I_Alloc;
+   //!  The elements, or a null pointer if there are none.
+   T* I_Data;
+   //!  The number of rows and columns.
+   size_type I_Ny;
+   size_type I_Nx;
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         C r e a t e
+//
+//  Create() allocates the block for the elements and constructs each of them as a copy of
+//  Source[Index * Step] - so a Step of zero sets them all to the one value. If one of the
+//  constructors throws, the elements already constructed are destroyed and the block is
+//  released before the exception is passed on, leaving the matrix empty. A matrix with no
+//  elements, such as one of 0 rows by 5 columns, has no block but still records its shape.
+
+template <typename T, typename Alloc>
+void Matrix<T,Alloc>::Create (size_type Ny, size_type Nx, const T* Source, size_type Step)
+{
+   size_type Elements = Ny * Nx;
+   if (Elements == 0) {
+      I_Ny = Ny;
+      I_Nx = Nx;
+      return;
+   }
+   T* Data = Traits::allocate(I_Alloc,Elements);
+   size_type Index = 0;
+   try {
+      for (; Index < Elements; Index++) {
+         Traits::construct(I_Alloc,Data + Index,Source[Index * Step]);
+      }
+   } catch (...) {
+      while (Index > 0) Traits::destroy(I_Alloc,Data + --Index);
+      Traits::deallocate(I_Alloc,Data,Elements);
+      throw;
+   }
+   I_Data = Data;
+   I_Ny = Ny;
+   I_Nx = Nx;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        D e s t r o y
+
+template <typename T, typename Alloc>
+void Matrix<T,Alloc>::Destroy (void)
+{
+   if (I_Data) {
+      size_type Elements = size();
+      for (size_type Index = 0; Index < Elements; Index++) {
+         Traits::destroy(I_Alloc,I_Data + Index);
+      }
+      Traits::deallocate(I_Alloc,I_Data,Elements);
+   }
+   Forget();
+}
+
+#endif
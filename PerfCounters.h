@@ -0,0 +1,283 @@
+//
+//                              P e r f  C o u n t e r s . h
+//
+//  Function:
+//     Hardware performance counters around the timed loop of the C++ test programs.
+//
+//  Description:
+//     Timing the different array layouts shows which is fastest, but not why. The reasons
+//     are usually things like the cache misses caused by the extra load of a row pointer,
+//     the branches in a loop the compiler couldn't simplify, or a loop that was vectorised
+//     with shorter vectors than it might have been - and all of those show up directly in
+//     the CPU's hardware performance counters. A PerfCounters object opens a set of those
+//     counters for the calling thread, using the Linux perf_event_open() system call, and
+//     BenchHarness.h uses one to count over the timed calls to subr(). The counts, divided
+//     by the number of array elements processed, appear in the harness's BENCH line, and
+//     Run.py tabulates them next to its summary of relative times.
+//
+//     The counters are:
+//
+//     cycles        CPU core cycles (which, unlike the time stamp counter, follow any
+//                   change in clock speed).
+//     instr         Instructions retired.
+//     l1d_miss      Level 1 data cache read misses.
+//     llc_miss      Last level cache misses.
+//     branch_miss   Mispredicted branches.
+//     vec_ops       Vector (packed) floating point arithmetic instructions retired.
+//     scalar_ops    Scalar floating point arithmetic instructions retired.
+//
+//     The first five are generic events that the kernel maps onto whatever the CPU has. The
+//     last two have no generic equivalent, and are only available by default on Intel CPUs,
+//     which have an FP_ARITH_INST_RETIRED event (event 0xC7) with separate masks for scalar
+//     and for packed instructions of each width. On other CPUs the raw event codes can be
+//     given using the environment variables BENCH_PERF_VECTOR and BENCH_PERF_SCALAR, in the
+//     form perf uses for raw events (eg 0xfcc7). The ratio of the two shows whether the loop
+//     was vectorised, and vec_ops per element shows how wide the vectors were - 0.25 of an
+//     addition per element means SSE, 0.0625 means AVX-512.
+//
+//     Not every counter is available everywhere. Most virtual machines don't give access to
+//     the hardware counters at all, and the kernel setting perf_event_paranoid can stop an
+//     ordinary user from using them. Any counter that can't be opened simply reads as -1,
+//     and the rest are still used. The counters only count user-mode events in the calling
+//     thread. If the CPU has fewer counters than are asked for, the kernel multiplexes them,
+//     and the values are scaled up to allow for the time each was actually counting.
+//
+//     Setting the environment variable BENCH_PERF to 0 stops any counters being opened, and
+//     compiling with BENCH_NO_PERF defined leaves out all the code. On systems other than
+//     Linux, there are no counters. PAPI would give the same information in a portable way,
+//     but would add a dependency that none of the other test programs has.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __PerfCounters__
+#define __PerfCounters__
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && !defined(BENCH_NO_PERF)
+#define BENCH_HAVE_PERF
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+class PerfCounters {
+public:
+   //!  The counters, in the order they are reported.
+   enum Counter { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses,
+                  VectorOps, ScalarOps, NCounters };
+   //!  Constructor. Opens as many of the counters as it can.
+   PerfCounters (void);
+   //!  Destructor. Closes the counters.
+   ~PerfCounters ();
+   //!  Zeros and starts the counters.
+   void Start (void);
+   //!  Stops the counters and reads them.
+   void Stop (void);
+   //!  The value of a counter since the last Start(), or -1 if it isn't available.
+   double Value (Counter Which) const { return I_Values[Which]; }
+   //!  The name of a counter, as used in the BENCH line.
+   static const char* Name (Counter Which);
+   //!  True if at least one counter could be opened.
+   bool Available (void) const;
+private:
+   //!  Open one counter, returning its file descriptor, or -1.
+   static int Open (unsigned Type, unsigned long long Config);
+   //!  The raw event code for one of the FP arithmetic counters, or 0 if not known.
+   static unsigned long long RawEvent (const char* EnvName, unsigned long long IntelCode);
+   //!  The file descriptors for the counters, -1 for those not open.
+   int I_Fds[NCounters];
+   //!  The counter values read by Stop().
+   double I_Values[NCounters];
+   //!  Copying would close the counters twice.
+   PerfCounters (const PerfCounters&);
+   PerfCounters& operator= (const PerfCounters&);
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+
+inline PerfCounters::PerfCounters (void)
+{
+   for (int Index = 0; Index < NCounters; Index++) {
+      I_Fds[Index] = -1;
+      I_Values[Index] = -1.0;
+   }
+#ifdef BENCH_HAVE_PERF
+   const char* Env = getenv("BENCH_PERF");
+   if (Env && atoi(Env) == 0) return;
+   I_Fds[Cycles] = Open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES);
+   I_Fds[Instructions] = Open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS);
+   I_Fds[L1DMisses] = Open(PERF_TYPE_HW_CACHE,PERF_COUNT_HW_CACHE_L1D |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+   I_Fds[LLCMisses] = Open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES);
+   I_Fds[BranchMisses] = Open(PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES);
+
+   //  FP_ARITH_INST_RETIRED: umask 0x01/0x02 are scalar double/single, 0x04 and 0x08 are
+   //  128 bit packed double/single, 0x10 and 0x20 256 bit, 0x40 and 0x80 512 bit.
+
+   unsigned long long Vector = RawEvent("BENCH_PERF_VECTOR",0xfcc7);
+   unsigned long long Scalar = RawEvent("BENCH_PERF_SCALAR",0x03c7);
+   if (Vector) I_Fds[VectorOps] = Open(PERF_TYPE_RAW,Vector);
+   if (Scalar) I_Fds[ScalarOps] = Open(PERF_TYPE_RAW,Scalar);
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+
+inline PerfCounters::~PerfCounters ()
+{
+#ifdef BENCH_HAVE_PERF
+   for (int Index = 0; Index < NCounters; Index++) {
+      if (I_Fds[Index] >= 0) close(I_Fds[Index]);
+   }
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           S t a r t
+
+inline void PerfCounters::Start (void)
+{
+#ifdef BENCH_HAVE_PERF
+   for (int Index = 0; Index < NCounters; Index++) {
+      if (I_Fds[Index] >= 0) {
+         ioctl(I_Fds[Index],PERF_EVENT_IOC_RESET,0);
+         ioctl(I_Fds[Index],PERF_EVENT_IOC_ENABLE,0);
+      }
+   }
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            S t o p
+//
+//  Stop() stops all the counters first, and only then reads them, so that reading one
+//  counter isn't counted by the others. Each read returns the count and the times the counter
+//  was enabled and actually running, and if the kernel had to multiplex the counters - so
+//  the running time is less than the enabled time - the count is scaled up accordingly.
+
+inline void PerfCounters::Stop (void)
+{
+#ifdef BENCH_HAVE_PERF
+   for (int Index = 0; Index < NCounters; Index++) {
+      if (I_Fds[Index] >= 0) ioctl(I_Fds[Index],PERF_EVENT_IOC_DISABLE,0);
+   }
+   for (int Index = 0; Index < NCounters; Index++) {
+      I_Values[Index] = -1.0;
+      if (I_Fds[Index] >= 0) {
+         unsigned long long Data[3];
+         if (read(I_Fds[Index],Data,sizeof(Data)) == ssize_t(sizeof(Data)) && Data[2] > 0) {
+            I_Values[Index] = double(Data[0]) * double(Data[1]) / double(Data[2]);
+         }
+      }
+   }
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       A v a i l a b l e
+
+inline bool PerfCounters::Available (void) const
+{
+   for (int Index = 0; Index < NCounters; Index++) {
+      if (I_Fds[Index] >= 0) return true;
+   }
+   return false;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            N a m e
+
+inline const char* PerfCounters::Name (Counter Which)
+{
+   static const char* Names[NCounters] = {
+      "cycles", "instr", "l1d_miss", "llc_miss", "branch_miss", "vec_ops", "scalar_ops" };
+   return (Which >= 0 && Which < NCounters) ? Names[Which] : "unknown";
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            O p e n
+
+inline int PerfCounters::Open (unsigned Type, unsigned long long Config)
+{
+#ifdef BENCH_HAVE_PERF
+   struct perf_event_attr Attr;
+   memset(&Attr,0,sizeof(Attr));
+   Attr.size = sizeof(Attr);
+   Attr.type = Type;
+   Attr.config = Config;
+   Attr.disabled = 1;
+   Attr.exclude_kernel = 1;
+   Attr.exclude_hv = 1;
+   Attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+   return int(syscall(SYS_perf_event_open,&Attr,0,-1,-1,0));
+#else
+   (void) Type;
+   (void) Config;
+   return -1;
+#endif
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        R a w  E v e n t
+//
+//  RawEvent() returns the raw event code given by the named environment variable, if it is
+//  set, or the Intel code if this is an Intel CPU, or zero.
+
+inline unsigned long long PerfCounters::RawEvent (const char* EnvName, unsigned long long IntelCode)
+{
+   const char* Env = getenv(EnvName);
+   if (Env && *Env) return strtoull(Env,NULL,0);
+#if defined(BENCH_HAVE_PERF) && (defined(__x86_64__) || defined(__i386__))
+   unsigned int Eax = 0, Ebx = 0, Ecx = 0, Edx = 0;
+   if (__get_cpuid(0,&Eax,&Ebx,&Ecx,&Edx)) {
+      char Vendor[13];
+      memcpy(Vendor,&Ebx,4);
+      memcpy(Vendor + 4,&Edx,4);
+      memcpy(Vendor + 8,&Ecx,4);
+      Vendor[12] = '\0';
+      if (!strcmp(Vendor,"GenuineIntel")) return IntelCode;
+   }
+#else
+   (void) IntelCode;
+#endif
+   return 0;
+}
+
+#endif
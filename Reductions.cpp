@@ -0,0 +1,621 @@
+//
+//                              R e d u c t i o n s . c p p
+//
+//  Function:
+//     Sums, means, minima, maxima and sigma-clipped medians along any axis of an array.
+//
+//  Description:
+//     See the .h file for a description of the reductions from a user's perspective. This
+//     file provides the implementation. GetLayout() turns the array, the axis and the
+//     result into a Layout: the strides, in elements, that take each dimension of the
+//     result to the corresponding element of the input, the stride along the axis being
+//     reduced and its length, and the way the work is split into units - blocks of up to
+//     Layout::Chunk consecutive elements of a row of the result. DoUnits() processes a range
+//     of those units, and DoParts(), which is what the thread pool runs, gives each thread
+//     its range.
+//
+//     There are two sets of kernels. For any axis but the first, the 'column' kernels take
+//     a block of consecutive elements of the result, whose inputs are consecutive elements
+//     of each row along the axis, and combine those rows one after another - loops with no
+//     dependence from one element to the next, which vectorise without any help. When the
+//     reduction is along the rows (axis 0), each element of the result comes from one
+//     contiguous row of the input, and the 'row' kernels reduce it into Lanes independent
+//     partial results, by treating it as a short block of Lanes columns and using the
+//     column kernels. The compiler can't vectorise a single running total, since it would
+//     have to change the order of the additions to do so, whereas this way the order is
+//     fixed by the code, and doesn't depend on the vector length or the compiler options.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. The thread pool is now always given one item per thread, with the
+//                    threads not needed given no units, rather than a part count that
+//                    changed with the size of the array.
+
+//     14th Oct 2026. GetLayout() now gets the strides from GetStride(), so it handles 3D
+//                    views correctly, and refuses those whose planes aren't evenly spaced.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "Reductions.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+
+//  The number of independent partial results used by the row kernels. Sixteen would fill an
+//  AVX-512 register, but each block then has to wait for the one before; sixty-four gives the
+//  CPU four independent chains even with AVX-512, and more with shorter vectors, which matters
+//  most for the Kahan sums, whose chains are four operations long.
+
+static const int Lanes = 64;
+
+//  The number of values below which the pairwise sums stop dividing, for rows and for
+//  columns. The row value is a multiple of Lanes.
+
+static const long RowPairBlock = 256;
+static const long ColPairBlock = 8;
+
+//  The block of columns handled at a time by the column kernels, and by the median, which
+//  needs a copy of every value along the axis for each column of the block.
+
+static const long ColumnChunk = 1024;
+static const long MedianChunk = 64;
+
+//  The smallest number of input elements worth giving to a thread (see cpsub.cpp).
+
+static const long MinElementsPerThread = 32768;
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   C o l u m n  K e r n e l s
+//
+//  Each of these combines Length rows of Count values, the first starting at In and each
+//  Stride elements on from the one before, into the Count values at Out. Kahan sums need
+//  Count floats of scratch space for the compensations, and pairwise sums Count floats for
+//  each level of the recursion.
+
+static void ColPlain (const float* In, long Stride, long Length, long Count,
+                                                                     float* __restrict Out)
+{
+   for (long Ix = 0; Ix < Count; Ix++) Out[Ix] = In[Ix];
+   for (long K = 1; K < Length; K++) {
+      const float* __restrict Row = In + K * Stride;
+      for (long Ix = 0; Ix < Count; Ix++) Out[Ix] += Row[Ix];
+   }
+}
+
+static void ColKahan (const float* In, long Stride, long Length, long Count,
+                                            float* __restrict Out, float* __restrict Comp)
+{
+   for (long Ix = 0; Ix < Count; Ix++) {
+      Out[Ix] = In[Ix];
+      Comp[Ix] = 0.0f;
+   }
+   for (long K = 1; K < Length; K++) {
+      const float* __restrict Row = In + K * Stride;
+      for (long Ix = 0; Ix < Count; Ix++) {
+         float Y = Row[Ix] - Comp[Ix];
+         float T = Out[Ix] + Y;
+         Comp[Ix] = (T - Out[Ix]) - Y;
+         Out[Ix] = T;
+      }
+   }
+}
+
+static void ColPairwise (const float* In, long Stride, long Length, long Count,
+                                            float* __restrict Out, float* __restrict Scratch)
+{
+   if (Length <= ColPairBlock) {
+      ColPlain(In,Stride,Length,Count,Out);
+   } else {
+      long Half = Length / 2;
+      ColPairwise(In,Stride,Half,Count,Out,Scratch);
+      ColPairwise(In + Half * Stride,Stride,Length - Half,Count,Scratch,Scratch + Count);
+      for (long Ix = 0; Ix < Count; Ix++) Out[Ix] += Scratch[Ix];
+   }
+}
+
+static void ColMin (const float* In, long Stride, long Length, long Count,
+                                                                     float* __restrict Out)
+{
+   for (long Ix = 0; Ix < Count; Ix++) Out[Ix] = In[Ix];
+   for (long K = 1; K < Length; K++) {
+      const float* __restrict Row = In + K * Stride;
+      for (long Ix = 0; Ix < Count; Ix++) Out[Ix] = Row[Ix] < Out[Ix] ? Row[Ix] : Out[Ix];
+   }
+}
+
+static void ColMax (const float* In, long Stride, long Length, long Count,
+                                                                     float* __restrict Out)
+{
+   for (long Ix = 0; Ix < Count; Ix++) Out[Ix] = In[Ix];
+   for (long K = 1; K < Length; K++) {
+      const float* __restrict Row = In + K * Stride;
+      for (long Ix = 0; Ix < Count; Ix++) Out[Ix] = Row[Ix] > Out[Ix] ? Row[Ix] : Out[Ix];
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      R o w  K e r n e l s
+//
+//  Each of these reduces N contiguous values, starting at V. The first Lanes values start the
+//  partial results off, and each following block of Lanes values is combined with them - which
+//  is just what the column kernels do, treating the row as N / Lanes rows of Lanes values, so
+//  they are used to do it. Whatever is left over at the end goes into the first few lanes,
+//  and the lanes are then combined. Rows shorter than Lanes are simply done one at a time.
+
+static float CombineLanes (float Acc[Lanes])
+{
+   for (int Width = Lanes / 2; Width > 0; Width /= 2) {
+      for (int Lane = 0; Lane < Width; Lane++) Acc[Lane] += Acc[Lane + Width];
+   }
+   return Acc[0];
+}
+
+static float RowPlain (const float* V, long N)
+{
+   if (N < Lanes) {
+      float Total = 0.0f;
+      for (long I = 0; I < N; I++) Total += V[I];
+      return Total;
+   }
+   float Acc[Lanes];
+   long NBlocks = N / Lanes;
+   ColPlain(V,Lanes,NBlocks,Lanes,Acc);
+   for (long I = NBlocks * Lanes; I < N; I++) Acc[I % Lanes] += V[I];
+   return CombineLanes(Acc);
+}
+
+static float RowKahan (const float* V, long N)
+{
+   float Sum[Lanes];
+   float Comp[Lanes];
+   long NBlocks = N / Lanes;
+   if (NBlocks > 0) {
+      ColKahan(V,Lanes,NBlocks,Lanes,Sum,Comp);
+   } else {
+      for (int Lane = 0; Lane < Lanes; Lane++) Sum[Lane] = Comp[Lane] = 0.0f;
+   }
+   for (long I = NBlocks * Lanes; I < N; I++) {
+      int Lane = int(I % Lanes);
+      float Y = V[I] - Comp[Lane];
+      float T = Sum[Lane] + Y;
+      Comp[Lane] = (T - Sum[Lane]) - Y;
+      Sum[Lane] = T;
+   }
+
+   //  Combine the lanes, still compensating, and allowing for what each lane had left over.
+
+   float Total = 0.0f;
+   float Error = 0.0f;
+   for (int Lane = 0; Lane < Lanes; Lane++) {
+      float Y = (Sum[Lane] - Comp[Lane]) - Error;
+      float T = Total + Y;
+      Error = (T - Total) - Y;
+      Total = T;
+   }
+   return Total;
+}
+
+static float RowPairwise (const float* V, long N)
+{
+   if (N <= RowPairBlock) return RowPlain(V,N);
+   long Half = (N / 2) & ~long(Lanes - 1);
+   return RowPairwise(V,Half) + RowPairwise(V + Half,N - Half);
+}
+
+static float RowMin (const float* V, long N)
+{
+   float Result = V[0];
+   long I = 0;
+   if (N >= Lanes) {
+      float Acc[Lanes];
+      long NBlocks = N / Lanes;
+      ColMin(V,Lanes,NBlocks,Lanes,Acc);
+      for (int Lane = 0; Lane < Lanes; Lane++) Result = Acc[Lane] < Result ? Acc[Lane] : Result;
+      I = NBlocks * Lanes;
+   }
+   for (; I < N; I++) Result = V[I] < Result ? V[I] : Result;
+   return Result;
+}
+
+static float RowMax (const float* V, long N)
+{
+   float Result = V[0];
+   long I = 0;
+   if (N >= Lanes) {
+      float Acc[Lanes];
+      long NBlocks = N / Lanes;
+      ColMax(V,Lanes,NBlocks,Lanes,Acc);
+      for (int Lane = 0; Lane < Lanes; Lane++) Result = Acc[Lane] > Result ? Acc[Lane] : Result;
+      I = NBlocks * Lanes;
+   }
+   for (; I < N; I++) Result = V[I] > Result ? V[I] : Result;
+   return Result;
+}
+
+//  The number of levels of scratch space ColPairwise() needs for a given length.
+
+static long PairLevels (long Length)
+{
+   long Levels = 0;
+   while (Length > ColPairBlock) {
+      Length -= Length / 2;
+      Levels++;
+   }
+   return Levels;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        M e d i a n s
+//
+//  MedianOf() returns the median of N values, reordering them as it does so. For an even
+//  number, it is the mean of the two middle values. ClippedMedianOf() first drops any NaNs,
+//  then applies the clipping, if Sigma is greater than zero, and returns the median of the
+//  values left, or a NaN if there are none. The standard deviation is about the mean, and
+//  is formed in double, but the rejection is about the median, which is what makes the
+//  clipping robust against the outliers it is there to remove. When a pass rejects nothing,
+//  the median it started with is the answer.
+
+static float MedianOf (float* V, long N)
+{
+   std::nth_element(V,V + N / 2,V + N);
+   float Upper = V[N / 2];
+   if (N % 2) return Upper;
+   float Lower = *std::max_element(V,V + N / 2);
+   return 0.5f * (Lower + Upper);
+}
+
+static float ClippedMedianOf (float* V, long N, float Sigma, int MaxIterations)
+{
+   long NValid = 0;
+   for (long I = 0; I < N; I++) {
+      if (V[I] == V[I]) V[NValid++] = V[I];
+   }
+   if (NValid == 0) return std::numeric_limits<float>::quiet_NaN();
+   float Median = MedianOf(V,NValid);
+   for (int Iteration = 0; Sigma > 0.0f && Iteration < MaxIterations; Iteration++) {
+      double Sum = 0.0;
+      for (long I = 0; I < NValid; I++) Sum += V[I];
+      double Mean = Sum / double(NValid);
+      double SumSq = 0.0;
+      for (long I = 0; I < NValid; I++) SumSq += (V[I] - Mean) * (V[I] - Mean);
+      double Limit = Sigma * sqrt(SumSq / double(NValid));
+      long NKept = 0;
+      for (long I = 0; I < NValid; I++) {
+         if (fabs(V[I] - Median) <= Limit) V[NKept++] = V[I];
+      }
+      if (NKept == NValid || NKept == 0) break;
+      NValid = NKept;
+      Median = MedianOf(V,NValid);
+   }
+   return Median;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+//
+//  Zero or fewer threads means one for each available CPU.
+
+Reductions::Reductions (ArrayManager& Manager, int NThreads) : I_Manager(Manager)
+{
+   I_NThreads = NThreads > 0 ? NThreads : ThreadPool::AvailableCPUs();
+   if (I_NThreads < 1) I_NThreads = 1;
+   I_Pool = (I_NThreads > 1) ? new ThreadPool (I_NThreads) : NULL;
+   I_Accuracy = Pairwise;
+   I_Sigma = 0.0f;
+   I_MaxIterations = 5;
+   I_Op = Total;
+   I_NParts = 1;
+   I_Scratch.resize(I_NThreads);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+
+Reductions::~Reductions ()
+{
+   delete I_Pool;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  S e t  C l i p p i n g
+
+void Reductions::SetClipping (float Sigma, int MaxIterations)
+{
+   I_Sigma = Sigma > 0.0f ? Sigma : 0.0f;
+   I_MaxIterations = MaxIterations > 0 ? MaxIterations : 1;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    R e s u l t  D i m s
+//
+//  ResultDims() returns the dimensions - X first, as GetDimensions() gives them - of the
+//  result of reducing the array at a given address along a given axis.
+
+bool Reductions::ResultDims (void* Address, int Axis, int* NDims, long Dims[])
+{
+   int NInDims = 0;
+   long InDims[4];
+   I_Manager.GetDimensions(Address,4,&NInDims,InDims);
+   if (NInDims < 1 || NInDims > 4 || Axis < 0 || Axis >= NInDims) return false;
+   *NDims = 0;
+   for (int IDim = 0; IDim < NInDims; IDim++) {
+      if (IDim != Axis) Dims[(*NDims)++] = InDims[IDim];
+   }
+   if (*NDims == 0) Dims[(*NDims)++] = 1;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     G e t  L a y o u t
+
+bool Reductions::GetLayout (Operation Op, void* Address, int Axis, void* Result, Layout* Details)
+{
+   int NInDims = 0;
+   long InDims[4];
+   I_Manager.GetDimensions(Address,4,&NInDims,InDims);
+   int NOutDims = 0;
+   long OutDims[3];
+   if (!ResultDims(Address,Axis,&NOutDims,OutDims)) return false;
+   for (int IDim = 0; IDim < NInDims; IDim++) {
+      if (InDims[IDim] <= 0) return false;
+   }
+
+   //  The result has to exist, and have exactly the dimensions the reduction gives.
+
+   int NResultDims = 0;
+   long ResultDims[3];
+   I_Manager.GetDimensions(Result,3,&NResultDims,ResultDims);
+   if (NResultDims != NOutDims) return false;
+   for (int IDim = 0; IDim < NOutDims; IDim++) {
+      if (ResultDims[IDim] != OutDims[IDim]) return false;
+   }
+   if (Result == Address) return false;
+
+   //  Strides through the input for each of its dimensions, and through the result. These
+   //  come from the manager, since the planes of a 3D view aren't Ny * Pitch apart. A view
+   //  whose planes aren't evenly spaced has a stride of zero, and can't be handled.
+
+   long Strides[4];
+   for (int IDim = 0; IDim < NInDims; IDim++) {
+      Strides[IDim] = I_Manager.GetStride(Address,IDim);
+      if (Strides[IDim] <= 0) return false;
+   }
+   long OutStrides[3];
+   for (int IDim = 0; IDim < NOutDims; IDim++) {
+      OutStrides[IDim] = I_Manager.GetStride(Result,IDim);
+      if (OutStrides[IDim] <= 0) return false;
+   }
+   Details->In = (const float*) I_Manager.BaseArray(Address);
+   Details->Out = (float*) I_Manager.BaseArray(Result);
+   Details->NOutDims = NOutDims;
+   int OutDim = 0;
+   for (int IDim = 0; IDim < NInDims; IDim++) {
+      if (IDim != Axis) Details->InStrides[OutDim++] = Strides[IDim];
+   }
+   if (OutDim == 0) Details->InStrides[0] = 0;
+   for (int IDim = 0; IDim < NOutDims; IDim++) {
+      Details->OutDims[IDim] = OutDims[IDim];
+      Details->OutStrides[IDim] = OutStrides[IDim];
+   }
+   Details->Length = InDims[Axis];
+   Details->AxisStride = Strides[Axis];
+
+   //  The units of work. Along the rows, each element of the result is a whole row of the
+   //  input, so a unit can be small; otherwise a unit is as many columns as the kernels
+   //  handle at a time.
+
+   if (Axis == 0) {
+      Details->Chunk = 16;
+   } else {
+      Details->Chunk = (Op == ClippedMedian) ? MedianChunk : ColumnChunk;
+   }
+   long NRows = 1;
+   for (int IDim = 1; IDim < NOutDims; IDim++) NRows *= OutDims[IDim];
+   Details->UnitsPerRow = (OutDims[0] + Details->Chunk - 1) / Details->Chunk;
+   Details->Units = NRows * Details->UnitsPerRow;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        D o  P a r t s
+//
+//  DoParts() is called by the thread pool once for each thread - each item of the job is
+//  one thread - and splits the units between the first I_NParts of them. The rest are given
+//  nothing to do. Context is the Reductions object.
+
+void Reductions::DoParts (void* Context, long First, long Last, int Part)
+{
+   Reductions* This = (Reductions*) Context;
+   (void) First;
+   (void) Last;
+   if (Part < This->I_NParts) {
+      long FirstUnit,LastUnit;
+      ThreadPool::Partition(This->I_Layout.Units,This->I_NParts,Part,&FirstUnit,&LastUnit);
+      if (FirstUnit < LastUnit) DoUnits(Context,FirstUnit,LastUnit,Part);
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        D o  U n i t s
+//
+//  DoUnits() processes units First up to (but not including) Last, using the scratch space
+//  for piece Part of the work. Context is the Reductions object.
+
+void Reductions::DoUnits (void* Context, long First, long Last, int Part)
+{
+   Reductions* This = (Reductions*) Context;
+   const Layout& L = This->I_Layout;
+   Operation Op = This->I_Op;
+   Accuracy Method = This->I_Accuracy;
+   float* Scratch = This->I_Scratch[Part].empty() ? NULL : &This->I_Scratch[Part][0];
+
+   for (long Unit = First; Unit < Last; Unit++) {
+
+      //  Find the block of the result, and where its first element's inputs begin.
+
+      long Row = Unit / L.UnitsPerRow;
+      long X0 = (Unit % L.UnitsPerRow) * L.Chunk;
+      long Count = std::min(L.Chunk,L.OutDims[0] - X0);
+      long InOffset = X0 * L.InStrides[0];
+      long OutOffset = X0;
+      for (int IDim = 1; IDim < L.NOutDims; IDim++) {
+         long Index = Row % L.OutDims[IDim];
+         Row /= L.OutDims[IDim];
+         InOffset += Index * L.InStrides[IDim];
+         OutOffset += Index * L.OutStrides[IDim];
+      }
+      const float* In = L.In + InOffset;
+      float* Out = L.Out + OutOffset;
+
+      if (L.AxisStride == 1) {
+
+         //  Along the rows: each element of the result is one row of the input.
+
+         for (long Ix = 0; Ix < Count; Ix++) {
+            const float* V = In + Ix * L.InStrides[0];
+            float Value = 0.0f;
+            if (Op == Minimum) {
+               Value = RowMin(V,L.Length);
+            } else if (Op == Maximum) {
+               Value = RowMax(V,L.Length);
+            } else if (Op == ClippedMedian) {
+               std::copy(V,V + L.Length,Scratch);
+               Value = ClippedMedianOf(Scratch,L.Length,This->I_Sigma,This->I_MaxIterations);
+            } else {
+               if (Method == Kahan) Value = RowKahan(V,L.Length);
+               else if (Method == Pairwise) Value = RowPairwise(V,L.Length);
+               else Value = RowPlain(V,L.Length);
+               if (Op == Average) Value /= float(L.Length);
+            }
+            Out[Ix] = Value;
+         }
+
+      } else if (Op == ClippedMedian) {
+
+         //  Along any other axis, a median needs all the values for each element together,
+         //  so they are copied, a row at a time, into the scratch space.
+
+         for (long K = 0; K < L.Length; K++) {
+            const float* V = In + K * L.AxisStride;
+            for (long Ix = 0; Ix < Count; Ix++) Scratch[Ix * L.Length + K] = V[Ix];
+         }
+         for (long Ix = 0; Ix < Count; Ix++) {
+            Out[Ix] = ClippedMedianOf(Scratch + Ix * L.Length,L.Length,
+                                                     This->I_Sigma,This->I_MaxIterations);
+         }
+
+      } else {
+
+         //  Otherwise, whole rows are combined at a time.
+
+         if (Op == Minimum) {
+            ColMin(In,L.AxisStride,L.Length,Count,Out);
+         } else if (Op == Maximum) {
+            ColMax(In,L.AxisStride,L.Length,Count,Out);
+         } else {
+            if (Method == Kahan) ColKahan(In,L.AxisStride,L.Length,Count,Out,Scratch);
+            else if (Method == Pairwise) ColPairwise(In,L.AxisStride,L.Length,Count,Out,Scratch);
+            else ColPlain(In,L.AxisStride,L.Length,Count,Out);
+            if (Op == Average) {
+               float Length = float(L.Length);
+               for (long Ix = 0; Ix < Count; Ix++) Out[Ix] /= Length;
+            }
+         }
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         R e d u c e
+//
+//  This is the form of Reduce() that puts the result into an existing array.
+
+bool Reductions::Reduce (Operation Op, void* Address, int Axis, void* Result)
+{
+   Layout Details;
+   if (!GetLayout(Op,Address,Axis,Result,&Details)) return false;
+
+   //  Make sure each thread has the scratch space the operation needs.
+
+   size_t ScratchFloats = 0;
+   if (Op == ClippedMedian) {
+      ScratchFloats = size_t(Details.Length) * (Axis == 0 ? 1 : Details.Chunk);
+   } else if ((Op == Total || Op == Average) && Axis != 0) {
+      if (I_Accuracy == Kahan) ScratchFloats = Details.Chunk;
+      if (I_Accuracy == Pairwise) ScratchFloats = PairLevels(Details.Length) * Details.Chunk;
+   }
+   for (int Part = 0; Part < I_NThreads; Part++) {
+      if (I_Scratch[Part].size() < ScratchFloats) I_Scratch[Part].resize(ScratchFloats);
+   }
+
+   //  Split the work, if it is big enough to be worth more than one thread. The pool is
+   //  always given the same job shape - one item for each thread - and DoParts() gives the
+   //  threads beyond the number worth using nothing to do, so the split never changes the
+   //  number of parts the pool sees from one call to the next.
+
+   I_Op = Op;
+   I_Layout = Details;
+   long Elements = Details.Units * Details.Chunk * Details.Length;
+   long MaxUseful = Elements / MinElementsPerThread;
+   int NParts = int(std::min(long(I_NThreads),std::max(MaxUseful,1L)));
+   if (I_Pool && NParts > 1) {
+      I_NParts = NParts;
+      I_Pool->ParallelFor(I_NThreads,DoParts,this,I_NThreads);
+   } else {
+      DoUnits(this,0,Details.Units,0);
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         R e d u c e
+//
+//  This is the form of Reduce() that allocates an array for the result.
+
+void* Reductions::Reduce (Operation Op, void* Address, int Axis)
+{
+   int NDims = 0;
+   long Dims[3];
+   if (!ResultDims(Address,Axis,&NDims,Dims)) return NULL;
+   void* Result = NULL;
+   if (NDims == 1) Result = I_Manager.Malloc1D(sizeof(float),Dims[0]);
+   if (NDims == 2) Result = I_Manager.Malloc2D(sizeof(float),Dims[1],Dims[0]);
+   if (NDims == 3) Result = I_Manager.Malloc3D(sizeof(float),Dims[2],Dims[1],Dims[0]);
+   if (Result && !Reduce(Op,Address,Axis,Result)) {
+      I_Manager.Free(Result);
+      Result = NULL;
+   }
+   return Result;
+}
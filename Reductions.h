@@ -0,0 +1,175 @@
+//
+//                                R e d u c t i o n s . h
+//
+//  Function:
+//     Sums, means, minima, maxima and sigma-clipped medians along any axis of an array.
+//
+//  Description:
+//     The test program in ArrayManager.cpp collapses a 4D array to a 3D one, the 3D one to a
+//     2D one and so on, by adding up the elements along one axis, and that is typical of what
+//     real data reduction code does with a stack of frames - except that it usually wants a
+//     mean, or a median that ignores the odd cosmic ray, rather than a sum, and that it
+//     usually does this for frames a great deal larger than the test's. Written as plain
+//     loops with a float total, as the test does it, these are slow - the obvious loop order
+//     runs along the axis being reduced, which for any axis but the first means striding
+//     through memory, and the compiler won't vectorise a floating point sum it would have to
+//     reorder - and for big stacks not very accurate either. A Reductions object does the
+//     same operations properly, for float arrays allocated by an ArrayManager.
+//
+//     Reduce() takes an array with up to four dimensions, and an axis (0 is X, the axis along
+//     the rows, 1 is Y, and so on), and returns a new array allocated by the same manager,
+//     with that axis removed - so reducing a 3D stack of Nz frames along axis 2 gives a 2D
+//     frame. (Reducing a 1D array gives a 1D array with one element.) The caller frees the
+//     result with the manager's Free() in the usual way. A second form of Reduce() puts the
+//     result into an array the caller has already allocated, which must have the right
+//     dimensions, and is better for a test that reduces the same shape over and over. Sum(),
+//     Mean(), Min(), Max() and Median() are shorthand for the allocating form.
+//
+//     Sums, and so means, can be formed in three ways, set by SetAccuracy(). Plain sums just
+//     add the values up, in float. Kahan sums keep a running compensation for the rounding
+//     error in each addition, which makes the error almost independent of the number of
+//     values, at the cost of four operations per value instead of one. Pairwise sums add
+//     the values in pairs, then the pairs in pairs and so on, which makes the error grow as
+//     the log of the number of values rather than linearly, for not much more than the cost
+//     of the plain sum. (Kahan summation relies on the compiler doing exactly the arithmetic
+//     it is told to, so is useless if this file is compiled with -ffast-math.)
+//
+//     Median() finds the median of the values along the axis, ignoring any NaN values, which
+//     is how bad pixels are usually flagged. If SetClipping() has been used, it also rejects
+//     values more than a given number of standard deviations from the median, and repeats
+//     that with the values that are left, up to a given number of times or until no more are
+//     rejected, before taking the median of what remains. Where every value is a NaN, the
+//     result is a NaN. Sums, means, minima and maxima do not treat NaNs specially.
+//
+//     Everything is vectorised, without any instruction set specific code. Along the rows,
+//     each sum, minimum or maximum is built up in sixty-four independent partial results,
+//     which the compiler can keep in vector registers, and which are combined at the end. Along
+//     any other axis, the values to be combined for neighbouring elements of the result are
+//     themselves neighbours, so whole rows are combined at a time, in blocks of columns small
+//     enough for the partial results to stay in the level 1 cache. The work is split across
+//     a ThreadPool (see ThreadPool.h) if the constructor is asked for more than one thread.
+//     The split is over blocks of the result, and each element of the result is always
+//     formed in the same order, so the results are the same however many threads are used.
+//
+//     Errors are reported as they are by ArrayManager. The allocating routines return NULL,
+//     and the others false, if the array isn't one the manager knows about, if it has more
+//     than four dimensions, or if the axis or the result array doesn't fit it. Views made
+//     by View2D() and View3D() can be reduced, and can hold the result, as long as the planes
+//     of a 3D view are evenly spaced in the original - and they are, unless it is a view of
+//     something more unusual than an allocated or mapped array.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Views can now be reduced, using the strides from GetStride().
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __Reductions__
+#define __Reductions__
+
+#include <vector>
+
+#include "ArrayManager.h"
+#include "ThreadPool.h"
+
+class Reductions {
+public:
+   //!  The operations that can be applied along an axis.
+   enum Operation { Total, Average, Minimum, Maximum, ClippedMedian };
+   //!  The ways a sum can be formed.
+   enum Accuracy { Plain, Kahan, Pairwise };
+   //!  Constructor, for arrays from the given manager, using a given number of threads.
+   Reductions (ArrayManager& Manager, int NThreads = 1);
+   //!  Destructor. Stops any threads.
+   ~Reductions ();
+   //!  Set the way sums (and so means) are formed. The default is Pairwise.
+   void SetAccuracy (Accuracy Method) { I_Accuracy = Method; }
+   //!  Set the clipping used by Median(). A Sigma of zero (the default) means no clipping.
+   void SetClipping (float Sigma, int MaxIterations = 5);
+   //!  Apply an operation along an axis of an array, returning a new array for the result.
+   void* Reduce (Operation Op, void* Address, int Axis);
+   //!  Apply an operation along an axis of an array, putting the result in a given array.
+   bool Reduce (Operation Op, void* Address, int Axis, void* Result);
+   //!  The sum along an axis.
+   void* Sum (void* Address, int Axis) { return Reduce(Total,Address,Axis); }
+   //!  The mean along an axis.
+   void* Mean (void* Address, int Axis) { return Reduce(Average,Address,Axis); }
+   //!  The minimum along an axis.
+   void* Min (void* Address, int Axis) { return Reduce(Minimum,Address,Axis); }
+   //!  The maximum along an axis.
+   void* Max (void* Address, int Axis) { return Reduce(Maximum,Address,Axis); }
+   //!  The median along an axis, with any clipping set by SetClipping().
+   void* Median (void* Address, int Axis) { return Reduce(ClippedMedian,Address,Axis); }
+   //!  The number of threads in use.
+   int Threads (void) const { return I_NThreads; }
+private:
+   //!  The layout of an array and its reduction, as worked out by GetLayout(). Strides are
+   //!  in elements. The work is split into units, each a block of up to Chunk elements of
+   //!  one row of the result.
+   struct Layout {
+      const float* In;
+      float* Out;
+      int NOutDims;
+      long OutDims[3];
+      long InStrides[3];
+      long OutStrides[3];
+      long Length;
+      long AxisStride;
+      long Chunk;
+      long UnitsPerRow;
+      long Units;
+   };
+   //!  Work out the layout for an array, an axis and a result, returning false if they
+   //!  don't fit together.
+   bool GetLayout (Operation Op, void* Address, int Axis, void* Result, Layout* Details);
+   //!  The dimensions of the result of reducing an array along an axis.
+   bool ResultDims (void* Address, int Axis, int* NDims, long Dims[]);
+   //!  The routine the thread pool calls for each thread, which works out the units for
+   //!  that thread and passes them to DoUnits().
+   static void DoParts (void* Context, long First, long Last, int Part);
+   //!  Process a range of the units of the current reduction.
+   static void DoUnits (void* Context, long First, long Last, int Part);
+   //!  The manager the arrays come from.
+   ArrayManager& I_Manager;
+   //!  The number of threads to use.
+   int I_NThreads;
+   //!  The thread pool, if more than one thread is used.
+   ThreadPool* I_Pool;
+   //!  The way sums are formed.
+   Accuracy I_Accuracy;
+   //!  The clipping limit, in standard deviations, or zero.
+   float I_Sigma;
+   //!  The maximum number of clipping passes.
+   int I_MaxIterations;
+   //!  The operation being performed, for DoUnits().
+   Operation I_Op;
+   //!  The number of threads the current reduction is split between, for DoParts().
+   int I_NParts;
+   //!  The layout of the reduction being performed, for DoUnits().
+   Layout I_Layout;
+   //!  Working space for each thread.
+   std::vector<std::vector<float> > I_Scratch;
+   //!  Copying would stop the threads twice.
+   Reductions (const Reductions&);
+   Reductions& operator= (const Reductions&);
+};
+
+#endif
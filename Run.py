@@ -14,18 +14,76 @@
 #     compiled languages like C or Fortran - and timing them as they run.
 #
 #  Invocation:
-#     ./Run.py ntests nx ny
+#     ./Run.py [options] ntests nx ny
 #
 #     or, depending on how Python and/or Python3 have been set up:
 #
-#     python Run.py ntests nx ny          or
-#     python3 Run.py ntests nx ny
+#     python Run.py [options] ntests nx ny          or
+#     python3 Run.py [options] ntests nx ny
 #
 #     where
 #        ntests  is how many times the full test set is repeated - default 1.
 #        nx      is the number of columns in the array tested - default 2000.
 #        ny      is the number of rows in the array tested - default 10.
 #
+#     and the options are:
+#        -jobs n       the number of builds to run in parallel - default is
+#                      one for each CPU.
+#        -cpu list     run each timed test pinned to the given CPU(s) using
+#                      taskset, eg -cpu 3 or -cpu 2,3. For the steadiest
+#                      timings, these should be CPUs the kernel has been told
+#                      to keep other work off (eg using isolcpus).
+#        -cache dir    the directory used to cache built programs - default
+#                      BuildCache.
+#        -nocache      build each test just before running it, one at a time,
+#                      as this program originally did.
+#        -checkpoint file  the file the results are saved to after each test
+#                      - default RunCheckpoint.json.
+#        -resume       pick up the results saved in the checkpoint file by an
+#                      earlier run with the same array size, and only run the
+#                      tests that it doesn't include.
+#        -sweep        instead of timing each test for the one array size,
+#                      time it for a series of sizes - see below.
+#        -sizes list   the array sizes for -sweep, as a comma-separated list
+#                      of either NxxNy or just N for a square array, eg
+#                      -sizes 256,1024x512,4096. The default is square arrays
+#                      from 256 to 16384 on a side, doubling each time.
+#        -target secs  the time each test should take, for each size, in a
+#                      sweep - default 1 second.
+#
+#     Programs built by a C/C++/Fortran compiler - any build command that names
+#     its output file using -o - are built first, all of them, in parallel, and
+#     the results are saved in the cache directory, keyed on the build command,
+#     the compiler version, and the contents of the files the command uses and
+#     of all the header files. A build that has been done before, for this test
+#     or any other, isn't repeated. Once all the builds are done, the tests are
+#     run one at a time, as before. Tests whose build commands don't name their
+#     output are built just before they are run, as before.
+#
+#     Either build command for a test can instead be a list of commands, run
+#     one after the other in the same directory, and treated as a single step
+#     whose output is that of the last command. This is how the profile-guided
+#     builds work: the first step compiles an instrumented subroutine, links and
+#     runs a training program, and then recompiles the subroutine using the
+#     profile, all as a single, cacheable, step, and the second step links the
+#     program that is timed. The intermediate files never leave the scratch
+#     directory the step is built in. The profile-guided and link time
+#     optimised builds are compared with the plain builds they are variants of
+#     in a summary at the end.
+#
+#     In a sweep, the repeat count for each test and size is chosen so the test
+#     takes about the target time: it starts from the count in the test
+#     definition, scaled for the size of the array, does a short run to see how
+#     long that takes, and then sets the count for the real run. For each size,
+#     the results show the time per call, the throughput in GB/s - counting
+#     each element of the array as 4 bytes read and 4 bytes written - and the
+#     elements processed per nanosecond, together with the cache level the two
+#     arrays fit into (taken from /sys on Linux), worked out from the element
+#     size each test reports, with tests using different sizes listed apart.
+#     The points at which the arrays outgrow one level of cache and spill into
+#     the next are marked, since that is usually where the throughput changes. A sweep ignores tests that
+#     define their own array size, and doesn't use the checkpoint file.
+#
 #     This assumes that all the code files for the various test programs are
 #     in the default directory. It also assumes that the various compilers
 #     and interpreters have been installed so that the various commands
@@ -53,6 +111,54 @@
 #                    which represent more efficient ways of coding the test
 #                    program in Rust (using iterators and 'unsafe', ie unchecked
 #                    access, respectively). KS.
+#     14th Oct 2026. Added the 'C++ : typed' tests, which use the Array2D<T>
+#                    templates from ArrayTemplates.h.
+#     14th Oct 2026. Added the 'C : parallel' tests, which use the multithreaded
+#                    subroutine in cpsub.cpp with different numbers of threads.
+#     14th Oct 2026. Added the SIMD tests, which use the run-time selected
+#                    vector kernels in SimdKernels.cpp for four array layouts.
+#     14th Oct 2026. Tests can now have an optional eighth item giving the
+#                    array size, and their times are scaled to the normal size.
+#                    Added the sized 'C : raw' and 'C : streaming' tests.
+#     14th Oct 2026. Added the naive and tiled transpose and collapse tests.
+#     14th Oct 2026. Programs that time themselves using BenchHarness.h are now
+#                    timed using the median time per call they report, instead
+#                    of the elapsed time for the whole program.
+#     14th Oct 2026. The summary now includes the hardware performance counter
+#                    values per element reported by BenchHarness.h, if any.
+#     14th Oct 2026. Compiled programs are now built in parallel before the
+#                    tests are run, and cached so the same build isn't done
+#                    twice. Added the dash options, taskset pinning, and the
+#                    checkpoint file that allows an interrupted run to resume.
+#     14th Oct 2026. Added the -sweep mode, which times each test for a series
+#                    of array sizes and reports the throughput for each.
+#     14th Oct 2026. Added the 'C : frames' tests of the batched subrframes().
+#     14th Oct 2026. Added the 'C++ : expression' tests, using ArrayExpr.h.
+#     14th Oct 2026. Added the 'C : matrix' tests, using Matrix.h.
+#     14th Oct 2026. Added the 'C++ : elem' tests, for arrays of 16 and 32 bit
+#                    integers, half precision, bfloat16 and double, with a
+#                    summary of the throughput of each. The sweep now allows
+#                    for the element size given in a test's BENCH line.
+#     14th Oct 2026. Added the 'CUDA : offload' tests, which show the kernel
+#                    only and end to end throughput of a GPU.
+#     14th Oct 2026. Added the 'C++ : pipeline' tests, which read and write
+#                    the frames, and show how much of the I/O is hidden.
+#     14th Oct 2026. Added the 'C : fixed shapes' tests, which use kernels
+#                    specialised for the frame shapes listed in FixedShapes.h.
+#     14th Oct 2026. A build command can now be a list of commands. Added the
+#                    profile-guided and link time optimised 'C : raw' builds,
+#                    and a summary comparing them with the plain builds.
+#     14th Oct 2026. Added the 'C++ : indexed' tests, comparing arrays with and
+#                    without their pointer arrays.
+#     14th Oct 2026. Added the 'C : reductions' tests, of the Reductions class.
+#     14th Oct 2026. Added the 'C++ : tiled' tests, of compressed tiled arrays.
+#     14th Oct 2026. Added the 'C : parallel large' tests, which run the parallel
+#                    tests on an array big enough to use all the threads.
+#     14th Oct 2026. The sweep's cache level notes now use each test's own
+#                    element size, rather than always assuming 8 bytes.
+#     14th Oct 2026. The clang PGO and ThinLTO tests find llvm-profdata for
+#                    themselves, and are skipped if 'c++' isn't clang.
+#     14th Oct 2026. Added a 'C : reductions' test of reducing a view.
 #
 #  Copyright (c) 2019 Knave and Varlet
 #
@@ -84,6 +190,11 @@ from __future__ import (print_function,division,absolute_import)
 import subprocess
 import datetime
 import sys
+import os
+import shutil
+import hashlib
+import json
+import threading
 import numpy
 
 # ------------------------------------------------------------------------------
@@ -98,7 +209,7 @@ import numpy
 #  to standard error by the command. Command should be a single string or a
 #  list of strings, but if it is a single string it will be split (using
 #  spaces as delimiters) into a list, rather than being passed to a shell to
-#  interpret.
+#  interpret. If Cwd is specified, the command is run in that directory.
 #
 #  This is packaged as a separate routine because it's actually tricky to
 #  get right, particularly using the subprocess module. (The recent routine
@@ -111,7 +222,7 @@ import numpy
 #  output and error streams from the subprocess as well as just the status.
 #
 
-def ExecuteCommand (Command) :
+def ExecuteCommand (Command,Cwd = None) :
 
    Status = None
    
@@ -138,7 +249,7 @@ def ExecuteCommand (Command) :
    Result = ""
    try :
       Proc = subprocess.Popen(CommandList,stdout=subprocess.PIPE, \
-                                                   stderr=subprocess.PIPE)
+                                             stderr=subprocess.PIPE,cwd=Cwd)
       (Output,Errors) = Proc.communicate()
       Output = Output.decode('utf-8')
       Errors = Errors.decode('utf-8')
@@ -159,6 +270,29 @@ def ExecuteCommand (Command) :
 
    return (Status,Output,Errors)
 
+#  BuildCommands() returns the list of commands making up a build step, which
+#  a test gives either as a single command, a null string if there is no such
+#  step, or a list of commands to be run one after the other.
+
+def BuildCommands (Build) :
+
+   if (isinstance(Build,str)) :
+      if (Build == "") : return []
+      return [Build]
+   return list(Build)
+
+#  ExecuteBuild() runs the commands making up a build step, in turn, stopping
+#  at the first that fails, and returns the same as ExecuteCommand() for the
+#  last command it ran.
+
+def ExecuteBuild (Build,Cwd = None) :
+
+   (Status,Output,Errors) = (None,"","")
+   for Command in BuildCommands(Build) :
+      (Status,Output,Errors) = ExecuteCommand(Command,Cwd)
+      if (Status != None) : break
+   return (Status,Output,Errors)
+
 # ------------------------------------------------------------------------------
 
 #                   B u i l d  A n d  T i m e  P r o g r a m
@@ -171,28 +305,39 @@ def ExecuteCommand (Command) :
 #  while a C++ program may require two compilation steps, one for the
 #  subroutine that does most of the work and one to build the main program.
 #  If no build staps are required, the build strings should be null strings.
+#  Either build step can also be a list of commands, which are run in turn
+#  (see BuildCommands() below).
 #  This routine will build the program by executing the build commands, then
 #  will run it, putting together a command line formed from the command
 #  string and the parameters and timing the execution of that line. If a
 #  non-null cleanup command is passed, it will then run that to remove any
 #  intermediate files, such as the built object files and executable. It
 #  returns the total time taken for the test in seconds, together with
-#  a status code and any error output, in a (Status,Secs,Errors) tuple.
+#  a status code, any error output and the results from the benchmark harness
+#  (see below), in a (Status,Secs,Errors,Bench) tuple.
 #  Normal output from the build and execution stages is ignored. The cleanup
 #  command is always run, even if earlier commands fail, but its status
 #  and errors are always ignored in this case.
+#
+#  Test programs that use the harness in BenchHarness.h time their own calls
+#  to the test subroutine, and write a line starting 'BENCH' with the results.
+#  If that line is found in the output, the time returned is worked out from
+#  the median time per call it gives, which doesn't include the program start
+#  up, setting up the arrays or checking the results, and there's no need for
+#  a second run to estimate those. In that case Bench is the dictionary of
+#  values from the BENCH line returned by ParseBenchLine(). Otherwise it is
+#  None, and the time is the elapsed time for the whole program, less that
+#  for a run with a single repeat.
 
 def BuildAndTimeProgram (
-      BuildCommand1,BuildCommand2,ExecCommand,Nrpt,Nx,Ny,CleanupCommand) :
+      BuildCommand1,BuildCommand2,ExecCommand,Nrpt,Nx,Ny,CleanupCommand,
+                                                                 Pin = "") :
 
    Status = None
    Secs = 0.0
+   Bench = None
+   Errors = ""
    
-   #  We need at least two repeats, or we can't subtract off the overheads
-   #  associated with starting the test and checking the results.
-   
-   if (Nrpt < 2) : Nrpt = 2
-
    #  We run through the varius stages of the process, the build stage(s)
    #  and then the execution of the test program. If there is a failure, we
    #  stop there, and Errors and Status will be as returned by the failing
@@ -200,34 +345,69 @@ def BuildAndTimeProgram (
    
    #  Run the two build commands, if these are needed.
    
-   if (BuildCommand1 != "") :
-      (Status,Output,Errors) = ExecuteCommand(BuildCommand1)
-      if (Status == None) :
-         if (BuildCommand2 != "") :
-            (Status,Output,Errors) = ExecuteCommand(BuildCommand2)
+   (Status,Output,Errors) = ExecuteBuild(BuildCommand1)
+   if (Status == None) :
+      (Status,Output,Errors) = ExecuteBuild(BuildCommand2)
    if (Status == None) :
    
-      #  No problems with the build, if any. Run the command that runs the
-      #  test program, forming the command to be executed from the supplied
-      #  command and the three parameters, Nrpt,Nx,Ny. Get the time at start
-      #  and end and compute the elapsed time.
+      #  No problems with the build, if any. Run and time the test program.
       
-      Command = "%s %d %d %d" % (ExecCommand,Nrpt,Nx,Ny)
-      
-      Start = datetime.datetime.now()
-      (Status,Output,Errors) = ExecuteCommand(Command)
-      End = datetime.datetime.now()
-      Elapsed = End - Start
-      Secs = Elapsed.total_seconds()
+      (Status,Secs,Errors,Bench) = TimeProgram(ExecCommand,Nrpt,Nx,Ny,Pin)
+
+   #  If a cleanup command is supplied, we run it no matter what, but only
+   #  report its errors if everything else has gone fine so far.
 
-      #  One wrinkle. If Nrpt is very low, say less than 10, it suggests the
-      #  code being tested is quite slow, and this means the time to setup and
-      #  check the results may be a significant fraction of the measured time.
-      #  In this case, do one run with Nrpt set to 1, and allow for the time
-      #  this takes to adjust the measured value of Secs. In fact, we might
-      #  as well do this for all cases - the faster PDL tests, for example,
-      #  still have very slow checking code.
+   (Status,Errors) = Cleanup(CleanupCommand,Status,Errors)
+
+   return (Status,Secs,Errors,Bench)
+
+# ------------------------------------------------------------------------------
+
+#                          T i m e  P r o g r a m
+#
+#  TimeProgram() runs a test program that has already been built, and returns
+#  the time it took, in seconds, as described for BuildAndTimeProgram(), in a
+#  (Status,Secs,Errors,Bench) tuple. If Pin is not blank, it is a list of CPUs
+#  as accepted by taskset, and the program is run pinned to those CPUs.
 
+def TimeProgram (ExecCommand,Nrpt,Nx,Ny,Pin = "") :
+
+   Secs = 0.0
+   Bench = None
+   if (Pin != "") : ExecCommand = "taskset -c " + Pin + " " + ExecCommand
+   
+   #  We need at least two repeats, or we can't subtract off the overheads
+   #  associated with starting the test and checking the results.
+   
+   if (Nrpt < 2) : Nrpt = 2
+
+   #  Run the command that runs the test program, forming the command to be
+   #  executed from the supplied command and the three parameters, Nrpt,Nx,Ny.
+   #  Get the time at start and end and compute the elapsed time.
+      
+   Command = "%s %d %d %d" % (ExecCommand,Nrpt,Nx,Ny)
+      
+   Start = datetime.datetime.now()
+   (Status,Output,Errors) = ExecuteCommand(Command)
+   End = datetime.datetime.now()
+   Elapsed = End - Start
+   Secs = Elapsed.total_seconds()
+   Bench = ParseBenchLine(Output)
+   if (Bench != None and Bench.get("median_ns",-1.0) > 0.0) :
+      Secs = Bench["median_ns"] * 1.0e-9 * float(Nrpt)
+   else :
+      Bench = None
+
+   #  One wrinkle. If Nrpt is very low, say less than 10, it suggests the
+   #  code being tested is quite slow, and this means the time to setup and
+   #  check the results may be a significant fraction of the measured time.
+   #  In this case, do one run with Nrpt set to 1, and allow for the time
+   #  this takes to adjust the measured value of Secs. In fact, we might
+   #  as well do this for all cases - the faster PDL tests, for example,
+   #  still have very slow checking code. (This isn't needed if the program
+   #  timed itself using the benchmark harness.)
+
+   if (Status == None and Bench == None) :
       Command = "%s %d %d %d" % (ExecCommand,1,Nx,Ny)
       Start = datetime.datetime.now()
       (Status,Output,Errors) = ExecuteCommand(Command)
@@ -235,16 +415,557 @@ def BuildAndTimeProgram (
       Elapsed = End - Start
       Secs = (Secs - Elapsed.total_seconds()) * float(Nrpt) / float(Nrpt - 1)
 
-   #  If a cleanup command is supplied, we run it no matter what, but only
-   #  report its errors if everything else has gone fine so far.
+   return (Status,Secs,Errors,Bench)
+
+# ------------------------------------------------------------------------------
+
+#                               C l e a n u p
+#
+#  Cleanup() runs a test's cleanup command, if it has one, and returns the
+#  (Status,Errors) to report for the test - those passed to it if they already
+#  show a problem, otherwise those from the cleanup command.
+
+def Cleanup (CleanupCommand,Status,Errors) :
 
    if (CleanupCommand != "") :
       (CleanStatus,Output,CleanErrors) = ExecuteCommand(CleanupCommand)
       if (Status == None) :
          Status = CleanStatus
          Errors = CleanErrors
+   return (Status,Errors)
+
+# ------------------------------------------------------------------------------
+
+#                              B u i l d  C a c h e
+#
+#  These routines handle the cache of built programs. A build command can be
+#  cached if it names its output file using '-o', which is true of all the
+#  compiled tests. Each such command is given a key, which is a hash of the
+#  command itself, the version of the compiler it uses, and the contents of
+#  each file named in the command - or, for the output of an earlier build
+#  step, that step's key - and of all the header files in the directory, since
+#  there's no simple way to tell which of those a file includes. The output
+#  from the command is kept in a sub-directory of the cache directory named
+#  after the key, so a command with the same key never needs to be run again.
+#
+#  Builds are run in a scratch sub-directory of the cache directory, set up
+#  with links to the files the command needs, so that builds of, say, two
+#  different versions of csub.o can run at the same time without getting in
+#  each other's way.
+#
+#  A step made up of several commands is cached as a whole. Its key covers all
+#  its commands, and the files they use, other than files created by an
+#  earlier command in the same step - which only ever exist in the scratch
+#  directory - and only the output of the last command is kept.
+
+#  A lock so that builds running in parallel can report progress in turn, and
+#  a couple of things it is only worth working out once.
+
+PrintLock = threading.Lock()
+CompilerVersions = {}
+HeadersDigest = None
+
+#  OutputOf() returns the name of the file a command creates, ie the item
+#  following -o, or None if there isn't one.
+
+def OutputOf (Command) :
+   Items = Command.split()
+   if ("-o" in Items) :
+      Index = Items.index("-o")
+      if (Index + 1 < len(Items)) : return Items[Index + 1]
+   return None
+
+#  FileDigest() returns the hash of the contents of a file.
+
+def FileDigest (FileName) :
+   Hash = hashlib.sha1()
+   File = open(FileName,"rb")
+   Hash.update(File.read())
+   File.close()
+   return Hash.hexdigest()
+
+#  HeaderFiles() returns the names of the header files in the directory.
+
+def HeaderFiles () :
+   return sorted([Name for Name in os.listdir(".") \
+                              if Name.endswith(".h") or Name.endswith(".hpp")])
+
+#  StepOutputs() returns the set of files created by the commands of a build
+#  step, as given by BuildCommands().
+
+def StepOutputs (Commands) :
+
+   Outputs = set()
+   for Command in Commands :
+      Output = OutputOf(Command)
+      if (Output != None) : Outputs.add(Output)
+   return Outputs
+
+#  CommandKey() returns the key for a build step, given its list of commands.
+#  Produced is a dictionary giving the key for any file created by an earlier
+#  build step. A command that runs a program created by an earlier command in
+#  the step, such as a profile-guided build's training run, has no compiler
+#  version to include.
+
+def CommandKey (Commands,Produced) :
+
+   global HeadersDigest
+   if (HeadersDigest == None) :
+      Hash = hashlib.sha1()
+      for Name in HeaderFiles() : Hash.update((Name + FileDigest(Name)).encode())
+      HeadersDigest = Hash.hexdigest()
+   Internal = StepOutputs(Commands)
+   Hash = hashlib.sha1()
+   for Command in Commands :
+      Items = Command.split()
+      Compiler = Items[0]
+      if (os.path.basename(Compiler) in Internal) :
+         Version = ""
+      else :
+         if (not Compiler in CompilerVersions) :
+            (Status,Output,Errors) = ExecuteCommand(Compiler + " --version")
+            CompilerVersions[Compiler] = Output + Errors
+         Version = CompilerVersions[Compiler]
+      Hash.update((Command + Version).encode())
+      for Item in Items[1:] :
+         if (Item in Internal) : continue
+         if (Item in Produced) :
+            Hash.update((Item + Produced[Item]).encode())
+         elif (os.path.isfile(Item)) :
+            Hash.update((Item + FileDigest(Item)).encode())
+   Hash.update(HeadersDigest.encode())
+   return Hash.hexdigest()[:16]
+
+#  CachedFile() returns the name of the cached copy of the output from the
+#  command with a given key.
+
+def CachedFile (CacheDir,Key,Output) :
+   return os.path.join(CacheDir,Key,os.path.basename(Output))
+
+#  PlanBuild() works out the build steps for a test, as a list of
+#  (Commands,Key,Output,Produced) tuples, one for each step, where Commands is
+#  the list of commands for the step and Produced is the dictionary of keys
+#  for the files created by the earlier steps. If the test can't be built
+#  using the cache - if any of its commands doesn't name its output, other
+#  than one running a program the step has just built - this returns None.
+
+def PlanBuild (Test) :
+
+   Steps = []
+   Produced = {}
+   for Build in (Test[2],Test[3]) :
+      Commands = BuildCommands(Build)
+      if (len(Commands) == 0) : continue
+      Internal = StepOutputs(Commands)
+      for Command in Commands :
+         Program = os.path.basename(Command.split()[0])
+         if (OutputOf(Command) == None and not Program in Internal) :
+            return None
+      Output = OutputOf(Commands[-1])
+      if (Output == None) : return None
+      Key = CommandKey(Commands,Produced)
+      Steps.append((Commands,Key,Output,dict(Produced)))
+      Produced[Output] = Key
+   if (len(Steps) == 0) : return None
+   return Steps
+
+#  BuildStep() runs one build step, unless its output is already in the cache,
+#  and returns (Status,Errors) as for ExecuteCommand().
+
+def BuildStep (Step,CacheDir) :
+
+   (Commands,Key,Output,Produced) = Step
+   Status = None
+   Errors = ""
+   Target = CachedFile(CacheDir,Key,Output)
+   if (not os.path.exists(Target)) :
+   
+      #  Set up the scratch directory, with links to the files the commands
+      #  use and to all the header files, and copies of the outputs from
+      #  any earlier steps - but not to anything the step itself creates.
+      
+      Work = os.path.join(CacheDir,"work-" + Key)
+      if (os.path.exists(Work)) : shutil.rmtree(Work)
+      os.makedirs(Work)
+      Internal = StepOutputs(Commands)
+      Items = []
+      for Command in Commands : Items = Items + Command.split()[1:]
+      for Item in Items + HeaderFiles() :
+         Link = os.path.join(Work,Item)
+         if (Item in Internal) : continue
+         if (Item in Produced) :
+            if (not os.path.exists(Link)) :
+               shutil.copy2(CachedFile(CacheDir,Produced[Item],Item),Link)
+         elif (os.path.isfile(Item) and not os.path.exists(Link)) :
+            os.symlink(os.path.abspath(Item),Link)
+      (Status,Text,Errors) = ExecuteBuild(Commands,Work)
+      if (Status == None) :
+         if (not os.path.isdir(os.path.join(CacheDir,Key))) :
+            os.makedirs(os.path.join(CacheDir,Key))
+         shutil.move(os.path.join(Work,Output),Target)
+      shutil.rmtree(Work,ignore_errors = True)
+   return (Status,Errors)
+
+#  BuildAll() builds everything needed by a list of tests, using up to Jobs
+#  parallel builds. Each distinct step is only built once, and all the
+#  first steps are done before any of the second steps, which use their
+#  outputs. It returns a dictionary giving the build steps for each test that
+#  can use the cache (indexed by the test's LangTech and CompOpt), and a
+#  dictionary giving the (Status,Errors) for any step that failed, indexed by
+#  key.
+
+def BuildAll (Tests,CacheDir,Jobs) :
+
+   Plans = {}
+   for Test in Tests :
+      Steps = PlanBuild(Test)
+      if (Steps != None) : Plans[(Test[0],Test[1])] = Steps
+   Failures = {}
+   for Level in (0,1) :
+      ToBuild = {}
+      for Steps in Plans.values() :
+         if (Level < len(Steps)) :
+            Step = Steps[Level]
+            Earlier = [Earlier[1] for Earlier in Steps[:Level]]
+            if (len([Key for Key in Earlier if Key in Failures]) == 0) :
+               ToBuild[Step[1]] = Step
+      Keys = sorted(ToBuild.keys())
+      Needed = [Key for Key in Keys if \
+            not os.path.exists(CachedFile(CacheDir,Key,ToBuild[Key][2]))]
+      print ("Build step",Level + 1,":",len(Keys),"distinct builds,",
+                     len(Keys) - len(Needed),"already cached")
+      Done = [0]
+      
+      def Builder (Key) :
+         (Status,Errors) = BuildStep(ToBuild[Key],CacheDir)
+         PrintLock.acquire()
+         Done[0] = Done[0] + 1
+         if (Status != None) :
+            Failures[Key] = (Status,Errors)
+            print ("   Failed:"," ; ".join(ToBuild[Key][0]))
+         PrintLock.release()
+         
+      ParallelMap(Builder,Needed,Jobs)
+   return (Plans,Failures)
+
+#  ParallelMap() calls Function for each item in Items, using up to Jobs
+#  threads. (Each build is a separate process, so threads are all we need.)
+
+def ParallelMap (Function,Items,Jobs) :
+
+   Queue = list(Items)
+   Lock = threading.Lock()
+   
+   def Worker () :
+      while True :
+         Lock.acquire()
+         if (len(Queue) == 0) :
+            Lock.release()
+            return
+         Item = Queue.pop(0)
+         Lock.release()
+         Function(Item)
+         
+   Threads = []
+   for Index in range(max(1,min(Jobs,len(Queue)))) :
+      Thread = threading.Thread(target = Worker)
+      Thread.daemon = True
+      Thread.start()
+      Threads.append(Thread)
+   for Thread in Threads :
+      while Thread.is_alive() : Thread.join(0.5)
+
+#  CachedTimeProgram() runs a test whose build steps have been done using the
+#  cache. It copies the built files into the current directory, runs the test
+#  and then its cleanup command. It returns the same as BuildAndTimeProgram().
+
+def CachedTimeProgram (Steps,Failures,CacheDir,ExecCommand,Nrpt,Nx,Ny,
+                                                      CleanupCommand,Pin) :
+
+   Status = None
+   Secs = 0.0
+   Errors = ""
+   Bench = None
+   for Step in Steps :
+      if (Step[1] in Failures) :
+         (Status,Errors) = Failures[Step[1]]
+         break
+      shutil.copy2(CachedFile(CacheDir,Step[1],Step[2]),Step[2])
+   if (Status == None) :
+      (Status,Secs,Errors,Bench) = TimeProgram(ExecCommand,Nrpt,Nx,Ny,Pin)
+   (Status,Errors) = Cleanup(CleanupCommand,Status,Errors)
+   return (Status,Secs,Errors,Bench)
+
+# ------------------------------------------------------------------------------
+
+#                              C h e c k p o i n t
+#
+#  The results of each test are written to a checkpoint file as soon as it
+#  completes, so a run that is interrupted can be resumed. The file is JSON,
+#  and holds the array size and a list of entries, one for each test run,
+#  each giving the pass number, LangTech, CompOpt, status, the time for 1000
+#  iterations, and the BENCH details if there were any. It is written to a
+#  temporary file that is then renamed, so it is never left half written.
+
+def SaveCheckpoint (FileName,Nx,Ny,Completed) :
+
+   if (FileName == "") : return
+   Temp = FileName + ".tmp"
+   File = open(Temp,"w")
+   json.dump({"Nx" : Nx, "Ny" : Ny, "Completed" : Completed},File,indent = 1)
+   File.close()
+   os.rename(Temp,FileName)
+
+def LoadCheckpoint (FileName,Nx,Ny) :
+
+   Completed = []
+   if (os.path.exists(FileName)) :
+      File = open(FileName,"r")
+      Data = json.load(File)
+      File.close()
+      if (Data.get("Nx") == Nx and Data.get("Ny") == Ny) :
+         Completed = Data.get("Completed",[])
+      else :
+         print ("Checkpoint",FileName,"is for a different array size, ignored")
+   return Completed
+
+# ------------------------------------------------------------------------------
+
+#                                  S w e e p
+#
+#  These routines handle the -sweep mode, where each test is timed for a
+#  series of array sizes rather than just one. See the comments at the start
+#  of this file.
+
+#  The number of bytes moved per array element: a float read and a float
+#  written. Programs that use other element types say how big they are in
+#  their BENCH line, and that's used instead.
+
+SweepBytesPerElement = 8
+
+#  BytesPerElement() returns the bytes moved per array element by a test,
+#  given the details from its BENCH line (or None).
+
+def BytesPerElement (Bench) :
+   if (Bench != None and Bench.get("elem_bytes",0) > 0) :
+      return 2 * Bench["elem_bytes"]
+   return SweepBytesPerElement
+
+#  ParseSizes() converts a -sizes list, eg "256,1024x512", into a list of
+#  (Nx,Ny) tuples.
+
+def ParseSizes (List) :
+   Sizes = []
+   for Item in List.split(",") :
+      if (Item == "") : continue
+      if ("x" in Item) :
+         Values = Item.split("x")
+         Sizes.append((int(Values[0]),int(Values[1])))
+      else :
+         Sizes.append((int(Item),int(Item)))
+   return Sizes
+
+#  CacheLevels() returns a list of (name,bytes) tuples for the data caches of
+#  the first CPU, smallest first, eg [("L1",49152),("L2",2097152),...]. This
+#  only works on Linux - elsewhere, the list is empty.
+
+def CacheLevels () :
+   Levels = []
+   Base = "/sys/devices/system/cpu/cpu0/cache"
+   if (os.path.isdir(Base)) :
+      for Index in sorted(os.listdir(Base)) :
+         Dir = os.path.join(Base,Index)
+         try :
+            Level = open(os.path.join(Dir,"level")).read().strip()
+            Type = open(os.path.join(Dir,"type")).read().strip()
+            Size = open(os.path.join(Dir,"size")).read().strip()
+         except :
+            continue
+         if (Type == "Instruction") : continue
+         Scale = 1
+         if (Size.endswith("K")) : Scale = 1024
+         if (Size.endswith("M")) : Scale = 1024 * 1024
+         Size = Size.rstrip("KM")
+         if (Size.isdigit()) : Levels.append(("L" + Level,int(Size) * Scale))
+   Levels.sort(key = lambda Level : Level[1])
+   return Levels
+
+#  FitsIn() returns the name of the smallest cache that will hold the given
+#  number of bytes, or "DRAM" if none will.
+
+def FitsIn (Bytes,Levels) :
+   for (Name,Size) in Levels :
+      if (Bytes <= Size) : return Name
+   return "DRAM"
+
+#  SweepTest() times one test for each of a list of sizes. The program is
+#  built - or copied from the cache, if Steps says it's there - once, and
+#  cleaned up at the end. It returns a list with an entry for each size, which
+#  is either the time per call in seconds, or None if the test failed, and the
+#  number of bytes the test moves per array element.
+
+def SweepTest (Test,Steps,Failures,CacheDir,Nx,Ny,Sizes,Target,Pin) :
+
+   Status = None
+   Errors = ""
+   Times = [None] * len(Sizes)
+   Bytes = SweepBytesPerElement
+   if (Steps != None) :
+      for Step in Steps :
+         if (Step[1] in Failures) :
+            (Status,Errors) = Failures[Step[1]]
+            break
+         shutil.copy2(CachedFile(CacheDir,Step[1],Step[2]),Step[2])
+   else :
+      for Build in (Test[2],Test[3]) :
+         if (Status == None) : (Status,Output,Errors) = ExecuteBuild(Build)
+   if (Status == None) :
+      for Index in range(len(Sizes)) :
+         (SNx,SNy) = Sizes[Index]
+         
+         #  A short run, about a twentieth of the scaled repeat count, shows
+         #  roughly how long each call takes, and so how many we need.
+         
+         Nrpt = int(float(Test[5]) * float(Nx * Ny) / float(SNx * SNy))
+         Probe = max(2,Nrpt // 20)
+         (Status,Secs,Errors,Bench) = TimeProgram(Test[4],Probe,SNx,SNy,Pin)
+         if (Status == None) :
+            PerCall = max(Secs / float(Probe),1.0e-9)
+            Nrpt = max(2,int(Target / PerCall))
+            (Status,Secs,Errors,Bench) = TimeProgram(Test[4],Nrpt,SNx,SNy,Pin)
+         if (Status != None) :
+            print (Test[0],Test[1],SNx,"x",SNy,"Error:",Status,Errors)
+            Status = None
+            continue
+         Times[Index] = Secs / float(Nrpt)
+         Elements = float(SNx * SNy)
+         Bytes = BytesPerElement(Bench)
+         print ("%24s %20s %6d x %-6d Rept: %9d Per call: %10.4g us, "
+                "%8.3f GB/s" % (Test[0],Test[1],SNx,SNy,Nrpt,
+                Times[Index] * 1.0e6,Elements * Bytes / Times[Index] * 1.0e-9))
+   else :
+      print (Test[0],Test[1],"Error:",Status,Errors)
+   (Status,Errors) = Cleanup(Test[6],None,"")
+   return (Times,Bytes)
+
+#  RunSweep() runs the sweep for all the tests and prints the results.
+
+def RunSweep (Tests,Plans,Failures,CacheDir,Nx,Ny,Sizes,Target,Pin) :
+
+   Levels = CacheLevels()
+   print ("")
+   print ("Sweeping array sizes, aiming for",Target,"seconds per test and size")
+   Line = "Data caches:"
+   for (Name,Size) in Levels : Line = Line + " %s %d KB" % (Name,Size // 1024)
+   if (len(Levels) == 0) : Line = Line + " unknown"
+   print (Line)
+   print ("")
+   AllTimes = []
+   AllBytes = []
+   for Test in Tests :
+      (Times,Bytes) = SweepTest(Test,Plans.get((Test[0],Test[1])),Failures,
+                                           CacheDir,Nx,Ny,Sizes,Target,Pin)
+      AllTimes.append(Times)
+      AllBytes.append(Bytes)
+   
+   #  For each size, the working set and where it fits, marking the sizes
+   #  where it moves out of one level of the cache hierarchy into the next.
+   #  The working set depends on the size of the elements, so tests that use
+   #  different element types each get their own list.
+   
+   Groups = sorted(set(AllBytes))
+   print ("")
+   print ("Array sizes swept:")
+   for GroupBytes in Groups :
+      print ("")
+      if (len(Groups) > 1) :
+         print ("For tests moving %d bytes per element:" % GroupBytes)
+      Previous = ""
+      for (SNx,SNy) in Sizes :
+         Bytes = SNx * SNy * GroupBytes
+         Level = FitsIn(Bytes,Levels)
+         Note = ""
+         if (Previous != "" and Level != Previous) :
+            Note = "  <- spills from " + Previous + " to " + Level
+         print ("%6d x %-6d working set %10.1f KB, fits in %-4s%s" %
+                                    (SNx,SNy,Bytes / 1024.0,Level,Note))
+         Previous = Level
+      
+   #  Then the throughput, in GB/s and in elements per nanosecond, for each
+   #  test and size, with the tests grouped by element size so that the line
+   #  showing where each size fits applies to all the tests below it.
+   
+   for (Title,InBytes) in (("GB/s",True),("Elements/ns",False)) :
+      print ("")
+      print ("Throughput,",Title + ":")
+      print ("")
+      Line = "%45s" % ""
+      for (SNx,SNy) in Sizes :
+         Line = Line + " %11s" % ("%dx%d" % (SNx,SNy))
+      print (Line)
+      Order = sorted(range(len(Tests)),key = lambda Index : AllBytes[Index])
+      GroupBytes = None
+      for Index in Order :
+         if (AllBytes[Index] != GroupBytes) :
+            GroupBytes = AllBytes[Index]
+            Line = "%45s" % ("(%d bytes per element)" % GroupBytes)
+            for (SNx,SNy) in Sizes :
+               Line = Line + " %11s" % FitsIn(SNx * SNy * AllBytes[Index],Levels)
+            print (Line)
+         Line = "%24s %20s" % (Tests[Index][0],Tests[Index][1])
+         Scale = 1
+         if (InBytes) : Scale = AllBytes[Index]
+         for ISize in range(len(Sizes)) :
+            Time = AllTimes[Index][ISize]
+            (SNx,SNy) = Sizes[ISize]
+            if (Time == None) :
+               Line = Line + " %11s" % "-"
+            else :
+               Line = Line + " %11.3f" % (SNx * SNy * Scale / Time * 1.0e-9)
+         print (Line)
+   
+   #  And the GB/s figures as .csv, for a spreadsheet.
+   
+   print ("")
+   Line = "Test"
+   for (SNx,SNy) in Sizes : Line = Line + ",%dx%d" % (SNx,SNy)
+   print (Line)
+   for Index in range(len(Tests)) :
+      Line = Tests[Index][0] + " " + Tests[Index][1]
+      for ISize in range(len(Sizes)) :
+         Time = AllTimes[Index][ISize]
+         (SNx,SNy) = Sizes[ISize]
+         if (Time == None) : Line = Line + ","
+         else : Line = Line + ",%.3f" % \
+                              (SNx * SNy * AllBytes[Index] / Time * 1.0e-9)
+      print (Line)
 
-   return (Status,Secs,Errors)
+# ------------------------------------------------------------------------------
+
+#                      P a r s e  B e n c h  L i n e
+#
+#  ParseBenchLine() looks through the output from a test program for the line
+#  starting 'BENCH' written by the benchmark harness in BenchHarness.h. That
+#  line is a set of key=value items, and this returns them as a dictionary,
+#  with the values converted to numbers where possible. If there is no such
+#  line, it returns None. If the harness reported that the test failed its
+#  check, this returns None as well, so the result isn't used.
+
+def ParseBenchLine (Output) :
+
+   Bench = None
+   for Line in Output.splitlines() :
+      if (Line.startswith("BENCH ")) :
+         Bench = {}
+         for Item in Line.split()[1:] :
+            if ("=" in Item) :
+               (Key,Value) = Item.split("=",1)
+               try :
+                  Bench[Key] = float(Value)
+               except ValueError :
+                  Bench[Key] = Value
+   if (Bench != None and Bench.get("status","") != "ok") : Bench = None
+   return Bench
 
 # ------------------------------------------------------------------------------
 
@@ -728,6 +1449,1105 @@ CNumRgccO3native = [
    5000000,
    "rm -f cnrmain cnrsub.o"]
 
+TypedCclangO3 = [
+   "C++ : typed",
+   "clang -O3",
+   "c++ -c -O3 ctsub.cpp -o ctsub.o",
+   "c++ -o ctmain -O3 ctmain.cpp ctsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctmain",
+   1000000,
+   "rm -f ctmain ctsub.o"]
+
+TypedCclangO3native = [
+   "C++ : typed",
+   "clang -O3 native",
+   "c++ -c -O3 -march=native ctsub.cpp -o ctsub.o",
+   "c++ -o ctmain -O3 -march=native ctmain.cpp ctsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctmain",
+   5000000,
+   "rm -f ctmain ctsub.o"]
+
+TypedCgccO3 = [
+   "C++ : typed",
+   "g++ -O3",
+   "g++ -c -O3 ctsub.cpp -o ctsub.o",
+   "g++ -o ctmain -O3 ctmain.cpp ctsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctmain",
+   1000000,
+   "rm -f ctmain ctsub.o"]
+
+TypedCgccO3native = [
+   "C++ : typed",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native ctsub.cpp -o ctsub.o",
+   "g++ -o ctmain -O3 -march=native ctmain.cpp ctsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctmain",
+   5000000,
+   "rm -f ctmain ctsub.o"]
+
+#  The 'C : parallel' tests use the multithreaded subroutine in cpsub.cpp,
+#  which splits the rows between a number of threads. Note that it only uses
+#  more than one thread if each gets at least 32K elements, so with the default
+#  array size these all run on one thread, and show only that the threading
+#  costs nothing for small arrays. The 'C : parallel large' tests are the same
+#  programs run on a 2000 by 2000 array, big enough for every thread to get
+#  its share, and they are the ones that show how it scales with the number
+#  of threads.
+
+ParCgccO3T1 = [
+   "C : parallel",
+   "g++ -O3 1 thread",
+   "g++ -c -O3 -DSUBR_THREADS=1 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   1000000,
+   "rm -f cpmain cpsub.o"]
+
+ParCgccO3T2 = [
+   "C : parallel",
+   "g++ -O3 2 threads",
+   "g++ -c -O3 -DSUBR_THREADS=2 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   1000000,
+   "rm -f cpmain cpsub.o"]
+
+ParCgccO3T4 = [
+   "C : parallel",
+   "g++ -O3 4 threads",
+   "g++ -c -O3 -DSUBR_THREADS=4 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   1000000,
+   "rm -f cpmain cpsub.o"]
+
+ParCgccO3T8 = [
+   "C : parallel",
+   "g++ -O3 8 threads",
+   "g++ -c -O3 -DSUBR_THREADS=8 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   1000000,
+   "rm -f cpmain cpsub.o"]
+
+ParCgccO3All = [
+   "C : parallel",
+   "g++ -O3 all threads",
+   "g++ -c -O3 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   1000000,
+   "rm -f cpmain cpsub.o"]
+
+ParCgccO3T1Large = [
+   "C : parallel large",
+   "g++ -O3 1 thread",
+   "g++ -c -O3 -DSUBR_THREADS=1 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   200,
+   "rm -f cpmain cpsub.o",
+   [2000,2000]]
+
+ParCgccO3T2Large = [
+   "C : parallel large",
+   "g++ -O3 2 threads",
+   "g++ -c -O3 -DSUBR_THREADS=2 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   200,
+   "rm -f cpmain cpsub.o",
+   [2000,2000]]
+
+ParCgccO3T4Large = [
+   "C : parallel large",
+   "g++ -O3 4 threads",
+   "g++ -c -O3 -DSUBR_THREADS=4 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   200,
+   "rm -f cpmain cpsub.o",
+   [2000,2000]]
+
+ParCgccO3T8Large = [
+   "C : parallel large",
+   "g++ -O3 8 threads",
+   "g++ -c -O3 -DSUBR_THREADS=8 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   200,
+   "rm -f cpmain cpsub.o",
+   [2000,2000]]
+
+ParCgccO3AllLarge = [
+   "C : parallel large",
+   "g++ -O3 all threads",
+   "g++ -c -O3 cpsub.cpp -o cpsub.o",
+   "g++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp"
+   " -lpthread",
+   "./cpmain",
+   200,
+   "rm -f cpmain cpsub.o",
+   [2000,2000]]
+
+#  The SIMD tests use the run-time selected vector kernels in SimdKernels.cpp,
+#  with the versions of subr() in csimdsub.cpp (flat arrays, Numerical Recipes
+#  row pointers and vectors of vectors) and cbsimdsub.cpp (Boost arrays). They
+#  are deliberately not compiled with -march=native - the point is that the
+#  same binary picks the best kernel for whatever machine it runs on.
+
+SimdFlatCclangO3 = [
+   "C : SIMD flat",
+   "clang -O3",
+   "c++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "c++ -o simdflat -O3 cmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdflat",
+   5000000,
+   "rm -f simdflat csimdsub.o"]
+
+SimdNumRCclangO3 = [
+   "C : SIMD num. rec.",
+   "clang -O3",
+   "c++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "c++ -o simdnr -O3 cnrmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdnr",
+   5000000,
+   "rm -f simdnr csimdsub.o"]
+
+SimdVecCclangO3 = [
+   "C : SIMD vectors",
+   "clang -O3",
+   "c++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "c++ -o simdvec -O3 cvmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdvec",
+   5000000,
+   "rm -f simdvec csimdsub.o"]
+
+SimdBoostCclangO3 = [
+   "C : SIMD Boost",
+   "clang -O3",
+   "c++ -c -O3 cbsimdsub.cpp -o cbsimdsub.o",
+   "c++ -o simdboost -O3 cbmain.cpp cbsimdsub.o SimdKernels.cpp",
+   "./simdboost",
+   5000000,
+   "rm -f simdboost cbsimdsub.o"]
+
+SimdFlatCgccO3 = [
+   "C : SIMD flat",
+   "g++ -O3",
+   "g++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "g++ -o simdflat -O3 cmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdflat",
+   5000000,
+   "rm -f simdflat csimdsub.o"]
+
+SimdNumRCgccO3 = [
+   "C : SIMD num. rec.",
+   "g++ -O3",
+   "g++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "g++ -o simdnr -O3 cnrmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdnr",
+   5000000,
+   "rm -f simdnr csimdsub.o"]
+
+SimdVecCgccO3 = [
+   "C : SIMD vectors",
+   "g++ -O3",
+   "g++ -c -O3 csimdsub.cpp -o csimdsub.o",
+   "g++ -o simdvec -O3 cvmain.cpp csimdsub.o SimdKernels.cpp",
+   "./simdvec",
+   5000000,
+   "rm -f simdvec csimdsub.o"]
+
+SimdBoostCgccO3 = [
+   "C : SIMD Boost",
+   "g++ -O3",
+   "g++ -c -O3 cbsimdsub.cpp -o cbsimdsub.o",
+   "g++ -o simdboost -O3 cbmain.cpp cbsimdsub.o SimdKernels.cpp",
+   "./simdboost",
+   5000000,
+   "rm -f simdboost cbsimdsub.o"]
+
+#  The sized tests compare the plain flat array code in csub.cpp with the
+#  streaming version in cstreamsub.cpp, which uses non-temporal stores for
+#  arrays larger than the last level cache, for a series of array sizes
+#  chosen to fit within L1, L2 and the last level cache, and then to need
+#  main memory. (The In and Out arrays together are about 16 KBytes, 256
+#  KBytes, 8 MBytes, 128 MBytes and 512 MBytes.) These use the optional
+#  eighth item in the test definition, [Nx,Ny], to set the array size. Their
+#  times are scaled to the size used for the other tests, so up to the point
+#  where the arrays no longer fit in the cache, they should be much the same
+#  as the normal 'C : raw g++ -O3' test. The repeat counts are scaled down
+#  as the arrays get bigger.
+
+RawCgccO3L1 = [
+   "C : raw",
+   "g++ -O3 L1 size",
+   "g++ -c -O3 csub.cpp -o csub.o",
+   "g++ -o cmain -O3 cmain.cpp csub.o",
+   "./cmain",
+   2000000,
+   "rm -f cmain csub.o",
+   [512,4]]
+
+StreamCgccO3L1 = [
+   "C : streaming",
+   "g++ -O3 L1 size",
+   "g++ -c -O3 cstreamsub.cpp -o cstreamsub.o",
+   "g++ -o cmain -O3 cmain.cpp cstreamsub.o",
+   "./cmain",
+   2000000,
+   "rm -f cmain cstreamsub.o",
+   [512,4]]
+
+RawCgccO3L2 = [
+   "C : raw",
+   "g++ -O3 L2 size",
+   "g++ -c -O3 csub.cpp -o csub.o",
+   "g++ -o cmain -O3 cmain.cpp csub.o",
+   "./cmain",
+   125000,
+   "rm -f cmain csub.o",
+   [1000,32]]
+
+StreamCgccO3L2 = [
+   "C : streaming",
+   "g++ -O3 L2 size",
+   "g++ -c -O3 cstreamsub.cpp -o cstreamsub.o",
+   "g++ -o cmain -O3 cmain.cpp cstreamsub.o",
+   "./cmain",
+   125000,
+   "rm -f cmain cstreamsub.o",
+   [1000,32]]
+
+RawCgccO3LLC = [
+   "C : raw",
+   "g++ -O3 LLC size",
+   "g++ -c -O3 csub.cpp -o csub.o",
+   "g++ -o cmain -O3 cmain.cpp csub.o",
+   "./cmain",
+   4000,
+   "rm -f cmain csub.o",
+   [2000,500]]
+
+StreamCgccO3LLC = [
+   "C : streaming",
+   "g++ -O3 LLC size",
+   "g++ -c -O3 cstreamsub.cpp -o cstreamsub.o",
+   "g++ -o cmain -O3 cmain.cpp cstreamsub.o",
+   "./cmain",
+   4000,
+   "rm -f cmain cstreamsub.o",
+   [2000,500]]
+
+RawCgccO3DRAM = [
+   "C : raw",
+   "g++ -O3 DRAM size",
+   "g++ -c -O3 csub.cpp -o csub.o",
+   "g++ -o cmain -O3 cmain.cpp csub.o",
+   "./cmain",
+   250,
+   "rm -f cmain csub.o",
+   [4000,4000]]
+
+StreamCgccO3DRAM = [
+   "C : streaming",
+   "g++ -O3 DRAM size",
+   "g++ -c -O3 cstreamsub.cpp -o cstreamsub.o",
+   "g++ -o cmain -O3 cmain.cpp cstreamsub.o",
+   "./cmain",
+   250,
+   "rm -f cmain cstreamsub.o",
+   [4000,4000]]
+
+RawCgccO38k = [
+   "C : raw",
+   "g++ -O3 8k frame",
+   "g++ -c -O3 csub.cpp -o csub.o",
+   "g++ -o cmain -O3 cmain.cpp csub.o",
+   "./cmain",
+   60,
+   "rm -f cmain csub.o",
+   [8192,8192]]
+
+StreamCgccO38k = [
+   "C : streaming",
+   "g++ -O3 8k frame",
+   "g++ -c -O3 cstreamsub.cpp -o cstreamsub.o",
+   "g++ -o cmain -O3 cmain.cpp cstreamsub.o",
+   "./cmain",
+   60,
+   "rm -f cmain cstreamsub.o",
+   [8192,8192]]
+
+#  The transpose and collapse tests time operations that can't work along the
+#  rows of their arrays: a 2D transpose (ctransmain.cpp) and the collapse of a
+#  3D array into 2D by summing along Z (ccollmain.cpp, always with 8 planes).
+#  The naive versions in cnaivesub.cpp are compared with the cache-blocked
+#  versions in ctilesub.cpp, which use Tiling.h. At the normal size everything
+#  fits in the cache and there should be little difference, so each is also
+#  run with 4000 by 4000 arrays, which don't.
+
+NaiveTransCgccO3 = [
+   "C : naive transpose",
+   "g++ -O3",
+   "g++ -c -O3 cnaivesub.cpp -o cnaivesub.o",
+   "g++ -o ctransmain -O3 ctransmain.cpp cnaivesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctransmain",
+   100000,
+   "rm -f ctransmain cnaivesub.o"]
+
+NaiveTransCgccO3Big = [
+   "C : naive transpose",
+   "g++ -O3 4000x4000",
+   "g++ -c -O3 cnaivesub.cpp -o cnaivesub.o",
+   "g++ -o ctransmain -O3 ctransmain.cpp cnaivesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctransmain",
+   50,
+   "rm -f ctransmain cnaivesub.o",
+   [4000,4000]]
+
+TiledTransCgccO3 = [
+   "C : tiled transpose",
+   "g++ -O3",
+   "g++ -c -O3 ctilesub.cpp -o ctilesub.o",
+   "g++ -o ctransmain -O3 ctransmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctransmain",
+   100000,
+   "rm -f ctransmain ctilesub.o"]
+
+TiledTransCgccO3Big = [
+   "C : tiled transpose",
+   "g++ -O3 4000x4000",
+   "g++ -c -O3 ctilesub.cpp -o ctilesub.o",
+   "g++ -o ctransmain -O3 ctransmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctransmain",
+   50,
+   "rm -f ctransmain ctilesub.o",
+   [4000,4000]]
+
+NaiveCollCgccO3 = [
+   "C : naive collapse",
+   "g++ -O3",
+   "g++ -c -O3 cnaivesub.cpp -o cnaivesub.o",
+   "g++ -o ccollmain -O3 ccollmain.cpp cnaivesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ccollmain",
+   20000,
+   "rm -f ccollmain cnaivesub.o"]
+
+NaiveCollCgccO3Big = [
+   "C : naive collapse",
+   "g++ -O3 4000x4000",
+   "g++ -c -O3 cnaivesub.cpp -o cnaivesub.o",
+   "g++ -o ccollmain -O3 ccollmain.cpp cnaivesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ccollmain",
+   10,
+   "rm -f ccollmain cnaivesub.o",
+   [4000,4000]]
+
+TiledCollCgccO3 = [
+   "C : tiled collapse",
+   "g++ -O3",
+   "g++ -c -O3 ctilesub.cpp -o ctilesub.o",
+   "g++ -o ccollmain -O3 ccollmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ccollmain",
+   20000,
+   "rm -f ccollmain ctilesub.o"]
+
+TiledCollCgccO3Big = [
+   "C : tiled collapse",
+   "g++ -O3 4000x4000",
+   "g++ -c -O3 ctilesub.cpp -o ctilesub.o",
+   "g++ -o ccollmain -O3 ccollmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ccollmain",
+   10,
+   "rm -f ccollmain ctilesub.o",
+   [4000,4000]]
+
+#  The 'C : frames' tests process a stack of 8 frames held in a 3D array,
+#  either by calling the 2D subr() in cnrsub.cpp for each frame in turn, or
+#  by calling the batched subrframes() in cbatchsub.cpp once for the whole
+#  stack, using one thread or all of them. The times are for the whole stack,
+#  so aren't directly comparable with the single frame tests. The 1000x1000
+#  versions use frames big enough for threads to be worth using.
+
+FramesPlaneCgccO3 = [
+   "C : frames, per plane",
+   "g++ -O3",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cbatchplane -O3 -DPER_PLANE cbatchmain.cpp cnrsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cbatchplane",
+   100000,
+   "rm -f cbatchplane cnrsub.o"]
+
+FramesBatchCgccO3 = [
+   "C : frames, batched",
+   "g++ -O3",
+   "g++ -c -O3 -DSUBR_THREADS=1 cbatchsub.cpp -o cbatchsub.o",
+   "g++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./cbatchmain",
+   100000,
+   "rm -f cbatchmain cbatchsub.o"]
+
+FramesBatchCgccO3All = [
+   "C : frames, batched",
+   "g++ -O3 all threads",
+   "g++ -c -O3 cbatchsub.cpp -o cbatchsub.o",
+   "g++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./cbatchmain",
+   100000,
+   "rm -f cbatchmain cbatchsub.o"]
+
+FramesPlaneCgccO3Big = [
+   "C : frames, per plane",
+   "g++ -O3 1000x1000",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cbatchplane -O3 -DPER_PLANE cbatchmain.cpp cnrsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cbatchplane",
+   500,
+   "rm -f cbatchplane cnrsub.o",
+   [1000,1000]]
+
+FramesBatchCgccO3Big = [
+   "C : frames, batched",
+   "g++ -O3 1000x1000",
+   "g++ -c -O3 -DSUBR_THREADS=1 cbatchsub.cpp -o cbatchsub.o",
+   "g++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./cbatchmain",
+   500,
+   "rm -f cbatchmain cbatchsub.o",
+   [1000,1000]]
+
+FramesBatchCgccO3AllBig = [
+   "C : frames, batched",
+   "g++ -O3 all threads 1000x1000",
+   "g++ -c -O3 cbatchsub.cpp -o cbatchsub.o",
+   "g++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./cbatchmain",
+   500,
+   "rm -f cbatchmain cbatchsub.o",
+   [1000,1000]]
+
+#  The 'C++ : expression' tests use the version of subr() in cexprsub.cpp,
+#  which writes the operation as an array expression (see ArrayExpr.h), with
+#  the same main program as the 'C++ : typed' tests.
+
+ExprCclangO3 = [
+   "C++ : expression",
+   "clang -O3",
+   "c++ -c -O3 cexprsub.cpp -o cexprsub.o",
+   "c++ -o cexprmain -O3 ctmain.cpp cexprsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cexprmain",
+   5000000,
+   "rm -f cexprmain cexprsub.o"]
+
+ExprCgccO3 = [
+   "C++ : expression",
+   "g++ -O3",
+   "g++ -c -O3 cexprsub.cpp -o cexprsub.o",
+   "g++ -o cexprmain -O3 ctmain.cpp cexprsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cexprmain",
+   5000000,
+   "rm -f cexprmain cexprsub.o"]
+
+#  The 'C : matrix' tests use the Matrix<float> container in Matrix.h, which
+#  keeps the rows in one contiguous block, in place of the vector of vectors
+#  used by the 'C : vectors' tests, with the same main program and subroutine
+#  code otherwise.
+
+MatrixCclangO3 = [
+   "C : matrix",
+   "clang -O3",
+   "c++ -c -O3 cvsub.cpp -o cvsub.o",
+   "c++ -o cvmatrix -O3 -DUSE_MATRIX cvmain.cpp cvsub.o",
+   "./cvmatrix",
+   1000000,
+   "rm -f cvmatrix cvsub.o"]
+
+MatrixCgccO3 = [
+   "C : matrix",
+   "g++ -O3",
+   "g++ -c -O3 cvsub.cpp -o cvsub.o",
+   "g++ -o cvmatrix -O3 -DUSE_MATRIX cvmain.cpp cvsub.o",
+   "./cvmatrix",
+   1000000,
+   "rm -f cvmatrix cvsub.o"]
+
+#  The 'C++ : elem' tests use the versions of subr() in celemsub.cpp, with the
+#  main program in celemmain.cpp, to run the same operation on arrays of each
+#  of the element types in ElementTypes.h. The arithmetic is done in a wider
+#  type, in registers, so the 16-bit types move half the bytes that float
+#  does, and the summary shows the throughput of each against that of float.
+#  Each program checks its results to the accuracy its type allows. They use
+#  arrays big enough to spill out of most caches, since that is where moving
+#  fewer bytes makes a difference.
+
+ElemInt16CgccO3 = [
+   "C++ : elem int16",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemint16 -O3 -march=native -DELEMENT=int16_t celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemint16",
+   200,
+   "rm -f celemint16 celemsub.o",
+   [2000,2000]]
+
+ElemUint16CgccO3 = [
+   "C++ : elem uint16",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemuint16 -O3 -march=native -DELEMENT=uint16_t celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemuint16",
+   200,
+   "rm -f celemuint16 celemsub.o",
+   [2000,2000]]
+
+ElemInt32CgccO3 = [
+   "C++ : elem int32",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemint32 -O3 -march=native -DELEMENT=int32_t celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemint32",
+   200,
+   "rm -f celemint32 celemsub.o",
+   [2000,2000]]
+
+ElemFp16CgccO3 = [
+   "C++ : elem fp16",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemfp16 -O3 -march=native -DELEMENT=Half celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemfp16",
+   200,
+   "rm -f celemfp16 celemsub.o",
+   [2000,2000]]
+
+ElemBf16CgccO3 = [
+   "C++ : elem bf16",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celembf16 -O3 -march=native -DELEMENT=BFloat16 celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celembf16",
+   200,
+   "rm -f celembf16 celemsub.o",
+   [2000,2000]]
+
+ElemFloatCgccO3 = [
+   "C++ : elem float",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemfloat -O3 -march=native -DELEMENT=float celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemfloat",
+   200,
+   "rm -f celemfloat celemsub.o",
+   [2000,2000]]
+
+ElemDoubleCgccO3 = [
+   "C++ : elem double",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native celemsub.cpp -o celemsub.o",
+   "g++ -o celemdouble -O3 -march=native -DELEMENT=double celemmain.cpp celemsub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./celemdouble",
+   200,
+   "rm -f celemdouble celemsub.o",
+   [2000,2000]]
+
+#  The 'CUDA : offload' tests use the kernel in cgpusub.cu, with the main
+#  program in cgpumain.cpp, to process a stack of 8 frames on a GPU. The time
+#  is the end to end time, including copying the frames to the GPU and back;
+#  the time for the kernels alone is shown as well. The variants use only one
+#  CUDA stream, so the copies can't overlap the processing, and ordinary
+#  pageable host memory rather than pinned memory. They need nvcc and a GPU.
+
+GpuCudaO3 = [
+   "CUDA : offload",
+   "nvcc -O3",
+   "nvcc -c -O3 cgpusub.cu -o cgpusub.o",
+   "nvcc -o cgpumain -O3 cgpumain.cpp cgpusub.o GpuArrayManager.cpp ArrayManager.cpp ArrayAllocator.cpp",
+   "./cgpumain",
+   200,
+   "rm -f cgpumain cgpusub.o",
+   [2000,2000]]
+
+GpuCudaO3OneStream = [
+   "CUDA : offload",
+   "nvcc -O3 1 stream",
+   "nvcc -c -O3 cgpusub.cu -o cgpusub.o",
+   "nvcc -o cgpumain -O3 cgpumain.cpp cgpusub.o GpuArrayManager.cpp ArrayManager.cpp ArrayAllocator.cpp",
+   "env GPU_STREAMS=1 ./cgpumain",
+   200,
+   "rm -f cgpumain cgpusub.o",
+   [2000,2000]]
+
+GpuCudaO3Pageable = [
+   "CUDA : offload",
+   "nvcc -O3 pageable",
+   "nvcc -c -O3 cgpusub.cu -o cgpusub.o",
+   "nvcc -o cgpumain -O3 cgpumain.cpp cgpusub.o GpuArrayManager.cpp ArrayManager.cpp ArrayAllocator.cpp",
+   "env GPU_PINNED=0 ./cgpumain",
+   200,
+   "rm -f cgpumain cgpusub.o",
+   [2000,2000]]
+
+#  The 'C++ : pipeline' tests use the subr() in cnrsub.cpp, with the main
+#  program in cpipemain.cpp, which reads each frame from a file and writes the
+#  results to another, using a FramePipeline (see FramePipeline.h). The serial
+#  tests read, process and write each frame in turn, and the overlapped tests
+#  read ahead and write behind while the processing is done, and show how much
+#  of the I/O time that hides. The direct tests use O_DIRECT, so the frames
+#  don't simply come from the page cache.
+
+PipeCgccO3Serial = [
+   "C++ : pipeline",
+   "g++ -O3 serial",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cpipemain -O3 cpipemain.cpp cnrsub.o FramePipeline.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env PIPE_MODE=serial ./cpipemain",
+   200,
+   "rm -f cpipemain cnrsub.o",
+   [2000,2000]]
+
+PipeCgccO3 = [
+   "C++ : pipeline",
+   "g++ -O3 overlapped",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cpipemain -O3 cpipemain.cpp cnrsub.o FramePipeline.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./cpipemain",
+   200,
+   "rm -f cpipemain cnrsub.o",
+   [2000,2000]]
+
+PipeCgccO3DirectSerial = [
+   "C++ : pipeline",
+   "g++ -O3 direct serial",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cpipemain -O3 cpipemain.cpp cnrsub.o FramePipeline.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env PIPE_MODE=serial PIPE_DIRECT=1 ./cpipemain",
+   200,
+   "rm -f cpipemain cnrsub.o",
+   [2000,2000]]
+
+PipeCgccO3Direct = [
+   "C++ : pipeline",
+   "g++ -O3 direct",
+   "g++ -c -O3 cnrsub.cpp -o cnrsub.o",
+   "g++ -o cpipemain -O3 cpipemain.cpp cnrsub.o FramePipeline.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env PIPE_DIRECT=1 ./cpipemain",
+   200,
+   "rm -f cpipemain cnrsub.o",
+   [2000,2000]]
+
+FixedCgccO3 = [
+   "C : fixed shapes",
+   "g++ -O3",
+   "g++ -c -O3 cfixedsub.cpp -o cfixedsub.o",
+   "g++ -o cfixed -O3 cmain.cpp cfixedsub.o",
+   "./cfixed",
+   1000000,
+   "rm -f cfixed cfixedsub.o"]
+
+FixedCgccO3native = [
+   "C : fixed shapes",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native cfixedsub.cpp -o cfixedsub.o",
+   "g++ -o cfixed -O3 -march=native cmain.cpp cfixedsub.o",
+   "./cfixed",
+   5000000,
+   "rm -f cfixed cfixedsub.o"]
+
+FixedCclangO3native = [
+   "C : fixed shapes",
+   "clang -O3 native",
+   "c++ -c -O3 -march=native cfixedsub.cpp -o cfixedsub.o",
+   "c++ -o cfixed -O3 -march=native cmain.cpp cfixedsub.o",
+   "./cfixed",
+   5000000,
+   "rm -f cfixed cfixedsub.o"]
+
+FixedCgccO3Unlisted = [
+   "C : fixed shapes",
+   "g++ -O3 unlisted",
+   "g++ -c -O3 -march=native cfixedsub.cpp -o cfixedsub.o",
+   "g++ -o cfixed -O3 -march=native cmain.cpp cfixedsub.o",
+   "./cfixed",
+   5000000,
+   "rm -f cfixed cfixedsub.o",
+   [2001,10]]
+
+FixedCgccO3Big = [
+   "C : fixed shapes",
+   "g++ -O3 native",
+   "g++ -c -O3 -march=native cfixedsub.cpp -o cfixedsub.o",
+   "g++ -o cfixed -O3 -march=native cmain.cpp cfixedsub.o",
+   "./cfixed",
+   200,
+   "rm -f cfixed cfixedsub.o",
+   [2000,2000]]
+
+#  Profile-guided and link time optimised builds of the 'C : raw' test, to be
+#  compared with the plain '-O3 native' builds they are variants of. For the
+#  profile-guided builds, the first build step is a list of commands: build an
+#  instrumented subroutine and a training program that uses it, run that for
+#  the default array size, and rebuild the subroutine using the profile this
+#  produces. With link time optimisation, the compiler can see subr() from the
+#  main program, and cmain.cpp passes each result to BenchHarness::Sink() to
+#  stop the repeated calls being optimised away. The clang builds use c++, as
+#  do the other clang tests, and the profile needs llvm-profdata to merge it.
+#
+#  The gcc builds work anywhere g++ does. The clang ones need 'c++' to be
+#  clang, which it is on macOS but often isn't on Linux, where -flto=thin and
+#  -fprofile-instr-generate mean nothing to g++. And llvm-profdata comes with
+#  Xcode, and is run through xcrun, on macOS, but elsewhere is on the PATH,
+#  sometimes with the LLVM version on the end of its name. So the toolchain is
+#  looked at here: CxxIsClang records whether 'c++' is clang, LlvmProfdata is
+#  the command that runs llvm-profdata, or "" if it can't be found, and the
+#  clang tests are left out of the run, with a message, if they can't work.
+
+def FindLlvmProfdata () :
+   (Status,Output,Errors) = ExecuteCommand("xcrun --find llvm-profdata")
+   if (Status == None) : return "xcrun llvm-profdata"
+   (Status,Output,Errors) = ExecuteCommand("llvm-profdata --version")
+   if (Status == None) : return "llvm-profdata"
+   Versioned = []
+   for Dir in os.environ.get("PATH","").split(os.pathsep) :
+      try :
+         Names = os.listdir(Dir)
+      except :
+         continue
+      for Name in Names :
+         if (Name.startswith("llvm-profdata-")) : Versioned.append(Name)
+   if (len(Versioned) > 0) : return sorted(Versioned)[-1]
+   return ""
+
+def FindCxxIsClang () :
+   (Status,Output,Errors) = ExecuteCommand("c++ --version")
+   return Status == None and "clang" in (Output + Errors)
+
+CxxIsClang = FindCxxIsClang()
+LlvmProfdata = FindLlvmProfdata()
+
+RawCgccO3nativePGO = [
+   "C : raw",
+   "g++ -O3 native PGO",
+   ["g++ -c -O3 -march=native -fprofile-generate csub.cpp -o csub.o",
+    "g++ -o cmain-train -O3 -march=native -fprofile-generate cmain.cpp csub.o",
+    "./cmain-train 20000 2000 10",
+    "g++ -c -O3 -march=native -fprofile-use csub.cpp -o csub.o"],
+   "g++ -o cmain -O3 -march=native cmain.cpp csub.o",
+   "./cmain",
+   5000000,
+   "rm -f cmain csub.o cmain-train csub.gcda cmain-train-cmain.gcda"]
+
+RawCgccO3nativeLTO = [
+   "C : raw",
+   "g++ -O3 native LTO",
+   "g++ -c -O3 -march=native -flto csub.cpp -o csub.o",
+   "g++ -o cmain -O3 -march=native -flto cmain.cpp csub.o",
+   "./cmain",
+   5000000,
+   "rm -f cmain csub.o"]
+
+RawCgccO3nativePGOLTO = [
+   "C : raw",
+   "g++ -O3 native PGO LTO",
+   ["g++ -c -O3 -march=native -flto -fprofile-generate csub.cpp -o csub.o",
+    "g++ -o cmain-train -O3 -march=native -flto -fprofile-generate "
+                                                         "cmain.cpp csub.o",
+    "./cmain-train 20000 2000 10",
+    "g++ -c -O3 -march=native -flto -fprofile-use csub.cpp -o csub.o"],
+   "g++ -o cmain -O3 -march=native -flto cmain.cpp csub.o",
+   "./cmain",
+   5000000,
+   "rm -f cmain csub.o cmain-train csub.gcda cmain-train-cmain.gcda"]
+
+RawCclangO3nativePGO = [
+   "C : raw",
+   "clang -O3 native PGO",
+   ["c++ -c -O3 -march=native -fprofile-instr-generate csub.cpp -o csub.o",
+    "c++ -o cmain-train -O3 -march=native -fprofile-instr-generate "
+                                                         "cmain.cpp csub.o",
+    "./cmain-train 20000 2000 10",
+    (LlvmProfdata or "llvm-profdata") +
+                         " merge -o default.profdata default.profraw",
+    "c++ -c -O3 -march=native -fprofile-instr-use=default.profdata "
+                                                   "csub.cpp -o csub.o"],
+   "c++ -o cmain -O3 -march=native cmain.cpp csub.o",
+   "./cmain",
+   5000000,
+   "rm -f cmain csub.o cmain-train default.profraw default.profdata"]
+
+RawCclangO3nativeThinLTO = [
+   "C : raw",
+   "clang -O3 native ThinLTO",
+   "c++ -c -O3 -march=native -flto=thin csub.cpp -o csub.o",
+   "c++ -o cmain -O3 -march=native -flto=thin cmain.cpp csub.o",
+   "./cmain",
+   5000000,
+   "rm -f cmain csub.o"]
+
+NeedsClang = [RawCclangO3nativePGO,RawCclangO3nativeThinLTO]
+NeedsProfdata = [RawCclangO3nativePGO]
+
+#  MissingTool() returns why a test can't be run here, or "" if it can.
+
+def MissingTool (Test) :
+   if (Test in NeedsClang and not CxxIsClang) :
+      return "'c++' is not clang"
+   if (Test in NeedsProfdata and LlvmProfdata == "") :
+      return "llvm-profdata can't be found"
+   return ""
+
+#  The 'C++ : indexed' tests process a stack of 8 frames held in a 3D array,
+#  as the 'C : frames' tests do, but compare two ways of finding the elements.
+#  The 'indexed' tests allocate the arrays with no pointer arrays, and subr()
+#  in cisub.cpp works out the address of each row from the subscripts, using
+#  the IndexedArray3D class in ArrayTemplates.h. The 'tables' tests run the
+#  same program with INDEX_TABLES=1, which allocates the arrays normally and
+#  uses subrtables(), the same loop written to go through the pointer arrays.
+
+IndexedCgccO3 = [
+   "C++ : indexed",
+   "g++ -O3 indexed",
+   "g++ -c -O3 cisub.cpp -o cisub.o",
+   "g++ -o cimain -O3 cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+IndexedCgccO3Tables = [
+   "C++ : indexed",
+   "g++ -O3 tables",
+   "g++ -c -O3 cisub.cpp -o cisub.o",
+   "g++ -o cimain -O3 cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env INDEX_TABLES=1 ./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+IndexedCgccO3native = [
+   "C++ : indexed",
+   "g++ -O3 native indexed",
+   "g++ -c -O3 -march=native cisub.cpp -o cisub.o",
+   "g++ -o cimain -O3 -march=native cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+IndexedCgccO3nativeTables = [
+   "C++ : indexed",
+   "g++ -O3 native tables",
+   "g++ -c -O3 -march=native cisub.cpp -o cisub.o",
+   "g++ -o cimain -O3 -march=native cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env INDEX_TABLES=1 ./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+IndexedCclangO3native = [
+   "C++ : indexed",
+   "clang -O3 native indexed",
+   "c++ -c -O3 -march=native cisub.cpp -o cisub.o",
+   "c++ -o cimain -O3 -march=native cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+IndexedCclangO3nativeTables = [
+   "C++ : indexed",
+   "clang -O3 native tables",
+   "c++ -c -O3 -march=native cisub.cpp -o cisub.o",
+   "c++ -o cimain -O3 -march=native cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env INDEX_TABLES=1 ./cimain",
+   100000,
+   "rm -f cimain cisub.o"]
+
+#  The 'C : reductions' tests reduce a stack of 16 frames held in a 3D array to
+#  a single frame, using the Reductions class in Reductions.cpp - finding the
+#  mean, median, minimum or maximum of each pixel through the stack. The 'naive'
+#  test does the same with plain loops and a float total, as the test program
+#  in ArrayManager.cpp does. The 'rows' test works along the rows instead of
+#  through the stack. The median tests are much slower than the others, so do
+#  fewer repeats, and the clipped one has a cosmic ray planted in each pixel.
+#  The 'view' test reduces a view of every other frame of a larger stack, to
+#  check that views, whose frames aren't next to each other, come out right.
+
+ReduceCgccO3Naive = [
+   "C : reductions",
+   "g++ -O3 naive mean",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_NAIVE=1 ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Plain = [
+   "C : reductions",
+   "g++ -O3 plain mean",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_ACCURACY=plain ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Kahan = [
+   "C : reductions",
+   "g++ -O3 Kahan mean",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_ACCURACY=kahan ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3 = [
+   "C : reductions",
+   "g++ -O3 pairwise mean",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3native = [
+   "C : reductions",
+   "g++ -O3 native pairwise mean",
+   "g++ -c -O3 -march=native Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 -march=native credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Rows = [
+   "C : reductions",
+   "g++ -O3 pairwise mean rows",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_AXIS=0 ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Min = [
+   "C : reductions",
+   "g++ -O3 min",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_OP=min ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Max = [
+   "C : reductions",
+   "g++ -O3 max",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_OP=max ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Median = [
+   "C : reductions",
+   "g++ -O3 median",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_OP=median ./credmain",
+   1000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3Clipped = [
+   "C : reductions",
+   "g++ -O3 3 sigma clipped median",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_OP=median REDUCE_SIGMA=3 ./credmain",
+   1000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3View = [
+   "C : reductions",
+   "g++ -O3 pairwise mean of a view",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_VIEW=1 ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3All = [
+   "C : reductions",
+   "g++ -O3 pairwise mean all threads",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_THREADS=0 ./credmain",
+   100000,
+   "rm -f credmain Reductions.o"]
+
+ReduceCgccO3ClippedAll = [
+   "C : reductions",
+   "g++ -O3 3 sigma clipped median all threads",
+   "g++ -c -O3 Reductions.cpp -o Reductions.o",
+   "g++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread",
+   "env REDUCE_OP=median REDUCE_SIGMA=3 REDUCE_THREADS=0 ./credmain",
+   1000,
+   "rm -f credmain Reductions.o"]
+
+#  The 'C++ : tiled' tests find the mean of each pixel through a stack of 16
+#  simulated sky frames held compressed in a TiledArray (see TiledArray.h),
+#  working through it a tile at a time, so every tile is decompressed on every
+#  pass. The 'plain' test does the same from an ordinary 3D array, and the
+#  'raw' test holds the tiles uncompressed, which shows the cost of the tiling
+#  on its own. 'Rice' is lossless, and the others quantise to a quarter of the
+#  noise, as fpack does by default.
+
+TiledCgccO3Plain = [
+   "C++ : tiled",
+   "g++ -O3 plain array",
+   "g++ -c -O3 TiledArray.cpp -o TiledArray.o",
+   "g++ -o ctiledmain -O3 ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env TILED_PLAIN=1 ./ctiledmain",
+   10000,
+   "rm -f ctiledmain TiledArray.o"]
+
+TiledCgccO3Raw = [
+   "C++ : tiled",
+   "g++ -O3 raw tiles",
+   "g++ -c -O3 TiledArray.cpp -o TiledArray.o",
+   "g++ -o ctiledmain -O3 ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env TILED_METHOD=raw ./ctiledmain",
+   10000,
+   "rm -f ctiledmain TiledArray.o"]
+
+TiledCgccO3Rice = [
+   "C++ : tiled",
+   "g++ -O3 Rice tiles",
+   "g++ -c -O3 TiledArray.cpp -o TiledArray.o",
+   "g++ -o ctiledmain -O3 ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp",
+   "env TILED_METHOD=rice ./ctiledmain",
+   1000,
+   "rm -f ctiledmain TiledArray.o"]
+
+TiledCgccO3 = [
+   "C++ : tiled",
+   "g++ -O3 quantised tiles",
+   "g++ -c -O3 TiledArray.cpp -o TiledArray.o",
+   "g++ -o ctiledmain -O3 ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctiledmain",
+   1000,
+   "rm -f ctiledmain TiledArray.o"]
+
+TiledCgccO3native = [
+   "C++ : tiled",
+   "g++ -O3 native quantised tiles",
+   "g++ -c -O3 -march=native TiledArray.cpp -o TiledArray.o",
+   "g++ -o ctiledmain -O3 -march=native ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp",
+   "./ctiledmain",
+   1000,
+   "rm -f ctiledmain TiledArray.o"]
+
 VecCclang = [
    "C : vectors",
    "clang",
@@ -1255,6 +3075,35 @@ FullTests = [
    CNumRclang,CNumRclangO,CNumRclangO1,
    CNumRclangO2,CNumRclangO3,CNumRclangO3native,
    CNumRgcc,CNumRgccO,CNumRgccO1,CNumRgccO2,CNumRgccO3,CNumRgccO3native,
+   TypedCclangO3,TypedCclangO3native,TypedCgccO3,TypedCgccO3native,
+   ParCgccO3T1,ParCgccO3T2,ParCgccO3T4,ParCgccO3T8,ParCgccO3All,
+   ParCgccO3T1Large,ParCgccO3T2Large,ParCgccO3T4Large,ParCgccO3T8Large,
+   ParCgccO3AllLarge,
+   SimdFlatCclangO3,SimdNumRCclangO3,SimdVecCclangO3,SimdBoostCclangO3,
+   SimdFlatCgccO3,SimdNumRCgccO3,SimdVecCgccO3,SimdBoostCgccO3,
+   RawCgccO3L1,StreamCgccO3L1,RawCgccO3L2,StreamCgccO3L2,RawCgccO3LLC,StreamCgccO3LLC,
+   RawCgccO3DRAM,StreamCgccO3DRAM,RawCgccO38k,StreamCgccO38k,
+   NaiveTransCgccO3,NaiveTransCgccO3Big,TiledTransCgccO3,TiledTransCgccO3Big,
+   NaiveCollCgccO3,NaiveCollCgccO3Big,TiledCollCgccO3,TiledCollCgccO3Big,
+   FramesPlaneCgccO3,FramesBatchCgccO3,FramesBatchCgccO3All,
+   FramesPlaneCgccO3Big,FramesBatchCgccO3Big,FramesBatchCgccO3AllBig,
+   ExprCclangO3,ExprCgccO3,
+   MatrixCclangO3,MatrixCgccO3,
+   ElemInt16CgccO3,ElemUint16CgccO3,ElemInt32CgccO3,ElemFp16CgccO3,
+   ElemBf16CgccO3,ElemFloatCgccO3,ElemDoubleCgccO3,
+   GpuCudaO3,GpuCudaO3OneStream,GpuCudaO3Pageable,
+   PipeCgccO3Serial,PipeCgccO3,PipeCgccO3DirectSerial,PipeCgccO3Direct,
+   FixedCgccO3,FixedCgccO3native,FixedCclangO3native,FixedCgccO3Unlisted,
+   FixedCgccO3Big,
+   RawCgccO3nativePGO,RawCgccO3nativeLTO,RawCgccO3nativePGOLTO,
+   RawCclangO3nativePGO,RawCclangO3nativeThinLTO,
+   IndexedCgccO3,IndexedCgccO3Tables,IndexedCgccO3native,
+   IndexedCgccO3nativeTables,IndexedCclangO3native,IndexedCclangO3nativeTables,
+   ReduceCgccO3Naive,ReduceCgccO3Plain,ReduceCgccO3Kahan,ReduceCgccO3,
+   ReduceCgccO3native,ReduceCgccO3Rows,ReduceCgccO3Min,ReduceCgccO3Max,
+   ReduceCgccO3Median,ReduceCgccO3Clipped,ReduceCgccO3View,ReduceCgccO3All,
+   ReduceCgccO3ClippedAll,
+   TiledCgccO3Plain,TiledCgccO3Raw,TiledCgccO3Rice,TiledCgccO3,TiledCgccO3native,
   ]
 
 # ------------------------------------------------------------------------------
@@ -1299,12 +3148,75 @@ Nx = 2000
 Ny = 10
 Ntests = 1
 
-if (len(sys.argv) > 1):
-   Ntests = int(sys.argv[1])
-   if (len(sys.argv) > 2):
-      Nx = int(sys.argv[2])
-      if (len(sys.argv) > 3):
-         Ny = int(sys.argv[3])
+#  The options are picked out first, and what's left are the three numbers.
+
+Jobs = 1
+try :
+   import multiprocessing
+   Jobs = multiprocessing.cpu_count()
+except :
+   pass
+Pin = ""
+CacheDir = "BuildCache"
+UseCache = True
+CheckpointFile = "RunCheckpoint.json"
+Resume = False
+Sweep = False
+Sizes = ParseSizes("256,512,1024,2048,4096,8192,16384")
+Target = 1.0
+Args = []
+Index = 1
+while (Index < len(sys.argv)) :
+   Arg = sys.argv[Index]
+   HasValue = (Index + 1 < len(sys.argv))
+   if (Arg == "-jobs" and HasValue) :
+      Jobs = int(sys.argv[Index + 1])
+      Index = Index + 1
+   elif (Arg == "-cpu" and HasValue) :
+      Pin = sys.argv[Index + 1]
+      Index = Index + 1
+   elif (Arg == "-cache" and HasValue) :
+      CacheDir = sys.argv[Index + 1]
+      Index = Index + 1
+   elif (Arg == "-checkpoint" and HasValue) :
+      CheckpointFile = sys.argv[Index + 1]
+      Index = Index + 1
+   elif (Arg == "-nocache") :
+      UseCache = False
+   elif (Arg == "-resume") :
+      Resume = True
+   elif (Arg == "-sweep") :
+      Sweep = True
+   elif (Arg == "-sizes" and HasValue) :
+      Sizes = ParseSizes(sys.argv[Index + 1])
+      Index = Index + 1
+   elif (Arg == "-target" and HasValue) :
+      Target = float(sys.argv[Index + 1])
+      Index = Index + 1
+   elif (Arg.startswith("-")) :
+      print ("Unrecognised option",Arg)
+      sys.exit(1)
+   else :
+      Args.append(Arg)
+   Index = Index + 1
+
+if (len(Args) > 0):
+   Ntests = int(Args[0])
+   if (len(Args) > 1):
+      Nx = int(Args[1])
+      if (len(Args) > 2):
+         Ny = int(Args[2])
+
+#  Leave out the tests that need a tool this system doesn't have, saying why,
+#  rather than have them fail.
+
+Unavailable = []
+for Test in FullTests :
+   Reason = MissingTool(Test)
+   if (Reason != "") :
+      print ("Skipping",Test[0],Test[1],"-",Reason)
+      Unavailable.append(Test)
+FullTests = [Test for Test in FullTests if not Test in Unavailable]
 
 #  Build up a list of all the different language/techniques we have.
 #  Ditto a list of all the compilers/option combinations we have.
@@ -1329,6 +3241,66 @@ NCompOpt = len(CompOptList)
 
 Results = numpy.zeros((NLangTech,NCompOpt))
 
+#  For tests that time themselves using BenchHarness.h, we also keep the
+#  dictionary of values from the BENCH line for the fastest run, indexed by
+#  (LangTechIndex,CompOptIndex). This includes any performance counter values.
+
+BenchDetails = {}
+
+#  RecordResult() records the time for 1000 iterations for a test in the
+#  Results array, using the indices for the language and compiler used. If we
+#  are running more than one iteration of the full test loop, we take the
+#  lowest (non-zero) number we get from any one iteration.
+
+def RecordResult (LangTech,CompOpt,KIterSecs,Bench) :
+
+   LangTechIndex = LangTechList.index(LangTech)
+   CompOptIndex = CompOptList.index(CompOpt)
+   if (KIterSecs > 0.0) :
+      LowestSoFar = Results[LangTechIndex,CompOptIndex]
+      if (LowestSoFar <= 0.0 or KIterSecs < LowestSoFar) :
+         Results[LangTechIndex,CompOptIndex] = KIterSecs
+         if (Bench != None) :
+            BenchDetails[(LangTechIndex,CompOptIndex)] = Bench
+
+#  If resuming, pick up the results of the tests already run, and record them.
+#  Done is the set of tests already done, as (pass,LangTech,CompOpt) tuples.
+
+if (Sweep) :
+   FullTests = [Test for Test in FullTests if len(Test) <= 7]
+   Resume = False
+   CheckpointFile = ""
+Completed = []
+if (Resume) : Completed = LoadCheckpoint(CheckpointFile,Nx,Ny)
+Done = set()
+for Entry in Completed :
+   if (Entry["LangTech"] in LangTechList and Entry["CompOpt"] in CompOptList) :
+      Done.add((Entry["Pass"],Entry["LangTech"],Entry["CompOpt"]))
+      RecordResult(Entry["LangTech"],Entry["CompOpt"],Entry["KIterSecs"],
+                                                               Entry["Bench"])
+if (len(Done) > 0) :
+   print ("")
+   print ("Resuming, with",len(Done),"test results from",CheckpointFile)
+
+#  Build all the compiled tests that still need running, in parallel, using
+#  the cache. (The tests are still timed one at a time, below.)
+
+Plans = {}
+Failures = {}
+if (UseCache) :
+   ToRun = [Test for Test in FullTests if \
+      len([ITest for ITest in range(Ntests) \
+                     if not (ITest,Test[0],Test[1]) in Done]) > 0]
+   print ("")
+   print ("Building compiled tests, using up to",Jobs,"parallel jobs")
+   (Plans,Failures) = BuildAll(ToRun,CacheDir,Jobs)
+
+#  A sweep is a different thing altogether, and that's all we do.
+
+if (Sweep) :
+   RunSweep(FullTests,Plans,Failures,CacheDir,Nx,Ny,Sizes,Target,Pin)
+   sys.exit(0)
+
 #  We can run the full set of tests a number of times, to try to even out
 #  any variations.
 
@@ -1350,34 +3322,66 @@ for ITest in range(Ntests) :
       #  Test[0] is language/technique, Test[1] the compiler/interpreter & flags.
       #  Test[2] and Test[3] are the build commands, Test[4] is the command
       #  to run the test, Test[5] is the number of iterations, and Test[6] is
-      #  the cleanup command.
+      #  the cleanup command. Test[7], if present, is the array size for the
+      #  test, as [Nx,Ny], overriding the size being used for the other tests.
+      #  The time for such a test is scaled to the time it would have taken
+      #  for an array of the normal size, assuming the time is proportional to
+      #  the number of elements, so it can be compared with the others. If it
+      #  isn't proportional - if the size makes the sort of difference these
+      #  tests are meant to show - the scaled time will show it.
       
       LangTech = Test[0]
       CompOpt = Test[1]
       Nrpt = Test[5]
-      (Status,Secs,Errors) = \
-         BuildAndTimeProgram(Test[2],Test[3],Test[4],Nrpt,Nx,Ny,Test[6])
+      if ((ITest,LangTech,CompOpt) in Done) : continue
+      (TestNx,TestNy) = (Nx,Ny)
+      if (len(Test) > 7) : (TestNx,TestNy) = (Test[7][0],Test[7][1])
+      if ((LangTech,CompOpt) in Plans) :
+         (Status,Secs,Errors,Bench) = \
+            CachedTimeProgram(Plans[(LangTech,CompOpt)],Failures,CacheDir,
+                                        Test[4],Nrpt,TestNx,TestNy,Test[6],Pin)
+      else :
+         (Status,Secs,Errors,Bench) = \
+            BuildAndTimeProgram(Test[2],Test[3],Test[4],Nrpt,TestNx,TestNy,
+                                                                  Test[6],Pin)
+      KIterSecs = 0.0
       if (Status) :
          print (LangTech,CompOpt,"Error:",Status,Errors)
       else :
          KIterSecs = (Secs / float(Nrpt)) * 1000.0
+         KIterSecs = KIterSecs * float(Nx * Ny) / float(TestNx * TestNy)
          print ("%24s %20s Rept: %8d Elap: %10.2f 1K Iter: %10.2g" %
                                    (LangTech,CompOpt,Nrpt,Secs,KIterSecs))
-
-         #  Record the result (the time to perform 1000 iterations) in the
-         #  Results array, using the indices for the language and compiler used.
-         #  If we are running more than one iteration of the full test loop,
-         #  we take the lowest (non-zero) number we get from any one iteration.
-
-         LangTechIndex = LangTechList.index(LangTech)
-         CompOptIndex = CompOptList.index(CompOpt)
-         if (KIterSecs > 0.0) :
-            LowestSoFar = Results[LangTechIndex,CompOptIndex]
-            if (LowestSoFar <= 0.0) :
-               Results[LangTechIndex,CompOptIndex] = KIterSecs
-            else :
-               if (KIterSecs < LowestSoFar) :
-                  Results[LangTechIndex,CompOptIndex] = KIterSecs
+         
+         #  If the program timed itself, show the spread of the times per call
+         #  and anything that might have disturbed them.
+         
+         if (Bench != None) :
+            print ("%45s Median: %.4g us, min: %.4g us, 90%%: %.4g us, "
+                   "loop page faults: %d" % ("",Bench["median_ns"] * 0.001,
+                   Bench["min_ns"] * 0.001,Bench["p90_ns"] * 0.001,
+                   int(Bench["minflt_loop"])))
+            if ("gbps" in Bench) :
+               print ("%45s Throughput: %.4g GB/s, %.4g elements/ns, with "
+                      "%d byte elements" % ("",Bench["gbps"],
+                      Bench["elem_per_ns"],int(Bench["elem_bytes"])))
+            if ("kernel_gbps" in Bench and "gbps" in Bench) :
+               print ("%45s Kernel only: %.4g GB/s, end to end: %.4g GB/s" %
+                               ("",Bench["kernel_gbps"],Bench["gbps"]))
+            if ("hidden" in Bench) :
+               print ("%45s I/O: %.4g sec, waited: %.4g sec, %.1f%% hidden" %
+                   ("",Bench["io_s"],Bench["wait_s"],Bench["hidden"] * 100.0))
+
+         #  Record the result (the time to perform 1000 iterations).
+
+         RecordResult(LangTech,CompOpt,KIterSecs,Bench)
+         
+      #  Save the result, good or bad, in the checkpoint file.
+      
+      Completed.append({"Pass" : ITest, "LangTech" : LangTech,
+         "CompOpt" : CompOpt, "Status" : Status, "KIterSecs" : KIterSecs,
+                                                            "Bench" : Bench})
+      SaveCheckpoint(CheckpointFile,Nx,Ny,Completed)
 
 #  Find the benchmark result - the lowest number in the results table (ignoring
 #  the zeros from non-existent or failed tests)
@@ -1403,11 +3407,27 @@ for LangTechIndex in range(NLangTech) :
 print ("Fastest combination is ",FastestLangTech,"and",FastestCompOpt)
 
 #  Now that we know the benchmark speed, output a final list of results, this
-#  time including the relative speed for each test.
+#  time including the relative speed for each test. For tests that were able
+#  to read the hardware performance counters (see PerfCounters.h), this is
+#  followed by the counts per array element: cycles, instructions, L1 data
+#  cache misses, last level cache misses, branch misses, and vector and scalar
+#  floating point instructions. Counters that weren't available show as '-'.
+
+PerfKeys = ["cycles","instr","l1d_miss","llc_miss","branch_miss","vec_ops",
+                                                                  "scalar_ops"]
+PerfHeadings = ["Cyc","Instr","L1D","LLC","BrMiss","Vec","Scalar"]
 
 print ("")
 print ("Summary of relative speeds:")
 print ("")
+HaveCounters = False
+for Details in BenchDetails.values() :
+   for Key in PerfKeys :
+      if (Details.get(Key + "_per_elem",-1.0) >= 0.0) : HaveCounters = True
+if (HaveCounters) :
+   Line = " " * 93
+   for Heading in PerfHeadings : Line = Line + " %7s" % Heading
+   print (Line + "  (per element)")
 for Test in FullTests :
    LangTech = Test[0]
    CompOpt = Test[1]
@@ -1415,8 +3435,74 @@ for Test in FullTests :
    CompOptIndex = CompOptList.index(CompOpt)
    KIterSecs = Results[LangTechIndex,CompOptIndex]
    RelativeSpeed = KIterSecs / BenchKIterSecs
-   print ("%24s %20s 1K Iter: %10.2g, Relative time %12.2f" %
+   Line = ("%24s %20s 1K Iter: %10.2g, Relative time %12.2f" %
                                 (LangTech,CompOpt,KIterSecs,RelativeSpeed))
+   Details = BenchDetails.get((LangTechIndex,CompOptIndex))
+   if (HaveCounters and Details != None) :
+      for Key in PerfKeys :
+         Value = Details.get(Key + "_per_elem",-1.0)
+         if (Value >= 0.0) : Line = Line + " %7.3g" % Value
+         else : Line = Line + " %7s" % "-"
+   print (Line)
+
+#  For the 'C++ : elem' tests, which run the same code on arrays with different
+#  element types, the throughput of each, and how it compares with the float
+#  version built the same way. Where memory bandwidth is the limit, the 16-bit
+#  types should process elements up to twice as fast as float.
+
+ElemTests = []
+for Test in FullTests :
+   if (Test[0].startswith("C++ : elem ")) : ElemTests.append(Test)
+if (len(ElemTests) > 0) :
+   print ("")
+   print ("Summary of element type throughput:")
+   print ("")
+   for Test in ElemTests :
+      LangTech = Test[0]
+      CompOpt = Test[1]
+      Details = BenchDetails.get((LangTechList.index(LangTech),
+                                              CompOptList.index(CompOpt)))
+      if (Details == None or not ("gbps" in Details)) :
+         print ("%24s %20s %s" % (LangTech,CompOpt,"no result"))
+         continue
+      Line = ("%24s %20s %2d bytes %8.3f GB/s %8.3f elements/ns" %
+                      (LangTech,CompOpt,int(Details["elem_bytes"]),
+                               Details["gbps"],Details["elem_per_ns"]))
+      Float = None
+      if ("C++ : elem float" in LangTechList) :
+         Float = BenchDetails.get((LangTechList.index("C++ : elem float"),
+                                                CompOptList.index(CompOpt)))
+      if (Float != None and Float.get("elem_per_ns",0.0) > 0.0) :
+         Line = Line + ", %5.2f x float" % \
+                                 (Details["elem_per_ns"] / Float["elem_per_ns"])
+      print (Line)
+
+#  For the profile-guided and link time optimised builds, how each compares
+#  with the plain build it is a variant of - the test with the same LangTech,
+#  and a CompOpt without the trailing PGO, LTO or ThinLTO. This shows what the
+#  usual builds are leaving on the table.
+
+BuildVariants = ["PGO","LTO","ThinLTO"]
+VariantTests = []
+for Test in FullTests :
+   Base = Test[1].split()
+   while (len(Base) > 0 and Base[-1] in BuildVariants) : Base = Base[:-1]
+   Base = " ".join(Base)
+   if (Base != Test[1] and Base in CompOptList) :
+      VariantTests.append((Test[0],Test[1],Base))
+if (len(VariantTests) > 0) :
+   print ("")
+   print ("Summary of profile-guided and link time optimised builds:")
+   print ("")
+   for (LangTech,CompOpt,Base) in VariantTests :
+      LangTechIndex = LangTechList.index(LangTech)
+      KIterSecs = Results[LangTechIndex,CompOptList.index(CompOpt)]
+      BaseKIterSecs = Results[LangTechIndex,CompOptList.index(Base)]
+      if (KIterSecs <= 0.0 or BaseKIterSecs <= 0.0) :
+         print ("%24s %24s %s" % (LangTech,CompOpt,"no result"))
+         continue
+      print ("%24s %24s 1K Iter: %10.2g, %5.2f x the speed of %s" %
+         (LangTech,CompOpt,KIterSecs,BaseKIterSecs / KIterSecs,Base))
 
 #  Finally, output the summary table of relative speeds in a .csv format that
 #  can be read by most spreadsheet programs.
@@ -0,0 +1,286 @@
+//
+//                            S i m d  K e r n e l s . c p p
+//
+//  Function:
+//     Vectorised row kernels for the index-add test, selected at run time.
+//
+//  Description:
+//     See the .h file for a description of the kernels from a user's perspective. This file
+//     provides the implementation. Each kernel keeps a vector of column indices as floats
+//     (0,1,2,3... for the first elements of the row), and for each vector's worth of the row
+//     loads the input, adds the column indices, adds the row index, stores the result, and
+//     moves the column indices on by the vector length. Whatever is left over at the end of
+//     the row is done with a masked operation (AVX-512) or a short scalar loop (the others).
+//
+//     The x86 kernels use function target attributes, supported by both gcc and clang, so
+//     the AVX2 and AVX-512 code is generated even though the file is compiled for the basic
+//     x86-64 instruction set. It's essential that these are only ever called on a CPU that
+//     supports them, which is what SelectKernel() makes sure of. On 64-bit ARM, NEON
+//     (Advanced SIMD) is part of the base architecture, but the hardware capability bits are
+//     still checked, to be on the safe side.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "SimdKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define SIMD_NEON
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 S c a l a r  K e r n e l
+//
+//  The plain C++ version, used if nothing better is available, and for the leftover elements
+//  at the end of a row by the SSE2, AVX2 and NEON kernels.
+
+static void ScalarRow (const float* In, float* Out, long Nx, long Iy)
+{
+   for (long Ix = 0; Ix < Nx; Ix++) {
+      Out[Ix] = In[Ix] + Ix + Iy;
+   }
+}
+
+//  Finish off a row from element Ix onwards.
+
+static inline void ScalarTail (const float* In, float* Out, long Ix, long Nx, long Iy)
+{
+   for (; Ix < Nx; Ix++) {
+      Out[Ix] = In[Ix] + Ix + Iy;
+   }
+}
+
+#ifdef SIMD_X86
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   S S E 2  K e r n e l
+//
+//  Four floats at a time. SSE2 is part of the x86-64 base architecture, so this is always
+//  available on a 64-bit x86 machine.
+
+__attribute__((target("sse2")))
+static void Sse2Row (const float* In, float* Out, long Nx, long Iy)
+{
+   const __m128 Row = _mm_set1_ps(float(Iy));
+   const __m128 Step = _mm_set1_ps(4.0f);
+   __m128 Col = _mm_setr_ps(0.0f,1.0f,2.0f,3.0f);
+   long Ix = 0;
+   for (; Ix + 4 <= Nx; Ix += 4) {
+      __m128 Value = _mm_add_ps(_mm_loadu_ps(In + Ix),Col);
+      _mm_storeu_ps(Out + Ix,_mm_add_ps(Value,Row));
+      Col = _mm_add_ps(Col,Step);
+   }
+   ScalarTail(In,Out,Ix,Nx,Iy);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   A V X 2  K e r n e l
+//
+//  Eight floats at a time, and two vectors per loop iteration, which gives the CPU two
+//  independent chains of additions to overlap.
+
+__attribute__((target("avx2")))
+static void Avx2Row (const float* In, float* Out, long Nx, long Iy)
+{
+   const __m256 Row = _mm256_set1_ps(float(Iy));
+   const __m256 Step = _mm256_set1_ps(8.0f);
+   const __m256 Step2 = _mm256_set1_ps(16.0f);
+   __m256 Col = _mm256_setr_ps(0.0f,1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f);
+   __m256 Col2 = _mm256_add_ps(Col,Step);
+   long Ix = 0;
+   for (; Ix + 16 <= Nx; Ix += 16) {
+      __m256 Value = _mm256_add_ps(_mm256_loadu_ps(In + Ix),Col);
+      __m256 Value2 = _mm256_add_ps(_mm256_loadu_ps(In + Ix + 8),Col2);
+      _mm256_storeu_ps(Out + Ix,_mm256_add_ps(Value,Row));
+      _mm256_storeu_ps(Out + Ix + 8,_mm256_add_ps(Value2,Row));
+      Col = _mm256_add_ps(Col,Step2);
+      Col2 = _mm256_add_ps(Col2,Step2);
+   }
+   if (Ix + 8 <= Nx) {
+      __m256 Value = _mm256_add_ps(_mm256_loadu_ps(In + Ix),Col);
+      _mm256_storeu_ps(Out + Ix,_mm256_add_ps(Value,Row));
+      Ix += 8;
+   }
+   ScalarTail(In,Out,Ix,Nx,Iy);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                A V X - 5 1 2  K e r n e l
+//
+//  Sixteen floats at a time, with the end of the row done using a masked load and store so
+//  no scalar code is needed at all.
+
+__attribute__((target("avx512f")))
+static void Avx512Row (const float* In, float* Out, long Nx, long Iy)
+{
+   const __m512 Row = _mm512_set1_ps(float(Iy));
+   const __m512 Step = _mm512_set1_ps(16.0f);
+   __m512 Col = _mm512_setr_ps(0.0f,1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f,
+                               8.0f,9.0f,10.0f,11.0f,12.0f,13.0f,14.0f,15.0f);
+   long Ix = 0;
+   for (; Ix + 16 <= Nx; Ix += 16) {
+      __m512 Value = _mm512_add_ps(_mm512_loadu_ps(In + Ix),Col);
+      _mm512_storeu_ps(Out + Ix,_mm512_add_ps(Value,Row));
+      Col = _mm512_add_ps(Col,Step);
+   }
+   if (Ix < Nx) {
+      __mmask16 Mask = (__mmask16) ((1U << (Nx - Ix)) - 1U);
+      __m512 Value = _mm512_add_ps(_mm512_maskz_loadu_ps(Mask,In + Ix),Col);
+      _mm512_mask_storeu_ps(Out + Ix,Mask,_mm512_add_ps(Value,Row));
+   }
+}
+
+#endif
+
+#ifdef SIMD_NEON
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   N E O N  K e r n e l
+//
+//  Four floats at a time, two vectors per loop iteration, as for AVX2.
+
+static void NeonRow (const float* In, float* Out, long Nx, long Iy)
+{
+   static const float Start[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+   const float32x4_t Row = vdupq_n_f32(float(Iy));
+   const float32x4_t Step = vdupq_n_f32(8.0f);
+   float32x4_t Col = vld1q_f32(Start);
+   float32x4_t Col2 = vaddq_f32(Col,vdupq_n_f32(4.0f));
+   long Ix = 0;
+   for (; Ix + 8 <= Nx; Ix += 8) {
+      float32x4_t Value = vaddq_f32(vld1q_f32(In + Ix),Col);
+      float32x4_t Value2 = vaddq_f32(vld1q_f32(In + Ix + 4),Col2);
+      vst1q_f32(Out + Ix,vaddq_f32(Value,Row));
+      vst1q_f32(Out + Ix + 4,vaddq_f32(Value2,Row));
+      Col = vaddq_f32(Col,Step);
+      Col2 = vaddq_f32(Col2,Step);
+   }
+   ScalarTail(In,Out,Ix,Nx,Iy);
+}
+
+#endif
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  S e l e c t  K e r n e l
+//
+//  SelectKernel() works out which kernels the CPU supports, and picks the best of them - or
+//  the one named by the SIMD_KERNEL environment variable, if that is set and supported.
+
+static IndexAddRowKernel TheKernel = NULL;
+static const char* TheKernelName = "scalar";
+
+static void SelectKernel (void)
+{
+   const char* Wanted = getenv("SIMD_KERNEL");
+   IndexAddRowKernel Kernel = ScalarRow;
+   const char* Name = "scalar";
+   bool Forced = false;
+   if (Wanted && !strcmp(Wanted,"scalar")) Forced = true;
+
+#ifdef SIMD_X86
+   __builtin_cpu_init();
+   struct { const char* Name; bool Supported; IndexAddRowKernel Kernel; } Choices[] = {
+      { "avx512", bool(__builtin_cpu_supports("avx512f")), Avx512Row },
+      { "avx2",   bool(__builtin_cpu_supports("avx2")),    Avx2Row },
+      { "sse2",   bool(__builtin_cpu_supports("sse2")),    Sse2Row } };
+   int NChoices = sizeof(Choices) / sizeof(Choices[0]);
+   for (int Index = 0; Index < NChoices && !Forced; Index++) {
+      if (Choices[Index].Supported) {
+         if (Wanted == NULL || !strcmp(Wanted,Choices[Index].Name)) {
+            Kernel = Choices[Index].Kernel;
+            Name = Choices[Index].Name;
+            break;
+         }
+      }
+   }
+#endif
+
+#ifdef SIMD_NEON
+   bool HaveNeon = true;
+#if defined(__linux__) && defined(HWCAP_ASIMD)
+   HaveNeon = (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#endif
+   if (HaveNeon && !Forced && (Wanted == NULL || !strcmp(Wanted,"neon"))) {
+      Kernel = NeonRow;
+      Name = "neon";
+   }
+#endif
+
+   TheKernelName = Name;
+   TheKernel = Kernel;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                              S i m d  I n d e x  A d d  R o w
+//
+//  SimdIndexAddRow() returns the kernel to use. The selection is made on the first call, and
+//  the kernel is then simply returned. (If two threads make the first call at the same time
+//  they will both make the same selection, so there is no harm done.)
+
+IndexAddRowKernel SimdIndexAddRow (void)
+{
+   if (TheKernel == NULL) SelectKernel();
+   return TheKernel;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                               S i m d  K e r n e l  N a m e
+
+const char* SimdKernelName (void)
+{
+   if (TheKernel == NULL) SelectKernel();
+   return TheKernelName;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                S i m d  I n d e x  A d d  2 D
+
+void SimdIndexAdd2D (const float* In, float* Out, long Nx, long Ny, long Pitch)
+{
+   IndexAddRowKernel Kernel = SimdIndexAddRow();
+   for (long Iy = 0; Iy < Ny; Iy++) {
+      (*Kernel)(In + Iy * Pitch,Out + Iy * Pitch,Nx,Iy);
+   }
+}
@@ -0,0 +1,84 @@
+//
+//                              S i m d  K e r n e l s . h
+//
+//  Function:
+//     Vectorised row kernels for the index-add test, selected at run time.
+//
+//  Description:
+//     The test operation in this study - set each element of Out to the corresponding element
+//     of In plus the sum of its two indices - is simple enough to be done efficiently using
+//     the vector instructions of any modern CPU. subrasavx.s shows how this can be done by
+//     hand using AVX, but it only works on a machine that has AVX, only works for the
+//     'Numerical Recipes' array layout, and has to be selected when the program is linked.
+//     This file declares a small library that provides the same operation for a single row,
+//     coded for a number of different instruction sets - SSE2, AVX2 and AVX-512 on x86, and
+//     NEON on ARM - together with a plain C++ version. All the versions for a given
+//     architecture are compiled into the one object file (using the compilers' target
+//     attributes, so the file itself doesn't need any special compilation flags) and the
+//     first call to SimdIndexAddRow() finds out what the CPU it is running on supports -
+//     using CPUID on x86 and the hardware capability bits on ARM - and returns the best
+//     version available. So a single program will run at full vector speed on whatever
+//     machine it happens to run on.
+//
+//     Since the kernel works on one row at a time, it can be used with any array layout that
+//     stores each row contiguously. csimdsub.cpp uses it to provide versions of subr() for
+//     flat arrays (as used by cmain.cpp), 'Numerical Recipes' row pointers (cnrmain.cpp) and
+//     vectors of vectors (cvmain.cpp), and cbsimdsub.cpp does the same for Boost arrays
+//     (cbmain.cpp). SimdIndexAdd2D() is a convenience routine for the common case of a
+//     flat array with a given row pitch.
+//
+//     The kernels give exactly the same results as the C++ code In[Iy][Ix] + Ix + Iy, which
+//     means adding the column index and then the row index, with rounding after each
+//     addition, rather than adding their sum in one go. The column indices are held as
+//     floats, which is exact up to 2^24 columns.
+//
+//     The environment variable SIMD_KERNEL can be set to 'scalar', 'sse2', 'avx2', 'avx512' or
+//     'neon' to force the use of a particular version, which is useful for testing and for
+//     comparing them. A version the CPU doesn't support is never used, whatever the variable
+//     says. SimdKernelName() returns the name of the version in use.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __SimdKernels__
+#define __SimdKernels__
+
+//  The type of a row kernel. It sets Out[Ix] to In[Ix] + Ix + Iy for Ix from 0 to Nx - 1.
+//  In and Out need not be aligned in any particular way, but must not overlap (unless they
+//  are the same).
+
+typedef void (*IndexAddRowKernel) (const float* In, float* Out, long Nx, long Iy);
+
+//  Return the best row kernel for this CPU, selecting it the first time this is called.
+
+IndexAddRowKernel SimdIndexAddRow (void);
+
+//  Return the name of the selected kernel - "scalar", "sse2", "avx2", "avx512" or "neon".
+
+const char* SimdKernelName (void);
+
+//  Apply the selected kernel to Ny rows of a flat array, each Pitch elements apart.
+
+void SimdIndexAdd2D (const float* In, float* Out, long Nx, long Ny, long Pitch);
+
+#endif
@@ -0,0 +1,279 @@
+//
+//                               T h r e a d  P o o l . c p p
+//
+//  Function:
+//     A small persistent pool of worker threads for splitting loops across cores.
+//
+//  Description:
+//     See the .h file for a description of the ThreadPool from a user's perspective. This
+//     file provides the implementation. The way a job is handed out is the thing to follow:
+//     ParallelFor() fills in the job details, sets the count of outstanding pieces and then
+//     increments the generation counter. Each worker has been waiting for the generation to
+//     change - spinning for a while, then blocking on a condition variable - and when it sees
+//     a new generation it runs its piece and decrements the outstanding count. The caller
+//     runs piece 0 itself and then waits for the count to reach zero.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Workers now copy the job and its generation together, under the mutex.
+//                    A worker with no piece of one job could run a piece of the next twice.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "ThreadPool.h"
+
+//  The number of times a waiting thread checks for something to do before it gives up and
+//  blocks. This is a compromise - long enough to cover the time between successive calls
+//  of a subroutine in a tight loop, short enough not to burn much CPU when the pool is idle.
+
+static const int SpinCount = 20000;
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+//
+//  The constructor starts NThreads - 1 worker threads (the thread that calls ParallelFor()
+//  does the first piece of the work itself). If PinThreads is true, each thread, including
+//  the calling thread, is pinned to a different one of the CPUs available to the process.
+//  The list of those CPUs has to be obtained before any thread is pinned, since a new thread
+//  inherits the affinity of the thread that creates it, and the calling thread is only
+//  pinned once all the workers have been started, for the same reason.
+
+ThreadPool::ThreadPool (int NThreads, bool PinThreads) :
+   I_Generation(0), I_Outstanding(0), I_Stop(false)
+{
+   I_Job.Task = nullptr;
+   I_Job.Context = nullptr;
+   I_Job.NItems = 0;
+   I_Job.NParts = 0;
+   if (NThreads <= 0) NThreads = AvailableCPUs();
+   if (NThreads <= 0) NThreads = 1;
+   I_NThreads = NThreads;
+   std::vector<int> CPUs;
+   if (PinThreads) CPUs = AllowedCPUs();
+   for (int Worker = 1; Worker < NThreads; Worker++) {
+      int CPU = CPUs.empty() ? -1 : CPUs[Worker % CPUs.size()];
+      I_Workers.push_back(std::thread([this,Worker,CPU] {
+         PinToCPU(CPU);
+         WorkerLoop(Worker);
+      }));
+   }
+   if (!CPUs.empty()) PinToCPU(CPUs[0]);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      D e s t r u c t o r
+
+ThreadPool::~ThreadPool ()
+{
+   {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_Stop = true;
+      I_Generation++;
+   }
+   I_WorkReady.notify_all();
+   for (size_t Index = 0; Index < I_Workers.size(); Index++) I_Workers[Index].join();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      P a r t i t i o n
+//
+//  Partition() returns the range of items (First up to, but not including, Last) for piece
+//  Part of a split of NItems into NParts pieces. The pieces are contiguous and as near equal
+//  as possible, the first NItems % NParts of them getting one item more than the others.
+
+void ThreadPool::Partition (long NItems, int NParts, int Part, long* First, long* Last)
+{
+   if (NParts < 1) NParts = 1;
+   long Base = NItems / NParts;
+   long Extra = NItems % NParts;
+   *First = Part * Base + ((Part < Extra) ? Part : Extra);
+   *Last = *First + Base + ((Part < Extra) ? 1 : 0);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                   P a r a l l e l  F o r
+//
+//  ParallelFor() splits NItems items into pieces, one for each thread unless MaxParts is
+//  smaller than the number of threads, calls Task for each piece, and returns once all the
+//  pieces have been done. There are never more pieces than items. With only one piece, Task
+//  is just called directly, with no synchronisation at all. Only one thread should call
+//  ParallelFor() for a given pool at any one time.
+
+void ThreadPool::ParallelFor (long NItems, ThreadPoolTask Task, void* Context, int MaxParts)
+{
+   int NParts = I_NThreads;
+   if (MaxParts > 0 && MaxParts < NParts) NParts = MaxParts;
+   if (NItems < NParts) NParts = int(NItems);
+   if (NParts <= 1) {
+      if (NItems > 0) (*Task)(Context,0,NItems,0);
+   } else {
+
+      //  Post the job. The details are set and the generation incremented under the mutex,
+      //  which is where the workers copy them from (see WorkerLoop()), and which also means
+      //  a worker that is just about to block can't miss the notification.
+
+      {
+         std::lock_guard<std::mutex> Lock(I_Mutex);
+         I_Job.Task = Task;
+         I_Job.Context = Context;
+         I_Job.NItems = NItems;
+         I_Job.NParts = NParts;
+         I_Outstanding.store(NParts - 1);
+         I_Generation.fetch_add(1);
+      }
+      I_WorkReady.notify_all();
+
+      //  Do the first piece ourselves, then wait for the others.
+
+      long First,Last;
+      Partition(NItems,NParts,0,&First,&Last);
+      (*Task)(Context,First,Last,0);
+      int Spins = 0;
+      while (I_Outstanding.load(std::memory_order_acquire) > 0) {
+         if (Spins < SpinCount) {
+            Spins++;
+         } else {
+            std::this_thread::yield();
+         }
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    W o r k e r  L o o p
+//
+//  WorkerLoop() is run by each worker thread. It waits for the generation counter to change,
+//  runs its piece of the new job (if the job has enough pieces to include one for this
+//  worker), and goes back to waiting, until the pool is stopped.
+//
+//  The generation and the details of the job are copied together, under the mutex, and only
+//  the copy is used. A worker with no piece of a job isn't waited for, so it may not get
+//  round to looking at the details until the next job has been posted - and if it read the
+//  generation and the details separately, it could take the new job's details for the old
+//  generation, run a piece of the new job, and then run the same piece again once it saw
+//  the new generation. Taking the mutex once per job costs little next to the job itself.
+
+void ThreadPool::WorkerLoop (int Worker)
+{
+   unsigned long Seen = 0;
+   for (;;) {
+      int Spins = 0;
+      while (I_Generation.load(std::memory_order_acquire) == Seen && Spins < SpinCount) {
+         Spins++;
+      }
+      Job Current;
+      {
+         std::unique_lock<std::mutex> Lock(I_Mutex);
+         I_WorkReady.wait(Lock,[this,Seen] { return I_Generation.load() != Seen; });
+         if (I_Stop) break;
+         Seen = I_Generation.load();
+         Current = I_Job;
+      }
+      RunPiece(Current,Worker);
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       R u n  P i e c e
+
+void ThreadPool::RunPiece (const Job& Current, int Part)
+{
+   if (Part < Current.NParts) {
+      long First,Last;
+      Partition(Current.NItems,Current.NParts,Part,&First,&Last);
+      (*Current.Task)(Current.Context,First,Last,Part);
+      I_Outstanding.fetch_sub(1,std::memory_order_release);
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    A l l o w e d  C P U s
+//
+//  AllowedCPUs() returns the numbers of the CPUs this process is allowed to run on, in
+//  ascending order. On most multi-socket Linux systems consecutive CPU numbers fill one NUMA
+//  node before moving on to the next, so pinning threads in this order keeps the threads
+//  that work on neighbouring pieces of an array on the same node. On other systems, the
+//  list is empty, and no pinning is done.
+
+std::vector<int> ThreadPool::AllowedCPUs (void)
+{
+   std::vector<int> CPUs;
+#ifdef __linux__
+   cpu_set_t Allowed;
+   if (sched_getaffinity(0,sizeof(Allowed),&Allowed) == 0) {
+      for (int CPU = 0; CPU < CPU_SETSIZE; CPU++) {
+         if (CPU_ISSET(CPU,&Allowed)) CPUs.push_back(CPU);
+      }
+   }
+#endif
+   return CPUs;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  A v a i l a b l e  C P U s
+//
+//  AvailableCPUs() returns the number of CPUs this process is allowed to run on. On Linux this
+//  respects any restriction set by taskset or a container, which hardware_concurrency() may not.
+
+int ThreadPool::AvailableCPUs (void)
+{
+   int Count = int(AllowedCPUs().size());
+   if (Count <= 0) Count = int(std::thread::hardware_concurrency());
+   if (Count <= 0) Count = 1;
+   return Count;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      P i n  T o  C P U
+//
+//  PinToCPU() pins the calling thread to the CPU with the given number. A negative number
+//  means don't pin it at all. It does nothing on systems other than Linux.
+
+void ThreadPool::PinToCPU (int CPU)
+{
+#ifdef __linux__
+   if (CPU >= 0) {
+      cpu_set_t Set;
+      CPU_ZERO(&Set);
+      CPU_SET(CPU,&Set);
+      pthread_setaffinity_np(pthread_self(),sizeof(Set),&Set);
+   }
+#else
+   (void) CPU;
+#endif
+}
@@ -0,0 +1,132 @@
+//
+//                                 T h r e a d  P o o l . h
+//
+//  Function:
+//     A small persistent pool of worker threads for splitting loops across cores.
+//
+//  Description:
+//     The test subroutines in this study are called a very large number of times - a million
+//     times, say - and each call only processes one frame. Starting threads for each call would
+//     cost far more than the work itself, so a ThreadPool starts its worker threads once, when
+//     it is created, and they then wait to be given work. ParallelFor() splits a range of
+//     indices (typically the rows of an array) into contiguous pieces, one for each thread,
+//     has the calling thread work on the first piece while the workers handle the others, and
+//     returns when all the pieces are done. For example:
+//
+//     static void DoRows (void* Context, long First, long Last, int Part)
+//     {
+//        ... process rows First to Last - 1 ...
+//     }
+//     ThreadPool Pool(4);
+//     Pool.ParallelFor (Ny,DoRows,&SomeContext);
+//
+//     The work is passed as a plain function pointer and a void* context, rather than anything
+//     fancier, to keep the cost of handing it to the workers down to a few stores. The split
+//     is static and deterministic: for the same number of items and pieces, piece N is always
+//     the same range and is always processed by the same thread. That matters on a NUMA
+//     machine - if the same thread always works on the same rows, and the memory for those
+//     rows was first touched by that thread, the rows will be in memory local to the core the
+//     thread runs on. To help with that, the pool can pin each worker to its own CPU, so the
+//     threads don't migrate between cores (and between NUMA nodes). Partition() is public
+//     so code that initialises arrays can split them up in exactly the same way.
+//
+//     Handing out work and waiting for it to finish needs some synchronisation. Waiting
+//     threads spin for a short while before blocking, since when a subroutine is called over
+//     and over, the next piece of work usually arrives almost immediately. Even so, there is
+//     a cost of the order of a microsecond or so for each ParallelFor() call, so for small
+//     amounts of work it is faster not to use the pool at all. (ParallelFor() lets the caller
+//     limit the number of pieces, and with one piece it just calls the function directly.)
+//
+//     This uses the C++11 thread library, so needs to be compiled with C++11 or later, which
+//     is the default for any recent compiler. CPU pinning is only available on Linux.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __ThreadPool__
+#define __ThreadPool__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//  The type of the routine ParallelFor() calls for each piece of the work. It is passed the
+//  context pointer given to ParallelFor(), the range of items to process (First up to, but
+//  not including, Last) and the number of the piece, from 0 up to the number of pieces - 1.
+
+typedef void (*ThreadPoolTask) (void* Context, long First, long Last, int Part);
+
+class ThreadPool {
+public:
+   //!  Constructor. Zero threads means one for each available CPU.
+   ThreadPool (int NThreads = 0, bool PinThreads = false);
+   //!  Destructor. Stops and joins the worker threads.
+   ~ThreadPool ();
+   //!  The number of threads, including the calling thread.
+   int Threads (void) const { return I_NThreads; }
+   //!  Split NItems across the threads, using at most MaxParts pieces (0 means no limit).
+   void ParallelFor (long NItems, ThreadPoolTask Task, void* Context, int MaxParts = 0);
+   //!  Return the range for one piece of a split of NItems into NParts pieces.
+   static void Partition (long NItems, int NParts, int Part, long* First, long* Last);
+   //!  The number of CPUs available to this process.
+   static int AvailableCPUs (void);
+private:
+   //!  The loop run by each worker thread.
+   void WorkerLoop (int Worker);
+   //!  The details of a job.
+   struct Job {
+      ThreadPoolTask Task;
+      void* Context;
+      long NItems;
+      int NParts;
+   };
+   //!  Run the piece of a job for a given worker, if it has one.
+   void RunPiece (const Job& Current, int Part);
+   //!  Return the numbers of the CPUs this process may run on.
+   static std::vector<int> AllowedCPUs (void);
+   //!  Pin the calling thread to a given CPU.
+   static void PinToCPU (int CPU);
+   //!  Number of threads, including the calling thread.
+   int I_NThreads;
+   //!  The worker threads - there are I_NThreads - 1 of them.
+   std::vector<std::thread> I_Workers;
+   //!  Protects the details of the current job and the generation they belong to.
+   std::mutex I_Mutex;
+   //!  Signalled when a new job is posted, or the pool is shutting down.
+   std::condition_variable I_WorkReady;
+   //!  Incremented each time a new job is posted.
+   std::atomic<unsigned long> I_Generation;
+   //!  The number of pieces of the current job not yet finished.
+   std::atomic<int> I_Outstanding;
+   //!  Set when the pool is being destroyed.
+   std::atomic<bool> I_Stop;
+   //!  The details of the current job.
+   Job I_Job;
+   //!  Copying a pool makes no sense.
+   ThreadPool (const ThreadPool&) = delete;
+   ThreadPool& operator= (const ThreadPool&) = delete;
+};
+
+#endif
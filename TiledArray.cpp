@@ -0,0 +1,766 @@
+//
+//                             T i l e d  A r r a y . c p p
+//
+//  Function:
+//     Large 4D float arrays held as compressed tiles, with a cache of decompressed tiles.
+//
+//  Description:
+//     See the .h file for a description of TiledArray from a user's perspective. This file
+//     provides the implementation. Each compressed tile starts with a byte giving the way it
+//     was held - Raw, Rice or Quantised - and, for a quantised tile, the zero point and step
+//     of the quantisation, as doubles. After that comes either the raw floats, row by row,
+//     or the Rice coded stream of integers, one for each element, also row by row. The
+//     integers are coded as the differences from the one before (the first from zero), mapped
+//     so that small negative and small positive differences both give small values, and the
+//     stream is written most significant bit first.
+//
+//     The cache is just an array of slots, each with its own 2D array from the manager, and
+//     a table giving the slot - if any - that holds each tile. The least recently used slot
+//     is found by looking at all of them, which is fine for the small numbers of slots that
+//     make sense.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "TiledArray.h"
+
+//  The number of values in each block of the Rice coding, the selector for a block held as
+//  raw 32-bit values, and the quantised value used to mark a NaN. The range of quantised
+//  values is limited to well below NullValue.
+
+static const int BlockSize = 32;
+static const unsigned int RawBlock = 63;
+static const uint32_t NullValue = 0x7fffffff;
+static const double MaxRange = 1073741824.0;
+
+//  The bytes taken by the header of a quantised tile - the method byte, the zero point and
+//  the step.
+
+static const size_t QuantisedHeader = 1 + 2 * sizeof(double);
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    B i t  W r i t e r
+//
+//  Writes a stream of bits, most significant first, to a buffer the caller has made big
+//  enough. Put() takes up to 32 bits at a time. Bits are collected in a 64-bit word and
+//  written out a byte at a time; bits above the NBits still to be written are ignored.
+
+struct BitWriter {
+   unsigned char* Out;
+   size_t Bytes;
+   uint64_t Bits;
+   int NBits;
+   BitWriter (unsigned char* Buffer) : Out(Buffer), Bytes(0), Bits(0), NBits(0) {}
+   void Put (uint32_t Value, int N) {
+      Bits = (Bits << N) | Value;
+      NBits += N;
+      while (NBits >= 8) {
+         NBits -= 8;
+         Out[Bytes++] = (unsigned char) (Bits >> NBits);
+      }
+   }
+   void Unary (uint32_t Count) {
+      while (Count >= 32) {
+         Put(0,32);
+         Count -= 32;
+      }
+      Put(1,int(Count) + 1);
+   }
+   size_t Finish (void) {
+      if (NBits > 0) Put(0,8 - NBits);
+      return Bytes;
+   }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    B i t  R e a d e r
+//
+//  Reads a stream written by a BitWriter. The NBits bits not yet used are held at the top of
+//  a 64-bit word, which is topped up to no more than 63 bits, so any number of bits read can
+//  be shifted out in one go. It takes as many whole bytes as will fit - read as one big
+//  endian word while there are at least eight left. That can leave some bits of the next
+//  byte below the NBits, but they are the right bits, and the next Fill() puts the same ones
+//  there again. Reading past the end of the data gives zeros, and sets Overrun once it has
+//  gone further than any valid stream could need, so a corrupted stream can't send Unary()
+//  round for ever.
+
+struct BitReader {
+   const unsigned char* In;
+   const unsigned char* End;
+   uint64_t Bits;
+   int NBits;
+   int Padding;
+   bool Overrun;
+   BitReader (const unsigned char* Data, size_t Bytes) :
+      In(Data), End(Data + Bytes), Bits(0), NBits(0), Padding(0), Overrun(false) {}
+   void Fill (void) {
+      if (End - In >= 8) {
+         uint64_t Word = 0;
+         for (int I = 0; I < 8; I++) Word = (Word << 8) | In[I];
+         Bits |= Word >> NBits;
+         int Bytes = (63 - NBits) >> 3;
+         In += Bytes;
+         NBits += Bytes * 8;
+         return;
+      }
+      while (NBits <= 55) {
+         if (In < End) {
+            Bits |= uint64_t(*In++) << (56 - NBits);
+         } else if (++Padding > 8) {
+            Overrun = true;
+         }
+         NBits += 8;
+      }
+   }
+   uint32_t Get (int N) {
+      if (N == 0) return 0;
+      if (NBits < N) Fill();
+      uint32_t Value = uint32_t(Bits >> (64 - N));
+      Bits <<= N;
+      NBits -= N;
+      return Value;
+   }
+   uint32_t Unary (void) {
+      uint32_t Count = 0;
+      for (;;) {
+         if (NBits == 0) Fill();
+         if (Overrun) return 0;
+         if (Bits != 0) {
+            int Zeros = LeadingZeros(Bits);
+            if (Zeros < NBits) {
+               Bits = (Zeros < 63) ? (Bits << (Zeros + 1)) : 0;
+               NBits -= (Zeros + 1);
+               return Count + uint32_t(Zeros);
+            }
+         }
+         Count += uint32_t(NBits);
+         Bits = 0;
+         NBits = 0;
+      }
+   }
+   static int LeadingZeros (uint64_t Word) {
+#if defined(__GNUC__)
+      return __builtin_clzll(Word);
+#else
+      int Zeros = 0;
+      while (!(Word & (uint64_t(1) << 63))) {
+         Word <<= 1;
+         Zeros++;
+      }
+      return Zeros;
+#endif
+   }
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 R i c e  E n c o d e
+//
+//  RiceEncode() codes NValues integers as described at the start of this file, returning
+//  the number of bytes written. For each block, the number of low bits to hold as they are,
+//  K, is first estimated from the sum of the mapped values, and then the exact cost of K and of
+//  K + 1 are compared, as is the cost of holding the block raw, which limits the worst case
+//  to a little over 32 bits a value.
+
+static size_t RiceEncode (const uint32_t* Values, long NValues, unsigned char* Out)
+{
+   BitWriter Writer(Out);
+   uint32_t Previous = 0;
+   uint32_t Mapped[BlockSize];
+   for (long First = 0; First < NValues; First += BlockSize) {
+      int N = int(std::min(long(BlockSize),NValues - First));
+      uint64_t Sum = 0;
+      for (int I = 0; I < N; I++) {
+         uint32_t Diff = Values[First + I] - Previous;
+         Previous = Values[First + I];
+         Mapped[I] = (Diff << 1) ^ (0u - (Diff >> 31));
+         Sum += Mapped[I];
+      }
+      int K = 0;
+      while (K < 30 && (uint64_t(N) << (K + 1)) <= Sum) K++;
+      uint64_t Cost = 0, CostUp = 0;
+      for (int I = 0; I < N; I++) {
+         Cost += Mapped[I] >> K;
+         CostUp += Mapped[I] >> (K + 1);
+      }
+      Cost += uint64_t(N) * (K + 1);
+      CostUp += uint64_t(N) * (K + 2);
+      if (CostUp < Cost) {
+         K++;
+         Cost = CostUp;
+      }
+      if (Cost >= uint64_t(N) * 32) {
+         Writer.Put(RawBlock,6);
+         for (int I = 0; I < N; I++) Writer.Put(Mapped[I],32);
+      } else {
+         Writer.Put(uint32_t(K),6);
+         uint32_t Mask = (1u << K) - 1u;
+         for (int I = 0; I < N; I++) {
+            Writer.Unary(Mapped[I] >> K);
+            if (K) Writer.Put(Mapped[I] & Mask,K);
+         }
+      }
+   }
+   return Writer.Finish();
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 R i c e  D e c o d e
+//
+//  RiceDecode() reverses RiceEncode(), returning false if the data runs out too soon or has
+//  a block selector that makes no sense. Almost every value's unary part and low bits are
+//  in the bits already read, so they are taken in one go, with a count of leading zeros, and
+//  only long unary runs use the general routines.
+
+static bool RiceDecode (const unsigned char* Data, size_t Bytes, uint32_t* Values, long NValues)
+{
+   BitReader Reader(Data,Bytes);
+   uint32_t Previous = 0;
+   for (long First = 0; First < NValues; First += BlockSize) {
+      long Last = std::min(First + BlockSize,NValues);
+      uint32_t K = Reader.Get(6);
+      if (K == RawBlock) {
+         for (long I = First; I < Last; I++) {
+            uint32_t Mapped = Reader.Get(32);
+            Previous += (Mapped >> 1) ^ (0u - (Mapped & 1u));
+            Values[I] = Previous;
+         }
+      } else if (K <= 31) {
+         const uint32_t Mask = (1u << K) - 1u;
+         for (long I = First; I < Last; I++) {
+            uint32_t Mapped;
+            if (Reader.NBits < 40) Reader.Fill();
+            int Zeros = Reader.Bits ? BitReader::LeadingZeros(Reader.Bits) : 64;
+            int Used = Zeros + 1 + int(K);
+            if (Used <= Reader.NBits) {
+               Mapped = (uint32_t(Zeros) << K) | (uint32_t(Reader.Bits >> (64 - Used)) & Mask);
+               Reader.Bits <<= Used;
+               Reader.NBits -= Used;
+            } else {
+               Mapped = Reader.Unary() << K;
+               Mapped |= Reader.Get(int(K));
+            }
+            Previous += (Mapped >> 1) ^ (0u - (Mapped & 1u));
+            Values[I] = Previous;
+         }
+      } else {
+         return false;
+      }
+      if (Reader.Overrun) return false;
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  O r d e r e d  B i t s
+//
+//  OrderedBits() turns a float into an unsigned integer that sorts in the same order, by
+//  setting the sign bit of a positive float and inverting all the bits of a negative one.
+//  Neighbouring floats then give neighbouring integers, so their differences are small.
+//  FromOrderedBits() does the reverse.
+
+static inline uint32_t OrderedBits (float Value)
+{
+   uint32_t Bits;
+   memcpy(&Bits,&Value,sizeof(Bits));
+   return (Bits & 0x80000000u) ? ~Bits : (Bits | 0x80000000u);
+}
+
+static inline float FromOrderedBits (uint32_t Bits)
+{
+   Bits = (Bits & 0x80000000u) ? (Bits & 0x7fffffffu) : ~Bits;
+   float Value;
+   memcpy(&Value,&Bits,sizeof(Value));
+   return Value;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      C o n s t r u c t o r
+//
+//  The constructor allocates the table of compressed tiles - all empty, so all zeros - and
+//  the cache, and the working space for compressing one tile. If any of it can't be
+//  allocated, Ready() returns false, and nothing else will work.
+
+TiledArray::TiledArray (ArrayManager& Manager, long Nt, long Nz, long Ny, long Nx,
+                                                long TileNx, long TileNy, int CacheTiles) :
+   I_Manager(Manager), I_Ready(false), I_TileNx(0), I_TileNy(0), I_TilesX(0), I_TilesY(0),
+   I_NTiles(0), I_Packed(NULL), I_SlotOf(NULL), I_Slots(NULL), I_NSlots(0),
+   I_Method(Quantised), I_Q(4.0f), I_Work(NULL), I_WorkBytes(0), I_Values(NULL),
+   I_Diffs(NULL), I_CompressedBytes(0), I_MaxStep(0.0), I_Clock(0), I_Hits(0), I_Misses(0)
+{
+   I_Dims[0] = Nx;
+   I_Dims[1] = Ny;
+   I_Dims[2] = Nz;
+   I_Dims[3] = Nt;
+   if (Nx <= 0 || Ny <= 0 || Nz <= 0 || Nt <= 0) return;
+   if (TileNx <= 0) TileNx = 128;
+   if (TileNy <= 0) TileNy = 128;
+   I_TileNx = std::min(TileNx,Nx);
+   I_TileNy = std::min(TileNy,Ny);
+   I_TilesX = (Nx + I_TileNx - 1) / I_TileNx;
+   I_TilesY = (Ny + I_TileNy - 1) / I_TileNy;
+   I_NTiles = I_TilesX * I_TilesY * Nz * Nt;
+   I_Packed = (Packed*) malloc(I_NTiles * sizeof(Packed));
+   I_SlotOf = (int*) malloc(I_NTiles * sizeof(int));
+   if (!I_Packed || !I_SlotOf) return;
+   for (long Index = 0; Index < I_NTiles; Index++) {
+      I_Packed[Index].Data = NULL;
+      I_Packed[Index].Bytes = 0;
+      I_SlotOf[Index] = -1;
+   }
+   long TileValues = I_TileNx * I_TileNy;
+   I_WorkBytes = QuantisedHeader + TileValues * sizeof(uint32_t) + TileValues / BlockSize + 8;
+   I_Work = (unsigned char*) malloc(I_WorkBytes);
+   I_Values = (uint32_t*) malloc(TileValues * sizeof(uint32_t));
+   I_Diffs = (float*) malloc(TileValues * sizeof(float));
+   if (CacheTiles < 1) CacheTiles = 1;
+   I_Slots = (Slot*) malloc(CacheTiles * sizeof(Slot));
+   if (!I_Work || !I_Values || !I_Diffs || !I_Slots) return;
+   for (int ISlot = 0; ISlot < CacheTiles; ISlot++) {
+      Slot& Cached = I_Slots[ISlot];
+      Cached.Tile = (float**) I_Manager.Malloc2D(sizeof(float),I_TileNy,I_TileNx);
+      if (Cached.Tile == NULL) return;
+      Cached.Index = -1;
+      Cached.Dirty = false;
+      Cached.Pins = 0;
+      Cached.LastUsed = 0;
+      I_NSlots++;
+   }
+   I_Ready = true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e s t r u c t o r
+//
+//  Any changes to tiles still in the cache are lost - Flush() first if they are wanted.
+
+TiledArray::~TiledArray ()
+{
+   if (I_Packed) {
+      for (long Index = 0; Index < I_NTiles; Index++) free(I_Packed[Index].Data);
+      free(I_Packed);
+   }
+   if (I_Slots) {
+      for (int ISlot = 0; ISlot < I_NSlots; ISlot++) I_Manager.Free(I_Slots[ISlot].Tile);
+      free(I_Slots);
+   }
+   free(I_SlotOf);
+   free(I_Work);
+   free(I_Values);
+   free(I_Diffs);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                  S e t  C o m p r e s s i o n
+//
+//  This affects tiles compressed from now on. Tiles already compressed stay as they are.
+
+void TiledArray::SetCompression (Method Which, float Q)
+{
+   I_Method = Which;
+   I_Q = (Q > 0.0f) ? Q : 4.0f;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                          E x t e n t
+
+void TiledArray::Extent (long Index, long* X0, long* X1, long* Y0, long* Y1) const
+{
+   long InPlane = Index % (I_TilesX * I_TilesY);
+   *X0 = (InPlane % I_TilesX) * I_TileNx;
+   *Y0 = (InPlane / I_TilesX) * I_TileNy;
+   *X1 = std::min(*X0 + I_TileNx,I_Dims[0]);
+   *Y1 = std::min(*Y0 + I_TileNy,I_Dims[1]);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                            L o a d
+//
+//  Load() gets a tile into the cache, if it isn't there already, and returns the slot that
+//  holds it. The slot used is the least recently used one not pinned by GetTile(), and the
+//  tile it held is compressed again first if it was changed. If Fill is false, the tile is
+//  about to be overwritten completely, so isn't decompressed. Returns -1 if every slot is
+//  pinned, or the tile can't be decompressed, or the one it replaces can't be compressed.
+
+int TiledArray::Load (long Index, bool Fill)
+{
+   int ISlot = I_SlotOf[Index];
+   if (ISlot >= 0) {
+      I_Hits++;
+      I_Slots[ISlot].LastUsed = ++I_Clock;
+      return ISlot;
+   }
+   I_Misses++;
+   for (int Candidate = 0; Candidate < I_NSlots; Candidate++) {
+      if (I_Slots[Candidate].Pins == 0) {
+         if (ISlot < 0 || I_Slots[Candidate].LastUsed < I_Slots[ISlot].LastUsed) {
+            ISlot = Candidate;
+         }
+      }
+   }
+   if (ISlot < 0) return -1;
+   Slot& Cached = I_Slots[ISlot];
+   if (Cached.Index >= 0) {
+      if (Cached.Dirty && !Store(ISlot)) return -1;
+      I_SlotOf[Cached.Index] = -1;
+      Cached.Index = -1;
+   }
+   long X0, X1, Y0, Y1;
+   Extent(Index,&X0,&X1,&Y0,&Y1);
+   if (Fill && !Decompress(I_Packed[Index],Cached.Tile,X1 - X0,Y1 - Y0)) return -1;
+   Cached.Index = Index;
+   Cached.Dirty = false;
+   Cached.LastUsed = ++I_Clock;
+   I_SlotOf[Index] = ISlot;
+   return ISlot;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           S t o r e
+//
+//  Store() compresses the tile held in a cache slot, replacing its old packed form. If the
+//  memory for the new form can't be had, the old one is kept and the tile stays changed.
+
+bool TiledArray::Store (int ISlot)
+{
+   Slot& Cached = I_Slots[ISlot];
+   long X0, X1, Y0, Y1;
+   Extent(Cached.Index,&X0,&X1,&Y0,&Y1);
+   size_t Bytes = Compress(Cached.Tile,X1 - X0,Y1 - Y0);
+   unsigned char* Data = (unsigned char*) malloc(Bytes);
+   if (Data == NULL) return false;
+   memcpy(Data,I_Work,Bytes);
+   Packed& Tile = I_Packed[Cached.Index];
+   free(Tile.Data);
+   I_CompressedBytes = I_CompressedBytes - Tile.Bytes + Bytes;
+   Tile.Data = Data;
+   Tile.Bytes = Bytes;
+   Cached.Dirty = false;
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                         C o m p r e s s
+//
+//  Compress() compresses Nx by Ny values from a tile into I_Work, falling back from one
+//  method to the next as described in the .h file, and returns the number of bytes used.
+
+size_t TiledArray::Compress (float** Tile, long Nx, long Ny)
+{
+   long NValues = Nx * Ny;
+   size_t RawBytes = 1 + NValues * sizeof(float);
+   Method Which = I_Method;
+   size_t Bytes = 0;
+   if (Which == Quantised) {
+      float Min = std::numeric_limits<float>::max();
+      float Max = -Min;
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         for (long Ix = 0; Ix < Nx; Ix++) {
+            float Value = Tile[Iy][Ix];
+            if (Value == Value) {
+               if (Value < Min) Min = Value;
+               if (Value > Max) Max = Value;
+            }
+         }
+      }
+      double Step = Noise(Tile,Nx,Ny) / I_Q;
+      double Zero = Min;
+      if (Step > 0.0 && (double(Max) - Zero) / Step < MaxRange) {
+         uint32_t* Value = I_Values;
+         for (long Iy = 0; Iy < Ny; Iy++) {
+            const float* Row = Tile[Iy];
+            for (long Ix = 0; Ix < Nx; Ix++) {
+               float X = Row[Ix];
+               *Value++ = (X == X) ? uint32_t((X - Zero) / Step + 0.5) : NullValue;
+            }
+         }
+         I_Work[0] = (unsigned char) Quantised;
+         memcpy(I_Work + 1,&Zero,sizeof(Zero));
+         memcpy(I_Work + 1 + sizeof(Zero),&Step,sizeof(Step));
+         Bytes = QuantisedHeader + RiceEncode(I_Values,NValues,I_Work + QuantisedHeader);
+         if (Bytes < RawBytes && Step > I_MaxStep) I_MaxStep = Step;
+      } else {
+         Which = Rice;
+      }
+   }
+   if (Which == Rice) {
+      uint32_t* Value = I_Values;
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         for (long Ix = 0; Ix < Nx; Ix++) *Value++ = OrderedBits(Tile[Iy][Ix]);
+      }
+      I_Work[0] = (unsigned char) Rice;
+      Bytes = 1 + RiceEncode(I_Values,NValues,I_Work + 1);
+   }
+   if (Which == Raw || Bytes >= RawBytes) {
+      I_Work[0] = (unsigned char) Raw;
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         memcpy(I_Work + 1 + Iy * Nx * sizeof(float),Tile[Iy],Nx * sizeof(float));
+      }
+      Bytes = RawBytes;
+   }
+   return Bytes;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       D e c o m p r e s s
+//
+//  Decompress() unpacks a tile into Nx by Ny values of a tile in the cache. A tile with no
+//  packed form has never been set, and is all zeros.
+
+bool TiledArray::Decompress (const Packed& From, float** Tile, long Nx, long Ny)
+{
+   long NValues = Nx * Ny;
+   if (From.Data == NULL) {
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         for (long Ix = 0; Ix < Nx; Ix++) Tile[Iy][Ix] = 0.0f;
+      }
+      return true;
+   }
+   int Which = From.Data[0];
+   if (Which == Raw) {
+      if (From.Bytes != 1 + NValues * sizeof(float)) return false;
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         memcpy(Tile[Iy],From.Data + 1 + Iy * Nx * sizeof(float),Nx * sizeof(float));
+      }
+   } else if (Which == Rice) {
+      if (!RiceDecode(From.Data + 1,From.Bytes - 1,I_Values,NValues)) return false;
+      const uint32_t* Value = I_Values;
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         for (long Ix = 0; Ix < Nx; Ix++) Tile[Iy][Ix] = FromOrderedBits(*Value++);
+      }
+   } else if (Which == Quantised && From.Bytes >= QuantisedHeader) {
+      double Zero, Step;
+      memcpy(&Zero,From.Data + 1,sizeof(Zero));
+      memcpy(&Step,From.Data + 1 + sizeof(Zero),sizeof(Step));
+      const size_t Header = QuantisedHeader;
+      if (!RiceDecode(From.Data + Header,From.Bytes - Header,I_Values,NValues)) return false;
+      const float NaN = std::numeric_limits<float>::quiet_NaN();
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         const int32_t* Value = (const int32_t*) I_Values + Iy * Nx;
+         float* Row = Tile[Iy];
+         for (long Ix = 0; Ix < Nx; Ix++) {
+            float Restored = float(Zero + double(Value[Ix]) * Step);
+            Row[Ix] = (Value[Ix] == int32_t(NullValue)) ? NaN : Restored;
+         }
+      }
+   } else {
+      return false;
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           N o i s e
+//
+//  Noise() estimates the noise in a tile from the median absolute second difference along
+//  its rows - |2x[i] - x[i-1] - x[i+1]| - which, unlike the difference between neighbours,
+//  isn't thrown off by a smooth gradient across the tile. For Gaussian noise of standard
+//  deviation sigma the second difference has a standard deviation of sqrt(6) sigma, and
+//  the median absolute value of a Gaussian is 0.6745 of its standard deviation, which gives
+//  the scale factor. If the rows are too short, the columns are used instead. NaNs are left
+//  out. fpack uses much the same estimate.
+
+float TiledArray::Noise (float** Tile, long Nx, long Ny)
+{
+   long NDiffs = 0;
+   if (Nx >= 3) {
+      for (long Iy = 0; Iy < Ny; Iy++) {
+         const float* Row = Tile[Iy];
+         for (long Ix = 1; Ix < Nx - 1; Ix++) {
+            float Diff = 2.0f * Row[Ix] - Row[Ix - 1] - Row[Ix + 1];
+            if (Diff == Diff) I_Diffs[NDiffs++] = (Diff < 0.0f) ? -Diff : Diff;
+         }
+      }
+   } else if (Ny >= 3) {
+      for (long Ix = 0; Ix < Nx; Ix++) {
+         for (long Iy = 1; Iy < Ny - 1; Iy++) {
+            float Diff = 2.0f * Tile[Iy][Ix] - Tile[Iy - 1][Ix] - Tile[Iy + 1][Ix];
+            if (Diff == Diff) I_Diffs[NDiffs++] = (Diff < 0.0f) ? -Diff : Diff;
+         }
+      }
+   }
+   if (NDiffs == 0) return 0.0f;
+   std::nth_element(I_Diffs,I_Diffs + NDiffs / 2,I_Diffs + NDiffs);
+   return I_Diffs[NDiffs / 2] * float(1.0 / (0.6745 * 2.449490));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        G e t  T i l e
+//
+//  GetTile() gets tile [Ty][Tx] of plane Iz of cube It into the cache and pins it there, so
+//  that the address returned stays good until ReleaseTile() - a tile can be got more than
+//  once, and must then be released as many times. Returns NULL if the tile is outside the
+//  array, or can't be got into the cache - because every slot is pinned, for example.
+
+float** TiledArray::GetTile (long It, long Iz, long Ty, long Tx, bool Modify)
+{
+   if (!I_Ready || It < 0 || It >= I_Dims[3] || Iz < 0 || Iz >= I_Dims[2] ||
+                         Ty < 0 || Ty >= I_TilesY || Tx < 0 || Tx >= I_TilesX) return NULL;
+   long Index = ((It * I_Dims[2] + Iz) * I_TilesY + Ty) * I_TilesX + Tx;
+   int ISlot = Load(Index,true);
+   if (ISlot < 0) return NULL;
+   I_Slots[ISlot].Pins++;
+   if (Modify) I_Slots[ISlot].Dirty = true;
+   return I_Slots[ISlot].Tile;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     R e l e a s e  T i l e
+
+void TiledArray::ReleaseTile (float** Tile)
+{
+   for (int ISlot = 0; ISlot < I_NSlots; ISlot++) {
+      if (I_Slots[ISlot].Tile == Tile && I_Slots[ISlot].Pins > 0) {
+         I_Slots[ISlot].Pins--;
+         break;
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     S t o r e  P l a n e
+//
+//  StorePlane() replaces every tile of the plane, so it has no need to decompress them
+//  first. Like FetchPlane(), it needs one slot of the cache that isn't pinned.
+
+bool TiledArray::StorePlane (long It, long Iz, float** Plane)
+{
+   if (!I_Ready || It < 0 || It >= I_Dims[3] || Iz < 0 || Iz >= I_Dims[2]) return false;
+   long First = (It * I_Dims[2] + Iz) * I_TilesY * I_TilesX;
+   for (long Index = First; Index < First + I_TilesY * I_TilesX; Index++) {
+      int ISlot = Load(Index,false);
+      if (ISlot < 0) return false;
+      long X0, X1, Y0, Y1;
+      Extent(Index,&X0,&X1,&Y0,&Y1);
+      float** Tile = I_Slots[ISlot].Tile;
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         memcpy(Tile[Iy - Y0],Plane[Iy] + X0,(X1 - X0) * sizeof(float));
+      }
+      I_Slots[ISlot].Dirty = true;
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                     F e t c h  P l a n e
+
+bool TiledArray::FetchPlane (long It, long Iz, float** Plane)
+{
+   if (!I_Ready || It < 0 || It >= I_Dims[3] || Iz < 0 || Iz >= I_Dims[2]) return false;
+   long First = (It * I_Dims[2] + Iz) * I_TilesY * I_TilesX;
+   for (long Index = First; Index < First + I_TilesY * I_TilesX; Index++) {
+      int ISlot = Load(Index,true);
+      if (ISlot < 0) return false;
+      long X0, X1, Y0, Y1;
+      Extent(Index,&X0,&X1,&Y0,&Y1);
+      float** Tile = I_Slots[ISlot].Tile;
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         memcpy(Plane[Iy] + X0,Tile[Iy - Y0],(X1 - X0) * sizeof(float));
+      }
+   }
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                       G e t  a n d  S e t
+//
+//  Get() and Set() go through the cache for each element, so are only for occasional use.
+
+float TiledArray::Get (long It, long Iz, long Iy, long Ix)
+{
+   float Value = 0.0f;
+   if (Iy >= 0 && Iy < I_Dims[1] && Ix >= 0 && Ix < I_Dims[0]) {
+      float** Tile = GetTile(It,Iz,Iy / I_TileNy,Ix / I_TileNx);
+      if (Tile) {
+         Value = Tile[Iy % I_TileNy][Ix % I_TileNx];
+         ReleaseTile(Tile);
+      }
+   }
+   return Value;
+}
+
+bool TiledArray::Set (long It, long Iz, long Iy, long Ix, float Value)
+{
+   if (Iy < 0 || Iy >= I_Dims[1] || Ix < 0 || Ix >= I_Dims[0]) return false;
+   float** Tile = GetTile(It,Iz,Iy / I_TileNy,Ix / I_TileNx,true);
+   if (Tile == NULL) return false;
+   Tile[Iy % I_TileNy][Ix % I_TileNx] = Value;
+   ReleaseTile(Tile);
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                           F l u s h
+
+bool TiledArray::Flush (void)
+{
+   bool Status = true;
+   for (int ISlot = 0; ISlot < I_NSlots; ISlot++) {
+      if (I_Slots[ISlot].Index >= 0 && I_Slots[ISlot].Dirty) {
+         if (!Store(ISlot)) Status = false;
+      }
+   }
+   return Status;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                        E n q u i r i e s
+//
+//  CacheBytes() counts just the elements of the cached tiles, not their row pointers.
+
+double TiledArray::RawBytes (void) const
+{
+   return double(I_Dims[0]) * I_Dims[1] * I_Dims[2] * I_Dims[3] * sizeof(float);
+}
+
+size_t TiledArray::CacheBytes (void) const
+{
+   return size_t(I_NSlots) * I_TileNx * I_TileNy * sizeof(float);
+}
@@ -0,0 +1,271 @@
+//
+//                               T i l e d  A r r a y . h
+//
+//  Function:
+//     Large 4D float arrays held as compressed tiles, with a cache of decompressed tiles.
+//
+//  Description:
+//     A 4D data product - Nt cubes of Nz planes of Ny rows of Nx columns - allocated by
+//     ArrayManager::Malloc4D() has to fit into memory all at once, and often it doesn't, even
+//     though most of it is smooth sky background that would compress well. A TiledArray holds
+//     the same data in far less memory, at the cost of having to decompress a part of it
+//     before it can be used, and to compress it again if it has been changed.
+//
+//     Each plane of the array is split into tiles of TileNx by TileNy elements (the tiles at
+//     the right and bottom edges are cut short if the plane isn't a multiple of the tile
+//     size), and each tile is compressed separately, so any one can be got at without
+//     touching the others. A small number of tiles - CacheTiles, given to the constructor -
+//     are kept decompressed at any one time, in ordinary 2D arrays allocated by the
+//     ArrayManager given to the constructor, so the memory they take shows in that manager's
+//     usage counts (see ArrayManager::GetUsage()). When a tile that isn't in the cache is
+//     wanted, the one that has gone unused for longest is dropped to make room for it -
+//     compressed again first, if it was changed.
+//
+//     GetTile() returns a decompressed tile as a row pointer array, indexed Tile[Iy][Ix] from
+//     the corner of the tile, and the tile stays in the cache until it is handed back with
+//     ReleaseTile(). If the tile is to be changed, GetTile() must be told so, and the tile is
+//     then compressed again when it leaves the cache or when Flush() is called. ForEachTile()
+//     does all this for every tile of the array in turn, in the order they are stored, calling
+//     a visitor for each one - any class with an operator() taking (Tile,X0,X1,Y0,Y1,Iz,It),
+//     where the tile covers elements X0 up to, but not including, X1, and the same for Y, of
+//     plane Iz of cube It - which is the same form as the visitors for ForEachTile2D() in
+//     Tiling.h, with the tile itself and the plane added. A kernel written this way needs only
+//     one tile in the cache, and touches each tile just once.
+//
+//     StorePlane() and FetchPlane() copy a whole plane of the array in from or out to any 2D
+//     row pointer array of the right size, such as one from ArrayManager::Malloc2D(), and
+//     Get() and Set() get at single elements, which is convenient but slow.
+//
+//     There are three ways a tile can be held, set by SetCompression():
+//
+//     Raw        The elements are simply copied. This saves nothing, but shows the cost of
+//                the tiling and caching on its own.
+//
+//     Rice       The bit pattern of each float is turned into an integer that sorts in the
+//                same order as the float, and the differences between successive integers are
+//                Rice coded. This is lossless, but floats with noise in their low bits don't
+//                compress much - usually by less than a factor of two.
+//
+//     Quantised  The default. As in the FITS tiled image convention (and fpack), each tile's
+//                values are quantised to integers in steps of the tile's noise level divided
+//                by Q, and the differences between successive integers are Rice coded. The
+//                noise level is estimated from the median absolute second difference along the
+//                rows (or the columns, if the rows are too short), |2x[i] - x[i-1] - x[i+1]|,
+//                scaled by 1/(0.6745 sqrt(6)) to give the standard deviation of Gaussian noise
+//                - which a smooth gradient doesn't throw off - so flat background that changes
+//                by little more than the noise compresses by a factor of several. No value is
+//                changed by more than half a step - 1/(2Q) of the noise - and NaNs are
+//                preserved. The default Q of 4 is fpack's; a larger Q keeps more of the noise,
+//                and compresses less.
+//
+//     A tile that doesn't suit the method chosen falls back to the next one: a tile with no
+//     noise, or with values too far apart to quantise, is compressed losslessly, and one that
+//     Rice coding would make bigger is held raw. So no tile takes more than a few bytes more
+//     than its raw size. A tile that has never been set holds zeros, and takes no memory.
+//
+//     The Rice coding works on blocks of 32 values, each with a 6-bit code giving the number
+//     of low bits held as they are - chosen from the mean of the block's values, as in the
+//     CCSDS and FITS Rice coders - with the rest of each value in unary. It decodes well over
+//     a hundred million values a second on a current CPU, so the cost of getting at a tile is
+//     small and bounded, but it is a cost: a kernel that does as little with each element as
+//     adding it to a total runs well over ten times slower on compressed tiles than on an
+//     ordinary array that fits in memory.
+//
+//     Be aware that a quantised tile that is changed is quantised again when it is compressed,
+//     which can move its values by up to another half a step, so a tile that is changed many
+//     times can drift by more than half a step from its values as first stored. Tiles that
+//     are only read are never compressed again.
+//
+//     A TiledArray is not thread-safe. Its errors are reported in the way ArrayManager's
+//     are: the routines that can fail return NULL or false, and Ready() shows whether the
+//     constructor managed to allocate what it needed. CompressedBytes(), CacheBytes(), Hits()
+//     and Misses() show how well it is doing.
+//
+//     ctiledmain.cpp is a test program that holds a stack of simulated frames in a TiledArray,
+//     and times a kernel that works through it a tile at a time. TiledArray itself uses
+//     nothing beyond C++98, but ctiledmain.cpp needs C++11, since BenchHarness.h, which does
+//     its timing, uses <chrono>.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Corrected the descriptions of the noise estimate and of what needs C++11.
+//
+//  Copyright (c) 2019 Knave and Varlet
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef __TiledArray__
+#define __TiledArray__
+
+#include <stddef.h>
+
+#include "ArrayManager.h"
+
+class TiledArray {
+public:
+   //!  The ways a tile can be held.
+   enum Method { Raw, Rice, Quantised };
+   //!  Constructor, for an array of Nt cubes of Nz planes of Ny rows of Nx columns, with
+   //!  tiles of TileNx by TileNy elements (zero meaning 128), and up to CacheTiles tiles
+   //!  decompressed at once in arrays allocated by Manager.
+   TiledArray (ArrayManager& Manager, long Nt, long Nz, long Ny, long Nx,
+                                      long TileNx = 0, long TileNy = 0, int CacheTiles = 8);
+   //!  Destructor. Releases the compressed tiles and the cache.
+   ~TiledArray ();
+   //!  True if the constructor was able to allocate everything it needed.
+   bool Ready (void) const { return I_Ready; }
+   //!  Set the way tiles are compressed from now on. Q is the noise level over the
+   //!  quantisation step, for the Quantised method.
+   void SetCompression (Method Which, float Q = 4.0f);
+   //!  Get a tile, decompressed, kept in the cache until ReleaseTile() is called. Modify
+   //!  must be true if the tile is to be changed.
+   float** GetTile (long It, long Iz, long Ty, long Tx, bool Modify = false);
+   //!  Hand back a tile returned by GetTile().
+   void ReleaseTile (float** Tile);
+   //!  Call a visitor for each tile in turn.
+   template <class Visitor> bool ForEachTile (Visitor& Visit, bool Modify = false);
+   //!  Copy a whole plane into the array from a 2D row pointer array.
+   bool StorePlane (long It, long Iz, float** Plane);
+   //!  Copy a whole plane of the array out to a 2D row pointer array.
+   bool FetchPlane (long It, long Iz, float** Plane);
+   //!  Get one element. Returns zero if the element is outside the array.
+   float Get (long It, long Iz, long Iy, long Ix);
+   //!  Set one element.
+   bool Set (long It, long Iz, long Iy, long Ix, float Value);
+   //!  Compress any changed tiles still in the cache.
+   bool Flush (void);
+   //!  The dimensions of the array - Dims[0] is Nx, Dims[3] is Nt.
+   long Dim (int IDim) const { return (IDim >= 0 && IDim < 4) ? I_Dims[IDim] : 0; }
+   //!  The size of a full tile along X.
+   long TileNx (void) const { return I_TileNx; }
+   //!  The size of a full tile along Y.
+   long TileNy (void) const { return I_TileNy; }
+   //!  The number of tiles across a plane.
+   long TilesX (void) const { return I_TilesX; }
+   //!  The number of tiles down a plane.
+   long TilesY (void) const { return I_TilesY; }
+   //!  The bytes taken by the compressed tiles.
+   size_t CompressedBytes (void) const { return I_CompressedBytes; }
+   //!  The bytes the array would take uncompressed.
+   double RawBytes (void) const;
+   //!  The bytes taken by the cache of decompressed tiles.
+   size_t CacheBytes (void) const;
+   //!  The largest quantisation step used for any tile - no value has been changed by
+   //!  more than half of this when first stored.
+   double MaxStep (void) const { return I_MaxStep; }
+   //!  The number of times a tile wanted was already in the cache.
+   unsigned long Hits (void) const { return I_Hits; }
+   //!  The number of times a tile wanted had to be decompressed.
+   unsigned long Misses (void) const { return I_Misses; }
+private:
+   //!  One compressed tile. Data is NULL for a tile that is all zeros.
+   struct Packed {
+      unsigned char* Data;
+      size_t Bytes;
+   };
+   //!  One tile's space in the cache.
+   struct Slot {
+      float** Tile;
+      long Index;
+      bool Dirty;
+      int Pins;
+      unsigned long LastUsed;
+   };
+   //!  The extent of a tile within its plane.
+   void Extent (long Index, long* X0, long* X1, long* Y0, long* Y1) const;
+   //!  Get a tile into the cache, decompressed if Fill is true, returning its slot, or -1.
+   int Load (long Index, bool Fill);
+   //!  Compress the tile in a cache slot back into its packed form.
+   bool Store (int ISlot);
+   //!  Compress Nx by Ny values from a tile into I_Work, returning the bytes used.
+   size_t Compress (float** Tile, long Nx, long Ny);
+   //!  Decompress a packed tile of Nx by Ny values into a tile.
+   bool Decompress (const Packed& From, float** Tile, long Nx, long Ny);
+   //!  Estimate the noise in Nx by Ny values from a tile.
+   float Noise (float** Tile, long Nx, long Ny);
+   //!  The manager for the cache arrays.
+   ArrayManager& I_Manager;
+   //!  True if the constructor succeeded.
+   bool I_Ready;
+   //!  The dimensions of the array, Nx first.
+   long I_Dims[4];
+   //!  The size of a tile.
+   long I_TileNx;
+   long I_TileNy;
+   //!  The number of tiles across and down a plane, and in total.
+   long I_TilesX;
+   long I_TilesY;
+   long I_NTiles;
+   //!  The compressed tiles, in order of plane, then tile row, then tile column.
+   Packed* I_Packed;
+   //!  The cache slot holding each tile, or -1.
+   int* I_SlotOf;
+   //!  The cache.
+   Slot* I_Slots;
+   int I_NSlots;
+   //!  The way tiles are compressed, and the Q for quantising them.
+   Method I_Method;
+   float I_Q;
+   //!  Working space for compression, big enough for the worst case.
+   unsigned char* I_Work;
+   size_t I_WorkBytes;
+   //!  Working space for the integers to be coded, one tile's worth.
+   unsigned int* I_Values;
+   //!  Working space for the noise estimate.
+   float* I_Diffs;
+   //!  Counters.
+   size_t I_CompressedBytes;
+   double I_MaxStep;
+   unsigned long I_Clock;
+   unsigned long I_Hits;
+   unsigned long I_Misses;
+   //!  Copying would release the tiles twice.
+   TiledArray (const TiledArray&);
+   TiledArray& operator= (const TiledArray&);
+};
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                    F o r  E a c h  T i l e
+//
+//  ForEachTile() calls the visitor for each of the tiles, in the order they are stored, so
+//  each is decompressed once, and the cache never needs more than one. It stops, returning
+//  false, if a tile can't be got into the cache.
+
+template <class Visitor>
+bool TiledArray::ForEachTile (Visitor& Visit, bool Modify)
+{
+   for (long Index = 0; Index < I_NTiles; Index++) {
+      long Plane = Index / (I_TilesX * I_TilesY);
+      long InPlane = Index % (I_TilesX * I_TilesY);
+      long It = Plane / I_Dims[2];
+      long Iz = Plane % I_Dims[2];
+      long Ty = InPlane / I_TilesX;
+      long Tx = InPlane % I_TilesX;
+      float** Tile = GetTile(It,Iz,Ty,Tx,Modify);
+      if (Tile == NULL) return false;
+      long X0, X1, Y0, Y1;
+      Extent(Index,&X0,&X1,&Y0,&Y1);
+      Visit(Tile,X0,X1,Y0,Y1,Iz,It);
+      ReleaseTile(Tile);
+   }
+   return true;
+}
+
+#endif
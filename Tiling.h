@@ -0,0 +1,323 @@
+//
+//                                 T i l i n g . h
+//
+//  Function:
+//     Cache-blocked (tiled) traversal of 2D and 3D arrays, and kernels built on it.
+//
+//  Description:
+//     All the tests in this study work along the rows of an array, which is the order in which
+//     C/C++ arrays are held in memory, and so the order the caches and the hardware prefetcher
+//     handle best. Plenty of real operations don't work that way. A transpose reads along the
+//     rows of one array and has to write down the columns of the other. Collapsing a 3D array
+//     into a 2D one by summing along Z - as the test code at the end of ArrayManager.cpp does
+//     - is naturally written with the Z loop innermost, and then each step of that loop jumps
+//     a whole plane through memory. For small arrays this doesn't matter, since everything
+//     stays in the cache, but once the arrays are larger than the cache each of those strided
+//     accesses can cost a cache miss, and a loop that only uses one element of each cache line
+//     it brings in can run many times slower than one that uses all of them.
+//
+//     The usual cure is to split the arrays into tiles - rectangular blocks small enough that
+//     the tiles of all the arrays involved fit into the cache together - and do all the work
+//     for one tile before moving on to the next. Within a tile the strided accesses still
+//     happen, but they hit lines that are already in the cache, and each line brought in is
+//     used in full before it is evicted. This file provides a small facility for doing that:
+//
+//     TileShape is just the size of a tile, in elements along X and Y.
+//
+//     TileShapeFor() suggests a tile shape for a given element size, a given number of arrays
+//     to be worked on at once, and a given cache size. The tiles it suggests are square-ish,
+//     with rows at least a 64 byte cache line long. The default cache size is 32 KBytes,
+//     the size of the L1 data cache of most current CPUs, and can be changed at compile time
+//     by defining TILING_CACHE_BYTES.
+//
+//     StripShapeFor() suggests tiles of the same size, but only one row high, which suits
+//     operations where every array is read along its rows and only the number of rows being
+//     worked on at once needs limiting.
+//
+//     ForEachTile2D() calls a visitor for each tile of an Nx by Ny area, in row-major order of
+//     tiles, passing it the extent of the tile. The visitor is any class with an operator()
+//     taking (X0,X1,Y0,Y1) - the tile being X0 up to, but not including, X1, and the same for
+//     Y. The tiles at the right and bottom edges are cut short if Nx and Ny aren't multiples
+//     of the tile size.
+//
+//     TiledTranspose2D(), TiledCollapseY2D() and TiledCollapseZ3D() are kernels built on
+//     ForEachTile2D(). They work on the 'Numerical Recipes' row pointer arrays returned by
+//     ArrayManager, each row of which is contiguous, and there are overloads for the typed
+//     Array2D<T> and Array3D<T> classes of ArrayTemplates.h that check the arrays are valid
+//     and the dimensions match before doing anything. (An indexed array, with no row pointers,
+//     gives an invalid Array2D<T> or Array3D<T>, so these return false for one.) The collapse
+//     kernels add the elements in exactly the same order as the obvious nested loop, so they
+//     give identical results, just sooner.
+//
+//     ctilesub.cpp uses these to provide tiled versions of the transpose() and collapse()
+//     routines driven by ctransmain.cpp and ccollmain.cpp, and cnaivesub.cpp provides the
+//     straightforward versions of the same routines for comparison.
+//
+//     This is all templates, so there is no .cpp file. It uses nothing beyond C++98.
+//
+//  History:
+//     14th Oct 2026. Original version.
+//     14th Oct 2026. Noted that indexed arrays are refused.
+//
+//  Copyright (c) Australian Astronomical Observatory (AAO), 2019.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+//  and associated documentation files (the "Software"), to deal in the Software without
+//  restriction, including without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all copies or
+//  substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+//  BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+//  DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __Tiling__
+#define __Tiling__
+
+#include <stddef.h>
+
+#include "ArrayTemplates.h"
+
+//  The cache size TileShapeFor() aims at by default.
+
+#ifndef TILING_CACHE_BYTES
+#define TILING_CACHE_BYTES 32768
+#endif
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                      T i l e  S h a p e
+
+typedef struct TileShape {
+   long Nx;          //  Elements along X (along a row)
+   long Ny;          //  Elements along Y (number of rows)
+} TileShape;
+
+//  MakeTileShape() is just a convenient way of filling in a TileShape. Values less than
+//  one are treated as one.
+
+inline TileShape MakeTileShape (long Nx, long Ny)
+{
+   TileShape Shape;
+   Shape.Nx = (Nx > 0) ? Nx : 1;
+   Shape.Ny = (Ny > 0) ? Ny : 1;
+   return Shape;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 T i l e  S h a p e  F o r
+//
+//  TileShapeFor() suggests a tile shape such that NArrays tiles of elements BytesPerElement
+//  bytes long fit into CacheBytes. It starts with one row one cache line long, and doubles
+//  whichever of the two dimensions has fewer elements while the tiles still fit, so the
+//  result is square, or twice as wide as it is high, in elements - which is what a transpose
+//  wants, since a tile of one array becomes a tile of the other with the dimensions swapped.
+
+inline TileShape TileShapeFor (
+   size_t BytesPerElement, int NArrays = 2, size_t CacheBytes = TILING_CACHE_BYTES)
+{
+   const size_t LineBytes = 64;
+   if (BytesPerElement == 0) BytesPerElement = 1;
+   if (NArrays < 1) NArrays = 1;
+   size_t Nx = LineBytes / BytesPerElement;
+   if (Nx < 1) Nx = 1;
+   size_t Ny = 1;
+   size_t Budget = CacheBytes / size_t(NArrays);
+   for (;;) {
+      size_t NewNx = (Ny < Nx) ? Nx : Nx * 2;
+      size_t NewNy = (Ny < Nx) ? Ny * 2 : Ny;
+      if (NewNx * NewNy * BytesPerElement > Budget) break;
+      Nx = NewNx;
+      Ny = NewNy;
+   }
+   return MakeTileShape(long(Nx),long(Ny));
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                S t r i p  S h a p e  F o r
+//
+//  StripShapeFor() suggests a tile shape one row high and as long as will fit in the same
+//  budget as TileShapeFor(). This is better than a square tile for an operation like the Z
+//  collapse, where nothing is transposed and every array is walked along its rows: longer
+//  runs of consecutive addresses are what the hardware prefetcher handles best, and it is
+//  only the number of rows in flight at once that needs to be limited.
+
+inline TileShape StripShapeFor (
+   size_t BytesPerElement, int NArrays = 2, size_t CacheBytes = TILING_CACHE_BYTES)
+{
+   TileShape Shape = TileShapeFor(BytesPerElement,NArrays,CacheBytes);
+   return MakeTileShape(Shape.Nx * Shape.Ny,1);
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                                 F o r  E a c h  T i l e  2 D
+//
+//  ForEachTile2D() visits each tile of an Nx by Ny area, calling Visit(X0,X1,Y0,Y1) for each.
+//  The tiles are visited a row of tiles at a time, which keeps the accesses to any array
+//  walked along its rows as near sequential as tiling allows.
+
+template <class Visitor>
+void ForEachTile2D (long Nx, long Ny, TileShape Shape, Visitor& Visit)
+{
+   if (Shape.Nx < 1) Shape.Nx = 1;
+   if (Shape.Ny < 1) Shape.Ny = 1;
+   for (long Y0 = 0; Y0 < Ny; Y0 += Shape.Ny) {
+      long Y1 = (Y0 + Shape.Ny < Ny) ? Y0 + Shape.Ny : Ny;
+      for (long X0 = 0; X0 < Nx; X0 += Shape.Nx) {
+         long X1 = (X0 + Shape.Nx < Nx) ? X0 + Shape.Nx : Nx;
+         Visit(X0,X1,Y0,Y1);
+      }
+   }
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                            T i l e d  T r a n s p o s e  2 D
+//
+//  TiledTranspose2D() sets Out[Ix][Iy] to In[Iy][Ix], In having Ny rows of Nx elements and
+//  Out having Nx rows of Ny elements. Each tile of In is read along its rows and written
+//  down the columns of the corresponding tile of Out. In and Out must not overlap. The
+//  TransposeTile class is the visitor that does the work for one tile.
+
+template <typename T>
+class TransposeTile {
+public:
+   TransposeTile (T* const* In, T** Out) : I_In(In), I_Out(Out) {}
+   void operator() (long X0, long X1, long Y0, long Y1) {
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         const T* InRow = I_In[Iy];
+         for (long Ix = X0; Ix < X1; Ix++) {
+            I_Out[Ix][Iy] = InRow[Ix];
+         }
+      }
+   }
+private:
+   T* const* I_In;
+   T** I_Out;
+};
+
+template <typename T>
+void TiledTranspose2D (T* const* In, long Nx, long Ny, T** Out, TileShape Shape)
+{
+   TransposeTile<T> Visit(In,Out);
+   ForEachTile2D(Nx,Ny,Shape,Visit);
+}
+
+template <typename T>
+bool TiledTranspose2D (const Array2D<T>& In, const Array2D<T>& Out, TileShape Shape)
+{
+   if (!In.IsValid() || !Out.IsValid()) return false;
+   if (In.Nx() != Out.Ny() || In.Ny() != Out.Nx()) return false;
+   TiledTranspose2D(In.Handle(),In.Nx(),In.Ny(),Out.Handle(),Shape);
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                           T i l e d  C o l l a p s e  Y  2 D
+//
+//  TiledCollapseY2D() sets Out[Ix] to the sum over Iy of In[Iy][Ix], In having Ny rows of Nx
+//  elements. The naive way to code this has Iy as the inner loop, walking down each column.
+//  Here the tiles are the full height of the array, so each tile is a vertical strip, and
+//  within a strip the rows are added into the strip of Out in turn. The elements of each
+//  column are still added in order of Iy, from a starting value of zero.
+
+template <typename TIn, typename TOut>
+class CollapseYTile {
+public:
+   CollapseYTile (TIn* const* In, TOut* Out) : I_In(In), I_Out(Out) {}
+   void operator() (long X0, long X1, long Y0, long Y1) {
+      if (Y0 == 0) {
+         for (long Ix = X0; Ix < X1; Ix++) I_Out[Ix] = TOut(0);
+      }
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         const TIn* InRow = I_In[Iy];
+         for (long Ix = X0; Ix < X1; Ix++) {
+            I_Out[Ix] += InRow[Ix];
+         }
+      }
+   }
+private:
+   TIn* const* I_In;
+   TOut* I_Out;
+};
+
+template <typename TIn, typename TOut>
+void TiledCollapseY2D (TIn* const* In, long Nx, long Ny, TOut* Out, TileShape Shape)
+{
+   CollapseYTile<TIn,TOut> Visit(In,Out);
+   Shape.Ny = (Ny > 0) ? Ny : 1;
+   ForEachTile2D(Nx,Ny,Shape,Visit);
+}
+
+template <typename TIn, typename TOut>
+bool TiledCollapseY2D (const Array2D<TIn>& In, const Array1D<TOut>& Out, TileShape Shape)
+{
+   if (!In.IsValid() || !Out.IsValid()) return false;
+   if (In.Nx() != Out.Nx()) return false;
+   TiledCollapseY2D(In.Handle(),In.Nx(),In.Ny(),Out.Handle(),Shape);
+   return true;
+}
+
+//  ------------------------------------------------------------------------------------------------
+
+//                           T i l e d  C o l l a p s e  Z  3 D
+//
+//  TiledCollapseZ3D() sets Out[Iy][Ix] to the sum over Iz of In[Iz][Iy][Ix], In having Nz
+//  planes of Ny rows of Nx elements. For each tile of the XY plane, the corresponding tile of
+//  each plane of In is added into the tile of Out in turn, so the tile of Out stays in the
+//  cache while it is being accumulated. The tile shape should allow for two arrays - the
+//  tile of Out and the tile of the plane being added in - and a shape from StripShapeFor()
+//  usually works best.
+
+template <typename TIn, typename TOut>
+class CollapseZTile {
+public:
+   CollapseZTile (TIn** const* In, long Nz, TOut** Out) : I_In(In), I_Nz(Nz), I_Out(Out) {}
+   void operator() (long X0, long X1, long Y0, long Y1) {
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         TOut* OutRow = I_Out[Iy];
+         for (long Ix = X0; Ix < X1; Ix++) OutRow[Ix] = TOut(0);
+      }
+      for (long Iz = 0; Iz < I_Nz; Iz++) {
+         TIn* const* Plane = I_In[Iz];
+         for (long Iy = Y0; Iy < Y1; Iy++) {
+            const TIn* InRow = Plane[Iy];
+            TOut* OutRow = I_Out[Iy];
+            for (long Ix = X0; Ix < X1; Ix++) {
+               OutRow[Ix] += InRow[Ix];
+            }
+         }
+      }
+   }
+private:
+   TIn** const* I_In;
+   long I_Nz;
+   TOut** I_Out;
+};
+
+template <typename TIn, typename TOut>
+void TiledCollapseZ3D (TIn** const* In, long Nx, long Ny, long Nz, TOut** Out, TileShape Shape)
+{
+   CollapseZTile<TIn,TOut> Visit(In,Nz,Out);
+   ForEachTile2D(Nx,Ny,Shape,Visit);
+}
+
+template <typename TIn, typename TOut>
+bool TiledCollapseZ3D (const Array3D<TIn>& In, const Array2D<TOut>& Out, TileShape Shape)
+{
+   if (!In.IsValid() || !Out.IsValid()) return false;
+   if (In.Nx() != Out.Nx() || In.Ny() != Out.Ny()) return false;
+   TiledCollapseZ3D(In.Handle(),In.Nx(),In.Ny(),In.Nz(),Out.Handle(),Shape);
+   return true;
+}
+
+#endif
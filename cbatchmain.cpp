@@ -0,0 +1,156 @@
+//
+//                         c b a t c h m a i n . c p p
+//
+// Summary:
+//    Multi-frame array access test main routine in C++, using an ArrayManager.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. It applies
+//    the same operation as the other tests - add to each element the sum of its
+//    two indices - to each frame of a stack of Nz 2D frames, held as a 3D
+//    array, and is used to compare two ways of doing that: calling the 2D
+//    subr() in cnrsub.cpp once for each frame, and calling the batched
+//    subrframes() in cbatchsub.cpp once for the whole stack.
+//
+// Structure:
+//    This main routine uses an ArrayManager to create 3D input and output
+//    arrays, each with Nz planes of Ny rows of Nx columns, fills In with test
+//    values, and then repeatedly processes all the frames. By default it calls
+//    subrframes() with the two arrays as they are; if compiled with PER_PLANE
+//    defined it instead calls subr() for each plane, passing it that plane's
+//    row table, In[Iz] and Out[Iz] - which is how a 2D routine has to be used
+//    on a 3D array. Then it checks the results. The subroutines have to be
+//    compiled separately, so the repeated calls can't be optimised away.
+//
+// Building:
+//    c++ -c -O3 -o cbatchsub.o cbatchsub.cpp
+//    c++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread
+//
+//    or, for the per-plane version:
+//
+//    c++ -c -O3 -o cnrsub.o cnrsub.cpp
+//    c++ -o cbatchmain -O3 -DPER_PLANE cbatchmain.cpp cnrsub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./cbatchmain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the stack is processed - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames - default 8.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 8 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ArrayManager.h"
+#include "BenchHarness.h"
+
+//  subr() processes one frame, subrframes() a whole stack of them. They have
+//  to be compiled separately to prevent a compiler optimising them away.
+
+void subr (float* In[], int Nx, int Ny, float* Out[]);
+void subrframes (float** In[], int Nx, int Ny, int Nz, float** Out[]);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 8;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+
+   //  Start the benchmark harness (see BenchHarness.h). It is told the stack
+   //  has Ny * Nz rows, so that its counts per element are per element of
+   //  every frame processed.
+
+   BenchHarness Bench ("cbatchmain",Nx,long(Ny) * long(Nz),Nrpt);
+   
+   ArrayManager Manager;
+   float*** In = (float***) Manager.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float*** Out = (float***) Manager.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   if (In == NULL || Out == NULL) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   
+   //  Set the input array to the test values used by the other tests, plus
+   //  the frame number so each frame is different.
+   
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            In[Iz][Iy][Ix] = float(Nx - Ix + Ny - Iy + Iz);
+         }
+      }
+   }
+   printf ("Arrays have %d frames of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+#ifdef PER_PLANE
+      for (int Iz = 0; Iz < Nz; Iz++) {
+         subr (In[Iz],Nx,Ny,Out[Iz]);
+      }
+#else
+      subrframes (In,Nx,Ny,Nz,Out);
+#endif
+   }
+   
+   //  Check that we got the expected results - each frame treated just as
+   //  the 2D tests treat their single array.
+   
+   bool Error = false;
+   for (int Iz = 0; Iz < Nz && !Error; Iz++) {
+      for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            if (Out[Iz][Iy][Ix] != In[Iz][Iy][Ix] + Ix + Iy) {
+               Error = true;
+               printf ("Error Out[%d][%d][%d] = %f, not %f\n",Iz,Iy,Ix,
+                        Out[Iz][Iy][Ix],float(In[Iz][Iy][Ix] + Ix + Iy));
+               break;
+            }
+         }
+      }
+   }
+   Bench.Report(Error);
+   return 0;
+}
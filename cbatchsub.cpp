@@ -0,0 +1,205 @@
+//
+//                          c b a t c h s u b . c p p
+//
+// Summary:
+//    Batched version of the array access test subroutine, for a stack of frames.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. The other
+//    C++ versions of subr() work on a single 2D array. In practice, data often
+//    comes as a cube of hundreds of frames, and processing it with one of those
+//    means a loop over the planes of a 3D array calling subr() for each -
+//    each call setting up its loops again, and, with a multithreaded version
+//    like the one in cpsub.cpp, handing out and waiting for work once for each
+//    frame. This routine, subrframes(), does the same operation - setting each
+//    element of Out to the corresponding element of In plus its column and row
+//    numbers within its frame - for all the frames in one call.
+//
+// This version:
+//    The arrays are passed as the float*** plane tables returned by the
+//    ArrayManager Malloc3D() routine (ArrayManager.h), so that In[Iz] is the
+//    'Numerical Recipes' row table for frame Iz, exactly what subr() in
+//    cnrsub.cpp expects. Since a float*** is simply an array of such row
+//    tables, it can just as well be an array of the float** handles returned
+//    by separate calls to Malloc2D() - the frames don't have to be part of the
+//    same 3D array, nor even have their rows in the same order in memory.
+//
+//    The routine treats the Nz frames of Ny rows as a single run of Nz * Ny
+//    rows, and works along it row by row, moving from the last row of one
+//    frame to the first of the next without a break. For a Malloc3D() array
+//    those rows are contiguous in memory, so the hardware prefetcher sees one
+//    unbroken stream for the whole cube. If the routine is to use more than
+//    one thread, it is this run of rows that is split between them, using the
+//    ThreadPool class in ThreadPool.h/.cpp, so there is a single hand-out of
+//    work for the whole cube rather than one per frame, and a thread's block
+//    of rows can start part way through one frame and end part way through
+//    another.
+//
+//    The threads are set up just as in cpsub.cpp, and are controlled in the
+//    same way: by default there is one thread for each CPU available to the
+//    process, SUBR_THREADS can be defined at compile time or set as an
+//    environment variable to change that, and SUBR_PIN set to 1 pins the
+//    threads to CPUs, which isn't done otherwise. The pool is shut down when
+//    the program exits. The number of threads used is limited so that each
+//    has at least SUBR_MIN_ELEMENTS elements to work on, and if that means
+//    one thread, the work is done directly, without the pool.
+//
+// Building:
+//    This needs to be compiled with C++11 or later (the default for recent
+//    compilers), and linked with ThreadPool.cpp and the system thread library,
+//    for example:
+//
+//    c++ -c -O3 cbatchsub.cpp -o cbatchsub.o
+//    c++ -o cbatchmain -O3 cbatchmain.cpp cbatchsub.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. The pool is now a static object, so its threads are joined
+//                   at exit, and pinning is only done if SUBR_PIN is 1.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdlib.h>
+
+#include "ThreadPool.h"
+
+//  The number of threads to use. Zero means one per available CPU.
+
+#ifndef SUBR_THREADS
+#define SUBR_THREADS 0
+#endif
+
+//  The smallest number of elements worth giving to a thread (see cpsub.cpp).
+
+#ifndef SUBR_MIN_ELEMENTS
+#define SUBR_MIN_ELEMENTS 32768
+#endif
+
+//  The thread pool, once it has been started by the first call that needs it,
+//  and the number of threads it is to have (negative until that has been
+//  decided). The pool itself is a static object in StartPool(), so it is
+//  destroyed - and its threads stopped and joined - when the program exits.
+
+static ThreadPool* Pool = NULL;
+static int PoolThreads = -1;
+
+//  ----------------------------------------------------------------------------
+//
+//                             S t a r t  P o o l
+//
+//  StartPool() creates the pool, the first time it is called, and returns its
+//  address. The threads are only pinned to CPUs if SUBR_PIN is set to 1.
+
+static ThreadPool* StartPool (void)
+{
+   const char* Pin = getenv("SUBR_PIN");
+   static ThreadPool ThePool (PoolThreads,Pin && atoi(Pin) == 1);
+   return &ThePool;
+}
+
+//  A FrameBlock describes the frames being processed, and is what the
+//  ThreadPool passes to SubrFrameRows() for each block of rows.
+
+typedef struct FrameBlock {
+   float*** In;
+   float*** Out;
+   int Nx;
+   int Ny;
+} FrameBlock;
+
+//  ----------------------------------------------------------------------------
+//
+//                        S u b r  F r a m e  R o w s
+//
+//  SubrFrameRows() does the actual work for the rows from First up to (but not
+//  including) Last, counting the rows of all the frames as one sequence - so
+//  row R is row R % Ny of frame R / Ny. The division is only done once, at the
+//  start of the block, and the row and frame numbers are then stepped along.
+
+static void SubrFrameRows (void* Context, long First, long Last, int /*Part*/)
+{
+   FrameBlock* Block = (FrameBlock*) Context;
+   float*** In = Block->In;
+   float*** Out = Block->Out;
+   int Nx = Block->Nx;
+   int Ny = Block->Ny;
+   int Iz = int(First / Ny);
+   int Iy = int(First % Ny);
+   for (long Row = First; Row < Last; Row++) {
+      const float* __restrict InRow = In[Iz][Iy];
+      float* __restrict OutRow = Out[Iz][Iy];
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         OutRow[Ix] = InRow[Ix] + Ix + Iy;
+      }
+      if (++Iy >= Ny) {
+         Iy = 0;
+         Iz++;
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                     S u b r  F r a m e s  T h r e a d s
+//
+//  SubrFramesThreads() sets the number of threads subrframes() will use, if
+//  NThreads is greater than zero and the threads haven't yet been started, and
+//  returns the number it will use (or is using). This is the equivalent of
+//  SubrThreads() in cpsub.cpp.
+
+int SubrFramesThreads (int NThreads)
+{
+   if (Pool == NULL) {
+      if (NThreads > 0) {
+         PoolThreads = NThreads;
+      } else if (PoolThreads < 0) {
+         PoolThreads = SUBR_THREADS;
+         const char* Env = getenv("SUBR_THREADS");
+         if (Env && atoi(Env) > 0) PoolThreads = atoi(Env);
+         if (PoolThreads <= 0) PoolThreads = ThreadPool::AvailableCPUs();
+      }
+   }
+   return Pool ? Pool->Threads() : PoolThreads;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                           S u b r  F r a m e s
+
+void subrframes (float** In[], int Nx, int Ny, int Nz, float** Out[])
+{
+   //  Work out how many threads are worth using for the whole stack. If that's
+   //  just one, do it all directly and don't even start the pool.
+
+   int NThreads = SubrFramesThreads(0);
+   long Rows = long(Ny) * long(Nz);
+   long MaxUseful = (long(Nx) * Rows) / SUBR_MIN_ELEMENTS;
+   if (MaxUseful < NThreads) NThreads = int(MaxUseful);
+   FrameBlock Block = { In, Out, Nx, Ny };
+   if (Rows <= 0) return;
+   if (NThreads <= 1) {
+      SubrFrameRows (&Block,0,Rows,0);
+   } else {
+      if (Pool == NULL) Pool = StartPool();
+      Pool->ParallelFor (Rows,SubrFrameRows,&Block,NThreads);
+   }
+}
@@ -73,6 +73,8 @@
 //
 // History:
 //    10th Aug 2019. First properly commented version. KS.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -98,6 +100,8 @@
 #include "boost/multi_array.hpp"
 #include <cassert>
 
+#include "BenchHarness.h"
+
 typedef boost::multi_array<float,2> Array2DType;
 typedef Array2DType::index Index2DType;
 
@@ -118,6 +122,11 @@ int main (int argc, char* argv[])
    if (argc > 2) Nx = atoi(argv[2]);
    if (argc > 3) Ny = atoi(argv[3]);
 
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("cbmain",Nx,Ny,Nrpt);
+
    //  Create the input and output 2D arrays.
    
    Array2DType In(boost::extents[Ny][Nx]);
@@ -137,9 +146,11 @@ int main (int argc, char* argv[])
    
    //  Repeat the call to the manipulating subroutine. A compiler can't optimise
    //  this out, as it doesn't know that the results will be the same every
-   //  time.
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
    
-   for (int Loop = 0; Loop < Nrpt; Loop++) {
+   Bench.StartLoop();
+   while (Bench.Next()) {
       subr (In,Nx,Ny,Out);
    }
 
@@ -157,6 +168,7 @@ int main (int argc, char* argv[])
       }
       if (Error) break;
    }
+   Bench.Report(Error);
    return 0;
 }
 
@@ -0,0 +1,82 @@
+//
+//                           c b s i m d s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, Boost arrays, run-time SIMD.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and is a replacement for cbsub.cpp, designed to
+//    be called from cbmain.cpp with two Boost multi_array 2D arrays. Like the
+//    routines in csimdsub.cpp, it does the work for each row using one of the
+//    vectorised row kernels in SimdKernels.h/.cpp, selected at run time to
+//    suit the CPU. A Boost multi_array created with the default (C) storage
+//    order, as cbmain.cpp does, holds each row contiguously, so the address
+//    of the first element of each row can be passed to the row kernel. This
+//    code checks that the innermost stride is 1, and if it isn't - if the
+//    array has been created with some other storage order - it falls back on
+//    the element by element code used in cbsub.cpp. Note that this bypasses
+//    Boost's bounds checking completely.
+//
+// Building:
+//    For example:
+//
+//    c++ -c -O3 cbsimdsub.cpp -o cbsimdsub.o
+//    c++ -o cbmain -O3 cbmain.cpp cbsimdsub.o SimdKernels.cpp
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "boost/multi_array.hpp"
+#include <cassert>
+
+#include "SimdKernels.h"
+
+typedef boost::multi_array<float,2> Array2DType;
+typedef Array2DType::index Index2DType;
+
+void subr (Array2DType& In, int Nx, int Ny, Array2DType& Out)
+{
+   if (In.strides()[1] == 1 && Out.strides()[1] == 1) {
+      IndexAddRowKernel Kernel = SimdIndexAddRow();
+      for (Index2DType Iy = 0; Iy < Ny; Iy++) {
+         (*Kernel)(In[Iy].origin(),Out[Iy].origin(),Nx,Iy);
+      }
+   } else {
+      for (Index2DType Iy = 0; Iy < Ny; Iy++) {
+         for (Index2DType Ix = 0; Ix < Nx; Ix++) {
+            Out[Iy][Ix] = In[Iy][Ix] + Ix + Iy;
+         }
+      }
+   }
+}
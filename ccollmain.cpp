@@ -0,0 +1,147 @@
+//
+//                         c c o l l m a i n . c p p
+//
+// Summary:
+//    3D to 2D array collapse test main routine in C++, using an ArrayManager.
+//
+// Introduction:
+//    This is the companion of ctransmain.cpp, for the other common operation
+//    that works against the grain of a C/C++ array: collapsing a 3D array
+//    into a 2D one by summing along Z, the slowest-varying index. The obvious
+//    way to code that - the way the test code at the end of ArrayManager.cpp
+//    does it - has the Z loop innermost, so successive additions are a whole
+//    plane apart in memory, and once the planes are bigger than the cache
+//    almost every one of them is a cache miss. This program times a collapse()
+//    routine so that the straightforward version in cnaivesub.cpp can be
+//    compared with the tiled version in ctilesub.cpp.
+//
+// Structure:
+//    This main routine uses an ArrayManager to create an input array In with
+//    Nz planes of Ny rows of Nx columns, and an output array Out with Ny rows
+//    of Nx columns, fills In with test values, and calls collapse() the
+//    requested number of times to set each Out[Iy][Ix] to the sum over Iz of
+//    In[Iz][Iy][Ix]. Then it checks the result against a sum done in the same
+//    order, which any correct version must match exactly. collapse() has to
+//    be compiled separately, so the repeated calls can't be optimised away.
+//
+// Building:
+//    c++ -c -O3 -o ctilesub.o ctilesub.cpp
+//    c++ -o ccollmain -O3 ccollmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./ccollmain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the subroutine is called - default 1000.
+//       nx    is the number of columns in each plane - default 2000.
+//       ny    is the number of rows in each plane - default 10.
+//       nz    is the number of planes - default 8.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 8 planes.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. The collapse() calls are now timed by the harness in
+//                   BenchHarness.h.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ArrayManager.h"
+#include "BenchHarness.h"
+
+//  collapse() is the subroutine that does the actual array manipulation. It has
+//  to be compiled separately to prevent a compiler optimising it away entirely.
+
+void collapse (float*** In, int Nx, int Ny, int Nz, float** Out);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 8;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+
+   //  Start the benchmark harness, which times the setup, the calls to
+   //  collapse() and the checking separately (see BenchHarness.h). It reports
+   //  its counters per element of the output array, each of which involves Nz
+   //  elements of the input array.
+
+   BenchHarness Bench ("ccollmain",Nx,Ny,Nrpt);
+   
+   ArrayManager Manager;
+   float*** In = (float***) Manager.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float** Out = (float**) Manager.Malloc2D(sizeof(float),Ny,Nx);
+   if (In == NULL || Out == NULL) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   
+   //  Set the input array to the test values used by the other tests, plus
+   //  the plane number. These are all small integers, so the sums are exact.
+   
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            In[Iz][Iy][Ix] = float(Nx - Ix + Ny - Iy + Iz);
+         }
+      }
+   }
+   printf ("Arrays have %d planes of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      collapse (In,Nx,Ny,Nz,Out);
+   }
+   
+   //  Check that we got the expected results.
+   
+   bool Error = false;
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         float Total = 0.0;
+         for (int Iz = 0; Iz < Nz; Iz++) Total += In[Iz][Iy][Ix];
+         if (Out[Iy][Ix] != Total) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Iy,Ix,Out[Iy][Ix],Total);
+            break;
+         }
+      }
+      if (Error) break;
+   }
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,290 @@
+//
+//                          c c o n c m a i n . c p p
+//
+// Summary:
+//    Multithreaded array allocation stress test, for ConcurrentArrayManager.
+//
+// Introduction:
+//    The other test programs in this study time the access to the elements of
+//    arrays that already exist. In a multithreaded program, though, the cost of
+//    creating and releasing the arrays can matter just as much - a program that
+//    splits its work into tiles and has each thread allocate a scratch array or
+//    two for every tile it processes makes a very large number of allocations,
+//    and if they all go through one lock, the threads spend their time queueing
+//    for it rather than working.
+//
+// This version:
+//    This program starts a number of threads, each of which repeatedly
+//    allocates a small 2D array, writes a tag into each row, and frees the
+//    array it allocated a few cycles earlier, after checking that its tags are
+//    still intact (which they wouldn't be if two live arrays had been given the
+//    same memory). Every fourth array is handed to the next thread to free, the
+//    way a tile is passed from one stage of a pipeline to the next, so arrays
+//    are freed by threads other than the ones that allocated them. The arrays
+//    cycle through three different shapes. Each thread keeps a handful of its
+//    arrays live at once, so the manager always has some arrays on its books.
+//
+//    The same test is run using three different managers:
+//
+//    global   A single ArrayManager, with a mutex around every call - which is
+//             how a program has had to share an ArrayManager between threads.
+//    sharded  A ConcurrentArrayManager, with arenas turned off, so every array
+//             comes from malloc().
+//    cached   A ConcurrentArrayManager with its default per-thread arenas, so
+//             an array is usually given memory its thread recently freed.
+//
+//    For each, it reports the elapsed time and the average time each thread
+//    took for one allocation and free, and checks that every array has been
+//    released. How much difference the manager makes depends on the number of
+//    threads and the number of CPUs they have to run on - with only one CPU,
+//    the threads are rarely running at the same time, and hardly contend at
+//    all.
+//
+// Building:
+//    This uses the C++11 thread library. Something like:
+//
+//    c++ -o cconcmain -O3 -pthread cconcmain.cpp ConcurrentArrayManager.cpp
+//                                          ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./cconcmain irpt nx ny nthreads mode
+//
+//    where:
+//      irpt     is the number of arrays each thread allocates - default 1000000.
+//      nx       is the number of columns in each array - default 16.
+//      ny       is the number of rows in each array - default 16.
+//      nthreads is the number of threads - default one per CPU.
+//      mode     is one of global, sharded or cached - default is to run all
+//               three in turn.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentArrayManager.h"
+
+//  The number of arrays each thread keeps live, and how often one is passed on.
+
+static const int Depth = 4;
+static const int HandOn = 4;
+
+//  GlobalManager is an ArrayManager with one mutex around every call, providing the same
+//  Malloc2D() and Free() as a ConcurrentArrayManager.
+
+class GlobalManager {
+public:
+   void* Malloc2D (unsigned int BytesPerElement,long Ny,long Nx) {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      return I_Manager.Malloc2D(BytesPerElement,Ny,Nx);
+   }
+   void Free (void* Address) {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_Manager.Free(Address);
+   }
+   void List (void (*ListRoutine)(const char* String)) {
+      std::lock_guard<std::mutex> Lock(I_Mutex);
+      I_Manager.List(ListRoutine);
+   }
+private:
+   std::mutex I_Mutex;
+   ArrayManager I_Manager;
+};
+
+//  What is shared between the threads of one run.
+
+struct StressShared {
+   int NThreads;
+   long Nrpt;
+   long Nx;
+   long Ny;
+   std::atomic<int> Ready;
+   std::atomic<bool> Go;
+   std::atomic<long> Errors;
+   std::vector<std::atomic<int**>> Mailbox;
+   explicit StressShared (int Threads) : Mailbox(Threads) {}
+};
+
+//  ----------------------------------------------------------------------------
+//
+//                            S t r e s s  T h r e a d
+//
+//  StressThread() is the work each thread does. Each array's rows are tagged
+//  with a value unique to that array, and checked just before it is freed.
+
+template <class Manager>
+static void StressThread (Manager* Arrays, StressShared* Shared, int Thread)
+{
+   int** Live[Depth] = { NULL };
+   long Errors = 0;
+   int NThreads = Shared->NThreads;
+   Shared->Ready++;
+   while (!Shared->Go) std::this_thread::yield();
+
+   for (long Cycle = 0; Cycle < Shared->Nrpt; Cycle++) {
+      long Ny = Shared->Ny + (Cycle % 3);
+      long Nx = Shared->Nx * (1 + Cycle % 3);
+      int** Tile = (int**) Arrays->Malloc2D(sizeof(int),Ny,Nx);
+      if (Tile == NULL) {
+         Errors++;
+         continue;
+      }
+      int Tag = int((Cycle << 8) + Thread);
+      Tile[0][1] = int(Ny);
+      for (long Iy = 0; Iy < Ny; Iy++) Tile[Iy][0] = Tag;
+
+      //  Either hand the new array on to the next thread, freeing what was left
+      //  for us (and anything we left before that the next thread hasn't yet
+      //  picked up), or keep it and free the oldest one we still have.
+
+      int** Done[2] = { NULL, NULL };
+      if (NThreads > 1 && Cycle % HandOn == 0) {
+         Done[0] = Shared->Mailbox[(Thread + 1) % NThreads].exchange(Tile);
+         Done[1] = Shared->Mailbox[Thread].exchange(NULL);
+      } else {
+         Done[0] = Live[Cycle % Depth];
+         Live[Cycle % Depth] = Tile;
+      }
+      for (int Index = 0; Index < 2; Index++) {
+         if (Done[Index]) {
+            for (long Iy = 1; Iy < Done[Index][0][1]; Iy++) {
+               if (Done[Index][Iy][0] != Done[Index][0][0]) Errors++;
+            }
+            Arrays->Free(Done[Index]);
+         }
+      }
+   }
+   for (int Index = 0; Index < Depth; Index++) Arrays->Free(Live[Index]);
+   Shared->Errors += Errors;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                                R u n  S t r e s s
+//
+//  RunStress() runs the test with one manager, and reports how long it took.
+
+static std::atomic<long> ArraysLeft(0);
+
+static void CountArray (const char* /*String*/)
+{
+   ArraysLeft++;
+}
+
+template <class Manager>
+static bool RunStress (Manager* Arrays, const char* Mode, int NThreads, long Nrpt,
+                                                                   long Nx, long Ny)
+{
+   StressShared Shared(NThreads);
+   Shared.NThreads = NThreads;
+   Shared.Nrpt = Nrpt;
+   Shared.Nx = Nx;
+   Shared.Ny = Ny;
+   Shared.Ready = 0;
+   Shared.Go = false;
+   Shared.Errors = 0;
+   for (int Thread = 0; Thread < NThreads; Thread++) Shared.Mailbox[Thread] = NULL;
+
+   std::vector<std::thread> Threads;
+   for (int Thread = 0; Thread < NThreads; Thread++) {
+      Threads.push_back(std::thread(StressThread<Manager>,Arrays,&Shared,Thread));
+   }
+   while (Shared.Ready < NThreads) std::this_thread::yield();
+   auto Start = std::chrono::steady_clock::now();
+   Shared.Go = true;
+   for (int Thread = 0; Thread < NThreads; Thread++) Threads[Thread].join();
+   double Secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+   //  Anything still in a mailbox was handed on after its recipient finished.
+
+   for (int Thread = 0; Thread < NThreads; Thread++) {
+      Arrays->Free(Shared.Mailbox[Thread].exchange(NULL));
+   }
+   ArraysLeft = 0;
+   Arrays->List(CountArray);
+
+   printf ("%-8s %8.3f sec, %8.1f nsec per allocation and free per thread\n",
+                                           Mode,Secs,Secs * 1.0e9 / double(Nrpt));
+   bool Ok = true;
+   if (Shared.Errors > 0) {
+      printf ("Error: %ld arrays were corrupted or not allocated\n",long(Shared.Errors));
+      Ok = false;
+   }
+   if (ArraysLeft > 0) {
+      printf ("Error: %ld arrays were not released\n",long(ArraysLeft));
+      Ok = false;
+   }
+   return Ok;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   long Nrpt = 1000000;
+   long Nx = 16;
+   long Ny = 16;
+   int NThreads = int(std::thread::hardware_concurrency());
+   const char* Mode = "all";
+   if (argc > 1) Nrpt = atol(argv[1]);
+   if (argc > 2) Nx = atol(argv[2]);
+   if (argc > 3) Ny = atol(argv[3]);
+   if (argc > 4) NThreads = atoi(argv[4]);
+   if (argc > 5) Mode = argv[5];
+   if (NThreads < 1) NThreads = 1;
+   if (Nx < 2) Nx = 2;
+   if (Ny < 1) Ny = 1;
+   bool All = !strcmp(Mode,"all");
+   if (!All && strcmp(Mode,"global") && strcmp(Mode,"sharded") && strcmp(Mode,"cached")) {
+      printf ("Unknown mode '%s' - use global, sharded, cached or all\n",Mode);
+      return 1;
+   }
+
+   printf ("Arrays of up to %ld rows of %ld columns, repeats = %ld, threads = %d\n",
+                                                       Ny + 2,Nx * 3,Nrpt,NThreads);
+   bool Ok = true;
+   if (All || !strcmp(Mode,"global")) {
+      GlobalManager Arrays;
+      Ok &= RunStress(&Arrays,"global",NThreads,Nrpt,Nx,Ny);
+   }
+   if (All || !strcmp(Mode,"sharded")) {
+      ConcurrentArrayManager Arrays(NThreads,false);
+      Ok &= RunStress(&Arrays,"sharded",NThreads,Nrpt,Nx,Ny);
+   }
+   if (All || !strcmp(Mode,"cached")) {
+      ConcurrentArrayManager Arrays(NThreads,true);
+      Ok &= RunStress(&Arrays,"cached",NThreads,Nrpt,Nx,Ny);
+   }
+   return Ok ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+//
+//                          c e l e m m a i n . c p p
+//
+// Summary:
+//    2D array access test main routine in C++, for a range of element types.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays - the sort of
+//    thing that are common in astronomy and similar scientific disciplines.
+//    This can also be used to see how efficient different ways of coding the
+//    same problem can be in the different languages, and to see what effect
+//    such things as compilation options - particularly optimisation options -
+//    have.
+//
+//    The problem chosen is a trivial one: given an 2D array, add to each
+//    element the sum of its two indices and return the result in a second,
+//    similarly-sized array. This is harder to optimise away than, for example,
+//    simply doing an element by element copy of the array, but is generally
+//    easy to code. It isn't a perfect test (something brought out by the
+//    study), but it does produce some interesting results.
+//
+// This version:
+//    All the other C++ test programs use arrays of float. This one can use any
+//    of the element types described in ElementTypes.h - int16_t, uint16_t,
+//    int32_t, Half, BFloat16, float or double - selected when it is compiled
+//    by defining ELEMENT, eg -DELEMENT=Half. The default is float. It uses
+//    the Array2D template from ArrayTemplates.h to allocate the arrays, which
+//    shows ArrayManager handling elements of any size, and passes their row
+//    pointers to the subr() in celemsub.cpp, which has a version for each
+//    type. It is much the same as ctmain.cpp otherwise, and like that it times
+//    the calls to subr() using BenchHarness.h, telling the harness how big
+//    each element is so it can report the rate at which data is moved.
+//
+//    The check of the results has to allow for the type. The integer types
+//    must give exactly the right answer, so the array must be small enough
+//    that Nx + Ny - the largest value in either array - fits into the type.
+//    The floating point types are allowed the error that rounding the result
+//    to the type can introduce. A Half holds integers exactly up to 2048, so
+//    with the default array size it is exact too, but a BFloat16 only holds
+//    integers exactly up to 256, so it has to round most of the results. The
+//    largest relative error found is reported along with the tolerance.
+//
+// Building:
+//    The file containing the implementation of the subr() routine has to be
+//    compiled separately, using the compiler being tested and with the options
+//    being tested. Then this main program needs to be linked against that
+//    compiled subroutine and the ArrayManager code. For example, something
+//    like:
+//
+//    c++ -c -O3 -o celemsub.o celemsub.cpp
+//    c++ -o celemmain -O3 -DELEMENT=Half celemmain.cpp celemsub.o
+//                                        ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./celemmain irpt nx ny
+//
+//    where
+//       irpt  is the number of times the subroutine is called - default 1000.
+//       nx    is the number of columns in the array tested - default 2000.
+//       ny    is the number of rows in the array tested - default 10.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ArrayTemplates.h"
+#include "ElementTypes.h"
+#include "BenchHarness.h"
+
+#ifndef ELEMENT
+#define ELEMENT float
+#endif
+
+typedef ELEMENT Element;
+typedef ElementTraits<Element> Traits;
+typedef Traits::Wide Wide;
+
+//  subr() is the subroutine that does the actual array manipulation. It has to
+//  be compiled separately to prevent a compiler optimising it away entirely.
+
+void subr (Element* In[], int Nx, int Ny, Element* Out[]);
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (double(Nx) + double(Ny) > Traits::MaxValue()) {
+      printf ("Arrays of %d rows of %d columns are too large for %s elements\n",
+                                                       Ny,Nx,Traits::Name());
+      return 1;
+   }
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("celemmain",Nx,Ny,Nrpt,sizeof(Element));
+
+   //  Create the input and output 2D arrays.
+
+   ArrayManager Manager;
+   Array2D<Element> In(Manager,Ny,Nx);
+   Array2D<Element> Out(Manager,Ny,Nx);
+   if (!In.IsValid() || !Out.IsValid()) {
+      printf ("Unable to allocate arrays of %d rows of %d columns\n",Ny,Nx);
+      return 1;
+   }
+
+   //  We set the elements of the input array to some set of values - it doesn't
+   //  matter what, just some values we can use to check the array manipulation
+   //  on. This uses the sum of the row and column indices in descending order.
+   //  We don't need to initialise the output array.
+
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         In[Iy][Ix] = Traits::FromWide(Wide(Nx - Ix + Ny - Iy));
+      }
+   }
+   printf ("Arrays have %d rows of %d columns of %s, repeats = %d\n",
+                                                   Ny,Nx,Traits::Name(),Nrpt);
+
+   //  Repeat the call to the manipulating subroutine. A compiler can't optimise
+   //  this out, as it doesn't know that the results will be the same every
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
+
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      subr (In.Handle(),Nx,Ny,Out.Handle());
+   }
+
+   //  Check that we got the expected results, to within the precision of the
+   //  type. The exact result is worked out in double from the value actually
+   //  stored in In, which for a BFloat16 may already have been rounded.
+
+   bool Error = false;
+   double MaxError = 0.0;
+   double Tolerance = Traits::Tolerance();
+   for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         double Exact = double(Traits::ToWide(In[Iy][Ix])) + Ix + Iy;
+         double Value = double(Traits::ToWide(Out[Iy][Ix]));
+         double RelError = (Exact != 0.0) ? fabs(Value - Exact) / fabs(Exact) : fabs(Value);
+         if (RelError > MaxError) MaxError = RelError;
+         if (RelError > Tolerance) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Iy,Ix,Value,Exact);
+            break;
+         }
+      }
+   }
+   printf ("Maximum relative error %.3g, tolerance for %s %.3g\n",
+                                               MaxError,Traits::Name(),Tolerance);
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,158 @@
+//
+//                          c e l e m s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, for a range of element types.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version uses the 'Numerical Recipes' scheme for passing the arrays,
+//    exactly as does cnrsub.cpp, but instead of only handling arrays of float
+//    it provides versions of subr() for arrays of 16 and 32 bit integers, the
+//    16-bit floating point types Half and BFloat16, float and double. They are
+//    all generated from the one template, which converts each element of In
+//    to a wider type (see ElementTraits in ElementTypes.h) - int32_t for the
+//    integers, float for the 16-bit floating point types - adds the indices in
+//    that type, and converts the result back to store it. The conversions are
+//    done in registers, so the arrays in memory stay at their narrow size, and
+//    for arrays too big for the caches, where the time is set by the number of
+//    bytes moved rather than the arithmetic, the 16-bit types should be the
+//    fastest. The float version is the same as the code in cnrsub.cpp. This
+//    is intended to be used with the main program in celemmain.cpp.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ElementTypes.h"
+
+#if defined(__F16C__) && defined(__AVX__)
+#define ELEM_HAVE_F16C
+#include <immintrin.h>
+#endif
+
+//  ----------------------------------------------------------------------------
+//
+//                                 S u b r  T
+//
+//  SubrT() does the work for any element type. The indices are converted to
+//  the wide type and added one after the other, just as in cnrsub.cpp, so the
+//  float version rounds in exactly the same way.
+
+template <typename T>
+static inline void SubrT (T* In[], int Nx, int Ny, T* Out[])
+{
+   typedef ElementTraits<T> Traits;
+   typedef typename Traits::Wide Wide;
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      const T* InRow = In[Iy];
+      T* OutRow = Out[Iy];
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         OutRow[Ix] = Traits::FromWide(Traits::ToWide(InRow[Ix]) + Wide(Ix) + Wide(Iy));
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                                   S u b r
+//
+//  One version of subr() for each element type.
+
+void subr (int16_t* In[], int Nx, int Ny, int16_t* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
+
+void subr (uint16_t* In[], int Nx, int Ny, uint16_t* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
+
+void subr (int32_t* In[], int Nx, int Ny, int32_t* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
+
+//  Compilers don't vectorise the conversions between half and float values when they are
+//  written as plain C++, even for a CPU that has instructions for them, and the bit
+//  manipulation in the Half class takes a dozen or so operations per element. So if the
+//  code is compiled for a CPU with the F16C instructions (-march=native on anything recent)
+//  this converts eight elements at a time using those, finishing off each row with the
+//  Half class. Both round to nearest even, so the results are identical.
+
+void subr (Half* In[], int Nx, int Ny, Half* Out[])
+{
+#ifdef ELEM_HAVE_F16C
+   const __m256 Step = _mm256_set1_ps(8.0f);
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      const Half* InRow = In[Iy];
+      Half* OutRow = Out[Iy];
+      const __m256 Row = _mm256_set1_ps(float(Iy));
+      __m256 Col = _mm256_setr_ps(0.0f,1.0f,2.0f,3.0f,4.0f,5.0f,6.0f,7.0f);
+      int Ix = 0;
+      for (; Ix + 8 <= Nx; Ix += 8) {
+         __m128i Bits = _mm_loadu_si128((const __m128i*)(InRow + Ix));
+         __m256 Value = _mm256_add_ps(_mm256_add_ps(_mm256_cvtph_ps(Bits),Col),Row);
+         _mm_storeu_si128((__m128i*)(OutRow + Ix),
+                                       _mm256_cvtps_ph(Value,_MM_FROUND_TO_NEAREST_INT));
+         Col = _mm256_add_ps(Col,Step);
+      }
+      for (; Ix < Nx; Ix++) {
+         OutRow[Ix] = Half(float(InRow[Ix]) + float(Ix) + float(Iy));
+      }
+   }
+#else
+   SubrT (In,Nx,Ny,Out);
+#endif
+}
+
+void subr (BFloat16* In[], int Nx, int Ny, BFloat16* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
+
+void subr (float* In[], int Nx, int Ny, float* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
+
+void subr (double* In[], int Nx, int Ny, double* Out[])
+{
+   SubrT (In,Nx,Ny,Out);
+}
@@ -0,0 +1,62 @@
+//
+//                         c e x p r s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, using array expressions.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and has the same calling sequence as ctsub.cpp,
+//    taking the Array2D<T> arrays defined in ArrayTemplates.h, so it is used
+//    with the main program in ctmain.cpp. Rather than coding the loops, it
+//    writes the operation as an array expression, using the expression
+//    templates in ArrayExpr.h, and leaves Evaluate() to generate the loops.
+//    The point of the test is to show that doing so costs nothing: the time
+//    should be the same as for ctsub.cpp. For a single operation like this
+//    one, that's all there is to it - the gain from expressions comes when an
+//    operation is a chain of steps that would otherwise each be a separate
+//    pass over the arrays, something this test doesn't have.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ArrayExpr.h"
+
+void subr (const Array2D<float>& In, const Array2D<float>& Out)
+{
+   //  This is the whole of it. XIndex() and YIndex() are the column and row
+   //  numbers, and are added in that order, as in the other versions.
+   
+   Evaluate (Out,In + XIndex() + YIndex());
+}
@@ -0,0 +1,128 @@
+//
+//                          c f i x e d s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, specialised for fixed shapes.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version has the same interface as csub.cpp - In and Out are simply
+//    the addresses of blocks of Nx by Ny floats - and is used with the same
+//    main program, cmain.cpp. But for each of the frame shapes listed in
+//    FixedShapes.h it has a specialised version, generated from the template
+//    SubrFixed<NX,NY>(), in which the dimensions are constants. That version
+//    treats In and Out as what they would be if they had been declared as
+//    static arrays, float In[NY][NX] - pointers to rows of exactly NX floats -
+//    so it can use In[Iy][Ix], and the compiler knows the exact number of
+//    times each loop runs. It can then vectorise each row with no remainder
+//    loop (if NX is a multiple of the vector length) or a remainder of known
+//    length, and unroll the loops as far as it thinks worthwhile. subr()
+//    compares the dimensions it is passed with each of the fixed shapes in
+//    turn, and calls the matching specialisation, or, if none matches,
+//    SubrGeneric(), the same code with the dimensions as variables. Both take
+//    the rows as __restrict pointers, so the only difference between them is
+//    whether the dimensions are known at compile time. The comparisons cost a
+//    few instructions per call, which is nothing compared with even the
+//    smallest of the frames.
+//    How much the constants gain depends on the compiler, and on the shape;
+//    a good compiler already does well with the loop in csub.cpp, and for
+//    big frames the time is set by the memory, not by the loop code at all.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. SubrGeneric() takes its rows as __restrict pointers too.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "FixedShapes.h"
+
+//  ----------------------------------------------------------------------------
+//
+//                              S u b r  F i x e d
+//
+//  The specialised version, for a frame of NY rows of NX columns. The rows are
+//  taken as __restrict pointers, telling the compiler In and Out don't overlap;
+//  without that it tests for overlap at run time, and with rows as short as
+//  the default 2000 floats, that loses most of what the constants gain.
+
+template <int NX, int NY>
+static void SubrFixed (const float In[][NX], float Out[][NX])
+{
+   for (int Iy = 0; Iy < NY; Iy++) {
+      const float* __restrict InRow = In[Iy];
+      float* __restrict OutRow = Out[Iy];
+      for (int Ix = 0; Ix < NX; Ix++) {
+         OutRow[Ix] = InRow[Ix] + Ix + Iy;
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                            S u b r  G e n e r i c
+//
+//  The version for any other shape. This is the loop from csub.cpp, but with
+//  the rows taken as __restrict pointers just as SubrFixed() takes them, so
+//  that comparing the two shows what the constant dimensions gain, and not
+//  what the lack of an overlap test gains as well.
+
+static void SubrGeneric (const float* In, int Nx, int Ny, float* Out)
+{
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      const float* __restrict InRow = In + Iy * Nx;
+      float* __restrict OutRow = Out + Iy * Nx;
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         OutRow[Ix] = InRow[Ix] + Ix + Iy;
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                                   S u b r
+
+void subr (float* In, int Nx, int Ny, float* Out)
+{
+#define SUBR_FIXED(NX,NY)                                                      \
+   if (Nx == NX && Ny == NY) {                                                 \
+      SubrFixed<NX,NY> ((const float (*)[NX]) In,(float (*)[NX]) Out);         \
+      return;                                                                  \
+   }
+   FIXED_SHAPES(SUBR_FIXED)
+#undef SUBR_FIXED
+   SubrGeneric (In,Nx,Ny,Out);
+}
@@ -0,0 +1,267 @@
+//
+//                          c g p u m a i n . c p p
+//
+// Summary:
+//    Multi-frame array access test main routine in C++, offloading to a GPU.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. It applies
+//    the same operation as the other tests - add to each element the sum of its
+//    two indices - to each frame of a stack of Nz 2D frames, but does the work
+//    on a GPU, using the CUDA kernel in cgpusub.cu. The question it answers is
+//    not how fast the GPU can do the operation - which is very fast indeed -
+//    but whether that makes up for the time taken to get the data there and
+//    back.
+//
+// Structure:
+//    The frames are held on the host in 3D arrays allocated by an ArrayManager
+//    and, on the GPU, in 3D arrays allocated by a GpuArrayManager (see
+//    GpuArrayManager.h). The host arrays are allocated using a PinnedAllocator,
+//    so they are in page-locked memory the GPU can copy to and from directly.
+//    After filling In with test values, the program makes two measurements:
+//
+//    Kernel only: In is copied to the GPU once, the kernel is run Nrpt times
+//    over every frame, and the time is measured by the GPU itself, using
+//    CUDA events. This is the throughput for data that is already on the GPU
+//    and stays there, and is done as part of the setup, before the timed loop.
+//
+//    End to end: this is the loop timed by the benchmark harness (see
+//    BenchHarness.h). Each call copies each frame of In to the GPU, runs the
+//    kernel on it, and copies the result back into Out, and then waits for
+//    all of that to finish. Successive frames go to different CUDA streams,
+//    so while one frame is being processed the next can be on its way to the
+//    GPU and the previous one on its way back, if the GPU has the copy
+//    engines to do that. With one stream, nothing overlaps.
+//
+//    Then it checks Out, which shows that the data really did make the round
+//    trip. The harness reports the end to end times, and the kernel only time
+//    is added to its BENCH line, as kernel_ns (per call, ie per stack) and
+//    kernel_gbps, so Run.py can show the two side by side. Both counts of
+//    GBytes/sec count each element as read once and written once.
+//
+//    Two environment variables change the way it works. GPU_STREAMS sets the
+//    number of streams the frames are spread over (default 2). Setting
+//    GPU_PINNED to 0 uses ordinary pageable memory for the host arrays, so
+//    the effect of pinned memory can be seen.
+//
+// Building:
+//    nvcc -c -O3 cgpusub.cu -o cgpusub.o
+//    nvcc -o cgpumain -O3 cgpumain.cpp cgpusub.o GpuArrayManager.cpp ArrayManager.cpp ArrayAllocator.cpp
+//
+//    (nvcc simply passes the .cpp files to the host compiler, and links with
+//    the CUDA runtime library.)
+//
+// Invocation:
+//    ./cgpumain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the stack is processed - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames - default 8.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 8 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include <cuda_runtime_api.h>
+
+#include "ArrayManager.h"
+#include "GpuArrayManager.h"
+#include "BenchHarness.h"
+
+//  subrgpu() queues the kernel for one frame, in cgpusub.cu.
+
+void subrgpu (const float* In, float* Out, int Nx, int Ny, long Pitch,
+                                                         cudaStream_t Stream);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 8;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+   
+   int NStreams = 2;
+   bool Pinned = true;
+   const char* Env = getenv("GPU_STREAMS");
+   if (Env && atoi(Env) > 0) NStreams = atoi(Env);
+   Env = getenv("GPU_PINNED");
+   if (Env && atoi(Env) == 0) Pinned = false;
+
+   //  Start the benchmark harness (see BenchHarness.h). It is told the stack
+   //  has Ny * Nz rows, so that its counts per element are per element of
+   //  every frame processed.
+
+   BenchHarness Bench ("cgpumain",Nx,long(Ny) * long(Nz),Nrpt);
+   
+   //  The GPU arrays, and the host arrays, in pinned memory unless told not
+   //  to use it. The host arrays are allocated as single blocks, so their row
+   //  tables are in the same pinned block as the data.
+   
+   GpuArrayManager Gpu;
+   if (!Gpu.Ready()) {
+      printf ("Unable to use the GPU: %s\n",Gpu.LastError());
+      return 1;
+   }
+   PinnedAllocator PinnedMemory;
+   ArrayManager Host;
+   if (Pinned) Host.SetAllocator(&PinnedMemory);
+   Host.SetSingleBlock(true);
+   float*** In = (float***) Host.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float*** Out = (float***) Host.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float* DeviceIn = (float*) Gpu.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float* DeviceOut = (float*) Gpu.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   if (In == NULL || Out == NULL || DeviceIn == NULL || DeviceOut == NULL) {
+      printf ("Unable to allocate arrays: %s\n",Gpu.LastError());
+      return 1;
+   }
+   void* HostIn = Host.BaseArray(In);
+   void* HostOut = Host.BaseArray(Out);
+   long HostPitch = Host.GetPitch(In);
+   long Pitch = Gpu.GetPitch(DeviceIn);
+   
+   std::vector<cudaStream_t> Streams(NStreams);
+   for (int Index = 0; Index < NStreams; Index++) {
+      cudaStreamCreateWithFlags(&Streams[Index],cudaStreamNonBlocking);
+   }
+   
+   //  Set the input array to the test values used by the other tests, plus
+   //  the frame number so each frame is different.
+   
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            In[Iz][Iy][Ix] = float(Nx - Ix + Ny - Iy + Iz);
+         }
+      }
+   }
+   printf ("Arrays have %d frames of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   printf ("Host arrays are in %s memory, frames use %d stream(s)\n",
+                                   Pinned ? "pinned" : "pageable",NStreams);
+
+   //  The device addresses of each frame.
+   
+   std::vector<float*> FramesIn(Nz), FramesOut(Nz);
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      FramesIn[Iz] = (float*) Gpu.Plane(DeviceIn,Iz);
+      FramesOut[Iz] = (float*) Gpu.Plane(DeviceOut,Iz);
+   }
+   
+   //  Kernel only. The data is copied to the GPU once, then processed over
+   //  and over, with the GPU timing the kernels using events in the first
+   //  stream. One untimed pass first makes sure everything is loaded.
+   
+   cudaStream_t First = Streams[0];
+   bool Ok = Gpu.ToDevice(DeviceIn,HostIn,HostPitch,First);
+   for (int Iz = 0; Iz < Nz && Ok; Iz++) {
+      subrgpu (FramesIn[Iz],FramesOut[Iz],Nx,Ny,Pitch,First);
+   }
+   cudaEvent_t KernelStart, KernelEnd;
+   cudaEventCreate(&KernelStart);
+   cudaEventCreate(&KernelEnd);
+   cudaEventRecord(KernelStart,First);
+   for (int Irpt = 0; Irpt < Nrpt && Ok; Irpt++) {
+      for (int Iz = 0; Iz < Nz; Iz++) {
+         subrgpu (FramesIn[Iz],FramesOut[Iz],Nx,Ny,Pitch,First);
+      }
+   }
+   cudaEventRecord(KernelEnd,First);
+   float KernelMsecs = 0.0;
+   if (cudaEventSynchronize(KernelEnd) != cudaSuccess ||
+         cudaEventElapsedTime(&KernelMsecs,KernelStart,KernelEnd) != cudaSuccess) {
+      Ok = false;
+   }
+   double KernelNs = 0.0;
+   if (Nrpt > 0) KernelNs = double(KernelMsecs) * 1.0e6 / double(Nrpt);
+   double Bytes = double(Nx) * double(Ny) * double(Nz) * 2.0 * sizeof(float);
+   double KernelGBytes = (KernelNs > 0.0) ? Bytes / KernelNs : 0.0;
+   
+   //  End to end. Each frame is copied in, processed and copied out in one of
+   //  the streams, in turn, and the call isn't over until every stream has
+   //  finished.
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      for (int Iz = 0; Iz < Nz; Iz++) {
+         cudaStream_t Stream = Streams[Iz % NStreams];
+         Gpu.ToDevice(DeviceIn,HostIn,HostPitch,Stream,Iz,1);
+         subrgpu (FramesIn[Iz],FramesOut[Iz],Nx,Ny,Pitch,Stream);
+         Gpu.ToHost(HostOut,HostPitch,DeviceOut,Stream,Iz,1);
+      }
+      cudaDeviceSynchronize();
+   }
+   if (cudaGetLastError() != cudaSuccess) Ok = false;
+   
+   //  Check that we got the expected results.
+   
+   bool Error = !Ok;
+   if (!Ok) printf ("CUDA error: %s\n",cudaGetErrorString(cudaGetLastError()));
+   for (int Iz = 0; Iz < Nz && !Error; Iz++) {
+      for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            if (Out[Iz][Iy][Ix] != In[Iz][Iy][Ix] + Ix + Iy) {
+               Error = true;
+               printf ("Error Out[%d][%d][%d] = %f, not %f\n",Iz,Iy,Ix,
+                          Out[Iz][Iy][Ix],float(In[Iz][Iy][Ix] + Ix + Iy));
+               break;
+            }
+         }
+      }
+   }
+   printf ("Kernel only %.4g us per call, %.4g GBytes/sec\n",
+                                                 KernelNs * 0.001,KernelGBytes);
+   Bench.Extra("kernel_ns",KernelNs);
+   Bench.Extra("kernel_gbps",KernelGBytes);
+   Bench.Extra("streams",NStreams);
+   Bench.Extra("pinned",Pinned ? 1 : 0);
+   Bench.Report(Error);
+   
+   cudaEventDestroy(KernelStart);
+   cudaEventDestroy(KernelEnd);
+   for (int Index = 0; Index < NStreams; Index++) {
+      cudaStreamDestroy(Streams[Index]);
+   }
+   return 0;
+}
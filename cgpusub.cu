@@ -0,0 +1,110 @@
+//
+//                            c g p u s u b . c u
+//
+// Summary:
+//    2D array access test subroutine in CUDA, run on a GPU.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version does the work on a GPU, using CUDA. In and Out are the
+//    device addresses of arrays in GPU memory, allocated by a GpuArrayManager
+//    (see GpuArrayManager.h), and Pitch is the number of elements from the
+//    start of one row to the start of the next, which is the same for both.
+//    subrgpu() launches a kernel with one thread for each element of a row,
+//    in blocks of 256 threads, and with as many blocks in the second grid
+//    dimension as there are rows (up to the CUDA limit, beyond which each
+//    block does more than one row). Consecutive threads access consecutive
+//    elements, so each warp reads and writes its part of a row in just a few
+//    memory transactions, and the rows start on boundaries chosen by
+//    cudaMallocPitch(), so those transactions are aligned. The launch is
+//    asynchronous, in the given CUDA stream - subrgpu() returns as soon as
+//    the kernel is queued, and the caller has to synchronise with the stream
+//    before using the results. This is intended to be used with the main
+//    program in cgpumain.cpp.
+//
+//    The arithmetic is the same as in cnrsub.cpp - the column index and then
+//    the row index are added separately, each as a float, with no fused
+//    operations - so the results are exactly the same as on the CPU.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// Building:
+//    nvcc -c -O3 cgpusub.cu -o cgpusub.o
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cuda_runtime.h>
+
+//  The number of threads in each block, and the most blocks CUDA allows in the
+//  second grid dimension.
+
+static const int BlockThreads = 256;
+static const int MaxGridRows = 65535;
+
+//  ----------------------------------------------------------------------------
+//
+//                            I n d e x  A d d
+//
+//  Each thread handles element Ix of each of the rows assigned to its block.
+
+__global__ static void IndexAdd (
+   const float* __restrict__ In, float* __restrict__ Out, int Nx, int Ny,
+                                                                  long Pitch)
+{
+   int Ix = blockIdx.x * blockDim.x + threadIdx.x;
+   if (Ix < Nx) {
+      for (int Iy = blockIdx.y; Iy < Ny; Iy += gridDim.y) {
+         long Index = long(Iy) * Pitch + Ix;
+         Out[Index] = In[Index] + float(Ix) + float(Iy);
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                              S u b r  G p u
+
+void subrgpu (const float* In, float* Out, int Nx, int Ny, long Pitch,
+                                                         cudaStream_t Stream)
+{
+   if (Nx <= 0 || Ny <= 0) return;
+   dim3 Block (BlockThreads);
+   dim3 Grid ((Nx + BlockThreads - 1) / BlockThreads,
+                                           Ny < MaxGridRows ? Ny : MaxGridRows);
+   IndexAdd<<<Grid,Block,0,Stream>>> (In,Out,Nx,Ny,Pitch);
+}
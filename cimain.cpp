@@ -0,0 +1,169 @@
+//
+//                            c i m a i n . c p p
+//
+// Summary:
+//    Multi-frame array access test main routine in C++, comparing arrays
+//    indexed by arithmetic with arrays indexed through pointer arrays.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. It applies
+//    the same operation as the other tests - add to each element the sum of its
+//    two indices - to each frame of a stack of Nz 2D frames, held as a 3D
+//    array. The ArrayManager normally gives a 3D array a table of plane
+//    pointers and a table of row pointers, so that In[Iz][Iy][Ix] works, and
+//    every access has to read those before it can read the element. This
+//    program times the same loop with arrays allocated with no pointer arrays
+//    at all, accessed through the IndexedArray3D class in ArrayTemplates.h,
+//    which works out the address of each row from the subscripts instead.
+//
+// Structure:
+//    This main routine uses an ArrayManager to create 3D input and output
+//    arrays, each with Nz planes of Ny rows of Nx columns, fills In with test
+//    values, and then repeatedly processes all the frames. By default the
+//    arrays are allocated after SetIndexed(true), and subr() in cisub.cpp is
+//    called with them as IndexedArray3D objects. If the environment variable
+//    INDEX_TABLES is set to 1, the arrays are allocated normally, with their
+//    pointer arrays, and subrtables() is called with the float*** tables
+//    instead. So the same executable can time both. Either way, the results
+//    are then checked - through IndexedArray3D objects, which can wrap either
+//    kind of array. The subroutines have to be compiled separately, so the
+//    repeated calls can't be optimised away.
+//
+// Building:
+//    c++ -c -O3 -o cisub.o cisub.cpp
+//    c++ -o cimain -O3 cimain.cpp cisub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./cimain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the stack is processed - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames - default 8.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 8 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ArrayTemplates.h"
+#include "BenchHarness.h"
+
+//  subr() processes the stack using arithmetic to find the rows, subrtables()
+//  using the pointer arrays. They have to be compiled separately to prevent a
+//  compiler optimising them away.
+
+void subr (const IndexedArray3D<float>& In, const IndexedArray3D<float>& Out);
+void subrtables (float** In[], int Nx, int Ny, int Nz, float** Out[]);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 8;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+   const char* Env = getenv("INDEX_TABLES");
+   bool Tables = (Env && atoi(Env) != 0);
+
+   //  Start the benchmark harness (see BenchHarness.h). It is told the stack
+   //  has Ny * Nz rows, so that its counts per element are per element of
+   //  every frame processed.
+
+   BenchHarness Bench ("cimain",Nx,long(Ny) * long(Nz),Nrpt);
+   
+   //  Allocate the arrays, with or without their pointer arrays. The
+   //  IndexedArray3D objects work with both.
+
+   ArrayManager Manager;
+   Manager.SetIndexed(!Tables);
+   IndexedArray3D<float> In (Manager,Nz,Ny,Nx);
+   IndexedArray3D<float> Out (Manager,Nz,Ny,Nx);
+   if (!In.IsValid() || !Out.IsValid()) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   float*** InTables = (float***) In.Handle();
+   float*** OutTables = (float***) Out.Handle();
+   
+   //  Set the input array to the test values used by the other tests, plus
+   //  the frame number so each frame is different.
+   
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            In[Iz][Iy][Ix] = float(Nx - Ix + Ny - Iy + Iz);
+         }
+      }
+   }
+   printf ("Arrays have %d frames of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   printf ("Elements are found using %s\n",
+                          Tables ? "pointer arrays" : "index arithmetic");
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      if (Tables) {
+         subrtables (InTables,Nx,Ny,Nz,OutTables);
+      } else {
+         subr (In,Out);
+      }
+      Bench.Sink(Out.Data());
+   }
+   
+   //  Check that we got the expected results - each frame treated just as
+   //  the 2D tests treat their single array.
+   
+   bool Error = false;
+   for (int Iz = 0; Iz < Nz && !Error; Iz++) {
+      for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            if (Out[Iz][Iy][Ix] != In[Iz][Iy][Ix] + Ix + Iy) {
+               Error = true;
+               printf ("Error Out[%d][%d][%d] = %f, not %f\n",Iz,Iy,Ix,
+                        Out[Iz][Iy][Ix],float(In[Iz][Iy][Ix] + Ix + Iy));
+               break;
+            }
+         }
+      }
+   }
+   Bench.Extra("tables",Tables ? 1 : 0);
+   Bench.Report(Error);
+   return 0;
+}
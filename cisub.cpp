@@ -0,0 +1,91 @@
+//
+//                            c i s u b . c p p
+//
+// Summary:
+//    Multi-frame array access test subroutines in C++, with and without the
+//    pointer arrays that the ArrayManager normally provides.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. It does the
+//    same operation as the other tests - setting each element of Out to the
+//    corresponding element of In plus its column and row numbers - for each
+//    frame of a stack of frames held as a 3D array, and is for comparing two
+//    ways of finding the elements.
+//
+// This version:
+//    subr() is passed the arrays as IndexedArray3D objects (see
+//    ArrayTemplates.h). In[Iz][Iy][Ix] looks just like an access through
+//    pointer arrays, but is worked out as the address of the first element
+//    plus ((Iz * Ny) + Iy) * Pitch + Ix, with no memory read needed to find
+//    the row. subrtables() is passed the float*** plane tables an ArrayManager
+//    normally returns, for which In[Iz][Iy][Ix] means reading a plane pointer
+//    and then a row pointer before the element itself can be read. The loops
+//    in the two routines are written in exactly the same way, with the full
+//    subscripts on every access, so the only difference is the way the row
+//    addresses are found - and what the compiler can make of that. With the
+//    arithmetic, it can see all of the calculation and take the invariant
+//    parts out of the loops. With the tables, a store to Out could in
+//    principle change a pointer in one of the tables, so it may have to read
+//    the pointers again for every element, or at least check.
+//
+//    These are designed to be called from the main program in cimain.cpp, and
+//    have to be compiled separately so the calls can't be optimised away.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ArrayTemplates.h"
+
+//  ----------------------------------------------------------------------------
+//
+//                                  S u b r
+
+void subr (const IndexedArray3D<float>& In, const IndexedArray3D<float>& Out)
+{
+   int Nx = int(In.Nx());
+   int Ny = int(In.Ny());
+   int Nz = int(In.Nz());
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            Out[Iz][Iy][Ix] = In[Iz][Iy][Ix] + Ix + Iy;
+         }
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                            S u b r  T a b l e s
+
+void subrtables (float** In[], int Nx, int Ny, int Nz, float** Out[])
+{
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            Out[Iz][Iy][Ix] = In[Iz][Iy][Ix] + Ix + Iy;
+         }
+      }
+   }
+}
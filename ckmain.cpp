@@ -85,6 +85,8 @@
 //
 // History:
 //    16th Aug 2019. First properly commented version. KS.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -107,6 +109,7 @@
 // SOFTWARE.
 
 #include "ArrayManager.h"
+#include "BenchHarness.h"
 
 typedef float** Array2DType; 
 typedef int Index2DType;
@@ -127,6 +130,11 @@ int main (int argc, char* argv[])
    if (argc > 1) Nrpt = atoi(argv[1]);
    if (argc > 2) Nx = atoi(argv[2]);
    if (argc > 3) Ny = atoi(argv[3]);
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("ckmain",Nx,Ny,Nrpt);
    
    //  Create the input and output 2D arrays, using the ArrayManager class
    //  defined in ArrayManager.h/.cpp.
@@ -149,9 +157,11 @@ int main (int argc, char* argv[])
 
    //  Repeat the call to the manipulating subroutine. A compiler can't optimise
    //  this out, as it doesn't know that the results will be the same every
-   //  time.
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
    
-   for (int Loop = 0; Loop < Nrpt; Loop++) {
+   Bench.StartLoop();
+   while (Bench.Next()) {
       subr (In,Nx,Ny,Out);
    }
    
@@ -169,6 +179,7 @@ int main (int argc, char* argv[])
       }
       if (Error) break;
    }
+   Bench.Report(Error);
    return 0;
 }
 
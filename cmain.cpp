@@ -96,6 +96,10 @@
 //
 // History:
 //     8th Aug 2019. First properly commented version. KS.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
+//    14th Oct 2026. Each call now passes Out to the harness's Sink(), for the
+//                   link time optimised builds.
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -120,6 +124,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "BenchHarness.h"
+
 //  subr() is the subroutine that does the actual array manipulation. It has to
 //  be compiled separately to prevent a compiler optimising it away entirely.
 
@@ -136,6 +142,11 @@ int main (int argc, char* argv[])
    if (argc > 1) Nrpt = atoi(argv[1]);
    if (argc > 2) Nx = atoi(argv[2]);
    if (argc > 3) Ny = atoi(argv[3]);
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("cmain",Nx,Ny,Nrpt);
    
    //  Allocate memory for the input array In and the output array Out.
    
@@ -156,10 +167,15 @@ int main (int argc, char* argv[])
 
    //  Repeat the call to the manipulating subroutine. A compiler can't optimise
    //  this out, as it doesn't know that the results will be the same every
-   //  time.
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls. Sink() makes sure each call still happens even if the
+   //  program is built with link time optimisation, which lets the compiler see
+   //  into subr() after all.
    
-   for (int Loop = 0; Loop < Nrpt; Loop++) {
+   Bench.StartLoop();
+   while (Bench.Next()) {
       subr (In,Nx,Ny,Out);
+      Bench.Sink(Out);
    }
    
    //  Check that we got the expected results.
@@ -176,6 +192,7 @@ int main (int argc, char* argv[])
       }
       if (Error) break;
    }
+   Bench.Report(Error);
    return 0;
 }
 
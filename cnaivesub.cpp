@@ -0,0 +1,78 @@
+//
+//                         c n a i v e s u b . c p p
+//
+// Summary:
+//    Straightforward transpose and collapse routines, for ctransmain/ccollmain.
+//
+// Introduction:
+//    The test programs ctransmain.cpp and ccollmain.cpp time two operations
+//    that can't simply work along the rows of their arrays: a 2D transpose,
+//    and the collapse of a 3D array into 2D by summing along Z. This file has
+//    the obvious versions of both, coded the way most people would write them
+//    first, and gives the times the cache-blocked versions in ctilesub.cpp
+//    are measured against.
+//
+// This version:
+//    transpose() reads In along its rows and writes Out down its columns, so
+//    successive stores are a whole row of Out (Ny elements) apart. collapse()
+//    has the Z loop innermost, exactly as in the ArrayManager test code, so
+//    successive loads are a whole plane apart. Both are fine while everything
+//    fits in the cache, and get much slower once it doesn't.
+//
+// Building:
+//    c++ -c -O3 -o cnaivesub.o cnaivesub.cpp
+//    c++ -o ctransmain -O3 ctransmain.cpp cnaivesub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+//  ----------------------------------------------------------------------------
+//
+//                              T r a n s p o s e
+
+void transpose (float** In, int Nx, int Ny, float** Out)
+{
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         Out[Ix][Iy] = In[Iy][Ix];
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                               C o l l a p s e
+
+void collapse (float*** In, int Nx, int Ny, int Nz, float** Out)
+{
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         float Total = 0.0;
+         for (int Iz = 0; Iz < Nz; Iz++) {
+            Total += In[Iz][Iy][Ix];
+         }
+         Out[Iy][Ix] = Total;
+      }
+   }
+}
@@ -84,6 +84,8 @@
 //
 // History:
 //    2nd Jul 2019. First properly commented version. KS.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -108,6 +110,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "BenchHarness.h"
+
 //  subr() is the subroutine that does the actual array manipulation. It has to
 //  be compiled separately to prevent a compiler optimising it away entirely.
 
@@ -128,6 +132,11 @@ int main (int argc, char* argv[])
    if (argc > 1) Nrpt = atoi(argv[1]);
    if (argc > 2) Nx = atoi(argv[2]);
    if (argc > 3) Ny = atoi(argv[3]);
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("cnrmain",Nx,Ny,Nrpt);
    
    //  Allocate memory for the input array InData and the output array OutData.
    
@@ -164,9 +173,11 @@ int main (int argc, char* argv[])
    
    //  Repeat the call to the manipulating subroutine. A compiler can't optimise
    //  this out, as it doesn't know that the results will be the same every
-   //  time.
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
    
-   for (int Loop = 0; Loop < Nrpt; Loop++) {
+   Bench.StartLoop();
+   while (Bench.Next()) {
       subr (In,Nx,Ny,Out);
    }
    
@@ -184,5 +195,6 @@ int main (int argc, char* argv[])
       }
       if (Error) break;
    }
+   Bench.Report(Error);
    return 0;
 }
@@ -0,0 +1,263 @@
+//
+//                         c p i p e m a i n . c p p
+//
+// Summary:
+//    2D array access test main routine in C++, with frames read from a file.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. It applies
+//    the same operation as the other tests - add to each element the sum of its
+//    two indices - using the subr() in cnrsub.cpp, but instead of processing
+//    the same array in memory over and over, it processes a stream of frames
+//    read from a file, and writes the results to another file, as a real
+//    reduction pipeline would. The question it answers is how much of the time
+//    taken by the I/O can be hidden behind the processing.
+//
+// Structure:
+//    The program first writes an input file of Nz frames, each of Ny rows of
+//    Nx floats, set to the test values used by the other tests plus the frame
+//    number, laid out as a FramePipeline expects (see FramePipeline.h). Then
+//    each call timed by the benchmark harness (see BenchHarness.h) gets the
+//    next frame from the pipeline, calls subr() to process it, and hands the
+//    results back to be written out. The frames are taken from the file in
+//    turn, over and over, so every call processes a frame, however many calls
+//    there are. After the loop, the output file is read back and checked.
+//
+//    By default the pipeline is overlapped - frames are read ahead and written
+//    behind, by separate threads, while the current one is processed. Setting
+//    the environment variable PIPE_MODE to 'serial' makes it read, process and
+//    write each frame in turn instead, which is what it is there to improve on.
+//    PIPE_DIRECT=1 uses O_DIRECT, so the frames really come from the disk and
+//    not the kernel's page cache. PIPE_BUFFERS sets the number of buffers in
+//    each direction (default 2), and PIPE_PASSES the number of times subr() is
+//    called for each frame (default 1), which increases the amount of work
+//    done for the same amount of I/O. The files are created in the current
+//    directory, or in the directory given by PIPE_DIR, and are deleted at the
+//    end.
+//
+//    As well as the usual harness output, it reports the time spent on I/O,
+//    the time the processing had to wait for it, and the fraction of the I/O
+//    time that was hidden, and these are added to the BENCH line as io_s,
+//    wait_s and hidden, so Run.py can show them.
+//
+// Building:
+//    c++ -c -O3 -o cnrsub.o cnrsub.cpp
+//    c++ -o cpipemain -O3 cpipemain.cpp cnrsub.o FramePipeline.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread
+//
+// Invocation:
+//    ./cpipemain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of frames processed - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames in the input file - default 8.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 8 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "FramePipeline.h"
+#include "BenchHarness.h"
+
+//  subr() is the subroutine that does the actual array manipulation. It has to
+//  be compiled separately to prevent a compiler optimising it away entirely.
+
+void subr (float* In[], int Nx, int Ny, float* Out[]);
+
+//  ----------------------------------------------------------------------------
+//
+//                             W r i t e  I n p u t
+//
+//  Writes the input file, with frame Iz set to the usual test values plus Iz,
+//  each frame padded out to the stride a FramePipeline expects.
+
+static bool WriteInput (const char* FileName, int Nx, int Ny, int Nz)
+{
+   FILE* File = fopen(FileName,"wb");
+   if (File == NULL) return false;
+   long Stride = FramePipeline::FrameStride(Nx,Ny);
+   std::vector<float> Frame(Stride / sizeof(float) + 1,0.0f);
+   bool Ok = true;
+   for (int Iz = 0; Iz < Nz && Ok; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            Frame[long(Iy) * Nx + Ix] = float(Nx - Ix + Ny - Iy + Iz);
+         }
+      }
+      Ok = (fwrite(&Frame[0],1,Stride,File) == size_t(Stride));
+   }
+   if (fclose(File) != 0) Ok = false;
+   return Ok;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                             C h e c k  O u t p u t
+//
+//  Reads back the first NFrames frames of the output file and checks them.
+
+static bool CheckOutput (const char* FileName, int Nx, int Ny, int NFrames)
+{
+   FILE* File = fopen(FileName,"rb");
+   if (File == NULL) {
+      printf ("Unable to open %s to check it\n",FileName);
+      return false;
+   }
+   long Stride = FramePipeline::FrameStride(Nx,Ny);
+   std::vector<float> Frame(Stride / sizeof(float) + 1);
+   bool Error = false;
+   for (int Iz = 0; Iz < NFrames && !Error; Iz++) {
+      if (fread(&Frame[0],1,Stride,File) != size_t(Stride)) {
+         printf ("Unable to read frame %d of %s\n",Iz,FileName);
+         Error = true;
+         break;
+      }
+      for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            float In = float(Nx - Ix + Ny - Iy + Iz);
+            float Out = Frame[long(Iy) * Nx + Ix];
+            if (Out != In + Ix + Iy) {
+               Error = true;
+               printf ("Error frame %d Out[%d][%d] = %f, not %f\n",Iz,Iy,Ix,
+                                                        Out,float(In + Ix + Iy));
+               break;
+            }
+         }
+      }
+   }
+   fclose(File);
+   return !Error;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 8;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+   if (Nz < 1) Nz = 1;
+   
+   FramePipeline::Mode How = FramePipeline::Overlapped;
+   bool Direct = false;
+   int NBuffers = 2;
+   int Passes = 1;
+   std::string Dir = ".";
+   const char* Env = getenv("PIPE_MODE");
+   if (Env && !strcmp(Env,"serial")) How = FramePipeline::Serial;
+   Env = getenv("PIPE_DIRECT");
+   if (Env && atoi(Env) != 0) Direct = true;
+   Env = getenv("PIPE_BUFFERS");
+   if (Env && atoi(Env) > 0) NBuffers = atoi(Env);
+   Env = getenv("PIPE_PASSES");
+   if (Env && atoi(Env) > 0) Passes = atoi(Env);
+   Env = getenv("PIPE_DIR");
+   if (Env && *Env) Dir = Env;
+   char Suffix[32];
+   snprintf (Suffix,sizeof(Suffix),"%ld.dat",long(getpid()));
+   std::string InFile = Dir + "/cpipe_in" + Suffix;
+   std::string OutFile = Dir + "/cpipe_out" + Suffix;
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h). Each timed call is one
+   //  frame, read, processed and written.
+
+   BenchHarness Bench ("cpipemain",Nx,Ny,Nrpt);
+   
+   if (!WriteInput(InFile.c_str(),Nx,Ny,Nz)) {
+      printf ("Unable to write input file %s\n",InFile.c_str());
+      unlink(InFile.c_str());
+      return 1;
+   }
+   printf ("Arrays have %d rows of %d columns, repeats = %d\n",Ny,Nx,Nrpt);
+   
+   bool Error = false;
+   int NFrames = 0;
+   {
+      FramePipeline Pipe (InFile.c_str(),OutFile.c_str(),Nx,Ny,How,NBuffers,Direct);
+      if (!Pipe.Ok()) {
+         printf ("Unable to start pipeline: %s\n",Pipe.Error().c_str());
+         unlink(InFile.c_str());
+         unlink(OutFile.c_str());
+         return 1;
+      }
+      printf ("Frames from a file of %d, %s, %d buffer(s), %s, %d pass(es)\n",Nz,
+          How == FramePipeline::Serial ? "serial" : "overlapped",NBuffers,
+                           Pipe.Direct() ? "O_DIRECT" : "page cache",Passes);
+   
+      //  The loop. If the pipeline fails, the remaining calls do nothing, and
+      //  the error is reported afterwards.
+   
+      Bench.StartLoop();
+      while (Bench.Next()) {
+         float** Out;
+         float** In = Pipe.Next(&Out);
+         if (In) {
+            for (int Pass = 0; Pass < Passes; Pass++) subr (In,Nx,Ny,Out);
+            Pipe.Done();
+         }
+      }
+      if (!Pipe.Flush()) {
+         printf ("Pipeline error: %s\n",Pipe.Error().c_str());
+         Error = true;
+      }
+      NFrames = int(Pipe.Frames() < Nz ? Pipe.Frames() : Nz);
+      printf ("I/O %.4g sec, waited %.4g sec, %.1f%% of the I/O time hidden\n",
+                  Pipe.IoSeconds(),Pipe.WaitSeconds(),Pipe.HiddenFraction() * 100.0);
+      Bench.Extra("io_s",Pipe.IoSeconds());
+      Bench.Extra("wait_s",Pipe.WaitSeconds());
+      Bench.Extra("hidden",Pipe.HiddenFraction());
+      Bench.Extra("direct",Pipe.Direct() ? 1 : 0);
+   }
+   
+   //  Check the frames written to the output file.
+   
+   if (!Error) Error = !CheckOutput(OutFile.c_str(),Nx,Ny,NFrames);
+   Bench.Report(Error);
+   unlink(InFile.c_str());
+   unlink(OutFile.c_str());
+   return 0;
+}
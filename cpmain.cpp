@@ -0,0 +1,244 @@
+//
+//                           c p m a i n . c p p
+//
+// Summary:
+//    2D array access test main routine in C++, multithreaded subroutine.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays - the sort of
+//    thing that are common in astronomy and similar scientific disciplines.
+//    This can also be used to see how efficient different ways of coding the
+//    same problem can be in the different languages, and to see what effect
+//    such things as compilation options - particularly optimisation options -
+//    have.
+//
+//    The problem chosen is a trivial one: given an 2D array, add to each
+//    element the sum of its two indices and return the result in a second,
+//    similarly-sized array. This is harder to optimise away than, for example,
+//    simply doing an element by element copy of the array, but is generally
+//    easy to code. It isn't a perfect test (something brought out by the
+//    study), but it does produce some interesting results.
+//
+// This version:
+//    This version is for C++, and is almost exactly the same as cnrmain.cpp.
+//    It uses the 'Numerical Recipes' scheme, where what is passed to the
+//    subroutine is the address of an array whose elements contain the
+//    addresses of the start of each row of the 2D array. It is intended to be
+//    used with the multithreaded subroutine in cpsub.cpp, which splits the
+//    rows of the array between a number of threads. The only difference from
+//    cnrmain.cpp is that it accepts an optional fourth parameter giving the
+//    number of threads the subroutine is to use, and reports the number it
+//    will use. (cpsub.cpp can also be used with cnrmain.cpp itself, in which
+//    case the number of threads is set when it is compiled, or through the
+//    SUBR_THREADS environment variable.)
+//
+//    On a machine with more than one NUMA node, where the arrays are placed in
+//    memory matters as much as how many threads work on them. The arrays are
+//    allocated by an ArrayManager using a NumaAllocator (see ArrayAllocator.h),
+//    and the environment variable SUBR_PLACEMENT selects how they are placed:
+//
+//      serial      the pages go wherever they are first written, and they are
+//                  first written by the main thread as it initialises them, so
+//                  they all end up on its node. This is the default, and is
+//                  what happens with a plain malloc().
+//      firsttouch  the arrays are first written by SubrFirstTouch(), with each
+//                  thread touching the rows it will later work on, so each
+//                  block of rows is on the node of the thread that uses it.
+//                  (Set SUBR_PIN to 1 as well, so the threads stay there.)
+//      interleave  the pages are spread evenly over all the nodes.
+//      node<n>     all the pages are on node n, eg node1.
+//
+//    Setting SUBR_HUGEPAGES to 1 also asks for transparent huge pages, which
+//    cuts the number of TLB misses for large arrays. Both only affect arrays
+//    of at least 256 KBytes, and only on Linux.
+//
+// Structure:
+//    Most test progrsms in this study code the basic array manipulation in a
+//    single subroutine, then create the original input array, and pass that,
+//    together with the dimensions of the array, to that subroutine, repeating
+//    that call a large number of times in oder to be able to get a reasonable
+//    estimate of the time taken. Then the final result is checked against the
+//    expected result. This program follows that structure.
+//
+// Building:
+//    The file containing the implementation of the subr() routine has to be
+//    compiled separately, using the compiler being tested and with the options
+//    being tested. Then this main program needs to be linked against that
+//    compiled subroutine, the ThreadPool code and the ArrayManager code. For
+//    example, something like:
+//
+//    c++ -c -O3 -o cpsub.o cpsub.cpp
+//    c++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp ArrayManager.cpp
+//                                                  ArrayAllocator.cpp -lpthread
+//
+// Invocation:
+//    ./cpmain irpt nx ny nthreads
+//
+//    where:
+//      irpt     is the number of times the subroutine is called - default 1000.
+//      nx       is the number of columns in the array tested - default 2000.
+//      ny       is the number of rows in the array tested - default 10.
+//      nthreads is the number of threads to use - the default is set by the
+//               subroutine, and is usually one per available CPU.
+//
+//    Note that the subroutine only uses more than one thread if the array is
+//    large enough for that to be worthwhile, so with the default array size
+//    the nthreads parameter makes no difference.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. Arrays now come from an ArrayManager with a NumaAllocator,
+//                   with the placement set by SUBR_PLACEMENT and SUBR_HUGEPAGES.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h, without its performance counters.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ArrayManager.h"
+
+//  The harness's performance counters only count events in the calling thread,
+//  so would miss most of what the other threads do. Its timing is still valid,
+//  since it is wall clock time for the whole of each call, so just the
+//  counters are left out.
+
+#define BENCH_NO_PERF
+#include "BenchHarness.h"
+
+//  subr() is the subroutine that does the actual array manipulation. It has to
+//  be compiled separately to prevent a compiler optimising it away entirely.
+//  SubrThreads() sets the number of threads it uses, and SubrFirstTouch()
+//  first writes to the arrays using those threads.
+
+void subr (float* in[], int nx, int ny, float* out[]);
+int SubrThreads (int NThreads);
+void SubrFirstTouch (float* in[], int nx, int ny, float* out[]);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions, repeat count and number of threads either from
+   //  the default values or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int NThreads = 0;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) NThreads = atoi(argv[4]);
+   NThreads = SubrThreads(NThreads);
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("cpmain",Nx,Ny,Nrpt);
+   
+   //  Work out how the arrays are to be placed in memory.
+   
+   const char* Placement = getenv("SUBR_PLACEMENT");
+   if (Placement == NULL || *Placement == '\0') Placement = "serial";
+   NumaAllocator::Placement Policy = NumaAllocator::FirstTouch;
+   int Node = 0;
+   if (!strcmp(Placement,"interleave")) {
+      Policy = NumaAllocator::Interleave;
+   } else if (!strncmp(Placement,"node",4)) {
+      Policy = NumaAllocator::Bind;
+      Node = atoi(Placement + 4);
+   } else if (strcmp(Placement,"serial") && strcmp(Placement,"firsttouch")) {
+      printf ("SUBR_PLACEMENT '%s' not recognised, using 'serial'\n",Placement);
+      Placement = "serial";
+   }
+   const char* Huge = getenv("SUBR_HUGEPAGES");
+   bool HugePages = (Huge && atoi(Huge) != 0);
+   
+   //  Allocate the input and output arrays. ArrayManager sets up the arrays
+   //  that contain the addresses of the start of the data for each row - see
+   //  cnrmain.cpp for the details of what it does.
+   
+   NumaAllocator Allocator(Policy,Node,HugePages);
+   ArrayManager Manager;
+   Manager.SetAllocator(&Allocator);
+   float** In = (float**) Manager.Malloc2D(sizeof(float),Ny,Nx);
+   float** Out = (float**) Manager.Malloc2D(sizeof(float),Ny,Nx);
+   if (In == NULL || Out == NULL) {
+      printf ("Unable to allocate arrays of %d rows of %d columns\n",Ny,Nx);
+      return 1;
+   }
+   if (!strcmp(Placement,"firsttouch")) SubrFirstTouch (In,Nx,Ny,Out);
+   
+   //  We set the elements of the input array to some set of values - it doesn't
+   //  matter what, just some values we can use to check the array manipulation
+   //  on. This uses the sum of the row and column indices in descending order.
+   //  We don't need to initialise the output array.
+   
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         In[Iy][Ix] = float(Nx - Ix + Ny - Iy);
+      }
+   }
+   printf ("Arrays have %d rows of %d columns, repeats = %d, threads = %d\n",
+                                                         Ny,Nx,Nrpt,NThreads);
+   printf ("Placement: %s%s, NUMA nodes = %d%s\n",Placement,
+            HugePages ? ", huge pages" : "",NumaAllocator::Nodes(),
+            Allocator.Failures() ? " (some placement requests failed)" : "");
+   
+   //  Repeat the call to the manipulating subroutine. A compiler can't optimise
+   //  this out, as it doesn't know that the results will be the same every
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      subr (In,Nx,Ny,Out);
+   }
+   
+   //  Check that we got the expected results.
+   
+   bool Error = false;
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         if (Out[Iy][Ix] != In[Iy][Ix] + Ix + Iy) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Iy,Ix,
+                                   Out[Iy][Ix],float(In[Iy][Ix] + Ix + Iy));
+            break;
+         }
+      }
+      if (Error) break;
+   }
+   Bench.Extra("threads",NThreads);
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,254 @@
+//
+//                           c p s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, multithreaded over the rows.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and uses the 'Numerical Recipes' scheme for
+//    passing the arrays, exactly as does cnrsub.cpp, so it has the same
+//    calling sequence and can be used with cnrmain.cpp, ckmain.cpp, or the
+//    cpmain.cpp program written for it. The difference is that this version
+//    splits the rows of the array between a number of threads, so that on a
+//    multi-core machine the work is shared between the cores. The rows are
+//    split into contiguous blocks, one for each thread, using the ThreadPool
+//    class in ThreadPool.h/.cpp.
+//
+//    The test calls this routine a very large number of times, so the threads
+//    are created only once, the first time the routine is called, and then
+//    wait to be given work on subsequent calls. Even so, handing out the work
+//    and waiting for it to finish has a cost, and for small arrays - the
+//    default 10 rows of 2000 elements used by the test, for example - that
+//    cost is more than the time saved. So the number of threads used is
+//    limited so that each has at least SUBR_MIN_ELEMENTS elements to work on,
+//    and for the default array size that means just one thread, in which case
+//    the work is done directly, exactly as in cnrsub.cpp. To see the threads
+//    being used, the test needs to be run with a much larger array.
+//
+//    By default, the routine uses one thread for each CPU available to the
+//    process. This can be changed at compile time by defining SUBR_THREADS,
+//    eg -DSUBR_THREADS=4, or at run time by setting the environment variable
+//    of the same name, which takes precedence. The main program can also set
+//    it by calling SubrThreads() before the first call to subr(). Setting the
+//    environment variable SUBR_PIN to 1 pins the threads to separate CPUs, in
+//    order, so that they don't migrate from core to core - and, on a NUMA
+//    machine, from node to node. Since the same thread always handles the
+//    same block of rows, those rows then stay in the caches - and in memory
+//    local to the node - of the core that handles them. The threads aren't
+//    pinned by default, since none of the other tests pin theirs. The pool is
+//    shut down, and its threads joined, when the program exits.
+//
+//    That only keeps the rows in local memory if they were put there in the
+//    first place. Linux places each page of memory on the node of the thread
+//    that first writes to it, so an array initialised by one thread ends up
+//    entirely on that thread's node. SubrFirstTouch() writes zeros to both
+//    arrays, using the same threads, with the same rows for each thread, as
+//    subr() will use for arrays of that size, so each block of rows is placed
+//    on the node of the thread that will work on it - which only stays true
+//    if the threads are pinned, with SUBR_PIN set to 1. It needs to be the
+//    first thing to write to the data - to be useful the data must have come
+//    straight from the system, as it does from a NumaAllocator (see
+//    ArrayAllocator.h).
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// Building:
+//    This needs to be compiled with C++11 or later (the default for recent
+//    compilers), and linked with ThreadPool.cpp and the system thread library,
+//    for example:
+//
+//    c++ -c -O3 -DSUBR_THREADS=4 cpsub.cpp -o cpsub.o
+//    c++ -o cpmain -O3 cpmain.cpp cpsub.o ThreadPool.cpp -lpthread
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. Added SubrFirstTouch().
+//    14th Oct 2026. The pool is now a static object, so its threads are joined
+//                   at exit, and pinning is only done if SUBR_PIN is 1.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <stdlib.h>
+
+#include "ThreadPool.h"
+
+//  The number of threads to use. Zero means one per available CPU.
+
+#ifndef SUBR_THREADS
+#define SUBR_THREADS 0
+#endif
+
+//  The smallest number of elements worth giving to a thread. 32K elements is
+//  32K floats in and 32K out, which takes a few microseconds to process - a
+//  good deal longer than it takes to hand the work to a waiting thread.
+
+#ifndef SUBR_MIN_ELEMENTS
+#define SUBR_MIN_ELEMENTS 32768
+#endif
+
+//  The thread pool, once it has been started by the first call that needs it,
+//  and the number of threads it is to have (negative until that has been
+//  decided). The pool itself is a static object in StartPool(), so it is
+//  destroyed - and its threads stopped and joined - when the program exits.
+
+static ThreadPool* Pool = NULL;
+static int PoolThreads = -1;
+
+//  ----------------------------------------------------------------------------
+//
+//                             S t a r t  P o o l
+//
+//  StartPool() creates the pool, the first time it is called, and returns its
+//  address. The threads are only pinned to CPUs if SUBR_PIN is set to 1.
+
+static ThreadPool* StartPool (void)
+{
+   const char* Pin = getenv("SUBR_PIN");
+   static ThreadPool ThePool (PoolThreads,Pin && atoi(Pin) == 1);
+   return &ThePool;
+}
+
+//  A RowBlock describes the arrays being processed, and is what the ThreadPool
+//  passes to SubrRows() for each block of rows.
+
+typedef struct RowBlock {
+   float** In;
+   float** Out;
+   int Nx;
+} RowBlock;
+
+//  ----------------------------------------------------------------------------
+//
+//                             S u b r  R o w s
+//
+//  SubrRows() does the actual work for the rows from First up to (but not
+//  including) Last. This is the same code as in cnrsub.cpp, just for a limited
+//  range of rows.
+
+static void SubrRows (void* Context, long First, long Last, int /*Part*/)
+{
+   RowBlock* Block = (RowBlock*) Context;
+   float** In = Block->In;
+   float** Out = Block->Out;
+   int Nx = Block->Nx;
+   for (int Iy = int(First); Iy < int(Last); Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         Out[Iy][Ix] = In[Iy][Ix] + Ix + Iy;
+      }
+   }
+}
+
+//  TouchRows() writes zeros to the rows from First up to (but not including)
+//  Last of both arrays, for SubrFirstTouch().
+
+static void TouchRows (void* Context, long First, long Last, int /*Part*/)
+{
+   RowBlock* Block = (RowBlock*) Context;
+   for (int Iy = int(First); Iy < int(Last); Iy++) {
+      for (int Ix = 0; Ix < Block->Nx; Ix++) {
+         Block->In[Iy][Ix] = 0.0f;
+         Block->Out[Iy][Ix] = 0.0f;
+      }
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                            S u b r  T h r e a d s
+//
+//  SubrThreads() sets the number of threads subr() will use, if NThreads is
+//  greater than zero and subr() hasn't yet started its threads, and returns
+//  the number it will use (or is using). If it isn't called, or is passed
+//  zero, the number comes from the SUBR_THREADS environment variable, or from
+//  the compile-time SUBR_THREADS value, or is the number of available CPUs.
+
+int SubrThreads (int NThreads)
+{
+   if (Pool == NULL) {
+      if (NThreads > 0) {
+         PoolThreads = NThreads;
+      } else if (PoolThreads < 0) {
+         PoolThreads = SUBR_THREADS;
+         const char* Env = getenv("SUBR_THREADS");
+         if (Env && atoi(Env) > 0) PoolThreads = atoi(Env);
+         if (PoolThreads <= 0) PoolThreads = ThreadPool::AvailableCPUs();
+      }
+   }
+   return Pool ? Pool->Threads() : PoolThreads;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                            R u n  R o w s
+//
+//  RunRows() applies a row routine to the whole of an array, using as many
+//  threads as are worth using for an array of that size. If that's just one,
+//  it does it all directly and doesn't even start the pool. subr() and
+//  SubrFirstTouch() both use this, which is what guarantees each thread gets
+//  the same rows from both.
+
+static void RunRows (ThreadPoolTask Task, float* In[], int Nx, int Ny,
+                                                              float* Out[])
+{
+   int NThreads = SubrThreads(0);
+   long Elements = long(Nx) * long(Ny);
+   long MaxUseful = Elements / SUBR_MIN_ELEMENTS;
+   if (MaxUseful < NThreads) NThreads = int(MaxUseful);
+   RowBlock Block = { In, Out, Nx };
+   if (NThreads <= 1) {
+      (*Task) (&Block,0,Ny,0);
+   } else {
+      if (Pool == NULL) Pool = StartPool();
+      Pool->ParallelFor (Ny,Task,&Block,NThreads);
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                         S u b r  F i r s t  T o u c h
+
+void SubrFirstTouch (float* In[], int Nx, int Ny, float* Out[])
+{
+   RunRows (TouchRows,In,Nx,Ny,Out);
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                                 S u b r
+
+void subr (float* In[], int Nx, int Ny, float* Out[])
+{
+   RunRows (SubrRows,In,Nx,Ny,Out);
+}
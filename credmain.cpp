@@ -0,0 +1,282 @@
+//
+//                           c r e d m a i n . c p p
+//
+// Summary:
+//    Stack reduction test main routine in C++, using the Reductions class.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of multi-dimensional arrays. The
+//    other tests apply the same simple operation to each element of an array.
+//    This one times the other thing data reduction code does most: collapsing
+//    an array along one axis - most often, combining a stack of frames into
+//    one by taking the sum, mean or median of each pixel through the stack.
+//    The test program in ArrayManager.cpp does this with plain loops and float
+//    totals; this program times the vectorised, multithreaded versions in
+//    Reductions.cpp, or, for comparison, the same plain loops.
+//
+// Structure:
+//    This main routine uses an ArrayManager to create a 3D input array with
+//    Nz planes of Ny rows of Nx columns, and a 2D output array the shape of
+//    the input with the axis being reduced taken out. It fills In with test
+//    values, and then repeatedly reduces it along that axis using a
+//    Reductions object. It then checks the results against a straightforward
+//    calculation done in double precision, and reports the largest relative
+//    error as well as the time.
+//
+//    The reduction is controlled by environment variables, so the one
+//    executable can be used for all of the tests:
+//
+//       REDUCE_OP        sum, mean, min, max or median - default mean.
+//       REDUCE_AXIS      0 (X), 1 (Y) or 2 (Z, through the stack) - default 2.
+//       REDUCE_ACCURACY  plain, kahan or pairwise - default pairwise.
+//       REDUCE_THREADS   the number of threads, 0 for one per CPU - default 1.
+//       REDUCE_SIGMA     the clipping limit for median, in standard deviations
+//                        - default 0, no clipping.
+//       REDUCE_NAIVE     if 1, use plain loops with a float total, looping
+//                        along the reduced axis innermost, as ArrayManager.cpp
+//                        does - only for sum and mean through the stack.
+//       REDUCE_VIEW      if 1, make the input a view (see View3D()) of every
+//                        other frame of a larger stack, missing out its first
+//                        row, so the frames aren't Ny rows apart - default 0.
+//
+//    For a clipped median through a stack of at least 16 frames, one frame
+//    in each pixel is given a large 'cosmic ray' value, and the result is
+//    expected to be the median of the other values.
+//
+// Building:
+//    c++ -c -O3 -o Reductions.o Reductions.cpp
+//    c++ -o credmain -O3 credmain.cpp Reductions.o ThreadPool.cpp ArrayManager.cpp ArrayAllocator.cpp -lpthread
+//
+// Invocation:
+//    ./credmain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the stack is reduced - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames - default 16.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 16 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. Added REDUCE_VIEW, to check reductions of views.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Reductions.h"
+#include "BenchHarness.h"
+
+//  The value given to the 'cosmic ray' in each pixel for a clipped median.
+
+static const float CosmicRay = 1.0e6f;
+
+//  ----------------------------------------------------------------------------
+//
+//                                   A t
+//
+//  At() returns the input element that is value K along the reduced axis for
+//  element [J1][J0] of the result.
+
+static float At (float*** In, int Axis, int K, int J0, int J1)
+{
+   if (Axis == 0) return In[J1][J0][K];
+   if (Axis == 1) return In[J1][K][J0];
+   return In[K][J1][J0];
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                               E n v  S t r i n g
+
+static const char* EnvString (const char* Name, const char* Default)
+{
+   const char* Value = getenv(Name);
+   return (Value && *Value) ? Value : Default;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 16;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+
+   //  Work out what is to be done.
+
+   const char* OpName = EnvString("REDUCE_OP","mean");
+   const char* Names[] = { "sum", "mean", "min", "max", "median" };
+   Reductions::Operation Ops[] = { Reductions::Total, Reductions::Average,
+          Reductions::Minimum, Reductions::Maximum, Reductions::ClippedMedian };
+   int IOp = -1;
+   for (int Index = 0; Index < 5; Index++) {
+      if (!strcmp(OpName,Names[Index])) IOp = Index;
+   }
+   int Axis = atoi(EnvString("REDUCE_AXIS","2"));
+   const char* AccuracyName = EnvString("REDUCE_ACCURACY","pairwise");
+   Reductions::Accuracy Method = Reductions::Pairwise;
+   if (!strcmp(AccuracyName,"plain")) Method = Reductions::Plain;
+   if (!strcmp(AccuracyName,"kahan")) Method = Reductions::Kahan;
+   int NThreads = atoi(EnvString("REDUCE_THREADS","1"));
+   float Sigma = float(atof(EnvString("REDUCE_SIGMA","0")));
+   bool Naive = atoi(EnvString("REDUCE_NAIVE","0")) != 0;
+   bool View = atoi(EnvString("REDUCE_VIEW","0")) != 0;
+   if (IOp < 0 || Axis < 0 || Axis > 2 || (Naive && (IOp > 1 || Axis != 2))) {
+      printf ("Can't do %s along axis %d%s\n",OpName,Axis,
+                                          Naive ? " with plain loops" : "");
+      return 1;
+   }
+   Reductions::Operation Op = Ops[IOp];
+
+   //  Start the benchmark harness (see BenchHarness.h). It is told the stack
+   //  has Ny * Nz rows, so that its counts per element are per input element.
+
+   BenchHarness Bench ("credmain",Nx,long(Ny) * long(Nz),Nrpt);
+
+   //  The result has the dimensions of the input with the reduced axis left
+   //  out - J0 is the first of those left, J1 the second.
+
+   long Dims[3] = { Nx, Ny, Nz };
+   int Length = int(Dims[Axis]);
+   int N0 = int(Axis == 0 ? Dims[1] : Dims[0]);
+   int N1 = int(Axis == 2 ? Dims[1] : Dims[2]);
+
+   ArrayManager Manager;
+   float*** In = NULL;
+   if (View) {
+      void* Stack = Manager.Malloc3D(sizeof(float),2 * Nz,Ny + 1,Nx);
+      In = (float***) Manager.View3D(Stack,1,1,0,Nz,Ny,Nx,2);
+   } else {
+      In = (float***) Manager.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   }
+   float** Out = (float**) Manager.Malloc2D(sizeof(float),N1,N0);
+   if (In == NULL || Out == NULL) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   Reductions Reducer (Manager,NThreads);
+   Reducer.SetAccuracy(Method);
+   Reducer.SetClipping(Sigma);
+   
+   //  Set the input array to the test values used by the other tests, plus
+   //  the frame number, and plant the cosmic rays if they are wanted.
+   
+   bool Cosmics = (Op == Reductions::ClippedMedian && Sigma > 0.0f &&
+                                                  Axis == 2 && Length >= 16);
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            In[Iz][Iy][Ix] = float(Nx - Ix + Ny - Iy + Iz);
+            if (Cosmics && (Ix + Iy) % Nz == Iz) In[Iz][Iy][Ix] = CosmicRay;
+         }
+      }
+   }
+   printf ("Arrays have %d frames of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   printf ("Finding the %s along axis %d, %s, using %d thread(s)\n",OpName,Axis,
+              Naive ? "with plain loops" : AccuracyName,Reducer.Threads());
+   if (View) printf ("The arrays are a view of every other frame of a larger stack\n");
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      if (Naive) {
+         for (int Iy = 0; Iy < Ny; Iy++) {
+            for (int Ix = 0; Ix < Nx; Ix++) {
+               float Total = 0.0;
+               for (int Iz = 0; Iz < Nz; Iz++) {
+                  Total += In[Iz][Iy][Ix];
+               }
+               Out[Iy][Ix] = (Op == Reductions::Average) ? Total / Nz : Total;
+            }
+         }
+      } else {
+         Reducer.Reduce(Op,In,Axis,Out);
+      }
+      Bench.Sink(Out[0]);
+   }
+   
+   //  Check that we got the expected results, working out each one as simply
+   //  as possible, sums in double. Sums and means are allowed a small relative
+   //  error, and the largest is reported.
+   
+   bool Error = false;
+   double MaxRelError = 0.0;
+   std::vector<float> Values (Length);
+   for (int J1 = 0; J1 < N1 && !Error; J1++) {
+      for (int J0 = 0; J0 < N0; J0++) {
+         double Expected = 0.0;
+         if (Op == Reductions::Total || Op == Reductions::Average) {
+            for (int K = 0; K < Length; K++) Expected += At(In,Axis,K,J0,J1);
+            if (Op == Reductions::Average) Expected /= Length;
+         } else {
+            int NValues = 0;
+            for (int K = 0; K < Length; K++) {
+               float Value = At(In,Axis,K,J0,J1);
+               if (!(Cosmics && Value == CosmicRay)) Values[NValues++] = Value;
+            }
+            std::sort(Values.begin(),Values.begin() + NValues);
+            if (Op == Reductions::Minimum) Expected = Values[0];
+            if (Op == Reductions::Maximum) Expected = Values[NValues - 1];
+            if (Op == Reductions::ClippedMedian) {
+               int Mid = NValues / 2;
+               Expected = Values[Mid];
+               if (NValues % 2 == 0) Expected = 0.5f * (Values[Mid - 1] + Values[Mid]);
+            }
+         }
+         double RelError = fabs(Out[J1][J0] - Expected);
+         if (Expected != 0.0) RelError /= fabs(Expected);
+         if (RelError > MaxRelError) MaxRelError = RelError;
+         if (RelError > 1.0e-4) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",J1,J0,Out[J1][J0],
+                                                                  Expected);
+            break;
+         }
+      }
+   }
+   printf ("Largest relative error %g\n",MaxRelError);
+   Bench.Extra("max_rel_err",MaxRelError);
+   Bench.Extra("threads",Naive ? 1 : Reducer.Threads());
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,120 @@
+//
+//                           c s i m d s u b . c p p
+//
+// Summary:
+//    2D array access test subroutines in C++, using run-time selected SIMD.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and does the work for each row using one of the
+//    vectorised row kernels in SimdKernels.h/.cpp. Which kernel is used - SSE2,
+//    AVX2 or AVX-512 on x86, NEON on ARM - is decided the first time one of
+//    these routines is called, according to what the CPU running the program
+//    supports. So, unlike subrasavx.s, these work on any machine, and there's
+//    no need to compile with -march=native to get the benefit of the vector
+//    hardware - a program compiled for the basic instruction set and run on an
+//    AVX-512 machine will use AVX-512 for the actual work.
+//
+//    Because the kernels work a row at a time, the one file provides versions
+//    of subr() for three of the ways the main programs in this study set up
+//    their arrays. C++ allows overloaded routines, so they can all be called
+//    subr(), and each main program simply picks up the one it expects:
+//
+//    o subr (float* In, int Nx, int Ny, float* Out) for the flat arrays used
+//      by cmain.cpp, where the rows simply follow one another in memory.
+//    o subr (float* In[], int Nx, int Ny, float* Out[]) for the 'Numerical
+//      Recipes' row pointers used by cnrmain.cpp (and ckmain.cpp), exactly as
+//      in cnrsub.cpp and subrasavx.s.
+//    o subr (vector<vector<float> >& In, int Nx, int Ny,
+//      vector<vector<float> >& Out) for the vectors of vectors used by
+//      cvmain.cpp.
+//
+//    The version for Boost arrays, used by cbmain.cpp, is in cbsimdsub.cpp,
+//    so that this file doesn't need the Boost headers.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// Building:
+//    For example:
+//
+//    c++ -c -O3 csimdsub.cpp -o csimdsub.o
+//    c++ -o cnrmain -O3 cnrmain.cpp csimdsub.o SimdKernels.cpp
+//
+//    The environment variable SIMD_KERNEL can be used to force a particular
+//    kernel - see SimdKernels.h.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <vector>
+
+#include "SimdKernels.h"
+
+using std::vector;
+
+//  ----------------------------------------------------------------------------
+//
+//                        F l a t  a r r a y s
+
+void subr (float* In, int Nx, int Ny, float* Out)
+{
+   SimdIndexAdd2D (In,Out,Nx,Ny,Nx);
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                    N u m e r i c a l  R e c i p e s
+
+void subr (float* In[], int Nx, int Ny, float* Out[])
+{
+   IndexAddRowKernel Kernel = SimdIndexAddRow();
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      (*Kernel)(In[Iy],Out[Iy],Nx,Iy);
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                   V e c t o r s  o f  v e c t o r s
+
+void subr (vector<vector<float> > &In,
+             int Nx,int Ny,vector<vector<float> > &Out)
+{
+   IndexAddRowKernel Kernel = SimdIndexAddRow();
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      (*Kernel)(&(In[Iy][0]),&(Out[Iy][0]),Nx,Iy);
+   }
+}
@@ -0,0 +1,188 @@
+//
+//                           c s t r e a m s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, flat arrays, streaming stores.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and is a replacement for csub.cpp, designed to
+//    be called from cmain.cpp with each of In and Out simply the address of the
+//    start of an area of memory that holds Nx by Ny floating point numbers.
+//    For small arrays it does exactly what csub.cpp does. The difference is in
+//    what it does for arrays too large to fit in the last level cache.
+//
+//    Normally, writing to an element of Out means the processor first has to
+//    read the cache line holding it from memory (a 'read for ownership'), only
+//    to overwrite the whole line shortly afterwards. While the arrays fit in
+//    the cache this hardly matters, as the lines are already there. But once
+//    they don't, every line of Out is read from memory and then written back,
+//    so a third of the memory traffic - one read in three - is wasted. x86
+//    processors provide 'non-temporal' or 'streaming' stores that write whole
+//    lines straight to memory without reading them first, and without keeping
+//    them in the cache (which is what we want - we're not going to look at
+//    Out again until the next call, by which time it would have been evicted
+//    anyway). Above a threshold size, this routine uses these for Out, and
+//    also prefetches In some way ahead of where it is working, to keep the
+//    reads flowing. Streaming stores are weakly ordered, so the routine ends
+//    with a store fence, so that anything that reads Out after this routine
+//    returns - another thread, say - is guaranteed to see the new values.
+//
+//    The threshold is the size of the last level cache, as reported by the
+//    system, if that can be found, or 8 MBytes if it can't. It can be set at
+//    compile time by defining SUBR_STREAM_BYTES. It is compared with the total
+//    size of In and Out. Below the threshold, streaming would make things
+//    worse, as Out would have to be brought back into the cache on the next
+//    call. The routine works a row at a time. Streaming stores need a 16 byte
+//    aligned address, so the first few elements of a row may have to be done
+//    with normal stores, as may the last few. On processors other than x86,
+//    the streaming path just uses ordinary stores with prefetching.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// Building:
+//    For example:
+//
+//    c++ -c -O3 cstreamsub.cpp -o cstreamsub.o
+//    c++ -o cmain -O3 cmain.cpp cstreamsub.o
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STREAM_X86
+#include <emmintrin.h>
+#endif
+
+//  How far ahead of the current element to prefetch In, in floats. 512 floats
+//  is 2 KBytes, or 32 cache lines, which is enough to cover memory latency at
+//  a good fraction of full memory bandwidth.
+
+#ifndef SUBR_PREFETCH_AHEAD
+#define SUBR_PREFETCH_AHEAD 512
+#endif
+
+//  ----------------------------------------------------------------------------
+//
+//                       S t r e a m  T h r e s h o l d
+//
+//  StreamThreshold() returns the total size of In and Out, in bytes, above
+//  which the streaming code is used. It is worked out on the first call.
+
+static long StreamThreshold (void)
+{
+   static long Threshold = 0;
+   if (Threshold == 0) {
+#ifdef SUBR_STREAM_BYTES
+      Threshold = SUBR_STREAM_BYTES;
+#else
+#ifdef _SC_LEVEL3_CACHE_SIZE
+      Threshold = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+      if (Threshold <= 0) Threshold = 8 * 1024 * 1024;
+#endif
+   }
+   return Threshold;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                           S t r e a m  R o w
+//
+//  StreamRow() does one row using streaming stores. Normal stores are used
+//  until Out is 16 byte aligned, then four floats at a time are streamed -
+//  sixteen per loop, which is one cache line of Out and one prefetch of In -
+//  and normal stores finish off whatever is left.
+
+static void StreamRow (const float* In, float* Out, int Nx, int Iy)
+{
+   int Ix = 0;
+#ifdef STREAM_X86
+   while (Ix < Nx && ((unsigned long) (Out + Ix) & 15)) {
+      Out[Ix] = In[Ix] + Ix + Iy;
+      Ix++;
+   }
+   const __m128 Row = _mm_set1_ps(float(Iy));
+   const __m128 Four = _mm_set1_ps(4.0f);
+   __m128 Col = _mm_setr_ps(float(Ix),float(Ix + 1),float(Ix + 2),float(Ix + 3));
+   for (; Ix + 16 <= Nx; Ix += 16) {
+      _mm_prefetch((const char*) (In + Ix + SUBR_PREFETCH_AHEAD),_MM_HINT_NTA);
+      for (int Part = 0; Part < 16; Part += 4) {
+         __m128 Value = _mm_add_ps(_mm_loadu_ps(In + Ix + Part),Col);
+         _mm_stream_ps(Out + Ix + Part,_mm_add_ps(Value,Row));
+         Col = _mm_add_ps(Col,Four);
+      }
+   }
+#else
+   for (; Ix + 16 <= Nx; Ix += 16) {
+      __builtin_prefetch(In + Ix + SUBR_PREFETCH_AHEAD,0,0);
+      for (int Part = 0; Part < 16; Part++) {
+         Out[Ix + Part] = In[Ix + Part] + (Ix + Part) + Iy;
+      }
+   }
+#endif
+   for (; Ix < Nx; Ix++) {
+      Out[Ix] = In[Ix] + Ix + Iy;
+   }
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                                 S u b r
+
+void subr (float* In, int Nx, int Ny, float* Out)
+{
+   long Bytes = 2L * long(Nx) * long(Ny) * long(sizeof(float));
+   if (Bytes <= StreamThreshold()) {
+
+      //  Small enough to stay in the cache - this is just csub.cpp.
+
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            Out[Iy * Nx + Ix] = In[Iy * Nx + Ix] + Ix + Iy;
+         }
+      }
+   } else {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         StreamRow (In + long(Iy) * Nx,Out + long(Iy) * Nx,Nx,Iy);
+      }
+#ifdef STREAM_X86
+      _mm_sfence();
+#endif
+   }
+}
@@ -0,0 +1,272 @@
+//
+//                          c t i l e d m a i n . c p p
+//
+// Summary:
+//    Compressed tiled array test main routine in C++, using TiledArray.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of multi-dimensional arrays. Most of
+//    the tests assume the arrays fit in memory. This one times what it costs
+//    when they are held compressed instead, using the TiledArray class, which
+//    keeps each plane as separately compressed tiles and decompresses them as
+//    they are needed. The data are simulated sky frames - a smooth background
+//    with a gradient across it, Gaussian noise, and a few bright stars - which
+//    is the kind of data that makes up most of a real data cube.
+//
+// Structure:
+//    This main routine uses an ArrayManager to create a 3D array with Nz planes
+//    of Ny rows of Nx columns, fills it with the simulated frames, and copies
+//    them into a TiledArray. It then repeatedly finds the mean of each pixel
+//    through the stack, working through the TiledArray a tile at a time with
+//    ForEachTile(), so every tile is decompressed on every pass - the cache is
+//    kept much smaller than the stack. It then checks the means against ones
+//    worked out in double precision from the original frames, allowing for
+//    the quantisation, and reports the compression ratio as well as the time.
+//
+//    The test is controlled by environment variables, so the one executable
+//    can be used for all of the tests:
+//
+//       TILED_METHOD  raw, rice or quantised - default quantised.
+//       TILED_Q       the noise level over the quantisation step - default 4.
+//       TILED_TILE    the size of the (square) tiles - default 128.
+//       TILED_CACHE   the number of tiles in the cache - default 4.
+//       TILED_PLAIN   if 1, find the means from the ordinary 3D array
+//                     instead, for comparison.
+//
+// Building:
+//    c++ -c -O3 -o TiledArray.o TiledArray.cpp
+//    c++ -o ctiledmain -O3 ctiledmain.cpp TiledArray.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./ctiledmain irpt nx ny nz
+//
+//    where
+//       irpt  is the number of times the means are found - default 1000.
+//       nx    is the number of columns in each frame - default 2000.
+//       ny    is the number of rows in each frame - default 10.
+//       nz    is the number of frames - default 16.
+//
+//    Run.py only passes irpt, nx and ny, so it always uses 16 frames.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TiledArray.h"
+#include "BenchHarness.h"
+
+//  The level of the background, and the standard deviation of its noise.
+
+static const double Background = 1000.0;
+static const double Sigma = 5.0;
+
+//  ----------------------------------------------------------------------------
+//
+//                                 G a u s s
+//
+//  Gauss() returns a value from a normal distribution of mean zero and unit
+//  standard deviation, near enough, as the sum of twelve uniform values from
+//  a simple generator. The same values every run are all that's needed.
+
+static double Gauss (unsigned long* Seed)
+{
+   double Sum = -6.0;
+   for (int I = 0; I < 12; I++) {
+      *Seed = (*Seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+      Sum += double(*Seed) / 2147483648.0;
+   }
+   return Sum;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                               S t a c k  S u m
+//
+//  The visitor passed to ForEachTile(), which adds each tile into the
+//  corresponding part of the running totals.
+
+struct StackSum {
+   float** Out;
+   void operator() (float** Tile, long X0, long X1, long Y0, long Y1,
+                                                          long Iz, long It) {
+      (void) Iz;
+      (void) It;
+      for (long Iy = Y0; Iy < Y1; Iy++) {
+         const float* In = Tile[Iy - Y0] - X0;
+         float* Row = Out[Iy];
+         for (long Ix = X0; Ix < X1; Ix++) Row[Ix] += In[Ix];
+      }
+   }
+};
+
+//  ----------------------------------------------------------------------------
+//
+//                               E n v  S t r i n g
+
+static const char* EnvString (const char* Name, const char* Default)
+{
+   const char* Value = getenv(Name);
+   return (Value && *Value) ? Value : Default;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   int Nz = 16;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+   if (argc > 4) Nz = atoi(argv[4]);
+
+   //  Work out what is to be done.
+
+   const char* MethodName = EnvString("TILED_METHOD","quantised");
+   TiledArray::Method Method = TiledArray::Quantised;
+   if (!strcmp(MethodName,"raw")) Method = TiledArray::Raw;
+   else if (!strcmp(MethodName,"rice")) Method = TiledArray::Rice;
+   else if (strcmp(MethodName,"quantised")) {
+      printf ("Unknown compression method '%s'\n",MethodName);
+      return 1;
+   }
+   float Q = float(atof(EnvString("TILED_Q","4")));
+   long TileSize = atol(EnvString("TILED_TILE","128"));
+   int CacheTiles = atoi(EnvString("TILED_CACHE","4"));
+   bool Plain = atoi(EnvString("TILED_PLAIN","0")) != 0;
+
+   //  Start the benchmark harness (see BenchHarness.h). It is told the stack
+   //  has Ny * Nz rows, so that its counts per element are per input element.
+
+   BenchHarness Bench ("ctiledmain",Nx,long(Ny) * long(Nz),Nrpt);
+
+   ArrayManager Manager;
+   float*** In = (float***) Manager.Malloc3D(sizeof(float),Nz,Ny,Nx);
+   float** Out = (float**) Manager.Malloc2D(sizeof(float),Ny,Nx);
+   TiledArray Tiled (Manager,1,Nz,Ny,Nx,TileSize,TileSize,CacheTiles);
+   if (In == NULL || Out == NULL || !Tiled.Ready()) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   Tiled.SetCompression(Method,Q);
+
+   //  Make up the frames. Each has the same background, sloping gently across
+   //  the frame and rising a little from one frame to the next, with its own
+   //  noise, and a star every few hundred pixels. Then copy them into the
+   //  TiledArray.
+
+   unsigned long Seed = 1;
+   for (int Iz = 0; Iz < Nz; Iz++) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) {
+            double Value = Background + 0.01 * Ix + 0.02 * Iy + Iz;
+            if ((Ix * 7 + Iy * 13) % 499 == 0) Value += 20000.0;
+            In[Iz][Iy][Ix] = float(Value + Sigma * Gauss(&Seed));
+         }
+      }
+      if (!Tiled.StorePlane(0,Iz,In[Iz])) {
+         printf ("Unable to store frame %d\n",Iz);
+         return 1;
+      }
+   }
+   Tiled.Flush();
+   double Ratio = Tiled.RawBytes() / double(Tiled.CompressedBytes());
+   printf ("Arrays have %d frames of %d rows of %d columns, repeats = %d\n",
+                                                            Nz,Ny,Nx,Nrpt);
+   if (Plain) {
+      printf ("Finding the mean through the stack, from an ordinary array\n");
+   } else {
+      printf ("Finding the mean through the stack, %s, tiles %ld by %ld\n",
+                                MethodName,Tiled.TileNx(),Tiled.TileNy());
+      printf ("Compressed from %.0f to %lu bytes, ratio %.2f\n",
+              Tiled.RawBytes(),(unsigned long) Tiled.CompressedBytes(),Ratio);
+   }
+
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) Out[Iy][Ix] = 0.0f;
+      }
+      if (Plain) {
+         for (int Iz = 0; Iz < Nz; Iz++) {
+            for (int Iy = 0; Iy < Ny; Iy++) {
+               for (int Ix = 0; Ix < Nx; Ix++) Out[Iy][Ix] += In[Iz][Iy][Ix];
+            }
+         }
+      } else {
+         StackSum Visitor;
+         Visitor.Out = Out;
+         Tiled.ForEachTile(Visitor);
+      }
+      float Scale = 1.0f / float(Nz);
+      for (int Iy = 0; Iy < Ny; Iy++) {
+         for (int Ix = 0; Ix < Nx; Ix++) Out[Iy][Ix] *= Scale;
+      }
+      Bench.Sink(Out[0]);
+   }
+
+   //  Check the means against ones worked out in double from the original
+   //  frames. No value can have moved by more than half a quantisation
+   //  step, so nor can the mean - and then there is rounding in the float
+   //  totals. The largest error is reported, in units of the noise.
+
+   bool Error = false;
+   double Allowed = (Plain ? 0.0 : 0.5 * Tiled.MaxStep()) + 1.0e-5 * Background;
+   double MaxError = 0.0;
+   for (int Iy = 0; Iy < Ny && !Error; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         double Expected = 0.0;
+         for (int Iz = 0; Iz < Nz; Iz++) Expected += In[Iz][Iy][Ix];
+         Expected /= Nz;
+         double Diff = fabs(Out[Iy][Ix] - Expected);
+         if (Diff > MaxError) MaxError = Diff;
+         if (Diff > Allowed + 1.0e-6 * fabs(Expected)) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Iy,Ix,Out[Iy][Ix],
+                                                                  Expected);
+            break;
+         }
+      }
+   }
+   printf ("Largest error %g (%g sigma)\n",MaxError,MaxError / Sigma);
+   Bench.Extra("ratio",Plain ? 1.0 : Ratio);
+   Bench.Extra("max_err_sigma",MaxError / Sigma);
+   Bench.Extra("cache_tiles",CacheTiles);
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,105 @@
+//
+//                          c t i l e s u b . c p p
+//
+// Summary:
+//    Cache-blocked transpose and collapse routines, for ctransmain/ccollmain.
+//
+// Introduction:
+//    This file provides the same transpose() and collapse() routines as
+//    cnaivesub.cpp, but implemented using the tiled kernels in Tiling.h. The
+//    arrays are split into tiles small enough that the tiles being worked on
+//    fit into the cache together, and all the work for one tile is done
+//    before moving on to the next. The results are identical - the collapse
+//    adds up the planes in the same order - but for arrays bigger than the
+//    cache, each cache line fetched is used in full rather than for just one
+//    element, which can make a very large difference.
+//
+// Tile shape:
+//    By default the tile shape for the transpose is the one TileShapeFor()
+//    suggests for two arrays of floats, which for a 32 KByte L1 cache is 64 by
+//    64 elements. The collapse doesn't need to turn anything round, and runs
+//    faster with the single row strips StripShapeFor() suggests, 4096 elements
+//    long for the same cache. Either shape can be set at compile time by defining TILE_NX and TILE_NY, eg
+//    -DTILE_NX=128 -DTILE_NY=32, or at run time by setting the environment
+//    variables of the same names, which take precedence. This makes it easy
+//    to see how sensitive the timings are to the tile shape.
+//
+// Building:
+//    c++ -c -O3 -o ctilesub.o ctilesub.cpp
+//    c++ -o ccollmain -O3 ccollmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdlib.h>
+
+#include "Tiling.h"
+
+#ifndef TILE_NX
+#define TILE_NX 0
+#endif
+#ifndef TILE_NY
+#define TILE_NY 0
+#endif
+
+//  ----------------------------------------------------------------------------
+//
+//                              G e t  S h a p e
+//
+//  GetShape() returns the tile shape to use, given the default shape for the
+//  operation in question. A zero or unset value for either dimension means use
+//  the default value.
+
+static TileShape GetShape (TileShape Shape)
+{
+   long Nx = TILE_NX;
+   long Ny = TILE_NY;
+   const char* Env = getenv("TILE_NX");
+   if (Env && atol(Env) > 0) Nx = atol(Env);
+   Env = getenv("TILE_NY");
+   if (Env && atol(Env) > 0) Ny = atol(Env);
+   if (Nx > 0) Shape.Nx = Nx;
+   if (Ny > 0) Shape.Ny = Ny;
+   return Shape;
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                              T r a n s p o s e
+
+void transpose (float** In, int Nx, int Ny, float** Out)
+{
+   static TileShape Shape = GetShape(TileShapeFor(sizeof(float),2));
+   TiledTranspose2D(In,Nx,Ny,Out,Shape);
+}
+
+//  ----------------------------------------------------------------------------
+//
+//                               C o l l a p s e
+
+void collapse (float*** In, int Nx, int Ny, int Nz, float** Out)
+{
+   static TileShape Shape = GetShape(StripShapeFor(sizeof(float),2));
+   TiledCollapseZ3D(In,Nx,Ny,Nz,Out,Shape);
+}
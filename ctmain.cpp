@@ -0,0 +1,172 @@
+//
+//                           c t m a i n . c p p
+//
+// Summary:
+//    2D array access test main routine in C++, using typed ArrayManager arrays.
+//
+// Introduction:
+//    This is a test program written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays - the sort of
+//    thing that are common in astronomy and similar scientific disciplines.
+//    This can also be used to see how efficient different ways of coding the
+//    same problem can be in the different languages, and to see what effect
+//    such things as compilation options - particularly optimisation options -
+//    have.
+//
+//    The problem chosen is a trivial one: given an 2D array, add to each
+//    element the sum of its two indices and return the result in a second,
+//    similarly-sized array. This is harder to optimise away than, for example,
+//    simply doing an element by element copy of the array, but is generally
+//    easy to code. It isn't a perfect test (something brought out by the
+//    study), but it does produce some interesting results.
+//
+// This version:
+//    This version is for C++, and is a variation on ckmain.cpp. That uses the
+//    ArrayManager class to allocate arrays using the 'Numerical Recipes'
+//    scheme, and has to cast the void pointer returned by Malloc2D() to a
+//    float**. This version uses the Array2D<float> template class defined in
+//    ArrayTemplates.h, which does the allocation through an ArrayManager but
+//    knows the element type and the array dimensions, so there are no casts
+//    and the dimensions travel with the arrays. Elements are still accessed
+//    as In[Iy][Ix], and the underlying memory layout is exactly the same as
+//    for ckmain.cpp, so any difference in timing comes from what the compiler
+//    can make of the typed interface in the subroutine.
+//
+// Structure:
+//    Most test progrsms in this study code the basic array manipulation in a
+//    single subroutine, then create the original input array, and pass that,
+//    together with the dimensions of the array, to that subroutine, repeating
+//    that call a large number of times in oder to be able to get a reasonable
+//    estimate of the time taken. Then the final result is checked against the
+//    expected result.
+//
+//    This code follows that structure, except that the dimensions don't need
+//    to be passed to the subroutine. The main routine and the subroutine have
+//    to be in different files and compiled separately, or at high levels of
+//    optimisation a C++ compiler may realise that it can optimise out the
+//    entire subroutine. The subroutine must have been written to expect to be
+//    passed Array2D<float> arrays, as is the code in the matching ctsub.cpp.
+//
+// Building:
+//    The file containing the implementation of the subr() routine has to be
+//    compiled separately, using the compiler being tested and with the options
+//    being tested. Then this main program needs to be linked against that
+//    compiled subroutine and the ArrayManager code. For example, something
+//    like:
+//
+//    c++ -c -O -o ctsub.o ctsub.cpp
+//    c++ -o ctmain -O ctmain.cpp ctsub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./ctmain irpt nx ny
+//
+//    where
+//       irpt  is the number of times the subroutine is called - default 1000.
+//       nx    is the number of columns in the array tested - default 2000.
+//       ny    is the number of rows in the array tested - default 10.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ArrayTemplates.h"
+#include "BenchHarness.h"
+
+//  subr() is the subroutine that does the actual array manipulation. It has to
+//  be compiled separately to prevent a compiler optimising it away entirely.
+
+void subr (const Array2D<float>& In, const Array2D<float>& Out);
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("ctmain",Nx,Ny,Nrpt);
+
+   //  Create the input and output 2D arrays, using the Array2D template
+   //  defined in ArrayTemplates.h, which uses an ArrayManager to allocate them.
+
+   ArrayManager Manager;
+   Array2D<float> In(Manager,Ny,Nx);
+   Array2D<float> Out(Manager,Ny,Nx);
+   if (!In.IsValid() || !Out.IsValid()) {
+      printf ("Unable to allocate arrays of %d rows of %d columns\n",Ny,Nx);
+      return 1;
+   }
+
+   //  We set the elements of the input array to some set of values - it doesn't
+   //  matter what, just some values we can use to check the array manipulation
+   //  on. This uses the sum of the row and column indices in descending order.
+   //  We don't need to initialise the output array.
+
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         In[Iy][Ix] = float(Nx - Ix + Ny - Iy);
+      }
+   }
+   printf ("Arrays have %d rows of %d columns, repeats = %d\n",Ny,Nx,Nrpt);
+
+   //  Repeat the call to the manipulating subroutine. A compiler can't optimise
+   //  this out, as it doesn't know that the results will be the same every
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
+
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      subr (In,Out);
+   }
+
+   //  Check that we got the expected results.
+
+   bool Error = false;
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         if (Out[Iy][Ix] != In[Iy][Ix] + Ix + Iy) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Iy,Ix,
+                                   Out[Iy][Ix],float(In[Iy][Ix] + Ix + Iy));
+            break;
+         }
+      }
+      if (Error) break;
+   }
+   Bench.Report(Error);
+   return 0;
+}
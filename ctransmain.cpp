@@ -0,0 +1,140 @@
+//
+//                        c t r a n s m a i n . c p p
+//
+// Summary:
+//    2D array transpose test main routine in C++, using an ArrayManager class.
+//
+// Introduction:
+//    The main test in this study works along the rows of its arrays, which is
+//    the order C/C++ hold them in memory. This program, and ccollmain.cpp, are
+//    for operations that can't do that. A transpose has to read one array
+//    along its rows and write the other down its columns - or the other way
+//    round - and for arrays larger than the cache the strided half of that
+//    can be very slow. This program times a transpose() routine, much as
+//    ckmain.cpp times subr(), so that a straightforward version (cnaivesub.cpp)
+//    can be compared with one that works in cache-sized tiles (ctilesub.cpp).
+//
+// Structure:
+//    This main routine uses an ArrayManager to create an input array In with
+//    Ny rows of Nx columns, and an output array Out with Nx rows of Ny
+//    columns, fills In with test values, and calls transpose() the requested
+//    number of times to set Out[Ix][Iy] to In[Iy][Ix]. Then it checks the
+//    result. As usual, transpose() has to be compiled separately, so the
+//    compiler can't optimise the repeated calls away.
+//
+// Building:
+//    c++ -c -O3 -o ctilesub.o ctilesub.cpp
+//    c++ -o ctransmain -O3 ctransmain.cpp ctilesub.o ArrayManager.cpp ArrayAllocator.cpp
+//
+// Invocation:
+//    ./ctransmain irpt nx ny
+//
+//    where
+//       irpt  is the number of times the subroutine is called - default 1000.
+//       nx    is the number of columns in the input array - default 2000.
+//       ny    is the number of rows in the input array - default 10.
+//
+//    The default size is the one used for the other tests, and fits easily in
+//    the cache. To see any difference between the naive and tiled versions,
+//    use something like 2048 by 2048.
+//
+// History:
+//    14th Oct 2026. Original version.
+//    14th Oct 2026. The transpose() calls are now timed by the harness in
+//                   BenchHarness.h.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ArrayManager.h"
+#include "BenchHarness.h"
+
+//  transpose() is the subroutine that does the actual array manipulation. It has
+//  to be compiled separately to prevent a compiler optimising it away entirely.
+
+void transpose (float** In, int Nx, int Ny, float** Out);
+
+//  ----------------------------------------------------------------------------
+//
+//                             M a i n  P r o g r a m
+
+int main (int argc, char* argv[])
+{
+   //  Set the array dimensions and repeat count either from the default values
+   //  or values supplied on the command line.
+   
+   int Nrpt = 1000;
+   int Nx = 2000;
+   int Ny = 10;
+   if (argc > 1) Nrpt = atoi(argv[1]);
+   if (argc > 2) Nx = atoi(argv[2]);
+   if (argc > 3) Ny = atoi(argv[3]);
+
+   //  Start the benchmark harness, which times the setup, the calls to
+   //  transpose() and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("ctransmain",Nx,Ny,Nrpt);
+   
+   //  Create the input and output arrays. Out has the dimensions of In the
+   //  other way round.
+   
+   ArrayManager Manager;
+   float** In = (float**) Manager.Malloc2D(sizeof(float),Ny,Nx);
+   float** Out = (float**) Manager.Malloc2D(sizeof(float),Nx,Ny);
+   if (In == NULL || Out == NULL) {
+      printf ("Unable to allocate arrays\n");
+      return 1;
+   }
+   
+   //  Set the input array to the same test values used by the other tests.
+   
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         In[Iy][Ix] = float(Nx - Ix + Ny - Iy);
+      }
+   }
+   printf ("Arrays have %d rows of %d columns, repeats = %d\n",Ny,Nx,Nrpt);
+   
+   Bench.StartLoop();
+   while (Bench.Next()) {
+      transpose (In,Nx,Ny,Out);
+   }
+   
+   //  Check that we got the expected results.
+   
+   bool Error = false;
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         if (Out[Ix][Iy] != In[Iy][Ix]) {
+            Error = true;
+            printf ("Error Out[%d][%d] = %f, not %f\n",Ix,Iy,
+                                                Out[Ix][Iy],In[Iy][Ix]);
+            break;
+         }
+      }
+      if (Error) break;
+   }
+   Bench.Report(Error);
+   return 0;
+}
@@ -0,0 +1,81 @@
+//
+//                           c t s u b . c p p
+//
+// Summary:
+//    2D array access test subroutine in C++, using typed ArrayManager arrays.
+//
+// Introduction:
+//    This is a test routine written as part of a study into how well different
+//    languages handle accessing elements of 2D rectangular arrays. This routine
+//    is passed a 2D array (In) with Ny rows and Nx columns, and another 2D
+//    array of the same size (Out). It modifies Out so so each element of Out
+//    is set to the value of the corresponding element of In, plus the sum of
+//    the two index values for the element - ie plus the row number and the
+//    column number. The idea is trivial, but the operation isn't completely
+//    trivial to optimise, and the intention is to see how well this runs when
+//    compiled using different compilers, or using different options.
+//
+// This version:
+//    This version is for C++, and uses the Array2D<T> template class defined
+//    in ArrayTemplates.h, which packages up the 'Numerical Recipes' row
+//    pointer arrays allocated by ArrayManager together with the dimensions of
+//    the array. The element type is a template parameter, so the code that
+//    does the work is written once, as the AddIndices() template, and the
+//    subr() routine called by the main program in ctmain.cpp simply
+//    instantiates it for floats. Because the dimensions come with the arrays,
+//    they don't need to be passed separately. The row pointers are picked up
+//    once per row into __restrict pointers, which tells the compiler that the
+//    input and output rows don't overlap, and the dimensions are copied into
+//    local variables, which tells it they don't change inside the loops.
+//
+//    Note that C/C++ use row-major order; arrays are stored in memory so that
+//    the second index varies fastest. We want the array to be stored so that
+//    elements of the same row are contiguous in memory, so we use the column
+//    number (the X-value) as the second index when setting up the array.
+//
+// History:
+//    14th Oct 2026. Original version.
+//
+// Copyright (c) 2019 Knave and Varlet
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ArrayTemplates.h"
+
+//  AddIndices() is the actual array manipulation, written once for any element
+//  type.
+
+template <typename T>
+inline void AddIndices (const Array2D<T>& In, const Array2D<T>& Out)
+{
+   const long Nx = In.Nx();
+   const long Ny = In.Ny();
+   for (long Iy = 0; Iy < Ny; Iy++) {
+      const T* __restrict InRow = In[Iy];
+      T* __restrict OutRow = Out[Iy];
+      for (long Ix = 0; Ix < Nx; Ix++) {
+         OutRow[Ix] = InRow[Ix] + Ix + Iy;
+      }
+   }
+}
+
+void subr (const Array2D<float>& In, const Array2D<float>& Out)
+{
+   AddIndices (In,Out);
+}
@@ -46,6 +46,12 @@
 //    passed these "<vector<vector<float> >" arrays, and this is the case for
 //    the code in the matching cvrsub.cpp file.
 //
+//    If compiled with USE_MATRIX defined, the arrays are instead created as
+//    Matrix<float> containers (see Matrix.h), which are accessed in the same
+//    way but hold all their rows in one contiguous block, and the Matrix
+//    version of subr() in cvsub.cpp is used. Everything else is the same, so
+//    the two versions can be compared directly.
+//
 // Building:
 //    The file containing the implementation of the subr() routine has to be
 //    compiled separately, using the compiler being tested and with the options
@@ -55,6 +61,10 @@
 //    c++ -c -O -o cvsub.o cvsub.cpp
 //    c++ -o cvmain -O cvmain.cpp cvsub.o
 //
+//    or, for the Matrix version:
+//
+//    c++ -o cvmain -O -DUSE_MATRIX cvmain.cpp cvsub.o
+//
 // Invocation:
 //    ./cvmain irpt nx ny
 //
@@ -73,6 +83,9 @@
 //
 // History:
 //    22nd Sep Jul 2019. Original version. KS.
+//    14th Oct 2026. The subr() calls are now timed by the harness in
+//                   BenchHarness.h.
+//    14th Oct 2026. Added the USE_MATRIX option to use Matrix<float> arrays.
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -98,6 +111,9 @@
 #include <stdio.h>
 #include <vector>
 
+#include "BenchHarness.h"
+#include "Matrix.h"
+
 using std::vector;
 
 //  subr() is the subroutine that does the actual array manipulation. It has to
@@ -105,6 +121,7 @@ using std::vector;
 
 void subr (vector<vector<float> > &In,
                int Nx,int Ny,vector<vector<float> >&Out);
+void subr (const Matrix<float> &In, int Nx, int Ny, Matrix<float> &Out);
 
 int main (int argc, char* argv[])
 {
@@ -118,15 +135,26 @@ int main (int argc, char* argv[])
    if (argc > 2) Nx = atoi(argv[2]);
    if (argc > 3) Ny = atoi(argv[3]);
 
+   //  Start the benchmark harness, which times the setup, the calls to subr()
+   //  and the checking separately (see BenchHarness.h).
+
+   BenchHarness Bench ("cvmain",Nx,Ny,Nrpt);
+
    //  Create the input and output 2D arrays. This uses the fill constructor
    //  for the vector container, setting each element of the In and Out arrays
    //  to a 1D vector Nx elements long. Initialise the input rows - it doesn't
    //  matter what, just some values we can use to check the array manipulation
    //  on. This uses the sum of the row and column indices in descending order.
-   //  We don't need to initialise the output array rows.
+   //  We don't need to initialise the output array rows. (The Matrix version
+   //  creates the same arrays as two single blocks of Ny * Nx elements.)
    
+#ifdef USE_MATRIX
+   Matrix<float> In(Ny,Nx);
+   Matrix<float> Out(Ny,Nx);
+#else
    vector< vector<float> > In(Ny,vector<float>(Nx));
    vector< vector<float> > Out(Ny,vector<float>(Nx));
+#endif
    for (int Iy = 0; Iy < Ny; Iy++) {
       for (int Ix = 0; Ix < Nx; Ix++) {
          In[Iy][Ix] = Nx - Ix + Ny - Iy;
@@ -136,9 +164,11 @@ int main (int argc, char* argv[])
 
    //  Repeat the call to the manipulating subroutine. A compiler can't optimise
    //  this out, as it doesn't know that the results will be the same every
-   //  time.
+   //  time. The harness allows a few untimed warm-up calls first, then exactly
+   //  Nrpt timed calls.
 
-   for (int Loop = 0; Loop < Nrpt; Loop++) {
+   Bench.StartLoop();
+   while (Bench.Next()) {
       subr (In,Nx,Ny,Out);
    }
 
@@ -157,6 +187,7 @@ int main (int argc, char* argv[])
       if (Error) break;
    }
 
+   Bench.Report(Error);
    return 0;
 }
 
@@ -170,6 +201,8 @@ int main (int argc, char* argv[])
       possible in the subr() routine, which are mostly to do with handling
       single rows efficiently, but it might limit what can be done with
       different processing code. (A straight copy of one array to another
-      couldn't collapse down to a single memcpy() call, for example.)
+      couldn't collapse down to a single memcpy() call, for example.) The
+      Matrix<float> container in Matrix.h, used if USE_MATRIX is defined, is
+      the alternative that does keep all the data contiguous.
  
 */
@@ -24,6 +24,12 @@
 //    called from the main test program in cvmain.cpp. See the comments in that
 //    code for more details.
 //
+//    There is also a version of subr() for the Matrix<float> container in
+//    Matrix.h, which keeps the same In[Iy][Ix] syntax but holds all the rows
+//    in one contiguous block. The code is exactly the same, so the two can be
+//    compared directly - cvmain.cpp uses the Matrix version if compiled with
+//    USE_MATRIX defined.
+//
 //    Note that C/C++ use row-major order; arrays are stored in memory so that
 //    the second index varies fastest. We want the array to be stored so that
 //    elements of the same row are contiguous in memory, so we use the column
@@ -33,6 +39,7 @@
 //
 // History:
 //    22nd Sep Jul 2019. Original version. KS.
+//    14th Oct 2026. Added the Matrix<float> version of subr().
 //
 // Copyright (c) 2019 Knave and Varlet
 //
@@ -56,6 +63,8 @@
 
 #include <vector>
 
+#include "Matrix.h"
+
 using std::vector;
 
 void subr (vector<vector<float> > &In,
@@ -68,6 +77,18 @@ void subr (vector<vector<float> > &In,
    }
 }
 
+//  The same, for Matrix<float> arrays, where operator[] returns a pointer to
+//  the start of the row in the one contiguous block.
+
+void subr (const Matrix<float> &In, int Nx, int Ny, Matrix<float> &Out)
+{
+   for (int Iy = 0; Iy < Ny; Iy++) {
+      for (int Ix = 0; Ix < Nx; Ix++) {
+         Out[Iy][Ix] = In[Iy][Ix] + Ix + Iy;
+      }
+   }
+}
+
 // -----------------------------------------------------------------------------
 
 /*                    P r o g r a m m i n g  N o t e s